@@ -15,3 +15,4 @@
 #include "esp_agent_events.h"
 #include "esp_agent_tools.h"
 #include "esp_agent_messages.h"
+#include "esp_agent_metrics.h"
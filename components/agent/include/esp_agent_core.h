@@ -59,6 +59,7 @@ typedef struct {
     esp_agent_conversation_type_t conversation_type;
     esp_agent_audio_config_t *upload_audio_config;
     esp_agent_audio_config_t *download_audio_config;
+    const char *name;           /**< Optional short name (e.g. "intent") used in task names and logs, to tell agents apart when running several */
 } esp_agent_config_t;
 
 /**
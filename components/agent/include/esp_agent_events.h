@@ -12,6 +12,7 @@
 #include <esp_event.h>
 
 #include "esp_agent_core.h"
+#include "esp_agent_metrics.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -40,6 +41,13 @@ typedef enum {
     ESP_AGENT_EVENT_DATA_TYPE_THINKING,
     ESP_AGENT_EVENT_DATA_TYPE_SPEECH,
 
+    ESP_AGENT_EVENT_LATENCY,
+    ESP_AGENT_EVENT_TOOL_CALL,
+    ESP_AGENT_EVENT_LINK_HEALTH,
+    ESP_AGENT_EVENT_IDLE,               /**< No activity for CONFIG_ESP_AGENT_IDLE_TIMEOUT_S, the connection is closed after this event */
+    ESP_AGENT_EVENT_USAGE,              /**< Token counts and server time of a turn, from the server `usage_info` */
+    ESP_AGENT_EVENT_TOOL_INFO,          /**< A tool call started or ended on the server, from `tool_call_info` and `tool_result_info` */
+
     ESP_AGENT_EVENT_DATA_TYPE_MAX,
 } esp_agent_event_t;
 
@@ -61,7 +69,9 @@ typedef enum {
 } esp_agent_message_role_t;
 
 /**
- * @brief Message generation stages, for text data(only applicable for assistant messages).
+ * @brief Message generation stages, for text data.
+ *
+ * User transcripts are UNKNOWN unless the server marks its interim and final transcripts.
  */
 typedef enum {
     ESP_AGENT_MESSAGE_GENERATION_STAGE_SPECULATIVE,
@@ -95,6 +105,40 @@ typedef union {
     struct {
         esp_agent_error_t error;
     } error;
+
+    struct {
+        uint32_t turn;
+        int32_t stage_ms[ESP_AGENT_LATENCY_STAGE_MAX];  /**< Offset from the start of the turn, -1 if not reached */
+    } latency;
+
+    struct {
+        const char *name;
+        const char *request_id;     /**< NULL for a tool run on the device with esp_agent_run_local_tool */
+    } tool;
+
+    struct {
+        int32_t rtt_ms;             /**< Round trip time of the ping just answered, -1 if a pong was missed */
+        uint32_t missed_pongs;      /**< Consecutive pings without a pong */
+        uint32_t silent_ms;         /**< Time since the last pong, if a pong was missed */
+        bool dead;                  /**< Too many pongs missed, the connection is torn down and started again */
+    } link_health;
+
+    struct {
+        uint32_t turn;              /**< Latency turn the usage belongs to, as in the latency event */
+        uint32_t input_tokens;      /**< Totals of the turn so far, if the server reports usage several times */
+        uint32_t output_tokens;
+        int32_t server_ms;          /**< Server time from the end of the request to the first reply, the first reported in the turn, -1 if none */
+        int32_t response_ms;        /**< Device time from `audio_stream_end` to the first downlink frame, -1 if not measured */
+        int32_t network_ms;         /**< response_ms - server_ms: network and device time, -1 if either is unknown */
+    } usage;
+
+    struct {
+        const char *name;
+        const char *call_id;        /**< NULL if the server did not send one */
+        bool result;                /**< false for `tool_call_info`, true for `tool_result_info` */
+        int64_t server_timestamp_ms;    /**< Timestamp sent by the server, -1 if none */
+        int32_t duration_ms;        /**< For a result: time since the call, -1 if the call was not seen */
+    } tool_info;
 } esp_agent_message_data_t;
 
 /**
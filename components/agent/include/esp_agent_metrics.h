@@ -0,0 +1,521 @@
+/**
+ * @file
+ * @brief ESP Agent metrics API for latency and transport statistics
+ *
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <esp_err.h>
+
+#include "esp_agent_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Stages of a voice turn, from the end of user speech to the first reply sample played.
+ *
+ * Stages up to `ESP_AGENT_LATENCY_STAGE_AUDIO_STREAM_END` describe the request and the latest
+ * mark wins. The remaining stages describe the response and only the first mark is kept.
+ */
+typedef enum {
+    ESP_AGENT_LATENCY_STAGE_VAD_END,                /**< Local VAD detected the end of user speech */
+    ESP_AGENT_LATENCY_STAGE_UPLINK_LAST_FRAME,      /**< Last uplink audio frame handed to the websocket */
+    ESP_AGENT_LATENCY_STAGE_AUDIO_STREAM_END,       /**< `audio_stream_end` queued */
+    ESP_AGENT_LATENCY_STAGE_DOWNLINK_FIRST_FRAME,   /**< First downlink audio frame received */
+    ESP_AGENT_LATENCY_STAGE_FIRST_DECODED_FRAME,    /**< First reply frame decoded by the playback pipeline, after the first downlink frame */
+    ESP_AGENT_LATENCY_STAGE_FIRST_CODEC_WRITE,      /**< First reply frame written to the codec */
+    ESP_AGENT_LATENCY_STAGE_MAX,
+} esp_agent_latency_stage_t;
+
+/**
+ * @brief Rolling percentiles over the last turns, in milliseconds.
+ */
+typedef struct {
+    uint32_t samples;       /**< Number of turns in the window */
+    uint32_t p50_ms;
+    uint32_t p90_ms;
+    uint32_t p99_ms;
+    uint32_t max_ms;
+} esp_agent_latency_percentiles_t;
+
+/**
+ * @brief Transport message counters.
+ *
+ * Tool counters are a subset of the text counters in the same direction.
+ */
+typedef enum {
+    ESP_AGENT_TRANSPORT_COUNTER_TX_TEXT,
+    ESP_AGENT_TRANSPORT_COUNTER_TX_AUDIO,
+    ESP_AGENT_TRANSPORT_COUNTER_TX_TOOL,        /**< Tool responses sent */
+    ESP_AGENT_TRANSPORT_COUNTER_RX_TEXT,
+    ESP_AGENT_TRANSPORT_COUNTER_RX_AUDIO,
+    ESP_AGENT_TRANSPORT_COUNTER_RX_TOOL,        /**< Tool requests received */
+    ESP_AGENT_TRANSPORT_COUNTER_MAX,
+} esp_agent_transport_counter_t;
+
+/**
+ * @brief Transport queues with latency tracking.
+ */
+typedef enum {
+    ESP_AGENT_TRANSPORT_QUEUE_SEND,             /**< `esp_agent_websocket_queue_message` to the websocket send task */
+    ESP_AGENT_TRANSPORT_QUEUE_MESSAGE,          /**< Websocket event handler to the message processing task */
+    ESP_AGENT_TRANSPORT_QUEUE_MAX,
+} esp_agent_transport_queue_t;
+
+/**
+ * @brief Rolling percentiles of the time messages spend in a queue, in microseconds.
+ */
+typedef struct {
+    uint32_t samples;       /**< Number of messages in the window */
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} esp_agent_queue_latency_t;
+
+/**
+ * @brief Text message compression statistics in one direction.
+ *
+ * The compression ratio is `original_bytes / compressed_bytes`.
+ */
+typedef struct {
+    uint32_t messages;          /**< Messages compressed or decompressed */
+    uint64_t original_bytes;
+    uint64_t compressed_bytes;  /**< Size on the wire, including the base64 encoding */
+    uint64_t cpu_us;            /**< Time spent compressing or decompressing */
+} esp_agent_compression_stats_t;
+
+/**
+ * @brief Uplink audio statistics, to compare the cost of one message per frame with aggregation.
+ *
+ * The overhead is the websocket frame header (with the mask key) and, when frames are aggregated,
+ * the length prefix of each frame.
+ */
+typedef struct {
+    uint32_t frames;                            /**< Audio frames sent */
+    uint32_t messages;                          /**< Binary messages carrying them */
+    uint64_t overhead_bytes;
+    uint32_t window_ms;                         /**< Current aggregation window, 0 while the link keeps up */
+    esp_agent_queue_latency_t added_latency;    /**< Time the first frame of a message waited for the next ones */
+} esp_agent_audio_uplink_stats_t;
+
+/**
+ * @brief Websocket write statistics of the send task.
+ *
+ * A stall is a write which blocked for more than 50 ms, e.g. while the socket buffer was full.
+ */
+typedef struct {
+    uint32_t fragmented_messages;               /**< Messages larger than CONFIG_ESP_AGENT_SEND_FRAGMENT_SIZE */
+    uint32_t fragments;                         /**< Fragments of those messages */
+    uint32_t stalls;
+    uint64_t stall_ms;                          /**< Time spent blocked in stalled writes */
+    uint32_t deadline_expired;                  /**< Writes which made no progress within CONFIG_ESP_AGENT_WRITE_DEADLINE_MS */
+    esp_agent_queue_latency_t write_time;       /**< Duration of each websocket write */
+} esp_agent_send_path_stats_t;
+
+/**
+ * @brief Transport statistics since the agent was initialized or the statistics were reset.
+ */
+typedef struct {
+    int64_t elapsed_us;                                         /**< Time covered by the statistics */
+    uint32_t messages[ESP_AGENT_TRANSPORT_COUNTER_MAX];
+    uint64_t bytes[ESP_AGENT_TRANSPORT_COUNTER_MAX];
+    uint32_t tx_dropped;                                        /**< Outgoing messages dropped (queue full or not connected) */
+    uint32_t rx_dropped;                                        /**< Incoming messages dropped (queue full or no memory) */
+    uint64_t bytes_copied;                                      /**< Payload bytes copied by the transport */
+    uint32_t allocations;                                       /**< Heap allocations made by the transport */
+    esp_agent_queue_latency_t queue_latency[ESP_AGENT_TRANSPORT_QUEUE_MAX];
+    esp_agent_compression_stats_t tx_compression;
+    esp_agent_compression_stats_t rx_compression;
+    uint32_t compression_memory;                                /**< Heap currently used by the compressor and decompressor */
+    esp_agent_audio_uplink_stats_t audio_uplink;
+    esp_agent_send_path_stats_t send_path;
+} esp_agent_transport_stats_t;
+
+/**
+ * @brief Keep-alive ping statistics since the agent was initialized.
+ */
+typedef struct {
+    uint32_t pings_sent;
+    uint32_t pongs_received;
+    uint32_t missed_pongs;                  /**< Pings not answered before the next one was due */
+    uint32_t dead_links;                    /**< Connections torn down because of missed pongs */
+    esp_agent_latency_percentiles_t rtt;    /**< Round trip time over the last pongs */
+} esp_agent_link_health_t;
+
+/**
+ * @brief Connection statistics since the agent was initialized.
+ *
+ * The time spent connected and the number of connects are proxies for the radio-on time
+ * and the wakeups of the radio.
+ */
+typedef struct {
+    uint32_t connects;                      /**< Connections which reached the handshake ack */
+    uint32_t resumes;                       /**< Of which reused the cached access token and the conversation */
+    uint32_t idle_closes;                   /**< Connections closed after CONFIG_ESP_AGENT_IDLE_TIMEOUT_S without activity */
+    uint64_t connected_ms;                  /**< Time spent connected */
+    uint64_t uptime_ms;                     /**< Time since boot, to compare connected_ms with */
+    esp_agent_latency_percentiles_t connect;    /**< Time from start to handshake ack, cold connects */
+    esp_agent_latency_percentiles_t resume;     /**< Time from start to handshake ack, resumed connections */
+    uint32_t stops;                         /**< Sessions ended by esp_agent_stop */
+    esp_agent_queue_latency_t start_call;   /**< Time spent in esp_agent_start, including the token refresh */
+    esp_agent_queue_latency_t stop_call;    /**< Time spent in esp_agent_stop, including the close handshake */
+    uint32_t heap_free_first;               /**< Free heap after the first stop */
+    uint32_t heap_free_last;                /**< Free heap after the last stop, a drop from the first is a leak */
+    uint32_t heap_largest_block_last;       /**< Largest free heap block after the last stop */
+    uint32_t heap_largest_block_min;        /**< Smallest of those over all stops, a drop shows fragmentation */
+} esp_agent_connection_stats_t;
+
+/**
+ * @brief Event streams of intermediate updates, rate limited to `CONFIG_ESP_AGENT_EVENT_STREAM_WINDOW_MS`.
+ */
+typedef enum {
+    ESP_AGENT_EVENT_STREAM_THINKING,        /**< Thinking events */
+    ESP_AGENT_EVENT_STREAM_SPECULATIVE,     /**< Speculative assistant text events */
+    ESP_AGENT_EVENT_STREAM_USER_SPECULATIVE,    /**< Interim user transcript events */
+    ESP_AGENT_EVENT_STREAM_MAX,
+} esp_agent_event_stream_t;
+
+/**
+ * @brief Updates of an event stream received from the server and delivered as events.
+ *
+ * The difference was merged into the next update, or discarded for the final text. Not counted if
+ * `CONFIG_ESP_AGENT_EVENT_STREAM_WINDOW_MS` is 0.
+ */
+typedef struct {
+    uint32_t received;
+    uint32_t delivered;
+    uint32_t discarded;                     /**< Held updates superseded by the final text of the same role */
+} esp_agent_event_stream_stats_t;
+
+/**
+ * @brief Statistics of the events which could not be posted right away, since the agent was initialized.
+ *
+ * Events are never posted with a timeout, so that the websocket and message tasks do not stall
+ * when the event loop is busy. Thinking, latency, link health and idle events are superseded
+ * by the next one of their type, the other events are posted later in order.
+ */
+typedef struct {
+    uint32_t deferred;                      /**< Events posted later, because the event loop was full */
+    uint32_t replaced;                      /**< Deferred events dropped for a newer one of the same type */
+    uint32_t dropped;                       /**< Events dropped because the backlog was full too */
+    uint32_t cleared;                       /**< Text, thinking and speech still deferred when the agent was stopped, not delivered */
+    uint32_t backlog;                       /**< Events currently deferred, in order */
+    uint32_t max_backlog;
+    esp_agent_event_stream_stats_t streams[ESP_AGENT_EVENT_STREAM_MAX];    /**< Rate limited intermediate updates */
+} esp_agent_event_stats_t;
+
+/**
+ * @brief Statistics of the sequenced text messages and their replay after a reconnect, since the agent was initialized.
+ *
+ * Only text messages are sequenced. Audio frames lost with the connection are not replayed.
+ */
+typedef struct {
+    bool negotiated;                        /**< The server accepted sequencing in the last handshake */
+    uint32_t tx_seq;                        /**< Sequence number of the last message sent */
+    uint32_t rx_seq;                        /**< Sequence number of the last message received */
+    uint32_t unacked;                       /**< Messages sent but not acknowledged yet, kept for replay */
+    uint32_t resumes;                       /**< Reconnects after a lost connection which resumed the conversation */
+    uint32_t replayed_messages;             /**< Messages sent again after a reconnect */
+    uint64_t replayed_bytes;
+    uint32_t duplicates;                    /**< Messages replayed by the server, but received before the reconnect */
+    uint32_t gaps;                          /**< Messages from the server which never arrived */
+    uint32_t evicted;                       /**< Unacknowledged messages dropped from the full retransmit buffer */
+    esp_agent_latency_percentiles_t recovery;   /**< Time from the lost connection to the replay */
+} esp_agent_resume_stats_t;
+
+/**
+ * @brief Usage reported by the server since the agent was initialized.
+ *
+ * The server time and the network time (the device measured response time minus the server time)
+ * separate where the response time of the turns went. Both are sampled once per turn, from the
+ * first usage of the turn reporting them, as the response time is measured to the first reply.
+ */
+typedef struct {
+    uint32_t turns;                         /**< Turns with usage reported */
+    uint64_t input_tokens;
+    uint64_t output_tokens;
+    uint32_t session_turns;                 /**< Turns with usage reported since the agent was last started */
+    uint64_t session_input_tokens;
+    uint64_t session_output_tokens;
+    esp_agent_latency_percentiles_t server;     /**< Server time per turn */
+    esp_agent_latency_percentiles_t network;    /**< Network and device time per turn */
+} esp_agent_usage_stats_t;
+
+/**
+ * @brief Tool requests received more than once, e.g. after a reconnect or a server retry.
+ *
+ * All zero unless `CONFIG_ESP_AGENT_TOOL_DEDUP_WINDOW_MS` is set.
+ */
+typedef struct {
+    uint32_t requests;                      /**< Tool requests received from the server */
+    uint32_t duplicates;                    /**< Requests not run again, because their request ID was seen before */
+    uint32_t in_flight_duplicates;          /**< Duplicates ignored because the tool was still running */
+    uint32_t evicted;                       /**< Requests forgotten before the end of the window, for lack of room */
+    uint32_t entries;                       /**< Requests currently remembered */
+    uint32_t bytes;                         /**< Heap used by the remembered request IDs and responses */
+} esp_agent_tool_dedup_stats_t;
+
+/**
+ * @brief Results of read-only tools served from the cache, see `esp_agent_tool_config_t`.
+ */
+typedef struct {
+    uint32_t hits;                          /**< Requests answered from the cache */
+    uint32_t misses;                        /**< Requests to a cacheable tool which ran the tool */
+    uint32_t invalidated;                   /**< Results dropped by esp_agent_invalidate_tool_cache() */
+    uint64_t saved_ms;                      /**< Run time of the tool calls saved by the hits */
+    uint32_t entries;                       /**< Results currently cached */
+} esp_agent_tool_cache_stats_t;
+
+/**
+ * @brief Concurrent local tool calls, limited to `CONFIG_ESP_AGENT_TOOL_MAX_CONCURRENT`.
+ */
+typedef struct {
+    uint32_t running;                       /**< Tool calls currently running in their task */
+    uint32_t max_running;
+    uint32_t slot_waits;                    /**< Calls which waited for a running one to end, because of the limit */
+    uint32_t serialized_waits;              /**< Calls to a non-reentrant tool which waited for the previous call */
+    uint32_t validated;                     /**< Requests checked against the parameters declared by the tool */
+    uint32_t rejected;                      /**< Requests answered with an error, without running the tool */
+    uint64_t validation_us;                 /**< Time spent checking the requests */
+} esp_agent_tool_exec_stats_t;
+
+/**
+ * @brief Transport buffers whose memory placement is set in menuconfig (Transport buffer placement).
+ */
+typedef enum {
+    ESP_AGENT_MEM_TX_TEXT,                  /**< Text messages queued for the send task */
+    ESP_AGENT_MEM_TX_AUDIO,                 /**< Audio frames queued for the send task, and packed frames */
+    ESP_AGENT_MEM_RX_TEXT,                  /**< Reassembly buffer and text messages queued for the message task */
+    ESP_AGENT_MEM_RX_AUDIO,                 /**< Audio frames posted in `ESP_AGENT_EVENT_DATA_TYPE_SPEECH` */
+    ESP_AGENT_MEM_MAX,
+} esp_agent_mem_buffer_t;
+
+/**
+ * @brief Allocations of a transport buffer since the agent was initialized.
+ *
+ * The copy throughput of the placement is `timed_copy_bytes / copy_us` (MB/s). Only one copy
+ * in 16 is timed.
+ */
+typedef struct {
+    uint32_t caps;                          /**< Heap capabilities requested, 0 for the default heap */
+    uint32_t allocations;
+    uint32_t internal_allocations;          /**< Of which landed in internal RAM */
+    uint32_t fallbacks;                     /**< Allocations which did not fit in the requested memory, served by the default heap */
+    uint32_t failures;
+    uint64_t bytes;                         /**< Bytes allocated */
+    uint64_t internal_bytes;                /**< Of which in internal RAM */
+    uint32_t copies;                        /**< Copies into these buffers */
+    uint64_t copy_bytes;                    /**< Bytes copied into these buffers */
+    uint64_t timed_copy_bytes;              /**< Bytes of the copies which were timed */
+    uint64_t copy_us;                       /**< Time spent on the timed copies */
+} esp_agent_mem_buffer_stats_t;
+
+/**
+ * @brief Placement of the transport buffers and free memory.
+ */
+typedef struct {
+    esp_agent_mem_buffer_stats_t buffers[ESP_AGENT_MEM_MAX];
+    bool queues_external;                   /**< The message and send queues are in PSRAM */
+    uint32_t internal_free;                 /**< Free internal RAM */
+    uint32_t internal_min_free;             /**< Lowest free internal RAM since boot */
+    uint32_t external_free;                 /**< Free PSRAM, 0 without PSRAM */
+} esp_agent_mem_stats_t;
+
+#define ESP_AGENT_TOOL_STATS_NAME_LEN 32
+
+/**
+ * @brief Number of buckets of the tool latency histograms.
+ *
+ * The buckets end at 10, 50, 100, 250, 500, 1000 and 2500 ms, the last one holds the slower calls.
+ */
+#define ESP_AGENT_TOOL_HISTOGRAM_BUCKETS 8
+
+/**
+ * @brief Where a tool ran.
+ */
+typedef enum {
+    ESP_AGENT_TOOL_TIMING_CLOUD,            /**< Tool run by the server, from `tool_call_info` to `tool_result_info` */
+    ESP_AGENT_TOOL_TIMING_LOCAL,            /**< Local tool run on the device */
+    ESP_AGENT_TOOL_TIMING_MAX,
+} esp_agent_tool_timing_source_t;
+
+/**
+ * @brief Latency of the calls to a tool.
+ */
+typedef struct {
+    uint32_t calls;
+    uint64_t total_ms;
+    uint32_t max_ms;
+    uint32_t histogram[ESP_AGENT_TOOL_HISTOGRAM_BUCKETS];
+} esp_agent_tool_timing_t;
+
+/**
+ * @brief Latency of a tool since the agent was initialized.
+ */
+typedef struct {
+    char name[ESP_AGENT_TOOL_STATS_NAME_LEN];               /**< Truncated if longer */
+    esp_agent_tool_timing_t timing[ESP_AGENT_TOOL_TIMING_MAX];
+    uint32_t stack_size;                    /**< Stack of the tool task, 0 if the tool never ran in its own task */
+    uint32_t stack_min_free;                /**< Lowest stack space left at the end of a call (high-water mark), in bytes */
+} esp_agent_tool_stats_t;
+
+/**
+ * @brief Record the time at which a turn reached a stage.
+ *
+ * The agent marks the transport stages itself. The application marks the stages it owns
+ * (VAD end, first decoded frame, first codec write). Marking `ESP_AGENT_LATENCY_STAGE_FIRST_CODEC_WRITE`
+ * completes the turn and emits `ESP_AGENT_EVENT_LATENCY` with the per-stage breakdown.
+ *
+ * This is cheap and safe to call for every frame from any task.
+ *
+ * @param[in] handle Agent handle obtained from esp_agent_init
+ * @param[in] stage Stage reached
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_latency_mark(esp_agent_handle_t handle, esp_agent_latency_stage_t stage);
+
+/**
+ * @brief Get rolling percentiles of the time from the start of the turn to a stage.
+ *
+ * The start of the turn is the VAD end if it was marked, otherwise the earliest request stage.
+ * Use `ESP_AGENT_LATENCY_STAGE_FIRST_CODEC_WRITE` for the end-to-end latency.
+ *
+ * @param[in] handle Agent handle obtained from esp_agent_init
+ * @param[in] stage Stage to get the percentiles for
+ * @param[out] percentiles Percentiles over the last turns
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_latency_get_percentiles(esp_agent_handle_t handle, esp_agent_latency_stage_t stage, esp_agent_latency_percentiles_t *percentiles);
+
+/**
+ * @brief Get the transport statistics.
+ *
+ * Message rates can be derived from the counters and `elapsed_us`.
+ *
+ * @param[in] handle Agent handle obtained from esp_agent_init
+ * @param[out] stats Transport statistics
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_get_transport_stats(esp_agent_handle_t handle, esp_agent_transport_stats_t *stats);
+
+/**
+ * @brief Reset the transport statistics, e.g. at the start of a measurement.
+ *
+ * @param[in] handle Agent handle obtained from esp_agent_init
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_reset_transport_stats(esp_agent_handle_t handle);
+
+/**
+ * @brief Get the keep-alive ping statistics.
+ *
+ * Pings are sent every `CONFIG_ESP_AGENT_KEEPALIVE_INTERVAL_MS` while connected. The round trip time
+ * includes the time the ping waits in the send queue.
+ *
+ * @param[in] handle Agent handle obtained from esp_agent_init
+ * @param[out] health Keep-alive ping statistics
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_get_link_health(esp_agent_handle_t handle, esp_agent_link_health_t *health);
+
+/**
+ * @brief Get the connection statistics.
+ *
+ * @param[in] handle Agent handle obtained from esp_agent_init
+ * @param[out] stats Connection statistics
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_get_connection_stats(esp_agent_handle_t handle, esp_agent_connection_stats_t *stats);
+
+/**
+ * @brief Get the statistics of the events which could not be posted right away.
+ *
+ * @param[in] handle Agent handle obtained from esp_agent_init
+ * @param[out] stats Event statistics
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_get_event_stats(esp_agent_handle_t handle, esp_agent_event_stats_t *stats);
+
+/**
+ * @brief Get the statistics of the sequenced text messages.
+ *
+ * All zero unless `CONFIG_ESP_AGENT_RESUME` is enabled.
+ *
+ * @param[in] handle Agent handle obtained from esp_agent_init
+ * @param[out] stats Resume statistics
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_get_resume_stats(esp_agent_handle_t handle, esp_agent_resume_stats_t *stats);
+
+/**
+ * @brief Get the usage reported by the server.
+ *
+ * Each `usage_info` message from the server is also posted as `ESP_AGENT_EVENT_USAGE`.
+ *
+ * @param[in] handle Agent handle obtained from esp_agent_init
+ * @param[out] stats Usage statistics
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_get_usage_stats(esp_agent_handle_t handle, esp_agent_usage_stats_t *stats);
+
+/**
+ * @brief Get the statistics of the duplicate tool requests.
+ *
+ * @param[in] handle Agent handle obtained from esp_agent_init
+ * @param[out] stats Duplicate tool request statistics
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_get_tool_dedup_stats(esp_agent_handle_t handle, esp_agent_tool_dedup_stats_t *stats);
+
+/**
+ * @brief Get the statistics of the cached results of read-only tools.
+ *
+ * @param[in] handle Agent handle obtained from esp_agent_init
+ * @param[out] stats Tool cache statistics
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_get_tool_cache_stats(esp_agent_handle_t handle, esp_agent_tool_cache_stats_t *stats);
+
+/**
+ * @brief Get the statistics of the concurrent local tool calls.
+ *
+ * @param[in] handle Agent handle obtained from esp_agent_init
+ * @param[out] stats Tool execution statistics
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_get_tool_exec_stats(esp_agent_handle_t handle, esp_agent_tool_exec_stats_t *stats);
+
+/**
+ * @brief Get the allocations of each transport buffer and the free memory.
+ *
+ * @param[in] handle Agent handle obtained from esp_agent_init
+ * @param[out] stats Memory statistics
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_get_mem_stats(esp_agent_handle_t handle, esp_agent_mem_stats_t *stats);
+
+/**
+ * @brief Get the latency of the tools called so far.
+ *
+ * Up to `CONFIG_ESP_AGENT_TOOL_STATS_MAX` tools are tracked; calls to further tools are not.
+ *
+ * @param[in] handle Agent handle obtained from esp_agent_init
+ * @param[out] stats Array receiving the statistics of each tool
+ * @param[in] max_tools Size of the array
+ * @param[out] num_tools Number of tools written to the array
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_get_tool_stats(esp_agent_handle_t handle, esp_agent_tool_stats_t *stats, size_t max_tools, size_t *num_tools);
+
+#ifdef __cplusplus
+}
+#endif
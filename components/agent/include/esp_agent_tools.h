@@ -61,6 +61,54 @@ typedef struct {
  */
 typedef esp_err_t (*esp_agent_tool_handler_t)(esp_agent_handle_t handle, const char *tool_name, esp_agent_tool_param_t params[], size_t num_params, void *user_data, char **result);
 
+/**
+ * @brief Declaration of a tool parameter, checked before the tool runs
+ */
+typedef struct {
+    const char *name;
+    esp_agent_tool_param_type_t type;
+    bool required;
+    bool has_range;                         /**< The value (int) or the length (string) must be within [min, max] */
+    int min;
+    int max;
+} esp_agent_tool_param_schema_t;
+
+/**
+ * @brief Where a local tool runs, when requested by the server
+ */
+typedef enum {
+    ESP_AGENT_TOOL_EXEC_TASK,               /**< In a task created for the call (default) */
+    ESP_AGENT_TOOL_EXEC_INLINE,             /**< In the message task, for trivial tools which never block */
+} esp_agent_tool_exec_mode_t;
+
+/**
+ * @brief Local tool configuration
+ */
+typedef struct {
+    const char *name;                       /**< Name of the tool */
+    esp_agent_tool_handler_t handler;       /**< Tool handler */
+    void *user_data;                        /**< User data passed to the tool handler */
+    /**
+     * For read-only tools (e.g. sensor readings): a request with the same parameters as a successful
+     * call less than this long ago is answered with its result, without running the tool.
+     * Use esp_agent_invalidate_tool_cache() when the state the tool reads changes. 0 to run every call.
+     */
+    uint32_t cache_ttl_ms;
+    esp_agent_tool_exec_mode_t exec_mode;   /**< Where the tool runs */
+    uint32_t stack_size;                    /**< Stack of the tool task in bytes, 0 for CONFIG_ESP_AGENT_TOOL_TASK_STACK_SIZE */
+    uint8_t priority;                       /**< Priority of the tool task, 0 for CONFIG_ESP_AGENT_TOOL_TASK_PRIORITY */
+    bool pin_to_core;                       /**< Run the tool task on core_id only, e.g. away from the audio tasks */
+    int core_id;
+    bool non_reentrant;                     /**< Calls to this tool run one at a time, in order */
+    /**
+     * Parameters of the tool (copied), as declared to the agent. A request with a missing required parameter,
+     * a parameter of another type or out of range is answered with an error, without running the tool.
+     * Parameters not declared here are passed on. NULL to pass all requests to the tool.
+     */
+    const esp_agent_tool_param_schema_t *params;
+    size_t num_params;
+} esp_agent_tool_config_t;
+
 /**
  * @brief Registers a local tool handler with the agent.
  *
@@ -72,6 +120,24 @@ typedef esp_err_t (*esp_agent_tool_handler_t)(esp_agent_handle_t handle, const c
  */
 esp_err_t esp_agent_register_local_tool(esp_agent_handle_t handle, const char *name, esp_agent_tool_handler_t tool_handler, void *user_data);
 
+/**
+ * @brief Registers a local tool with the agent, with options.
+ *
+ * @param[in] handle Agent handle obtained from esp_agent_init
+ * @param[in] config Tool configuration (copied)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_register_local_tool_with_config(esp_agent_handle_t handle, const esp_agent_tool_config_t *config);
+
+/**
+ * @brief Drop the cached results of a tool, e.g. because the state it reads changed.
+ *
+ * @param[in] handle Agent handle obtained from esp_agent_init
+ * @param[in] name Name of the tool, NULL for all tools
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_invalidate_tool_cache(esp_agent_handle_t handle, const char *name);
+
 /**
  * @brief This unregisters the local tool for the agent.
  *
@@ -81,6 +147,27 @@ esp_err_t esp_agent_register_local_tool(esp_agent_handle_t handle, const char *n
  */
 esp_err_t esp_agent_unregister_local_tool(esp_agent_handle_t handle, const char *name);
 
+/**
+ * @brief Run a registered local tool right away, without waiting for the server to request it.
+ *
+ * This is the fast path for simple commands recognized on the device, e.g. from the user transcript.
+ * The tool handler runs in the calling task. Its result is kept for CONFIG_ESP_AGENT_LOCAL_TOOL_RESULT_TTL_MS:
+ * if the server requests the same tool with the same parameters within that time, the request is answered
+ * with this result instead of running the tool a second time. A request received while the tool is still
+ * running is answered when it returns. That tool response is how the server learns about the command.
+ *
+ * The reconciliation is best-effort: a request with other parameters, or received after the TTL, runs the
+ * tool again, and the server does not learn about a local run it never requests.
+ *
+ * @param[in] handle Agent handle obtained from esp_agent_init
+ * @param[in] name Name of a registered local tool
+ * @param[in] params Array of tool parameters (copied)
+ * @param[in] num_params Number of tool parameters
+ * @return ESP_OK if the tool succeeded, ESP_ERR_NOT_FOUND if no such tool is registered,
+ *         the error returned by the tool handler otherwise
+ */
+esp_err_t esp_agent_run_local_tool(esp_agent_handle_t handle, const char *name, const esp_agent_tool_param_t params[], size_t num_params);
+
 #ifdef __cplusplus
 }
 #endif
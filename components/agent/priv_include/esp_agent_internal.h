@@ -10,6 +10,17 @@
 #include <esp_websocket_client.h>
 #include <esp_timer.h>
 #include <freertos/event_groups.h>
+#include <freertos/semphr.h>
+
+#include <esp_agent_internal_metrics.h>
+#include <esp_agent_internal_keepalive.h>
+#include <esp_agent_internal_compression.h>
+#include <esp_agent_internal_connection.h>
+#include <esp_agent_internal_resume.h>
+#include <esp_agent_internal_aggregation.h>
+#include <esp_agent_internal_tool_stats.h>
+#include <esp_agent_internal_tool_dedup.h>
+#include <esp_agent_internal_mem.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -17,30 +28,168 @@ extern "C" {
 
 ESP_EVENT_DECLARE_BASE(AGENT_EVENT);
 
+#if CONFIG_ESP_AGENT_API_USE_TLS
 #define ESP_AGENT_API_USE_TLS 1
+#else
+#define ESP_AGENT_API_USE_TLS 0
+#endif
 
 /* Event group bits for task stop signals */
 #define MESSAGE_TASK_STOP_BIT BIT0
 #define SEND_TASK_STOP_BIT    BIT1
 
+/* Event group bits for work done in the message task, as it blocks and must not run in the event loop */
+#define LINK_DOWN_REQUEST_BIT  BIT2
+#define IDLE_CLOSE_REQUEST_BIT BIT3
+#define AGENT_WORK_BITS        (LINK_DOWN_REQUEST_BIT | IDLE_CLOSE_REQUEST_BIT)
+
+/* Event group bits for emptying the send queue on stop, done by the send task as the only one taking messages from it */
+#define SEND_QUEUE_PURGE_BIT   BIT4
+#define SEND_QUEUE_PURGED_BIT  BIT5
+
+/* Set on connect, so that the send task runs the write deadline of the new connection from then */
+#define SEND_PROGRESS_RESET_BIT BIT6
+
 typedef enum {
     ESP_AGENT_HANDSHAKE_NOT_DONE,
     ESP_AGENT_HANDSHAKE_AWAITING_ACK,
     ESP_AGENT_HANDSHAKE_DONE,
 } esp_agent_handshake_state_t;
 
+/* Serializes the calls to a non-reentrant tool. Shared by the tool and its running calls, so that
+ * unregistering the tool does not delete the mutex under a waiting call.
+ */
+typedef struct {
+    SemaphoreHandle_t mutex;                       /* Held by the running call, from the server or esp_agent_run_local_tool() */
+    uint32_t refs;                                 /* Protected by the tool execution lock */
+    bool busy;                                     /* A call from the server was dispatched, protected by the tool execution lock */
+} esp_agent_tool_serial_t;
+
 /* Local tool node structure for simple linked list */
 typedef struct local_tool_node {
     char *name;                                    /* Tool name (dynamically allocated) */
     esp_agent_tool_handler_t tool_handler;         /* Function pointer */
     void *user_data;                               /* User-provided context */
+    uint32_t cache_ttl_ms;                         /* 0 if the results are not cached */
+    esp_agent_tool_exec_mode_t exec_mode;
+    uint32_t stack_size;                           /* Of the tool task, defaults applied */
+    UBaseType_t priority;
+    BaseType_t core_id;                            /* tskNO_AFFINITY if not pinned */
+    esp_agent_tool_serial_t *serial;               /* NULL if the tool is reentrant */
+    esp_agent_tool_param_schema_t *schema;         /* Copy of the declared parameters, NULL if none */
+    size_t num_schema;
     struct local_tool_node *next;                 /* Next node in the list */
 } local_tool_node_t;
 
+/* Last local tool run on the device (esp_agent_run_local_tool), kept to answer the
+ * matching request from the server without running the tool again. Stored before the tool
+ * runs, so that a request received meanwhile is answered when it ends. A mutex, as the
+ * parameters of the requests are compared under it.
+ */
+typedef struct {
+    SemaphoreHandle_t lock;
+    uint32_t run;                                  /* Number of the run, kept when the result is taken */
+    char *tool_name;                               /* NULL if there is no result */
+    esp_agent_tool_param_t *parameters;
+    size_t num_parameters;
+    bool running;                                  /* The tool has not returned yet */
+    char *request_id;                              /* Server request to answer when it returns */
+    esp_err_t status;
+    char *result;
+    int64_t ran_at_us;                             /* When the tool returned */
+} esp_agent_local_tool_result_t;
+
+/* Result of a successful call to a cacheable tool */
+typedef struct {
+    char *tool_name;                               /* NULL if the entry is free */
+    esp_agent_tool_param_t *parameters;
+    size_t num_parameters;
+    char *result;
+    int64_t expires_us;
+    uint32_t run_ms;                               /* Time the call took, saved by each hit */
+} esp_agent_tool_cache_entry_t;
+
+/* Results of read-only tools. A mutex, as the hits copy the result. */
+typedef struct {
+    SemaphoreHandle_t lock;
+    esp_agent_tool_cache_entry_t entries[CONFIG_ESP_AGENT_TOOL_CACHE_ENTRIES];
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t invalidated;
+    uint64_t saved_ms;
+    uint32_t generation;                           /* Incremented by each invalidation */
+} esp_agent_tool_cache_t;
+
+/* Tool calls running in their own task. Calls beyond CONFIG_ESP_AGENT_TOOL_MAX_CONCURRENT wait in
+ * order, without a task, until a running one ends.
+ */
+typedef struct {
+    portMUX_TYPE lock;                             /* Protects the pending calls, the counters and the serial refs */
+    struct esp_agent_tool_request *pending;        /* Calls waiting for a slot, in arrival order */
+    struct esp_agent_tool_request *pending_tail;
+    uint32_t running;
+    uint32_t max_running;
+    uint32_t slot_waits;
+    uint32_t serialized_waits;
+    uint32_t validated;
+    uint32_t rejected;
+    uint64_t validation_us;
+} esp_agent_tool_exec_t;
+
+/* Complete text message received from the server, queued for the message processing task */
+typedef struct {
+    char *message;
+    int64_t queued_at_us;
+} esp_agent_rx_message_t;
+
+/* Reassembly buffer for text messages split across websocket frames */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t capacity;
+} esp_agent_rx_buffer_t;
+
+/* Event posted once the event loop has room again */
+typedef struct {
+    int32_t event;                                 /* -1 for a free slot */
+    bool has_data;
+    uint32_t session;                              /* esp_agent_event_backlog_t session it was posted in */
+    esp_agent_message_data_t data;
+} esp_agent_deferred_event_t;
+
+/* Events of which only the latest one is kept if the event loop is full */
+#define ESP_AGENT_EVENT_LATEST_SLOTS 4
+
+/* Intermediate updates delivered at most once per CONFIG_ESP_AGENT_EVENT_STREAM_WINDOW_MS */
+typedef struct {
+    int64_t delivered_us;                          /* Time the last update was delivered */
+    esp_agent_deferred_event_t pending;            /* Latest update held back, event -1 if none */
+    uint32_t received;
+    uint32_t delivered;
+    uint32_t discarded;
+} esp_agent_event_stream_state_t;
+
+/* Events which could not be posted without blocking */
+typedef struct {
+    QueueHandle_t queue;                           /* esp_agent_deferred_event_t, posted in order */
+    portMUX_TYPE lock;                             /* Protects latest, streams and the counters */
+    esp_agent_deferred_event_t latest[ESP_AGENT_EVENT_LATEST_SLOTS];
+    esp_agent_event_stream_state_t streams[ESP_AGENT_EVENT_STREAM_MAX];
+    uint32_t deferred;
+    uint32_t replaced;
+    uint32_t dropped;
+    uint32_t cleared;
+    uint32_t max_backlog;
+    uint32_t session;                              /* Incremented on stop, older conversation events are not delivered */
+} esp_agent_event_backlog_t;
+
 /* Agent handle structure */
 typedef struct {
-    bool started;
-    bool connected;
+    char *name;
+    bool started;                                 /* Protected by state_lock */
+    bool connected;                               /* Protected by state_lock */
+    portMUX_TYPE state_lock;
+    SemaphoreHandle_t start_stop_mutex;           /* Recursive, serializes starting and stopping from the application and the message task */
     int64_t access_token_timestamp;
     char *access_token;
     char *agent_id;
@@ -57,13 +206,44 @@ typedef struct {
     TaskHandle_t message_task_handle;
     QueueHandle_t send_queue;
     TaskHandle_t send_task_handle;
-    EventGroupHandle_t event_group;               /* Event group for task stop signals */
+    EventGroupHandle_t event_group;               /* Event group for task stop signals and work requests */
     local_tool_node_t *local_tools;               /* Head of linked list of registered local tools */
+    esp_agent_local_tool_result_t local_tool_result;
+    esp_agent_tool_dedup_t tool_dedup;            /* Recent tool requests and their responses */
+    esp_agent_tool_cache_t tool_cache;            /* Results of read-only tools */
+    esp_agent_tool_exec_t tool_exec;              /* Concurrency of the tool calls */
+    esp_agent_latency_tracker_t latency;          /* End-to-end voice latency per turn */
+    esp_agent_transport_stats_internal_t transport_stats;
+    esp_agent_usage_t usage;                      /* Usage reported by the server */
+    esp_agent_tool_stats_table_t tool_stats;      /* Per-tool latency, server and local tools */
+    esp_agent_keepalive_t keepalive;              /* Keep-alive pings and link health */
+    esp_agent_compression_t compression;          /* Text message compression */
+    esp_agent_connection_t connection;            /* Idle timeout and connect metrics */
+    esp_agent_event_backlog_t event_backlog;      /* Events waiting for room in the event loop */
+    esp_agent_aggregation_t aggregation;          /* Uplink audio frame aggregation */
+    esp_agent_resume_t resume;                    /* Sequence numbers and retransmit buffer of text messages */
+    esp_agent_rx_buffer_t rx_buffer;              /* Only accessed from the websocket event handler */
+    esp_agent_mem_t mem;                          /* Placement and allocations of the transport buffers */
 } esp_agent_t;
 
 /* This function will strip the https:// prefix from the menuconfig URL */
 char *esp_agents_get_api_endpoint(void);
 
+/* Run work (AGENT_WORK_BITS) in the message processing task, for callers that must not block */
+void esp_agent_request_work(esp_agent_t *agent, EventBits_t bits);
+
+/* started and connected are changed by the application, the websocket task and the message task */
+bool esp_agent_is_started(esp_agent_t *agent);
+bool esp_agent_is_connected(esp_agent_t *agent);
+void esp_agent_set_started(esp_agent_t *agent);
+void esp_agent_set_connected(esp_agent_t *agent);
+/* Clears both flags, returns whether the agent was started */
+bool esp_agent_clear_started(esp_agent_t *agent);
+
+/* Held across a stop and the start that follows it, so that the application does not interleave */
+void esp_agent_start_stop_lock(esp_agent_t *agent);
+void esp_agent_start_stop_unlock(esp_agent_t *agent);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,69 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cJSON.h>
+
+#include <esp_agent_core.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Uplink audio frame aggregation state, used by the send task only (negotiated is set by the message task) */
+typedef struct {
+    bool negotiated;            /* The server accepted length-prefixed frames in the handshake ack */
+    uint32_t window_us;         /* Time the first frame of a message may wait for the next ones, 0 on a fast link */
+} esp_agent_aggregation_t;
+
+/* Forward declaration, defined in esp_agent_websocket.h */
+struct ws_send_message;
+
+/**
+ * @brief Offer aggregation in the audio input configuration of the handshake, if enabled
+ *
+ * @param input Audio input configuration object
+ */
+void esp_agent_aggregation_add_to_handshake(cJSON *input);
+
+/**
+ * @brief Enable aggregation if the server accepted it in the handshake ack
+ *
+ * @param handle Agent handle
+ * @param content Handshake ack content object
+ */
+void esp_agent_aggregation_handshake_ack(esp_agent_handle_t handle, cJSON *content);
+
+/**
+ * @brief Pack the audio frames following a frame in the send queue into one message
+ *
+ * Frames already waiting in the send queue are always packed. While the link is congested,
+ * the send task also waits up to the current window for more frames. A text message in the
+ * queue ends the aggregation, so that the order of messages is kept.
+ *
+ * @param handle Agent handle
+ * @param msg First frame, taken from the send queue. Its payload is replaced by the packed frames.
+ * @return Number of frames in the message (1 if not aggregated), 0 if the frame cannot be sent
+ */
+uint32_t esp_agent_aggregation_collect(esp_agent_handle_t handle, struct ws_send_message *msg);
+
+/**
+ * @brief Adapt the aggregation window to the time an audio message took to send
+ *
+ * @param handle Agent handle
+ * @param frames Frames in the message
+ * @param send_us Time spent in the websocket send
+ */
+void esp_agent_aggregation_sent(esp_agent_handle_t handle, uint32_t frames, int64_t send_us);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,78 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <cJSON.h>
+
+#include <esp_agent_core.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_AGENT_MESSAGE_TYPE_COMPRESSED "compressed"
+
+/* Text message compression state. The compressor is only used by the send task and the
+ * decompressor only by the message task, so they need no locking.
+ */
+typedef struct {
+    bool negotiated;            /* The server accepted compression in the handshake ack */
+    void *deflate;              /* z_stream, allocated on first use */
+    void *inflate;              /* z_stream, allocated on first use */
+    size_t deflate_memory;      /* Bytes allocated by the compressor */
+    size_t inflate_memory;      /* Bytes allocated by the decompressor */
+} esp_agent_compression_t;
+
+/**
+ * @brief Offer compression in the handshake, if enabled
+ *
+ * @param content Handshake content object
+ */
+void esp_agent_compression_add_to_handshake(cJSON *content);
+
+/**
+ * @brief Enable compression if the server accepted it in the handshake ack
+ *
+ * @param handle Agent handle
+ * @param content Handshake ack content object
+ */
+void esp_agent_compression_handshake_ack(esp_agent_handle_t handle, cJSON *content);
+
+/**
+ * @brief Compress a text message, if compression was negotiated and the message is large enough
+ *
+ * @param handle Agent handle
+ * @param message Text message
+ * @param len Message length
+ * @param[out] out_len Length of the compressed message
+ * @return Compressed message to send instead (to be freed by the caller), or NULL to send the original
+ */
+char *esp_agent_compression_compress(esp_agent_handle_t handle, const char *message, size_t len, size_t *out_len);
+
+/**
+ * @brief Decompress the content of a "compressed" message
+ *
+ * @param handle Agent handle
+ * @param content Content of the compressed message
+ * @param metadata Metadata of the compressed message
+ * @return Original message (to be freed by the caller), NULL on error
+ */
+char *esp_agent_compression_decompress(esp_agent_handle_t handle, cJSON *content, cJSON *metadata);
+
+/**
+ * @brief Free the compressor and decompressor, once the send and message tasks have stopped
+ *
+ * @param handle Agent handle
+ */
+void esp_agent_compression_deinit(esp_agent_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
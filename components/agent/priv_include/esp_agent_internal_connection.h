@@ -0,0 +1,120 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <freertos/FreeRTOS.h>
+#include <esp_timer.h>
+
+#include <esp_agent_core.h>
+#include <esp_agent_internal_stats.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Connection lifetime, idle timeout and connect metrics, updated from the app, timer,
+ * websocket, send and message tasks
+ */
+typedef struct {
+    esp_timer_handle_t idle_timer;              /* NULL if the idle timeout is disabled */
+    portMUX_TYPE lock;
+    int64_t last_activity_us;                   /* Last message sent or received, pings excluded */
+    bool idle_posted;                           /* ESP_AGENT_EVENT_IDLE posted for this connection */
+    int64_t connect_started_us;                 /* 0 if no connect is in progress */
+    bool resume;                                /* The connect in progress reuses the access token and conversation */
+    int64_t ready_at_us;                        /* Handshake ack of the current connection, 0 if none */
+    int64_t connected_total_us;                 /* Of the previous connections */
+    uint32_t connects;
+    uint32_t resumes;
+    uint32_t idle_closes;
+    esp_agent_stats_window_t connect_ms;
+    esp_agent_stats_window_t resume_ms;
+    uint32_t stops;
+    esp_agent_stats_window_t start_call_us;
+    esp_agent_stats_window_t stop_call_us;
+    uint32_t heap_free_first;                   /* 0 until the first stop */
+    uint32_t heap_free_last;
+    uint32_t heap_largest_block_last;
+    uint32_t heap_largest_block_min;
+} esp_agent_connection_t;
+
+/**
+ * @brief Create the idle timer, if the idle timeout is enabled
+ *
+ * @param handle Agent handle
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_connection_init(esp_agent_handle_t handle);
+
+/**
+ * @brief Stop and delete the idle timer
+ *
+ * @param handle Agent handle
+ */
+void esp_agent_connection_deinit(esp_agent_handle_t handle);
+
+/**
+ * @brief Record the start of a connect
+ *
+ * @param handle Agent handle
+ * @param resume The cached access token and the conversation ID are reused
+ */
+void esp_agent_connection_connecting(esp_agent_handle_t handle, bool resume);
+
+/**
+ * @brief Record the time esp_agent_start took
+ *
+ * @param handle Agent handle
+ * @param call_us Duration of the call
+ */
+void esp_agent_connection_started(esp_agent_handle_t handle, int64_t call_us);
+
+/**
+ * @brief Record the time esp_agent_stop took and the state of the heap once the session is parked
+ *
+ * @param handle Agent handle
+ * @param call_us Duration of the call
+ */
+void esp_agent_connection_stopped(esp_agent_handle_t handle, int64_t call_us);
+
+/**
+ * @brief Record that the connection is ready (handshake acknowledged) and start the idle timer
+ *
+ * @param handle Agent handle
+ */
+void esp_agent_connection_ready(esp_agent_handle_t handle);
+
+/**
+ * @brief Record the end of the connection and stop the idle timer
+ *
+ * @param handle Agent handle
+ */
+void esp_agent_connection_closed(esp_agent_handle_t handle);
+
+/**
+ * @brief Record a message sent or received, which postpones the idle timeout
+ *
+ * @param handle Agent handle
+ */
+void esp_agent_connection_activity(esp_agent_handle_t handle);
+
+/**
+ * @brief Close an idle connection cleanly
+ *
+ * This blocks until the websocket task stops, so it runs in the message processing task
+ * (IDLE_CLOSE_REQUEST_BIT), not in the timer task or the event loop.
+ *
+ * @param handle Agent handle
+ */
+void esp_agent_connection_idle_close(esp_agent_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
@@ -17,21 +17,61 @@ extern "C" {
 #endif
 
 /**
- * @brief Post an event to the agent's event loop
+ * @brief Post an event to the agent's event loop, without blocking
+ *
+ * If the event loop is full, the event is deferred according to its policy: most events are
+ * posted later, in order, by the message task; for thinking, latency, link health and idle events
+ * only the latest one is kept. Thinking and speculative text updates are also delivered at most once
+ * per CONFIG_ESP_AGENT_EVENT_STREAM_WINDOW_MS, the latest one at the end of the window. The agent owns the heap data of the event from here on, and frees
+ * it if the event has to be dropped.
  *
  * @param handle Agent handle
  * @param event Event type
- * @param data Event data
- * @return ESP_OK on success, error code otherwise
+ * @param data Event data, NULL if none
+ * @return ESP_OK if the event was posted or deferred, ESP_ERR_TIMEOUT if it was dropped
  */
 esp_err_t esp_agent_post_event(esp_agent_handle_t handle, esp_agent_event_t event, esp_agent_message_data_t *data);
 
+/**
+ * @brief Create the backlog of deferred events
+ *
+ * @param handle Agent handle
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_events_backlog_init(esp_agent_handle_t handle);
+
+/**
+ * @brief Free the deferred events and delete the backlog
+ *
+ * @param handle Agent handle
+ */
+void esp_agent_events_backlog_deinit(esp_agent_handle_t handle);
+
+/**
+ * @brief Drop the deferred text, thinking and speech of the conversation being stopped
+ *
+ * They are not delivered by the next flush. The other events, e.g. the disconnect, still are.
+ *
+ * @param handle Agent handle
+ */
+void esp_agent_events_backlog_clear(esp_agent_handle_t handle);
+
+/**
+ * @brief Post the deferred events the event loop has room for, without blocking
+ *
+ * Called from the message task.
+ *
+ * @param handle Agent handle
+ * @return true if events are still deferred
+ */
+bool esp_agent_events_backlog_flush(esp_agent_handle_t handle);
+
 /**
  * @brief Internal event handler for cleanup
  *
  * This should always be the last event handler in the chain.
  *
- * @param handler_args Handler arguments
+ * @param handler_args Agent handle
  * @param base Event base
  * @param event_id Event ID
  * @param event_data Event data
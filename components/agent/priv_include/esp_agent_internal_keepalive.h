@@ -0,0 +1,88 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <freertos/FreeRTOS.h>
+#include <esp_timer.h>
+
+#include <esp_agent_core.h>
+#include <esp_agent_internal_stats.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Keep-alive ping state, updated from the timer and websocket tasks */
+typedef struct {
+    esp_timer_handle_t timer;                   /* NULL if keep-alive pings are disabled */
+    portMUX_TYPE lock;
+    uint32_t seq;                               /* Sequence number of the last ping, echoed in the pong */
+    int64_t ping_sent_us;                       /* 0 if no ping is outstanding */
+    int64_t last_pong_us;                       /* Time of the last pong, or of the connection */
+    uint32_t missed;                            /* Consecutive pings without a pong */
+    uint32_t pings_sent;
+    uint32_t pongs_received;
+    uint32_t missed_total;
+    uint32_t dead_links;
+    esp_agent_stats_window_t rtt_ms;
+} esp_agent_keepalive_t;
+
+/**
+ * @brief Create the keep-alive timer, if keep-alive pings are enabled
+ *
+ * @param handle Agent handle
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_keepalive_init(esp_agent_handle_t handle);
+
+/**
+ * @brief Stop and delete the keep-alive timer
+ *
+ * @param handle Agent handle
+ */
+void esp_agent_keepalive_deinit(esp_agent_handle_t handle);
+
+/**
+ * @brief Start sending pings, when the websocket connects
+ *
+ * @param handle Agent handle
+ */
+void esp_agent_keepalive_start(esp_agent_handle_t handle);
+
+/**
+ * @brief Stop sending pings, when the websocket disconnects or the agent stops
+ *
+ * @param handle Agent handle
+ */
+void esp_agent_keepalive_stop(esp_agent_handle_t handle);
+
+/**
+ * @brief Handle a pong frame
+ *
+ * @param handle Agent handle
+ * @param data Pong payload
+ * @param len Pong payload length
+ */
+void esp_agent_keepalive_pong_received(esp_agent_handle_t handle, const uint8_t *data, size_t len);
+
+/**
+ * @brief Tear down a dead link, so that the disconnect path runs, and connect again
+ *
+ * This blocks until the websocket task stops and the new connection is started, so it runs
+ * in the message processing task (LINK_DOWN_REQUEST_BIT), not in the timer task or the event loop.
+ *
+ * @param handle Agent handle
+ */
+void esp_agent_keepalive_link_down(esp_agent_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,101 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+#include <esp_agent_core.h>
+#include <esp_agent_metrics.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Allocations of the transport buffers, updated from the websocket, send and app tasks */
+typedef struct {
+    portMUX_TYPE lock;
+    esp_agent_mem_buffer_stats_t buffers[ESP_AGENT_MEM_MAX];
+} esp_agent_mem_t;
+
+/**
+ * @brief Initialize the transport buffer statistics
+ *
+ * @param mem Transport buffer statistics
+ */
+void esp_agent_mem_init(esp_agent_mem_t *mem);
+
+/**
+ * @brief Allocate or resize a transport buffer in its configured memory
+ *
+ * The memory falls back to the default heap if the configured one is full. It is released with free().
+ *
+ * @param handle Agent handle
+ * @param buffer Transport buffer
+ * @param ptr Buffer to resize, NULL to allocate one
+ * @param size New size
+ * @return The buffer, NULL if out of memory (ptr is then left untouched)
+ */
+void *esp_agent_mem_realloc(esp_agent_handle_t handle, esp_agent_mem_buffer_t buffer, void *ptr, size_t size);
+
+/**
+ * @brief Allocate a transport buffer in its configured memory and copy data into it
+ *
+ * @param handle Agent handle
+ * @param buffer Transport buffer
+ * @param data Data to copy
+ * @param len Length of the data
+ * @return The copy, released with free(), NULL if out of memory
+ */
+void *esp_agent_mem_dup(esp_agent_handle_t handle, esp_agent_mem_buffer_t buffer, const void *data, size_t len);
+
+/**
+ * @brief Record a copy into a transport buffer made by the caller
+ *
+ * Only one copy in several is timed: if this one is, the caller times it and reports the time
+ * with esp_agent_mem_time_copy().
+ *
+ * @param handle Agent handle
+ * @param buffer Transport buffer
+ * @param len Bytes copied
+ * @return Whether the copy is to be timed
+ */
+bool esp_agent_mem_count_copy(esp_agent_handle_t handle, esp_agent_mem_buffer_t buffer, size_t len);
+
+/**
+ * @brief Record the time of a copy selected by esp_agent_mem_count_copy()
+ *
+ * @param handle Agent handle
+ * @param buffer Transport buffer
+ * @param len Bytes copied
+ * @param copy_us Time the copy took
+ */
+void esp_agent_mem_time_copy(esp_agent_handle_t handle, esp_agent_mem_buffer_t buffer, size_t len, int64_t copy_us);
+
+/**
+ * @brief Create a message or send queue, in PSRAM if configured
+ *
+ * @param length Number of items
+ * @param item_size Size of an item
+ * @return Queue handle, NULL if out of memory
+ */
+QueueHandle_t esp_agent_mem_queue_create(UBaseType_t length, UBaseType_t item_size);
+
+/**
+ * @brief Delete a queue created by esp_agent_mem_queue_create
+ *
+ * @param queue Queue handle
+ */
+void esp_agent_mem_queue_delete(QueueHandle_t queue);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,204 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <esp_agent_metrics.h>
+#include <esp_agent_internal_stats.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A turn which does not complete within this time is discarded on the next mark */
+#define ESP_AGENT_LATENCY_TURN_TIMEOUT_US (30 * 1000 * 1000LL)
+
+typedef enum {
+    ESP_AGENT_LATENCY_TURN_IDLE,            /* No turn in progress, or the last one completed */
+    ESP_AGENT_LATENCY_TURN_REQUEST,         /* A request stage has been marked */
+    ESP_AGENT_LATENCY_TURN_RESPONSE,        /* A response stage has been marked */
+} esp_agent_latency_turn_state_t;
+
+/* Per-turn latency state */
+typedef struct {
+    portMUX_TYPE lock;                                          /* Marks come from the audio, websocket and app tasks */
+    uint32_t turn;                                              /* Number of the current turn */
+    esp_agent_latency_turn_state_t state;
+    int64_t turn_started_us;
+    int64_t timestamp_us[ESP_AGENT_LATENCY_STAGE_MAX];          /* 0 if the stage was not reached */
+    esp_agent_stats_window_t stage_ms[ESP_AGENT_LATENCY_STAGE_MAX];   /* Offsets from the start of the turn */
+} esp_agent_latency_tracker_t;
+
+/* Transport counters, updated from the websocket, send, message and tool tasks */
+typedef struct {
+    portMUX_TYPE lock;
+    int64_t reset_at_us;
+    uint32_t messages[ESP_AGENT_TRANSPORT_COUNTER_MAX];
+    uint64_t bytes[ESP_AGENT_TRANSPORT_COUNTER_MAX];
+    uint32_t tx_dropped;
+    uint32_t rx_dropped;
+    uint64_t bytes_copied;
+    uint32_t allocations;
+    esp_agent_stats_window_t queue_latency_us[ESP_AGENT_TRANSPORT_QUEUE_MAX];
+    esp_agent_compression_stats_t tx_compression;
+    esp_agent_compression_stats_t rx_compression;
+    uint32_t audio_frames;
+    uint32_t audio_messages;
+    uint64_t audio_overhead_bytes;
+    esp_agent_stats_window_t audio_added_latency_us;
+    uint32_t fragmented_messages;
+    uint32_t fragments;
+    uint32_t stalls;
+    uint64_t stall_us;
+    uint32_t deadline_expired;
+    esp_agent_stats_window_t write_time_us;
+} esp_agent_transport_stats_internal_t;
+
+/* Usage reported by the server, updated from the message task */
+typedef struct {
+    portMUX_TYPE lock;
+    uint32_t turn;                                              /* Latency turn of the last usage */
+    uint32_t turn_input_tokens;
+    uint32_t turn_output_tokens;
+    int32_t turn_server_ms;                                     /* First reported in the turn, -1 if none yet */
+    int32_t turn_network_ms;                                    /* -1 if not known yet */
+    uint32_t turns;
+    uint64_t input_tokens;
+    uint64_t output_tokens;
+    uint32_t session_turns;                                     /* Since the agent was last started */
+    uint64_t session_input_tokens;
+    uint64_t session_output_tokens;
+    esp_agent_stats_window_t server_ms;
+    esp_agent_stats_window_t network_ms;
+} esp_agent_usage_t;
+
+/* Usage of one usage_info message */
+typedef struct {
+    uint32_t input_tokens;
+    uint32_t output_tokens;
+    int32_t server_ms;                                          /* -1 if not reported */
+} esp_agent_usage_report_t;
+
+/**
+ * @brief Initialize the latency tracker
+ *
+ * @param tracker Tracker to initialize
+ */
+void esp_agent_latency_tracker_init(esp_agent_latency_tracker_t *tracker);
+
+/**
+ * @brief Initialize (or reset) the transport statistics
+ *
+ * @param stats Statistics to initialize
+ */
+void esp_agent_transport_stats_init(esp_agent_transport_stats_internal_t *stats);
+
+/**
+ * @brief Count a message sent or received
+ *
+ * @param stats Transport statistics
+ * @param counter Counter to increment
+ * @param len Message length in bytes
+ */
+void esp_agent_transport_stats_count_message(esp_agent_transport_stats_internal_t *stats, esp_agent_transport_counter_t counter, size_t len);
+
+/**
+ * @brief Count payload copies and heap allocations made by the transport
+ *
+ * @param stats Transport statistics
+ * @param bytes Bytes copied
+ * @param allocations Heap allocations made
+ */
+void esp_agent_transport_stats_count_copy(esp_agent_transport_stats_internal_t *stats, size_t bytes, uint32_t allocations);
+
+/**
+ * @brief Count a dropped message
+ *
+ * @param stats Transport statistics
+ * @param tx true for an outgoing message, false for an incoming one
+ */
+void esp_agent_transport_stats_count_drop(esp_agent_transport_stats_internal_t *stats, bool tx);
+
+/**
+ * @brief Record the time a message spent in a queue
+ *
+ * @param stats Transport statistics
+ * @param queue Queue the message was taken from
+ * @param queued_at_us Time the message was queued (esp_timer_get_time)
+ */
+void esp_agent_transport_stats_count_queue_latency(esp_agent_transport_stats_internal_t *stats, esp_agent_transport_queue_t queue, int64_t queued_at_us);
+
+/**
+ * @brief Count a compressed or decompressed text message
+ *
+ * @param stats Transport statistics
+ * @param tx true for an outgoing message, false for an incoming one
+ * @param original_len Uncompressed length
+ * @param compressed_len Length on the wire
+ * @param cpu_us Time spent compressing or decompressing
+ */
+void esp_agent_transport_stats_count_compression(esp_agent_transport_stats_internal_t *stats, bool tx, size_t original_len, size_t compressed_len, uint32_t cpu_us);
+
+/**
+ * @brief Count an uplink audio message
+ *
+ * @param stats Transport statistics
+ * @param frames Audio frames in the message
+ * @param overhead_bytes Websocket header and length prefixes
+ * @param added_latency_us Time the first frame waited for the next ones
+ */
+void esp_agent_transport_stats_count_audio_uplink(esp_agent_transport_stats_internal_t *stats, uint32_t frames, size_t overhead_bytes, uint32_t added_latency_us);
+
+/**
+ * @brief Count a websocket write
+ *
+ * @param stats Transport statistics
+ * @param write_us Time spent in the write
+ * @param stalled The write blocked long enough to count as a stall
+ * @param deadline_expired The write failed as the write deadline expired
+ */
+void esp_agent_transport_stats_count_write(esp_agent_transport_stats_internal_t *stats, uint32_t write_us, bool stalled, bool deadline_expired);
+
+/**
+ * @brief Count a message sent in fragments
+ *
+ * @param stats Transport statistics
+ * @param fragments Fragments sent
+ */
+void esp_agent_transport_stats_count_fragmented(esp_agent_transport_stats_internal_t *stats, uint32_t fragments);
+
+/**
+ * @brief Initialize the usage counters
+ *
+ * @param usage Usage counters
+ */
+void esp_agent_usage_init(esp_agent_usage_t *usage);
+
+/**
+ * @brief Account usage reported by the server against the current latency turn and post ESP_AGENT_EVENT_USAGE
+ *
+ * @param handle Agent handle
+ * @param report Usage of the message
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_usage_record(esp_agent_handle_t handle, const esp_agent_usage_report_t *report);
+
+/**
+ * @brief Start the usage counters of a new session, when the agent is started
+ *
+ * @param handle Agent handle
+ */
+void esp_agent_usage_session_start(esp_agent_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
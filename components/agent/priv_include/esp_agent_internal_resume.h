@@ -0,0 +1,147 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <cJSON.h>
+
+#include <esp_agent_core.h>
+#include <esp_agent_internal_stats.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_AGENT_MESSAGE_TYPE_ACK "ack"
+
+/* Text message sent but not acknowledged by the server yet */
+typedef struct {
+    uint32_t seq;
+    char *payload;              /* Sequenced message, as sent */
+    size_t len;
+} esp_agent_resume_entry_t;
+
+/* Sequence numbers, acknowledgements and retransmit buffer of text messages. Messages are
+ * sequenced, buffered and replayed by the send task, acknowledged by the message task. Text
+ * queued between the handshake and its ack is held by the send task, so that it is sequenced
+ * and sent after the replayed messages.
+ * The lock is a mutex, as buffer entries are allocated and freed with it held.
+ */
+typedef struct {
+    SemaphoreHandle_t lock;
+    bool negotiated;                            /* The server accepted sequencing in the handshake ack */
+    bool awaiting_ack;                          /* Sequencing was offered, the handshake ack not received yet */
+    bool replay_pending;                        /* Accepted, the send task has not taken the messages to replay yet */
+    uint32_t next_tx_seq;
+    uint32_t last_rx_seq;                       /* Highest sequence number received from the server */
+    uint32_t unacked_rx;                        /* Messages received since the last ack was sent */
+    esp_agent_resume_entry_t *entries;          /* Ring of CONFIG_ESP_AGENT_RESUME_BUFFER_SIZE */
+    size_t head;
+    size_t count;
+    int64_t disconnected_at_us;                 /* Unexpected disconnect not recovered yet, 0 if none */
+    uint32_t resumes;
+    uint32_t replayed_messages;
+    uint64_t replayed_bytes;
+    uint32_t duplicates;
+    uint32_t gaps;
+    uint32_t evicted;
+    esp_agent_stats_window_t recovery_ms;
+} esp_agent_resume_t;
+
+/**
+ * @brief Allocate the retransmit buffer, if resume is enabled
+ *
+ * @param handle Agent handle
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_resume_init(esp_agent_handle_t handle);
+
+/**
+ * @brief Free the retransmit buffer, once the send and message tasks have stopped
+ *
+ * @param handle Agent handle
+ */
+void esp_agent_resume_deinit(esp_agent_handle_t handle);
+
+/**
+ * @brief Offer sequencing in the handshake, with the last sequence number received, if enabled
+ *
+ * @param handle Agent handle
+ * @param content Handshake content object
+ */
+void esp_agent_resume_add_to_handshake(esp_agent_handle_t handle, cJSON *content);
+
+/**
+ * @brief Enable sequencing if the server accepted it, and have the send task replay the messages it has not received
+ *
+ * @param handle Agent handle
+ * @param content Handshake ack content object
+ */
+void esp_agent_resume_handshake_ack(esp_agent_handle_t handle, cJSON *content);
+
+/**
+ * @brief Whether the send task holds text messages back, until the handshake ack
+ *
+ * @param handle Agent handle
+ * @return true while sequencing was offered and the ack not received
+ */
+bool esp_agent_resume_holding(esp_agent_handle_t handle);
+
+/**
+ * @brief Copy the messages to replay once the server accepted the resume, to be sent as is
+ *
+ * @param handle Agent handle
+ * @param[out] count Number of messages
+ * @return Copies (payloads and array to be freed by the caller), NULL if there is nothing to replay
+ */
+esp_agent_resume_entry_t *esp_agent_resume_take_replay(esp_agent_handle_t handle, size_t *count);
+
+/**
+ * @brief Count the replayed messages sent
+ *
+ * @param handle Agent handle
+ * @param messages Messages sent
+ * @param bytes Bytes sent
+ */
+void esp_agent_resume_replayed(esp_agent_handle_t handle, size_t messages, size_t bytes);
+
+/**
+ * @brief Sequence a text message and keep a copy until the server acknowledges it
+ *
+ * @param handle Agent handle
+ * @param message Text message (JSON object)
+ * @param len Message length
+ * @param[out] out_len Length of the sequenced message
+ * @return Sequenced message to send instead (to be freed by the caller), or NULL to send the original
+ */
+char *esp_agent_resume_sequence(esp_agent_handle_t handle, const char *message, size_t len, size_t *out_len);
+
+/**
+ * @brief Process the sequence number and acknowledgement of a received message
+ *
+ * @param handle Agent handle
+ * @param json Received message
+ * @return false if the message was already received before a reconnect and must be ignored
+ */
+bool esp_agent_resume_received(esp_agent_handle_t handle, cJSON *json);
+
+/**
+ * @brief Stop sequencing until the next handshake ack
+ *
+ * @param handle Agent handle
+ * @param unexpected The connection was lost rather than stopped, so the recovery time is measured
+ */
+void esp_agent_resume_disconnected(esp_agent_handle_t handle, bool unexpected);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,45 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of most recent samples the percentiles are computed over */
+#define ESP_AGENT_STATS_WINDOW_SIZE 32
+
+/* Fixed size rolling window of samples */
+typedef struct {
+    uint32_t samples[ESP_AGENT_STATS_WINDOW_SIZE];
+    size_t next;                /* Index the next sample is written to */
+    size_t count;               /* Number of valid samples, saturates at the window size */
+} esp_agent_stats_window_t;
+
+/**
+ * @brief Add a sample to the window, replacing the oldest one when the window is full
+ *
+ * @param window Window to add to
+ * @param value Sample value
+ */
+void esp_agent_stats_window_add(esp_agent_stats_window_t *window, uint32_t value);
+
+/**
+ * @brief Get a percentile of the samples in the window (nearest rank)
+ *
+ * @param window Window to compute over
+ * @param percentile Percentile, 1 to 100
+ * @return Sample value at the percentile, 0 if the window is empty
+ */
+uint32_t esp_agent_stats_window_percentile(const esp_agent_stats_window_t *window, uint8_t percentile);
+
+#ifdef __cplusplus
+}
+#endif
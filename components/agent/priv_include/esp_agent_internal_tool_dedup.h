@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <esp_agent_core.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_ESP_AGENT_TOOL_DEDUP_WINDOW_MS
+#define ESP_AGENT_TOOL_DEDUP_ENTRIES CONFIG_ESP_AGENT_TOOL_DEDUP_ENTRIES
+#else
+#define ESP_AGENT_TOOL_DEDUP_ENTRIES 1
+#endif
+
+/* A tool request from the server, and the response sent for it */
+typedef struct {
+    char *request_id;               /* NULL if the entry is free */
+    char *response;                 /* NULL while the tool is running */
+    int64_t stored_us;              /* Time of the request, then of the response */
+} esp_agent_tool_dedup_entry_t;
+
+/* Recent tool requests, updated from the message task and the tool tasks */
+typedef struct {
+    portMUX_TYPE lock;
+    esp_agent_tool_dedup_entry_t entries[ESP_AGENT_TOOL_DEDUP_ENTRIES];
+    uint32_t requests;
+    uint32_t duplicates;
+    uint32_t in_flight_duplicates;
+    uint32_t evicted;
+} esp_agent_tool_dedup_t;
+
+/**
+ * @brief Initialize the cache of recent tool requests
+ *
+ * @param dedup Tool request cache
+ */
+void esp_agent_tool_dedup_init(esp_agent_tool_dedup_t *dedup);
+
+/**
+ * @brief Free the cached responses
+ *
+ * @param dedup Tool request cache
+ */
+void esp_agent_tool_dedup_deinit(esp_agent_tool_dedup_t *dedup);
+
+/**
+ * @brief Check whether a tool request was already received, within CONFIG_ESP_AGENT_TOOL_DEDUP_WINDOW_MS
+ *
+ * A duplicate of a request already answered is answered again with the cached response. A duplicate
+ * of a request whose tool is still running is ignored, as its response is on its way. Otherwise,
+ * the request is recorded as running.
+ *
+ * @param handle Agent handle
+ * @param request_id Request ID of the tool call
+ * @return true if the request is a duplicate and must not run the tool
+ */
+bool esp_agent_tool_dedup_check(esp_agent_handle_t handle, const char *request_id);
+
+/**
+ * @brief Record the response sent for a tool request
+ *
+ * @param handle Agent handle
+ * @param request_id Request ID of the tool call
+ * @param response Response message, copied. NULL to forget the request, e.g. if the tool could not run.
+ */
+void esp_agent_tool_dedup_store(esp_agent_handle_t handle, const char *request_id, const char *response);
+
+#ifdef __cplusplus
+}
+#endif
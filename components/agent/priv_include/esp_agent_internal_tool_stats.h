@@ -0,0 +1,79 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <freertos/FreeRTOS.h>
+#include <cJSON.h>
+
+#include <esp_agent_core.h>
+#include <esp_agent_metrics.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Server tool calls waiting for their result */
+#define ESP_AGENT_TOOL_STATS_PENDING 8
+#define ESP_AGENT_TOOL_STATS_CALL_ID_LEN 48
+
+typedef struct {
+    char call_id[ESP_AGENT_TOOL_STATS_CALL_ID_LEN];   /* Empty if the slot is free */
+    int64_t started_us;
+    int64_t server_timestamp_ms;                        /* -1 if the server sent none */
+} esp_agent_tool_stats_pending_t;
+
+/* Per-tool latency, updated from the message task and the tool tasks */
+typedef struct {
+    portMUX_TYPE lock;
+    size_t count;
+    esp_agent_tool_stats_t tools[CONFIG_ESP_AGENT_TOOL_STATS_MAX];
+    esp_agent_tool_stats_pending_t pending[ESP_AGENT_TOOL_STATS_PENDING];
+} esp_agent_tool_stats_table_t;
+
+/**
+ * @brief Initialize the tool statistics
+ *
+ * @param table Tool statistics
+ */
+void esp_agent_tool_stats_init(esp_agent_tool_stats_table_t *table);
+
+/**
+ * @brief Record the duration of a call to a tool
+ *
+ * @param handle Agent handle
+ * @param name Tool name
+ * @param source Where the tool ran
+ * @param duration_ms Duration of the call
+ */
+void esp_agent_tool_stats_record(esp_agent_handle_t handle, const char *name, esp_agent_tool_timing_source_t source, uint32_t duration_ms);
+
+/**
+ * @brief Record the stack space a call to a tool left unused
+ *
+ * @param handle Agent handle
+ * @param name Tool name
+ * @param stack_size Stack of the tool task
+ * @param free_bytes High-water mark of the tool task
+ */
+void esp_agent_tool_stats_record_stack(esp_agent_handle_t handle, const char *name, uint32_t stack_size, uint32_t free_bytes);
+
+/**
+ * @brief Process a tool_call_info or tool_result_info message and post ESP_AGENT_EVENT_TOOL_INFO
+ *
+ * @param handle Agent handle
+ * @param content Message content
+ * @param result true for tool_result_info
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_tool_stats_info(esp_agent_handle_t handle, cJSON *content, bool result);
+
+#ifdef __cplusplus
+}
+#endif
@@ -26,6 +26,23 @@ extern "C" {
  */
 esp_err_t esp_agent_execute_tool(esp_agent_handle_t handle, char *request_id, char *tool_name, esp_agent_tool_param_t *parameters, size_t num_parameters);
 
+/**
+ * @brief Create the cache of the results of read-only tools, the tool call queue and the lock of the local run result
+ *
+ * @param handle Agent handle
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t esp_agent_tools_init(esp_agent_handle_t handle);
+
+/**
+ * @brief Free the cached results, the registered tools and the tool calls still waiting for a slot
+ *
+ * The tool tasks must have ended.
+ *
+ * @param handle Agent handle
+ */
+void esp_agent_tools_deinit(esp_agent_handle_t handle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <esp_agent.h>
+#include <esp_agent_internal.h>
 #include <freertos/FreeRTOS.h>
 #include <stddef.h>
 
@@ -17,14 +18,17 @@ extern "C" {
 /* WebSocket send message types */
 typedef enum {
     WS_SEND_MSG_TYPE_TEXT,
+    WS_SEND_MSG_TYPE_TEXT_UNSEQUENCED,  /* Text sent as is: the handshake, replayed messages and acks */
     WS_SEND_MSG_TYPE_BINARY,
+    WS_SEND_MSG_TYPE_PING,
 } ws_send_msg_type_t;
 
 /* WebSocket send message structure */
-typedef struct {
+typedef struct ws_send_message {
     ws_send_msg_type_t type;
     char *payload;
     size_t len;
+    int64_t queued_at_us;
 } ws_send_message_t;
 
 /**
@@ -64,6 +68,13 @@ void esp_agent_websocket_send_task(void *pvParameters);
  */
 void esp_agent_websocket_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data);
 
+/**
+ * @brief Free the text message reassembly buffer of an agent
+ *
+ * @param rx_buffer Reassembly buffer
+ */
+void esp_agent_websocket_rx_buffer_free(esp_agent_rx_buffer_t *rx_buffer);
+
 #ifdef __cplusplus
 }
 #endif
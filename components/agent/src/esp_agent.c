@@ -9,6 +9,7 @@
 #include <freertos/task.h>
 #include <freertos/event_groups.h>
 
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -17,7 +18,10 @@
 #include <esp_log.h>
 #include <esp_event.h>
 #include <esp_check.h>
+#include <esp_system.h>
+#if CONFIG_ESP_AGENT_API_USE_TLS
 #include <esp_crt_bundle.h>
+#endif
 
 #include <esp_agent.h>
 #include <esp_agent_internal.h>
@@ -40,7 +44,8 @@ ESP_EVENT_DEFINE_BASE(AGENT_EVENT);
 static void message_processing_task(void *pvParameters)
 {
     esp_agent_t *agent = (esp_agent_t *)pvParameters;
-    char *message = NULL;
+    esp_agent_rx_message_t rx_message;
+    bool events_deferred = false;
 
     ESP_LOGD(TAG, "Message Parsing Task Started");
 
@@ -52,16 +57,95 @@ static void message_processing_task(void *pvParameters)
             break;
         }
 
-        if (xQueueReceive(agent->message_queue, &message, pdMS_TO_TICKS(100)) == pdTRUE) {
-            esp_agent_messages_parse_process(agent, message);
-            free(message);
+        /* Retry deferred events soon, the event loop usually catches up within a few ms */
+        TickType_t timeout = events_deferred ? pdMS_TO_TICKS(CONFIG_ESP_AGENT_EVENT_BACKLOG_RETRY_MS) : pdMS_TO_TICKS(100);
+        /* An empty message only wakes the task up for the work requested in the event group */
+        if (xQueueReceive(agent->message_queue, &rx_message, timeout) == pdTRUE && rx_message.message) {
+            esp_agent_transport_stats_count_queue_latency(&agent->transport_stats, ESP_AGENT_TRANSPORT_QUEUE_MESSAGE, rx_message.queued_at_us);
+            esp_agent_messages_parse_process(agent, rx_message.message);
+            free(rx_message.message);
         }
+
+        EventBits_t work = xEventGroupClearBits(agent->event_group, AGENT_WORK_BITS);
+        if (work & LINK_DOWN_REQUEST_BIT) {
+            esp_agent_keepalive_link_down(agent);
+        }
+        if (work & IDLE_CLOSE_REQUEST_BIT) {
+            esp_agent_connection_idle_close(agent);
+        }
+
+        events_deferred = esp_agent_events_backlog_flush(agent);
     }
 
     ESP_LOGD(TAG, "Message Parsing Task exiting cleanly");
     vTaskDelete(NULL);
 }
 
+void esp_agent_request_work(esp_agent_t *agent, EventBits_t bits)
+{
+    esp_agent_rx_message_t wakeup = {0};
+
+    xEventGroupSetBits(agent->event_group, bits);
+    /* If the queue is full, the task is busy and checks the bits after the current message */
+    xQueueSend(agent->message_queue, &wakeup, 0);
+}
+
+bool esp_agent_is_started(esp_agent_t *agent)
+{
+    portENTER_CRITICAL(&agent->state_lock);
+    bool started = agent->started;
+    portEXIT_CRITICAL(&agent->state_lock);
+    return started;
+}
+
+bool esp_agent_is_connected(esp_agent_t *agent)
+{
+    portENTER_CRITICAL(&agent->state_lock);
+    bool connected = agent->connected;
+    portEXIT_CRITICAL(&agent->state_lock);
+    return connected;
+}
+
+void esp_agent_set_started(esp_agent_t *agent)
+{
+    portENTER_CRITICAL(&agent->state_lock);
+    agent->started = true;
+    portEXIT_CRITICAL(&agent->state_lock);
+}
+
+void esp_agent_set_connected(esp_agent_t *agent)
+{
+    portENTER_CRITICAL(&agent->state_lock);
+    agent->connected = true;
+    portEXIT_CRITICAL(&agent->state_lock);
+}
+
+bool esp_agent_clear_started(esp_agent_t *agent)
+{
+    portENTER_CRITICAL(&agent->state_lock);
+    bool started = agent->started;
+    agent->started = false;
+    agent->connected = false;
+    portEXIT_CRITICAL(&agent->state_lock);
+    return started;
+}
+
+void esp_agent_start_stop_lock(esp_agent_t *agent)
+{
+    xSemaphoreTakeRecursive(agent->start_stop_mutex, portMAX_DELAY);
+}
+
+void esp_agent_start_stop_unlock(esp_agent_t *agent)
+{
+    xSemaphoreGiveRecursive(agent->start_stop_mutex);
+}
+
+/* Task names are derived from the agent name, so that several agents can be told apart */
+static void agent_task_name(const esp_agent_t *agent, const char *suffix, char *name, size_t name_len)
+{
+    snprintf(name, name_len, "%.*s_%s", (int)(name_len - strlen(suffix) - 2), agent->name, suffix);
+}
+
 esp_agent_handle_t esp_agent_init(const esp_agent_config_t *config)
 {
     if (config == NULL) {
@@ -69,6 +153,10 @@ esp_agent_handle_t esp_agent_init(const esp_agent_config_t *config)
         return NULL;
     }
 
+    /* Approximate, other tasks may allocate concurrently */
+    size_t free_heap_before = esp_get_free_heap_size();
+    char task_name[configMAX_TASK_NAME_LEN];
+
     esp_agent_t *agent = calloc(1, sizeof(esp_agent_t));
 
     if (agent == NULL) {
@@ -76,6 +164,19 @@ esp_agent_handle_t esp_agent_init(const esp_agent_config_t *config)
         goto err;
     }
 
+    portMUX_INITIALIZE(&agent->state_lock);
+    agent->start_stop_mutex = xSemaphoreCreateRecursiveMutex();
+    if (agent->start_stop_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create start/stop mutex");
+        goto err;
+    }
+
+    agent->name = strdup(config->name ? config->name : "agent");
+    if (agent->name == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate name");
+        goto err;
+    }
+
     agent->conversation_id = NULL;
     agent->conversation_type = config->conversation_type;
 
@@ -105,17 +206,20 @@ esp_agent_handle_t esp_agent_init(const esp_agent_config_t *config)
 
     // Configure websocket client
     esp_websocket_client_config_t ws_cfg = {
-        .buffer_size = 8*1024,
+        .buffer_size = CONFIG_ESP_AGENT_WS_BUFFER_SIZE,
         .network_timeout_ms = 10000,
+#if CONFIG_ESP_AGENT_API_USE_TLS
         .crt_bundle_attach = esp_crt_bundle_attach,
+#endif
         .disable_auto_reconnect = true,
     };
 
     esp_err_t err;
 
+    agent_task_name(agent, "events", task_name, sizeof(task_name));
     esp_event_loop_args_t loop_args = {
         .queue_size = 10,
-        .task_name = "agent_events",
+        .task_name = task_name,
         .task_priority = 5,
         .task_stack_size = 4096,
         .task_core_id = 0,
@@ -127,13 +231,21 @@ esp_agent_handle_t esp_agent_init(const esp_agent_config_t *config)
         goto err;
     }
 
-    agent->message_queue = xQueueCreate(ESP_AGENT_TEXT_MESSAGE_QUEUE_SIZE, sizeof(char *));
+    err = esp_agent_events_backlog_init(agent);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create event backlog");
+        goto err;
+    }
+
+    esp_agent_mem_init(&agent->mem);
+
+    agent->message_queue = esp_agent_mem_queue_create(ESP_AGENT_TEXT_MESSAGE_QUEUE_SIZE, sizeof(esp_agent_rx_message_t));
     if (agent->message_queue == NULL) {
         ESP_LOGE(TAG, "Failed to create message queue");
         goto err;
     }
 
-    agent->send_queue = xQueueCreate(ESP_AGENT_SEND_QUEUE_SIZE, sizeof(ws_send_message_t *));
+    agent->send_queue = esp_agent_mem_queue_create(ESP_AGENT_SEND_QUEUE_SIZE, sizeof(ws_send_message_t *));
     if (agent->send_queue == NULL) {
         ESP_LOGE(TAG, "Failed to create send queue");
         goto err;
@@ -147,7 +259,7 @@ esp_agent_handle_t esp_agent_init(const esp_agent_config_t *config)
     }
 
     esp_websocket_register_events(agent->ws_client, WEBSOCKET_EVENT_ANY, esp_agent_websocket_event_handler, agent);
-    esp_event_handler_instance_register_with(agent->event_loop, AGENT_EVENT, ESP_EVENT_ANY_ID, esp_agent_internal_event_handler, NULL, &agent->internal_event_handler);
+    esp_event_handler_instance_register_with(agent->event_loop, AGENT_EVENT, ESP_EVENT_ANY_ID, esp_agent_internal_event_handler, agent, &agent->internal_event_handler);
 
     agent->connected = false;
     agent->started = false;
@@ -156,6 +268,36 @@ esp_agent_handle_t esp_agent_init(const esp_agent_config_t *config)
     // Initialize local tools list
     agent->local_tools = NULL;
 
+    esp_agent_latency_tracker_init(&agent->latency);
+    esp_agent_transport_stats_init(&agent->transport_stats);
+    esp_agent_usage_init(&agent->usage);
+    esp_agent_tool_stats_init(&agent->tool_stats);
+    esp_agent_tool_dedup_init(&agent->tool_dedup);
+
+    err = esp_agent_tools_init(agent);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create the tool cache");
+        goto err;
+    }
+
+    err = esp_agent_keepalive_init(agent);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create keep-alive timer");
+        goto err;
+    }
+
+    err = esp_agent_connection_init(agent);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create idle timer");
+        goto err;
+    }
+
+    err = esp_agent_resume_init(agent);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create retransmit buffer");
+        goto err;
+    }
+
     // Create event group for task stop signals
     agent->event_group = xEventGroupCreate();
     if (agent->event_group == NULL) {
@@ -164,9 +306,10 @@ esp_agent_handle_t esp_agent_init(const esp_agent_config_t *config)
     }
 
     // Create message processing task
+    agent_task_name(agent, "msg", task_name, sizeof(task_name));
     xTaskCreate(
         message_processing_task,
-        "agent_msg_task",
+        task_name,
         4096,
         agent,
         5,
@@ -174,16 +317,18 @@ esp_agent_handle_t esp_agent_init(const esp_agent_config_t *config)
     );
 
     // Create websocket send task
+    agent_task_name(agent, "send", task_name, sizeof(task_name));
     xTaskCreate(
         esp_agent_websocket_send_task,
-        "agent_ws_send",
+        task_name,
         4096,
         agent,
         5,
         &agent->send_task_handle
     );
 
-    ESP_LOGI(TAG, "Agent initialized");
+    ESP_LOGI(TAG, "Agent '%s' initialized, using about %d bytes of heap", agent->name,
+             (int)(free_heap_before - esp_get_free_heap_size()));
 
     return (esp_agent_handle_t)agent;
 
@@ -224,7 +369,7 @@ void esp_agent_deinit(esp_agent_handle_t handle)
 
     esp_agent_t *agent = (esp_agent_t *)handle;
 
-    if (agent->started) {
+    if (agent->start_stop_mutex && esp_agent_is_started(agent)) {
         esp_agent_stop(handle);
     }
 
@@ -238,19 +383,38 @@ void esp_agent_deinit(esp_agent_handle_t handle)
         agent->event_group = NULL;
     }
 
+    esp_agent_keepalive_deinit(handle);
+    esp_agent_connection_deinit(handle);
+
     if (agent->ws_client) {
         esp_websocket_client_destroy(agent->ws_client);
     }
 
+    /* The internal handler gets the agent as its argument: no event still queued may reach it once the agent is freed */
+    if (agent->event_loop) {
+        if (agent->internal_event_handler) {
+            esp_event_handler_instance_unregister_with(agent->event_loop, AGENT_EVENT, ESP_EVENT_ANY_ID, agent->internal_event_handler);
+            agent->internal_event_handler = NULL;
+        }
+        esp_event_loop_delete(agent->event_loop);
+        agent->event_loop = NULL;
+    }
+
+    esp_agent_events_backlog_deinit(handle);
+    esp_agent_compression_deinit(handle);
+    esp_agent_resume_deinit(handle);
+
+    esp_agent_websocket_rx_buffer_free(&agent->rx_buffer);
+
     if (agent->message_queue) {
         /* Purge any remaining messages in received messages queue */
-        char *message = NULL;
-        while (xQueueReceive(agent->message_queue, &message, 0) == pdTRUE) {
-            if (message) {
-                free(message);
+        esp_agent_rx_message_t rx_message;
+        while (xQueueReceive(agent->message_queue, &rx_message, 0) == pdTRUE) {
+            if (rx_message.message) {
+                free(rx_message.message);
             }
         }
-        vQueueDelete(agent->message_queue);
+        esp_agent_mem_queue_delete(agent->message_queue);
     }
 
     if (agent->send_queue) {
@@ -264,7 +428,7 @@ void esp_agent_deinit(esp_agent_handle_t handle)
                 free(msg);
             }
         }
-        vQueueDelete(agent->send_queue);
+        esp_agent_mem_queue_delete(agent->send_queue);
     }
 
     if (agent->agent_id) {
@@ -284,19 +448,16 @@ void esp_agent_deinit(esp_agent_handle_t handle)
     }
 
     // Clean up all registered local tools
-    local_tool_node_t *tool_node = agent->local_tools;
-    while (tool_node != NULL) {
-        local_tool_node_t *next_node = tool_node->next;
-        if (tool_node->name) {
-            free(tool_node->name);
-        }
-        free(tool_node);
-        tool_node = next_node;
-    }
+    esp_agent_tools_deinit(handle);
+    esp_agent_tool_dedup_deinit(&agent->tool_dedup);
 
-    free(agent);
+    ESP_LOGI(TAG, "Agent '%s' deinitialized", agent->name ? agent->name : "");
 
-    ESP_LOGI(TAG, "Agent deinitialized");
+    if (agent->start_stop_mutex) {
+        vSemaphoreDelete(agent->start_stop_mutex);
+    }
+    free(agent->name);
+    free(agent);
 }
 
 esp_err_t esp_agent_set_agent_id(esp_agent_handle_t handle, const char *agent_id)
@@ -322,21 +483,22 @@ esp_err_t esp_agent_set_agent_id(esp_agent_handle_t handle, const char *agent_id
     ESP_LOGI(TAG, "Set agent_id to: %s", agent_id);
 
     // If agent was started and agent_id changed, reconnect with new agent_id
-    if (agent_id_changed && agent->started) {
-        esp_err_t err = esp_agent_stop(handle);
+    esp_err_t err = ESP_OK;
+    esp_agent_start_stop_lock(agent);
+    if (agent_id_changed && esp_agent_is_started(agent)) {
+        err = esp_agent_stop(handle);
         if (err != ESP_OK) {
             ESP_LOGE(TAG, "Failed to stop agent during agent_id update: %x", err);
-            return err;
-        }
-
-        err = esp_agent_start(handle, NULL);
-        if (err != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to restart agent after agent_id update: %x", err);
-            return err;
+        } else {
+            err = esp_agent_start(handle, NULL);
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to restart agent after agent_id update: %x", err);
+            }
         }
     }
+    esp_agent_start_stop_unlock(agent);
 
-    return ESP_OK;
+    return err;
 }
 
 esp_err_t esp_agent_set_refresh_token(esp_agent_handle_t handle, const char *refresh_token)
@@ -362,14 +524,17 @@ esp_err_t esp_agent_set_refresh_token(esp_agent_handle_t handle, const char *ref
     }
 
     /* If agent was started/connected, stop and restart it with new refresh token */
-    if (agent->started) {
+    esp_agent_start_stop_lock(agent);
+    if (esp_agent_is_started(agent)) {
         esp_err_t err = esp_agent_stop(handle);
         if (err != ESP_OK) {
             ESP_LOGE(TAG, "Failed to stop agent during refresh_token update: %x", err);
+            esp_agent_start_stop_unlock(agent);
             return err;
         }
-        err = esp_agent_start(handle, NULL);
+        esp_agent_start(handle, NULL);
     }
+    esp_agent_start_stop_unlock(agent);
 
     ESP_LOGI(TAG, "Set refresh_token");
     return ESP_OK;
@@ -0,0 +1,182 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <cJSON.h>
+
+#include <esp_agent.h>
+#include <esp_agent_internal.h>
+#include <esp_agent_internal_aggregation.h>
+#include <esp_agent_websocket.h>
+
+#if CONFIG_ESP_AGENT_AUDIO_AGGREGATION
+
+static const char *TAG = "esp_agent_aggregation";
+
+/* Each frame is preceded by its length, 16 bit big endian */
+#define AGGREGATION_FRAMING "u16be-length-prefixed"
+#define AGGREGATION_PREFIX_LEN 2
+#define AGGREGATION_MAX_WINDOW_US (CONFIG_ESP_AGENT_AUDIO_AGGREGATION_MAX_WINDOW_MS * 1000)
+
+void esp_agent_aggregation_add_to_handshake(cJSON *input)
+{
+    cJSON *aggregation = cJSON_CreateObject();
+    if (aggregation == NULL) {
+        return;
+    }
+    cJSON_AddStringToObject(aggregation, "framing", AGGREGATION_FRAMING);
+    cJSON_AddNumberToObject(aggregation, "maxFrames", CONFIG_ESP_AGENT_AUDIO_AGGREGATION_MAX_FRAMES);
+    cJSON_AddItemToObject(input, "aggregation", aggregation);
+}
+
+void esp_agent_aggregation_handshake_ack(esp_agent_handle_t handle, cJSON *content)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    cJSON *aggregation = cJSON_GetObjectItemCaseSensitive(content, "audioAggregation");
+    char *framing = cJSON_GetStringValue(cJSON_IsObject(aggregation) ? cJSON_GetObjectItemCaseSensitive(aggregation, "framing") : aggregation);
+
+    agent->aggregation.negotiated = framing && strcmp(framing, AGGREGATION_FRAMING) == 0;
+    agent->aggregation.window_us = 0;
+    if (agent->conversation_type == ESP_AGENT_CONVERSATION_SPEECH) {
+        ESP_LOGI(TAG, "Uplink audio aggregation %s", agent->aggregation.negotiated ? "enabled" : "not supported by the server");
+    }
+}
+
+static TickType_t aggregation_wait_ticks(int64_t remaining_us)
+{
+    if (remaining_us <= 0) {
+        return 0;
+    }
+    const int64_t tick_us = portTICK_PERIOD_MS * 1000;
+    return (TickType_t)((remaining_us + tick_us - 1) / tick_us);
+}
+
+uint32_t esp_agent_aggregation_collect(esp_agent_handle_t handle, ws_send_message_t *msg)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_aggregation_t *aggregation = &agent->aggregation;
+
+    if (!aggregation->negotiated) {
+        return 1;
+    }
+    if (msg->len > UINT16_MAX) {
+        ESP_LOGE(TAG, "Audio frame of %u bytes too large for its length prefix", (unsigned)msg->len);
+        return 0;
+    }
+
+    ws_send_message_t *frames[CONFIG_ESP_AGENT_AUDIO_AGGREGATION_MAX_FRAMES] = { msg };
+    uint32_t count = 1;
+    size_t total = AGGREGATION_PREFIX_LEN + msg->len;
+    int64_t deadline_us = esp_timer_get_time() + aggregation->window_us;
+
+    while (count < CONFIG_ESP_AGENT_AUDIO_AGGREGATION_MAX_FRAMES) {
+        ws_send_message_t *next = NULL;
+        TickType_t wait = aggregation_wait_ticks(deadline_us - esp_timer_get_time());
+        if (xQueuePeek(agent->send_queue, &next, wait) != pdTRUE) {
+            break;
+        }
+        if (next == NULL || next->type != WS_SEND_MSG_TYPE_BINARY || next->len > UINT16_MAX) {
+            break;
+        }
+        /* Only the send task takes messages from the queue, so this is the message peeked */
+        xQueueReceive(agent->send_queue, &next, 0);
+        esp_agent_transport_stats_count_queue_latency(&agent->transport_stats, ESP_AGENT_TRANSPORT_QUEUE_SEND, next->queued_at_us);
+        frames[count++] = next;
+        total += AGGREGATION_PREFIX_LEN + next->len;
+    }
+
+    uint8_t *packed = esp_agent_mem_realloc(agent, ESP_AGENT_MEM_TX_AUDIO, NULL, total);
+    if (packed == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate %u bytes for %lu frames", (unsigned)total, (unsigned long)count);
+        /* The first frame is still sent, on its own */
+        for (uint32_t i = 1; i < count; i++) {
+            esp_agent_transport_stats_count_drop(&agent->transport_stats, true);
+            free(frames[i]->payload);
+            free(frames[i]);
+        }
+        count = 1;
+        total = AGGREGATION_PREFIX_LEN + msg->len;
+        packed = esp_agent_mem_realloc(agent, ESP_AGENT_MEM_TX_AUDIO, NULL, total);
+        if (packed == NULL) {
+            return 0;
+        }
+    }
+
+    size_t offset = 0;
+    bool timed = esp_agent_mem_count_copy(agent, ESP_AGENT_MEM_TX_AUDIO, total);
+    int64_t copy_start_us = timed ? esp_timer_get_time() : 0;
+    for (uint32_t i = 0; i < count; i++) {
+        packed[offset++] = (uint8_t)(frames[i]->len >> 8);
+        packed[offset++] = (uint8_t)(frames[i]->len & 0xff);
+        memcpy(packed + offset, frames[i]->payload, frames[i]->len);
+        offset += frames[i]->len;
+        if (i > 0) {
+            free(frames[i]->payload);
+            free(frames[i]);
+        }
+    }
+    if (timed) {
+        esp_agent_mem_time_copy(agent, ESP_AGENT_MEM_TX_AUDIO, total, esp_timer_get_time() - copy_start_us);
+    }
+    esp_agent_transport_stats_count_copy(&agent->transport_stats, total, 1);
+
+    free(msg->payload);
+    msg->payload = (char *)packed;
+    msg->len = total;
+    return count;
+}
+
+void esp_agent_aggregation_sent(esp_agent_handle_t handle, uint32_t frames, int64_t send_us)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_aggregation_t *aggregation = &agent->aggregation;
+
+    if (!aggregation->negotiated) {
+        return;
+    }
+
+    uint32_t frame_us = (agent->upload_audio_config.frame_duration ? agent->upload_audio_config.frame_duration : 20) * 1000;
+    UBaseType_t waiting = uxQueueMessagesWaiting(agent->send_queue);
+
+    /* The link is congested if sending takes longer than the audio it carries, or frames pile up */
+    if (send_us * 2 > (int64_t)frame_us * frames || waiting >= 2) {
+        uint32_t window_us = aggregation->window_us ? aggregation->window_us * 2 : frame_us;
+        aggregation->window_us = window_us > AGGREGATION_MAX_WINDOW_US ? AGGREGATION_MAX_WINDOW_US : window_us;
+    } else if (send_us * 4 < frame_us && waiting == 0) {
+        aggregation->window_us /= 2;
+        if (aggregation->window_us < frame_us / 2) {
+            aggregation->window_us = 0;
+        }
+    }
+}
+
+#else /* CONFIG_ESP_AGENT_AUDIO_AGGREGATION */
+
+void esp_agent_aggregation_add_to_handshake(cJSON *input)
+{
+}
+
+void esp_agent_aggregation_handshake_ack(esp_agent_handle_t handle, cJSON *content)
+{
+}
+
+uint32_t esp_agent_aggregation_collect(esp_agent_handle_t handle, ws_send_message_t *msg)
+{
+    return 1;
+}
+
+void esp_agent_aggregation_sent(esp_agent_handle_t handle, uint32_t frames, int64_t send_us)
+{
+}
+
+#endif /* CONFIG_ESP_AGENT_AUDIO_AGGREGATION */
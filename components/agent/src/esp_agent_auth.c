@@ -9,7 +9,9 @@
 #include <string.h>
 #include <stdlib.h>
 
+#if CONFIG_ESP_AGENT_API_USE_TLS
 #include <esp_crt_bundle.h>
+#endif
 #include <esp_http_client.h>
 
 #include <esp_agent_auth.h>
@@ -85,7 +87,9 @@ esp_err_t esp_agent_auth_get_access_token(const char *refresh_token, char **acce
         .url = refresh_url,
         .method = HTTP_METHOD_POST,
         .timeout_ms = 10000,
+#if CONFIG_ESP_AGENT_API_USE_TLS
         .crt_bundle_attach = esp_crt_bundle_attach,
+#endif
         .buffer_size = 3072,
     };
 
@@ -0,0 +1,292 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <cJSON.h>
+
+#if CONFIG_ESP_AGENT_TEXT_COMPRESSION
+#include <zlib.h>
+#include <mbedtls/base64.h>
+#endif
+
+#include <esp_agent.h>
+#include <esp_agent_internal.h>
+#include <esp_agent_internal_compression.h>
+
+static const char *TAG = "esp_agent_compression";
+
+#if CONFIG_ESP_AGENT_TEXT_COMPRESSION
+
+/* Raw deflate (no zlib header), as the message carries its own framing */
+#define COMPRESSION_ALGORITHM "deflate-raw"
+#define COMPRESSION_WINDOW_BITS CONFIG_ESP_AGENT_TEXT_COMPRESSION_WINDOW_BITS
+#define COMPRESSION_MEM_LEVEL 4
+
+/* Same limit as for the reassembly of uncompressed messages */
+#define COMPRESSION_MAX_MESSAGE_LEN (64 * 1024)
+
+#define COMPRESSED_MESSAGE_PREFIX "{\"type\":\"" ESP_AGENT_MESSAGE_TYPE_COMPRESSED "\",\"content_type\":\"" COMPRESSION_ALGORITHM "\",\"content\":\""
+#define COMPRESSED_MESSAGE_SUFFIX_FMT "\",\"metadata\":{\"length\":%u}}"
+
+/* zlib does not pass the size to zfree, so it is stored in front of each allocation */
+static voidpf compression_zalloc(voidpf opaque, uInt items, uInt size)
+{
+    size_t *memory = (size_t *)opaque;
+    size_t len = (size_t)items * size;
+    size_t *ptr = malloc(sizeof(size_t) + len);
+    if (ptr == NULL) {
+        return Z_NULL;
+    }
+    ptr[0] = len;
+    *memory += len;
+    return ptr + 1;
+}
+
+static void compression_zfree(voidpf opaque, voidpf address)
+{
+    if (address == Z_NULL) {
+        return;
+    }
+    size_t *memory = (size_t *)opaque;
+    size_t *ptr = (size_t *)address - 1;
+    *memory -= ptr[0];
+    free(ptr);
+}
+
+static z_stream *compression_stream_create(size_t *memory, bool deflate)
+{
+    z_stream *stream = calloc(1, sizeof(z_stream));
+    if (stream == NULL) {
+        return NULL;
+    }
+    stream->zalloc = compression_zalloc;
+    stream->zfree = compression_zfree;
+    stream->opaque = memory;
+
+    int ret;
+    if (deflate) {
+        ret = deflateInit2(stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -COMPRESSION_WINDOW_BITS, COMPRESSION_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+    } else {
+        ret = inflateInit2(stream, -COMPRESSION_WINDOW_BITS);
+    }
+    if (ret != Z_OK) {
+        ESP_LOGE(TAG, "Failed to initialize %s: %d", deflate ? "deflate" : "inflate", ret);
+        free(stream);
+        return NULL;
+    }
+
+    *memory += sizeof(z_stream);
+    return stream;
+}
+
+void esp_agent_compression_add_to_handshake(cJSON *content)
+{
+    cJSON *compression = cJSON_CreateObject();
+    if (compression == NULL) {
+        return;
+    }
+    cJSON_AddStringToObject(compression, "algorithm", COMPRESSION_ALGORITHM);
+    cJSON_AddNumberToObject(compression, "windowBits", COMPRESSION_WINDOW_BITS);
+    cJSON_AddNumberToObject(compression, "threshold", CONFIG_ESP_AGENT_TEXT_COMPRESSION_THRESHOLD);
+    cJSON_AddItemToObject(content, "compression", compression);
+}
+
+void esp_agent_compression_handshake_ack(esp_agent_handle_t handle, cJSON *content)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    cJSON *compression = cJSON_GetObjectItemCaseSensitive(content, "compression");
+    char *algorithm = cJSON_GetStringValue(cJSON_IsObject(compression) ? cJSON_GetObjectItemCaseSensitive(compression, "algorithm") : compression);
+
+    agent->compression.negotiated = algorithm && strcmp(algorithm, COMPRESSION_ALGORITHM) == 0;
+    ESP_LOGI(TAG, "Text message compression %s", agent->compression.negotiated ? "enabled" : "not supported by the server");
+}
+
+char *esp_agent_compression_compress(esp_agent_handle_t handle, const char *message, size_t len, size_t *out_len)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_compression_t *compression = &agent->compression;
+
+    if (!compression->negotiated || len < CONFIG_ESP_AGENT_TEXT_COMPRESSION_THRESHOLD || len > COMPRESSION_MAX_MESSAGE_LEN) {
+        return NULL;
+    }
+
+    int64_t start = esp_timer_get_time();
+    char *compressed = NULL;
+    uint8_t *deflated = NULL;
+
+    if (compression->deflate == NULL) {
+        compression->deflate = compression_stream_create(&compression->deflate_memory, true);
+        if (compression->deflate == NULL) {
+            return NULL;
+        }
+    }
+
+    z_stream *stream = (z_stream *)compression->deflate;
+    size_t deflated_cap = deflateBound(stream, len);
+    deflated = malloc(deflated_cap);
+    if (deflated == NULL) {
+        goto end;
+    }
+
+    stream->next_in = (Bytef *)message;
+    stream->avail_in = len;
+    stream->next_out = deflated;
+    stream->avail_out = deflated_cap;
+    int ret = deflate(stream, Z_FINISH);
+    size_t deflated_len = deflated_cap - stream->avail_out;
+    deflateReset(stream);
+    if (ret != Z_STREAM_END) {
+        ESP_LOGW(TAG, "Failed to compress message: %d", ret);
+        goto end;
+    }
+
+    size_t encoded_len = 0;
+    mbedtls_base64_encode(NULL, 0, &encoded_len, deflated, deflated_len);
+
+    /* Not worth it if base64 eats the gain (the suffix is at most 32 bytes) */
+    size_t total_cap = sizeof(COMPRESSED_MESSAGE_PREFIX) - 1 + encoded_len + 32;
+    if (total_cap >= len) {
+        goto end;
+    }
+
+    compressed = malloc(total_cap);
+    if (compressed == NULL) {
+        goto end;
+    }
+
+    size_t offset = sizeof(COMPRESSED_MESSAGE_PREFIX) - 1;
+    memcpy(compressed, COMPRESSED_MESSAGE_PREFIX, offset);
+    if (mbedtls_base64_encode((unsigned char *)compressed + offset, total_cap - offset, &encoded_len, deflated, deflated_len) != 0) {
+        free(compressed);
+        compressed = NULL;
+        goto end;
+    }
+    offset += encoded_len;
+    offset += snprintf(compressed + offset, total_cap - offset, COMPRESSED_MESSAGE_SUFFIX_FMT, (unsigned int)len);
+    *out_len = offset;
+
+    esp_agent_transport_stats_count_compression(&agent->transport_stats, true, len, offset, (uint32_t)(esp_timer_get_time() - start));
+    ESP_LOGD(TAG, "Compressed text message: %d -> %d bytes", (int)len, (int)offset);
+
+end:
+    free(deflated);
+    return compressed;
+}
+
+char *esp_agent_compression_decompress(esp_agent_handle_t handle, cJSON *content, cJSON *metadata)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_compression_t *compression = &agent->compression;
+
+    const char *encoded = cJSON_GetStringValue(content);
+    cJSON *length = cJSON_GetObjectItemCaseSensitive(metadata, "length");
+    if (encoded == NULL || !cJSON_IsNumber(length) || length->valuedouble <= 0 || length->valuedouble > COMPRESSION_MAX_MESSAGE_LEN) {
+        ESP_LOGE(TAG, "Invalid compressed message");
+        return NULL;
+    }
+
+    int64_t start = esp_timer_get_time();
+    size_t encoded_len = strlen(encoded);
+    size_t original_len = (size_t)length->valuedouble;
+    size_t deflated_len = 0;
+    uint8_t *deflated = NULL;
+    char *original = NULL;
+
+    if (compression->inflate == NULL) {
+        compression->inflate = compression_stream_create(&compression->inflate_memory, false);
+        if (compression->inflate == NULL) {
+            return NULL;
+        }
+    }
+
+    /* base64 decodes to at most 3/4 of its length */
+    deflated = malloc(encoded_len / 4 * 3 + 3);
+    original = malloc(original_len + 1);
+    if (deflated == NULL || original == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate memory for decompression");
+        goto err;
+    }
+
+    if (mbedtls_base64_decode(deflated, encoded_len / 4 * 3 + 3, &deflated_len, (const unsigned char *)encoded, encoded_len) != 0) {
+        ESP_LOGE(TAG, "Invalid base64 in compressed message");
+        goto err;
+    }
+
+    z_stream *stream = (z_stream *)compression->inflate;
+    stream->next_in = deflated;
+    stream->avail_in = deflated_len;
+    stream->next_out = (Bytef *)original;
+    stream->avail_out = original_len;
+    int ret = inflate(stream, Z_FINISH);
+    size_t inflated_len = original_len - stream->avail_out;
+    inflateReset(stream);
+    if (ret != Z_STREAM_END || inflated_len != original_len) {
+        ESP_LOGE(TAG, "Failed to decompress message: %d", ret);
+        goto err;
+    }
+    original[original_len] = '\0';
+    free(deflated);
+
+    esp_agent_transport_stats_count_compression(&agent->transport_stats, false, original_len, encoded_len, (uint32_t)(esp_timer_get_time() - start));
+    return original;
+
+err:
+    free(deflated);
+    free(original);
+    return NULL;
+}
+
+void esp_agent_compression_deinit(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_compression_t *compression = &agent->compression;
+
+    if (compression->deflate) {
+        deflateEnd((z_stream *)compression->deflate);
+        free(compression->deflate);
+        compression->deflate = NULL;
+    }
+    if (compression->inflate) {
+        inflateEnd((z_stream *)compression->inflate);
+        free(compression->inflate);
+        compression->inflate = NULL;
+    }
+    compression->negotiated = false;
+    compression->deflate_memory = 0;
+    compression->inflate_memory = 0;
+}
+
+#else /* CONFIG_ESP_AGENT_TEXT_COMPRESSION */
+
+void esp_agent_compression_add_to_handshake(cJSON *content)
+{
+}
+
+void esp_agent_compression_handshake_ack(esp_agent_handle_t handle, cJSON *content)
+{
+}
+
+char *esp_agent_compression_compress(esp_agent_handle_t handle, const char *message, size_t len, size_t *out_len)
+{
+    return NULL;
+}
+
+char *esp_agent_compression_decompress(esp_agent_handle_t handle, cJSON *content, cJSON *metadata)
+{
+    ESP_LOGE(TAG, "Received a compressed message, but compression is disabled");
+    return NULL;
+}
+
+void esp_agent_compression_deinit(esp_agent_handle_t handle)
+{
+}
+
+#endif /* CONFIG_ESP_AGENT_TEXT_COMPRESSION */
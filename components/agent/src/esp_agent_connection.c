@@ -0,0 +1,294 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <esp_log.h>
+#include <esp_event.h>
+#include <esp_timer.h>
+#if CONFIG_IDF_TARGET_LINUX
+#include <malloc.h>
+#else
+#include <esp_heap_caps.h>
+#endif
+
+#include <esp_agent.h>
+#include <esp_agent_internal.h>
+#include <esp_agent_internal_connection.h>
+#include <esp_agent_internal_events.h>
+
+static const char *TAG = "esp_agent_connection";
+
+#if CONFIG_ESP_AGENT_IDLE_TIMEOUT_S
+/* The timeout is checked this often, so it fires up to this much late */
+#define IDLE_CHECK_INTERVAL_US (CONFIG_ESP_AGENT_IDLE_TIMEOUT_S * 1000000LL / 4)
+
+static void idle_timer_cb(void *arg)
+{
+    esp_agent_t *agent = (esp_agent_t *)arg;
+    esp_agent_connection_t *connection = &agent->connection;
+    int64_t now = esp_timer_get_time();
+    bool idle = false;
+
+    portENTER_CRITICAL(&connection->lock);
+    if (!connection->idle_posted && connection->ready_at_us &&
+            now - connection->last_activity_us >= CONFIG_ESP_AGENT_IDLE_TIMEOUT_S * 1000000LL) {
+        connection->idle_posted = true;
+        idle = true;
+    }
+    portEXIT_CRITICAL(&connection->lock);
+
+    if (!idle) {
+        return;
+    }
+
+    ESP_LOGI(TAG, "No activity for %d s, closing the connection", CONFIG_ESP_AGENT_IDLE_TIMEOUT_S);
+    /* If the event is lost, it is posted again on the next check */
+    if (esp_agent_post_event(agent, ESP_AGENT_EVENT_IDLE, NULL) != ESP_OK) {
+        portENTER_CRITICAL(&connection->lock);
+        connection->idle_posted = false;
+        portEXIT_CRITICAL(&connection->lock);
+    }
+}
+#endif
+
+esp_err_t esp_agent_connection_init(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+
+    memset(&agent->connection, 0, sizeof(esp_agent_connection_t));
+    portMUX_INITIALIZE(&agent->connection.lock);
+
+#if CONFIG_ESP_AGENT_IDLE_TIMEOUT_S
+    esp_timer_create_args_t timer_args = {
+        .callback = idle_timer_cb,
+        .arg = agent,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "agent_idle",
+        .skip_unhandled_events = true,
+    };
+    return esp_timer_create(&timer_args, &agent->connection.idle_timer);
+#else
+    return ESP_OK;
+#endif
+}
+
+void esp_agent_connection_deinit(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+
+    if (agent->connection.idle_timer) {
+        esp_timer_stop(agent->connection.idle_timer);
+        esp_timer_delete(agent->connection.idle_timer);
+        agent->connection.idle_timer = NULL;
+    }
+}
+
+void esp_agent_connection_connecting(esp_agent_handle_t handle, bool resume)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_connection_t *connection = &agent->connection;
+
+    portENTER_CRITICAL(&connection->lock);
+    connection->connect_started_us = esp_timer_get_time();
+    connection->resume = resume;
+    portEXIT_CRITICAL(&connection->lock);
+}
+
+void esp_agent_connection_started(esp_agent_handle_t handle, int64_t call_us)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+
+    portENTER_CRITICAL(&agent->connection.lock);
+    esp_agent_stats_window_add(&agent->connection.start_call_us, (uint32_t)call_us);
+    portEXIT_CRITICAL(&agent->connection.lock);
+}
+
+/* Sampled outside the critical section, the heap takes its own lock */
+static void connection_heap_sample(uint32_t *heap_free, uint32_t *heap_largest_block)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    /* The host heap has no fixed size: count down from UINT32_MAX by the bytes in use, so that a leak still lowers it */
+    struct mallinfo2 info = mallinfo2();
+    size_t used = info.uordblks + info.hblkhd;
+    *heap_free = used < UINT32_MAX ? UINT32_MAX - (uint32_t)used : 0;
+    *heap_largest_block = *heap_free;
+#else
+    *heap_free = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    *heap_largest_block = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+#endif
+}
+
+void esp_agent_connection_stopped(esp_agent_handle_t handle, int64_t call_us)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_connection_t *connection = &agent->connection;
+    uint32_t heap_free = 0;
+    uint32_t heap_largest_block = 0;
+    connection_heap_sample(&heap_free, &heap_largest_block);
+
+    portENTER_CRITICAL(&connection->lock);
+    connection->stops++;
+    esp_agent_stats_window_add(&connection->stop_call_us, (uint32_t)call_us);
+    if (connection->heap_free_first == 0) {
+        connection->heap_free_first = heap_free;
+        connection->heap_largest_block_min = heap_largest_block;
+    }
+    connection->heap_free_last = heap_free;
+    connection->heap_largest_block_last = heap_largest_block;
+    if (heap_largest_block < connection->heap_largest_block_min) {
+        connection->heap_largest_block_min = heap_largest_block;
+    }
+    portEXIT_CRITICAL(&connection->lock);
+
+    ESP_LOGD(TAG, "Stopped in %lu us, free heap %lu, largest block %lu", (unsigned long)call_us,
+             (unsigned long)heap_free, (unsigned long)heap_largest_block);
+}
+
+void esp_agent_connection_ready(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_connection_t *connection = &agent->connection;
+    int64_t now = esp_timer_get_time();
+    uint32_t connect_ms = 0;
+    bool resume = false;
+
+    portENTER_CRITICAL(&connection->lock);
+    if (connection->connect_started_us) {
+        connect_ms = (uint32_t)((now - connection->connect_started_us) / 1000);
+        resume = connection->resume;
+        esp_agent_stats_window_add(resume ? &connection->resume_ms : &connection->connect_ms, connect_ms);
+        connection->connect_started_us = 0;
+    }
+    connection->connects++;
+    if (resume) {
+        connection->resumes++;
+    }
+    connection->ready_at_us = now;
+    connection->last_activity_us = now;
+    connection->idle_posted = false;
+    portEXIT_CRITICAL(&connection->lock);
+
+    ESP_LOGI(TAG, "%s in %lu ms", resume ? "Resumed" : "Connected", (unsigned long)connect_ms);
+
+#if CONFIG_ESP_AGENT_IDLE_TIMEOUT_S
+    esp_timer_stop(connection->idle_timer);
+    esp_timer_start_periodic(connection->idle_timer, IDLE_CHECK_INTERVAL_US);
+#endif
+}
+
+void esp_agent_connection_closed(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_connection_t *connection = &agent->connection;
+
+    if (connection->idle_timer) {
+        esp_timer_stop(connection->idle_timer);
+    }
+
+    portENTER_CRITICAL(&connection->lock);
+    if (connection->ready_at_us) {
+        connection->connected_total_us += esp_timer_get_time() - connection->ready_at_us;
+        connection->ready_at_us = 0;
+    }
+    connection->connect_started_us = 0;
+    portEXIT_CRITICAL(&connection->lock);
+}
+
+void esp_agent_connection_activity(esp_agent_handle_t handle)
+{
+#if CONFIG_ESP_AGENT_IDLE_TIMEOUT_S
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&agent->connection.lock);
+    agent->connection.last_activity_us = now;
+    portEXIT_CRITICAL(&agent->connection.lock);
+#endif
+}
+
+void esp_agent_connection_idle_close(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    bool idle;
+
+    /* The application does not start the agent again between the check and the stop */
+    esp_agent_start_stop_lock(agent);
+
+    /* Activity may have resumed while the event was queued */
+    portENTER_CRITICAL(&agent->connection.lock);
+    idle = agent->connection.idle_posted && agent->connection.ready_at_us &&
+           esp_timer_get_time() - agent->connection.last_activity_us >= CONFIG_ESP_AGENT_IDLE_TIMEOUT_S * 1000000LL;
+    if (idle) {
+        agent->connection.idle_closes++;
+    }
+    agent->connection.idle_posted = false;
+    portEXIT_CRITICAL(&agent->connection.lock);
+
+    if (idle && esp_agent_is_started(agent)) {
+        /* Sends a close frame and waits briefly for the server to close its side */
+        esp_agent_stop(handle);
+    }
+    esp_agent_start_stop_unlock(agent);
+}
+
+esp_err_t esp_agent_get_connection_stats(esp_agent_handle_t handle, esp_agent_connection_stats_t *stats)
+{
+    if (handle == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_connection_t *connection = &agent->connection;
+    esp_agent_stats_window_t connect_window;
+    esp_agent_stats_window_t resume_window;
+    esp_agent_stats_window_t start_call_window;
+    esp_agent_stats_window_t stop_call_window;
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&connection->lock);
+    stats->connects = connection->connects;
+    stats->resumes = connection->resumes;
+    stats->idle_closes = connection->idle_closes;
+    int64_t connected_us = connection->connected_total_us;
+    if (connection->ready_at_us) {
+        connected_us += now - connection->ready_at_us;
+    }
+    connect_window = connection->connect_ms;
+    resume_window = connection->resume_ms;
+    start_call_window = connection->start_call_us;
+    stop_call_window = connection->stop_call_us;
+    stats->stops = connection->stops;
+    stats->heap_free_first = connection->heap_free_first;
+    stats->heap_free_last = connection->heap_free_last;
+    stats->heap_largest_block_last = connection->heap_largest_block_last;
+    stats->heap_largest_block_min = connection->heap_largest_block_min;
+    portEXIT_CRITICAL(&connection->lock);
+
+    stats->connected_ms = (uint64_t)(connected_us / 1000);
+    stats->uptime_ms = (uint64_t)(now / 1000);
+
+    const esp_agent_stats_window_t *windows[] = { &connect_window, &resume_window };
+    esp_agent_latency_percentiles_t *percentiles[] = { &stats->connect, &stats->resume };
+    for (int i = 0; i < 2; i++) {
+        percentiles[i]->samples = windows[i]->count;
+        percentiles[i]->p50_ms = esp_agent_stats_window_percentile(windows[i], 50);
+        percentiles[i]->p90_ms = esp_agent_stats_window_percentile(windows[i], 90);
+        percentiles[i]->p99_ms = esp_agent_stats_window_percentile(windows[i], 99);
+        percentiles[i]->max_ms = esp_agent_stats_window_percentile(windows[i], 100);
+    }
+
+    const esp_agent_stats_window_t *call_windows[] = { &start_call_window, &stop_call_window };
+    esp_agent_queue_latency_t *calls[] = { &stats->start_call, &stats->stop_call };
+    for (int i = 0; i < 2; i++) {
+        calls[i]->samples = call_windows[i]->count;
+        calls[i]->p50_us = esp_agent_stats_window_percentile(call_windows[i], 50);
+        calls[i]->p99_us = esp_agent_stats_window_percentile(call_windows[i], 99);
+        calls[i]->max_us = esp_agent_stats_window_percentile(call_windows[i], 100);
+    }
+
+    return ESP_OK;
+}
@@ -5,10 +5,15 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
 
 #include <esp_log.h>
 #include <esp_event.h>
 #include <esp_check.h>
+#include <esp_timer.h>
 
 #include <esp_agent.h>
 #include <esp_agent_internal.h>
@@ -16,11 +21,39 @@
 
 static const char *TAG = "esp_agent_events";
 
-/* This should always be the last event handler in the chain. */
-void esp_agent_internal_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
+typedef enum {
+    EVENT_POST_POLICY_DEFER,        /* Never dropped while the backlog has room, posted later in order */
+    EVENT_POST_POLICY_LATEST,       /* Superseded by the next one, so only the latest is kept */
+} event_post_policy_t;
+
+/* Events not listed here are deferred */
+static const event_post_policy_t g_event_post_policy[ESP_AGENT_EVENT_DATA_TYPE_MAX] = {
+    [ESP_AGENT_EVENT_DATA_TYPE_THINKING] = EVENT_POST_POLICY_LATEST,
+    [ESP_AGENT_EVENT_LATENCY] = EVENT_POST_POLICY_LATEST,
+    [ESP_AGENT_EVENT_LINK_HEALTH] = EVENT_POST_POLICY_LATEST,
+    [ESP_AGENT_EVENT_IDLE] = EVENT_POST_POLICY_LATEST,
+};
+
+#define EVENT_STREAM_WINDOW_US (CONFIG_ESP_AGENT_EVENT_STREAM_WINDOW_MS * 1000LL)
+
+static event_post_policy_t event_post_policy(int32_t event_id)
 {
-    esp_agent_message_data_t *data = (esp_agent_message_data_t *)event_data;
+    if (event_id < 0 || event_id >= ESP_AGENT_EVENT_DATA_TYPE_MAX) {
+        return EVENT_POST_POLICY_DEFER;
+    }
+    return g_event_post_policy[event_id];
+}
 
+/* Events of the conversation, not delivered once it was stopped */
+static bool event_is_conversation_data(int32_t event_id)
+{
+    return event_id == ESP_AGENT_EVENT_DATA_TYPE_TEXT || event_id == ESP_AGENT_EVENT_DATA_TYPE_THINKING ||
+           event_id == ESP_AGENT_EVENT_DATA_TYPE_SPEECH;
+}
+
+/* Frees the heap data of an event, once it has been handled or dropped */
+static void event_data_free(int32_t event_id, esp_agent_message_data_t *data)
+{
     switch (event_id) {
         case ESP_AGENT_EVENT_DATA_TYPE_TEXT:
             if (data->text.text) {
@@ -46,11 +79,347 @@ void esp_agent_internal_event_handler(void *handler_args, esp_event_base_t base,
                 free((void *)data->thinking.thought);
             }
             break;
+        case ESP_AGENT_EVENT_TOOL_CALL:
+            if (data->tool.name) {
+                free((void *)data->tool.name);
+            }
+            if (data->tool.request_id) {
+                free((void *)data->tool.request_id);
+            }
+            break;
+        case ESP_AGENT_EVENT_TOOL_INFO:
+            if (data->tool_info.name) {
+                free((void *)data->tool_info.name);
+            }
+            if (data->tool_info.call_id) {
+                free((void *)data->tool_info.call_id);
+            }
+            break;
         default:
             break;
     }
 }
 
+/* This should always be the last event handler in the chain. */
+void esp_agent_internal_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
+{
+    esp_agent_message_data_t *data = (esp_agent_message_data_t *)event_data;
+
+    if (data) {
+        event_data_free(event_id, data);
+    }
+
+    switch (event_id) {
+        case ESP_AGENT_EVENT_LINK_HEALTH:
+            /* Torn down once the application has seen the event. Stopping the websocket client
+             * blocks, so it is left to the message processing task.
+             */
+            if (data && data->link_health.dead && handler_args) {
+                esp_agent_request_work((esp_agent_t *)handler_args, LINK_DOWN_REQUEST_BIT);
+            }
+            break;
+        case ESP_AGENT_EVENT_IDLE:
+            /* Closed once the application has seen the event, in the message processing task as well */
+            if (handler_args) {
+                esp_agent_request_work((esp_agent_t *)handler_args, IDLE_CLOSE_REQUEST_BIT);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static esp_err_t event_post_now(esp_agent_t *agent, const esp_agent_deferred_event_t *item)
+{
+    return esp_event_post_to(agent->event_loop, AGENT_EVENT, item->event, item->has_data ? (void *)&item->data : NULL,
+                             item->has_data ? sizeof(esp_agent_message_data_t) : 0, 0);
+}
+
+/* Frees the event and returns true if it is conversation data posted before the last stop */
+static bool event_drop_stale(esp_agent_t *agent, esp_agent_deferred_event_t *item)
+{
+    esp_agent_event_backlog_t *backlog = &agent->event_backlog;
+
+    if (!event_is_conversation_data(item->event)) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&backlog->lock);
+    bool stale = item->session != backlog->session;
+    if (stale) {
+        backlog->cleared++;
+    }
+    portEXIT_CRITICAL(&backlog->lock);
+
+    if (stale && item->has_data) {
+        event_data_free(item->event, &item->data);
+    }
+    return stale;
+}
+
+esp_err_t esp_agent_events_backlog_init(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_event_backlog_t *backlog = &agent->event_backlog;
+
+    memset(backlog, 0, sizeof(esp_agent_event_backlog_t));
+    portMUX_INITIALIZE(&backlog->lock);
+    for (int i = 0; i < ESP_AGENT_EVENT_LATEST_SLOTS; i++) {
+        backlog->latest[i].event = -1;
+    }
+    for (int i = 0; i < ESP_AGENT_EVENT_STREAM_MAX; i++) {
+        backlog->streams[i].pending.event = -1;
+    }
+
+    backlog->queue = xQueueCreate(CONFIG_ESP_AGENT_EVENT_BACKLOG_SIZE, sizeof(esp_agent_deferred_event_t));
+    return backlog->queue ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+void esp_agent_events_backlog_deinit(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_event_backlog_t *backlog = &agent->event_backlog;
+    esp_agent_deferred_event_t item;
+
+    if (backlog->queue) {
+        while (xQueueReceive(backlog->queue, &item, 0) == pdTRUE) {
+            if (item.has_data) {
+                event_data_free(item.event, &item.data);
+            }
+        }
+        vQueueDelete(backlog->queue);
+        backlog->queue = NULL;
+    }
+
+    for (int i = 0; i < ESP_AGENT_EVENT_LATEST_SLOTS; i++) {
+        if (backlog->latest[i].event >= 0 && backlog->latest[i].has_data) {
+            event_data_free(backlog->latest[i].event, &backlog->latest[i].data);
+        }
+        backlog->latest[i].event = -1;
+    }
+
+    for (int i = 0; i < ESP_AGENT_EVENT_STREAM_MAX; i++) {
+        if (backlog->streams[i].pending.event >= 0 && backlog->streams[i].pending.has_data) {
+            event_data_free(backlog->streams[i].pending.event, &backlog->streams[i].pending.data);
+        }
+        backlog->streams[i].pending.event = -1;
+    }
+}
+
+/* Keep only this event of its type. The replaced one is returned in `replaced` to be freed. */
+static bool event_keep_latest(esp_agent_event_backlog_t *backlog, const esp_agent_deferred_event_t *item, esp_agent_deferred_event_t *replaced)
+{
+    int slot = -1;
+    bool stored = false;
+
+    replaced->event = -1;
+
+    portENTER_CRITICAL(&backlog->lock);
+    for (int i = 0; i < ESP_AGENT_EVENT_LATEST_SLOTS; i++) {
+        if (backlog->latest[i].event == item->event) {
+            slot = i;
+            break;
+        }
+        if (slot < 0 && backlog->latest[i].event < 0) {
+            slot = i;
+        }
+    }
+    if (slot >= 0) {
+        if (backlog->latest[slot].event >= 0) {
+            memcpy(replaced, &backlog->latest[slot], sizeof(esp_agent_deferred_event_t));
+            backlog->replaced++;
+        } else {
+            backlog->deferred++;
+        }
+        memcpy(&backlog->latest[slot], item, sizeof(esp_agent_deferred_event_t));
+        stored = true;
+    } else {
+        backlog->dropped++;
+    }
+    portEXIT_CRITICAL(&backlog->lock);
+
+    return stored;
+}
+
+/* A newer event of the same type was posted, so the pending one is stale */
+static void event_discard_latest(esp_agent_event_backlog_t *backlog, int32_t event_id)
+{
+    esp_agent_deferred_event_t stale = { .event = -1 };
+
+    portENTER_CRITICAL(&backlog->lock);
+    for (int i = 0; i < ESP_AGENT_EVENT_LATEST_SLOTS; i++) {
+        if (backlog->latest[i].event == event_id) {
+            memcpy(&stale, &backlog->latest[i], sizeof(esp_agent_deferred_event_t));
+            backlog->latest[i].event = -1;
+            backlog->replaced++;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&backlog->lock);
+
+    if (stale.event >= 0 && stale.has_data) {
+        event_data_free(stale.event, &stale.data);
+    }
+}
+
+/* Stream of intermediate updates the event belongs to, -1 if none */
+static int event_stream(const esp_agent_deferred_event_t *item)
+{
+    if (item->event == ESP_AGENT_EVENT_DATA_TYPE_THINKING) {
+        return ESP_AGENT_EVENT_STREAM_THINKING;
+    }
+    if (item->event == ESP_AGENT_EVENT_DATA_TYPE_TEXT && item->has_data &&
+            item->data.text.generation_stage == ESP_AGENT_MESSAGE_GENERATION_STAGE_SPECULATIVE) {
+        if (item->data.text.role == ESP_AGENT_MESSAGE_ROLE_ASSISTANT) {
+            return ESP_AGENT_EVENT_STREAM_SPECULATIVE;
+        }
+        if (item->data.text.role == ESP_AGENT_MESSAGE_ROLE_USER) {
+            return ESP_AGENT_EVENT_STREAM_USER_SPECULATIVE;
+        }
+    }
+    return -1;
+}
+
+/* Stream of the speculative text a final text supersedes, -1 if none */
+static int event_stream_superseded(const esp_agent_deferred_event_t *item)
+{
+    if (item->event != ESP_AGENT_EVENT_DATA_TYPE_TEXT || !item->has_data) {
+        return -1;
+    }
+    if (item->data.text.role == ESP_AGENT_MESSAGE_ROLE_ASSISTANT) {
+        return ESP_AGENT_EVENT_STREAM_SPECULATIVE;
+    }
+    if (item->data.text.role == ESP_AGENT_MESSAGE_ROLE_USER) {
+        return ESP_AGENT_EVENT_STREAM_USER_SPECULATIVE;
+    }
+    return -1;
+}
+
+static esp_err_t event_post_item(esp_agent_t *agent, esp_agent_deferred_event_t *item)
+{
+    esp_agent_event_backlog_t *backlog = &agent->event_backlog;
+    int32_t event = item->event;
+    event_post_policy_t policy = event_post_policy(event);
+
+    /* Deferred events go first, so that e.g. speech frames stay in order */
+    if (policy == EVENT_POST_POLICY_LATEST || uxQueueMessagesWaiting(backlog->queue) == 0) {
+        if (event_post_now(agent, item) == ESP_OK) {
+            if (policy == EVENT_POST_POLICY_LATEST) {
+                event_discard_latest(backlog, event);
+            }
+            return ESP_OK;
+        }
+    }
+
+    if (policy == EVENT_POST_POLICY_LATEST) {
+        esp_agent_deferred_event_t replaced;
+        bool stored = event_keep_latest(backlog, item, &replaced);
+        if (replaced.event >= 0 && replaced.has_data) {
+            event_data_free(replaced.event, &replaced.data);
+        }
+        if (stored) {
+            return ESP_OK;
+        }
+    } else if (xQueueSend(backlog->queue, item, 0) == pdTRUE) {
+        UBaseType_t waiting = uxQueueMessagesWaiting(backlog->queue);
+        portENTER_CRITICAL(&backlog->lock);
+        backlog->deferred++;
+        if (waiting > backlog->max_backlog) {
+            backlog->max_backlog = waiting;
+        }
+        portEXIT_CRITICAL(&backlog->lock);
+        return ESP_OK;
+    } else {
+        portENTER_CRITICAL(&backlog->lock);
+        backlog->dropped++;
+        portEXIT_CRITICAL(&backlog->lock);
+    }
+
+    ESP_LOGE(TAG, "Event loop and backlog full, dropping event %d", (int)event);
+    if (item->has_data) {
+        event_data_free(event, &item->data);
+    }
+    return ESP_ERR_TIMEOUT;
+}
+
+/* Hold the update back if the stream delivered one less than a window ago. Returns true if held. */
+static bool event_stream_hold(esp_agent_event_backlog_t *backlog, int stream, const esp_agent_deferred_event_t *item)
+{
+    esp_agent_event_stream_state_t *state = &backlog->streams[stream];
+    esp_agent_deferred_event_t superseded = { .event = -1 };
+    int64_t now = esp_timer_get_time();
+    bool held = false;
+
+    portENTER_CRITICAL(&backlog->lock);
+    state->received++;
+    /* A held update is superseded either way: by this one, now or at the end of the window */
+    memcpy(&superseded, &state->pending, sizeof(esp_agent_deferred_event_t));
+    state->pending.event = -1;
+    if (state->delivered_us != 0 && now - state->delivered_us < EVENT_STREAM_WINDOW_US) {
+        memcpy(&state->pending, item, sizeof(esp_agent_deferred_event_t));
+        held = true;
+    } else {
+        state->delivered_us = now;
+        state->delivered++;
+    }
+    portEXIT_CRITICAL(&backlog->lock);
+
+    if (superseded.event >= 0 && superseded.has_data) {
+        event_data_free(superseded.event, &superseded.data);
+    }
+    return held;
+}
+
+/* Drop the held update of the stream: the final text it led to is more recent */
+static void event_stream_discard(esp_agent_event_backlog_t *backlog, int stream)
+{
+    esp_agent_event_stream_state_t *state = &backlog->streams[stream];
+    esp_agent_deferred_event_t stale = { .event = -1 };
+
+    portENTER_CRITICAL(&backlog->lock);
+    if (state->pending.event >= 0) {
+        memcpy(&stale, &state->pending, sizeof(esp_agent_deferred_event_t));
+        state->pending.event = -1;
+        state->discarded++;
+    }
+    portEXIT_CRITICAL(&backlog->lock);
+
+    if (stale.event >= 0 && stale.has_data) {
+        event_data_free(stale.event, &stale.data);
+    }
+}
+
+/* Deliver the held updates whose window is over. Returns true if some are still held. */
+static bool event_streams_release(esp_agent_t *agent)
+{
+    esp_agent_event_backlog_t *backlog = &agent->event_backlog;
+    bool held = false;
+
+    for (int i = 0; i < ESP_AGENT_EVENT_STREAM_MAX; i++) {
+        esp_agent_event_stream_state_t *state = &backlog->streams[i];
+        esp_agent_deferred_event_t item = { .event = -1 };
+        int64_t now = esp_timer_get_time();
+
+        portENTER_CRITICAL(&backlog->lock);
+        if (state->pending.event >= 0) {
+            if (now - state->delivered_us >= EVENT_STREAM_WINDOW_US) {
+                memcpy(&item, &state->pending, sizeof(esp_agent_deferred_event_t));
+                state->pending.event = -1;
+                state->delivered_us = now;
+                state->delivered++;
+            } else {
+                held = true;
+            }
+        }
+        portEXIT_CRITICAL(&backlog->lock);
+
+        if (item.event >= 0 && !event_drop_stale(agent, &item)) {
+            event_post_item(agent, &item);
+        }
+    }
+    return held;
+}
+
 esp_err_t esp_agent_post_event(esp_agent_handle_t handle, esp_agent_event_t event, esp_agent_message_data_t *data)
 {
     if (handle == NULL) {
@@ -58,12 +427,123 @@ esp_err_t esp_agent_post_event(esp_agent_handle_t handle, esp_agent_event_t even
     }
 
     esp_agent_t *agent = (esp_agent_t *)handle;
-    esp_err_t err = esp_event_post_to(agent->event_loop, AGENT_EVENT, event, data, sizeof(esp_agent_message_data_t), pdMS_TO_TICKS(1000));
+    esp_agent_deferred_event_t item = {
+        .event = event,
+        .has_data = data != NULL,
+    };
+    portENTER_CRITICAL(&agent->event_backlog.lock);
+    item.session = agent->event_backlog.session;
+    portEXIT_CRITICAL(&agent->event_backlog.lock);
+    if (data) {
+        memcpy(&item.data, data, sizeof(esp_agent_message_data_t));
+    }
 
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to post event: %x", err);
-        return err;
+    if (EVENT_STREAM_WINDOW_US > 0) {
+        int stream = event_stream(&item);
+        if (stream >= 0 && event_stream_hold(&agent->event_backlog, stream, &item)) {
+            return ESP_OK;
+        }
+        if (stream < 0) {
+            /* Final text: the held update of the same role is older, and would overwrite it later */
+            int superseded = event_stream_superseded(&item);
+            if (superseded >= 0) {
+                event_stream_discard(&agent->event_backlog, superseded);
+            }
+        }
+    }
+
+    return event_post_item(agent, &item);
+}
+
+void esp_agent_events_backlog_clear(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+
+    /* Only the message task takes events out of the backlog, so they are dropped there, in esp_agent_events_backlog_flush() */
+    portENTER_CRITICAL(&agent->event_backlog.lock);
+    agent->event_backlog.session++;
+    portEXIT_CRITICAL(&agent->event_backlog.lock);
+}
+
+bool esp_agent_events_backlog_flush(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_event_backlog_t *backlog = &agent->event_backlog;
+    esp_agent_deferred_event_t item;
+    bool pending = false;
+
+    while (xQueuePeek(backlog->queue, &item, 0) == pdTRUE) {
+        if (!event_drop_stale(agent, &item) && event_post_now(agent, &item) != ESP_OK) {
+            return true;
+        }
+        xQueueReceive(backlog->queue, &item, 0);
+    }
+
+    if (EVENT_STREAM_WINDOW_US > 0) {
+        pending |= event_streams_release(agent);
+    }
+
+    for (int i = 0; i < ESP_AGENT_EVENT_LATEST_SLOTS; i++) {
+        portENTER_CRITICAL(&backlog->lock);
+        memcpy(&item, &backlog->latest[i], sizeof(esp_agent_deferred_event_t));
+        backlog->latest[i].event = -1;
+        portEXIT_CRITICAL(&backlog->lock);
+
+        if (item.event < 0 || event_drop_stale(agent, &item)) {
+            continue;
+        }
+        if (event_post_now(agent, &item) != ESP_OK) {
+            /* Put it back, unless a newer one arrived in the meantime */
+            bool restored = false;
+            bool newer = false;
+            portENTER_CRITICAL(&backlog->lock);
+            for (int j = 0; j < ESP_AGENT_EVENT_LATEST_SLOTS; j++) {
+                newer |= backlog->latest[j].event == item.event;
+            }
+            for (int j = 0; j < ESP_AGENT_EVENT_LATEST_SLOTS && !newer && !restored; j++) {
+                if (backlog->latest[j].event < 0) {
+                    memcpy(&backlog->latest[j], &item, sizeof(esp_agent_deferred_event_t));
+                    restored = true;
+                }
+            }
+            if (!restored) {
+                backlog->replaced++;
+            }
+            portEXIT_CRITICAL(&backlog->lock);
+
+            if (!restored && item.has_data) {
+                event_data_free(item.event, &item.data);
+            }
+            pending = true;
+        }
+    }
+
+    return pending;
+}
+
+esp_err_t esp_agent_get_event_stats(esp_agent_handle_t handle, esp_agent_event_stats_t *stats)
+{
+    if (handle == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
     }
+
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_event_backlog_t *backlog = &agent->event_backlog;
+
+    portENTER_CRITICAL(&backlog->lock);
+    stats->deferred = backlog->deferred;
+    stats->replaced = backlog->replaced;
+    stats->dropped = backlog->dropped;
+    stats->cleared = backlog->cleared;
+    stats->max_backlog = backlog->max_backlog;
+    for (int i = 0; i < ESP_AGENT_EVENT_STREAM_MAX; i++) {
+        stats->streams[i].received = backlog->streams[i].received;
+        stats->streams[i].delivered = backlog->streams[i].delivered;
+        stats->streams[i].discarded = backlog->streams[i].discarded;
+    }
+    portEXIT_CRITICAL(&backlog->lock);
+    stats->backlog = backlog->queue ? uxQueueMessagesWaiting(backlog->queue) : 0;
+
     return ESP_OK;
 }
 
@@ -86,7 +566,7 @@ esp_err_t esp_agent_register_event_handler(esp_agent_handle_t handle, esp_agent_
         esp_agent_unregister_event_handler(handle, agent->internal_event_handler, ESP_EVENT_ANY_ID);
     }
     esp_err_t err = ESP_OK;
-    err = esp_event_handler_instance_register_with(agent->event_loop, AGENT_EVENT, ESP_EVENT_ANY_ID, esp_agent_internal_event_handler, NULL, &agent->internal_event_handler);
+    err = esp_event_handler_instance_register_with(agent->event_loop, AGENT_EVENT, ESP_EVENT_ANY_ID, esp_agent_internal_event_handler, agent, &agent->internal_event_handler);
     if (err != ESP_OK) {
         ESP_LOGW(TAG, "Failed to (re) register the internal event handler");
     }
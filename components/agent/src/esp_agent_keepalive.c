@@ -0,0 +1,232 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <esp_log.h>
+#include <esp_event.h>
+#include <esp_timer.h>
+#include <esp_websocket_client.h>
+
+#include <esp_agent.h>
+#include <esp_agent_internal.h>
+#include <esp_agent_internal_keepalive.h>
+#include <esp_agent_internal_events.h>
+#include <esp_agent_websocket.h>
+
+static const char *TAG = "esp_agent_keepalive";
+
+static void keepalive_post_event(esp_agent_t *agent, esp_agent_message_data_t *data)
+{
+    /* If the event loop is full, only the latest link health is kept */
+    esp_err_t err = esp_agent_post_event(agent, ESP_AGENT_EVENT_LINK_HEALTH, data);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to post link health event: %x", err);
+    }
+}
+
+#if CONFIG_ESP_AGENT_KEEPALIVE_INTERVAL_MS
+static void keepalive_timer_cb(void *arg)
+{
+    esp_agent_t *agent = (esp_agent_t *)arg;
+    esp_agent_keepalive_t *keepalive = &agent->keepalive;
+    esp_agent_message_data_t data = {0};
+    bool missed = false;
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&keepalive->lock);
+
+    if (keepalive->ping_sent_us) {
+        missed = true;
+        keepalive->missed++;
+        keepalive->missed_total++;
+        data.link_health.rtt_ms = -1;
+        data.link_health.missed_pongs = keepalive->missed;
+        data.link_health.silent_ms = (uint32_t)((now - keepalive->last_pong_us) / 1000);
+        data.link_health.dead = keepalive->missed >= CONFIG_ESP_AGENT_KEEPALIVE_MAX_MISSED;
+        if (keepalive->missed == CONFIG_ESP_AGENT_KEEPALIVE_MAX_MISSED) {
+            keepalive->dead_links++;
+        }
+    }
+
+    /* A ping which cannot even be queued will not be answered either, so it counts as sent */
+    uint32_t seq = 0;
+    if (!data.link_health.dead) {
+        seq = ++keepalive->seq;
+        keepalive->ping_sent_us = now;
+        keepalive->pings_sent++;
+    }
+
+    portEXIT_CRITICAL(&keepalive->lock);
+
+    if (missed) {
+        if (data.link_health.dead) {
+            ESP_LOGW(TAG, "No pong for %lu ms, link is dead", (unsigned long)data.link_health.silent_ms);
+        }
+        keepalive_post_event(agent, &data);
+    }
+
+    if (!data.link_health.dead) {
+        esp_agent_websocket_queue_message(agent, WS_SEND_MSG_TYPE_PING, (const char *)&seq, sizeof(seq), 0);
+    }
+}
+#endif
+
+esp_err_t esp_agent_keepalive_init(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+
+    memset(&agent->keepalive, 0, sizeof(esp_agent_keepalive_t));
+    portMUX_INITIALIZE(&agent->keepalive.lock);
+
+#if CONFIG_ESP_AGENT_KEEPALIVE_INTERVAL_MS
+    esp_timer_create_args_t timer_args = {
+        .callback = keepalive_timer_cb,
+        .arg = agent,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "agent_keepalive",
+        .skip_unhandled_events = true,
+    };
+    return esp_timer_create(&timer_args, &agent->keepalive.timer);
+#else
+    return ESP_OK;
+#endif
+}
+
+void esp_agent_keepalive_deinit(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+
+    if (agent->keepalive.timer) {
+        esp_timer_stop(agent->keepalive.timer);
+        esp_timer_delete(agent->keepalive.timer);
+        agent->keepalive.timer = NULL;
+    }
+}
+
+void esp_agent_keepalive_start(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_keepalive_t *keepalive = &agent->keepalive;
+
+    if (keepalive->timer == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&keepalive->lock);
+    keepalive->ping_sent_us = 0;
+    keepalive->last_pong_us = esp_timer_get_time();
+    keepalive->missed = 0;
+    portEXIT_CRITICAL(&keepalive->lock);
+
+#if CONFIG_ESP_AGENT_KEEPALIVE_INTERVAL_MS
+    esp_timer_stop(keepalive->timer);
+    esp_timer_start_periodic(keepalive->timer, CONFIG_ESP_AGENT_KEEPALIVE_INTERVAL_MS * 1000ULL);
+#endif
+}
+
+void esp_agent_keepalive_stop(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+
+    if (agent->keepalive.timer) {
+        esp_timer_stop(agent->keepalive.timer);
+    }
+}
+
+void esp_agent_keepalive_pong_received(esp_agent_handle_t handle, const uint8_t *data, size_t len)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_keepalive_t *keepalive = &agent->keepalive;
+    esp_agent_message_data_t event_data = {0};
+    uint32_t seq;
+
+    /* Pongs to the pings of the websocket client itself have no payload */
+    if (data == NULL || len != sizeof(seq)) {
+        return;
+    }
+    memcpy(&seq, data, sizeof(seq));
+
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&keepalive->lock);
+
+    /* A late pong to an earlier ping does not prove that the link is alive now */
+    if (keepalive->ping_sent_us == 0 || seq != keepalive->seq) {
+        portEXIT_CRITICAL(&keepalive->lock);
+        return;
+    }
+
+    uint32_t rtt_ms = (uint32_t)((now - keepalive->ping_sent_us) / 1000);
+    esp_agent_stats_window_add(&keepalive->rtt_ms, rtt_ms);
+    keepalive->ping_sent_us = 0;
+    keepalive->last_pong_us = now;
+    keepalive->missed = 0;
+    keepalive->pongs_received++;
+
+    portEXIT_CRITICAL(&keepalive->lock);
+
+    ESP_LOGV(TAG, "Pong %lu, rtt %lu ms", (unsigned long)seq, (unsigned long)rtt_ms);
+    event_data.link_health.rtt_ms = (int32_t)rtt_ms;
+    keepalive_post_event(agent, &event_data);
+}
+
+void esp_agent_keepalive_link_down(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+
+    esp_agent_keepalive_stop(handle);
+
+    /* The application does not stop or start the agent until it reconnected */
+    esp_agent_start_stop_lock(agent);
+
+    /* Stopped by the application meanwhile */
+    if (!esp_agent_is_started(agent) || agent->ws_client == NULL) {
+        esp_agent_start_stop_unlock(agent);
+        return;
+    }
+
+    /* No close handshake, the peer is not answering anyway. The websocket task emits
+     * WEBSOCKET_EVENT_FINISH when it stops, which runs the usual disconnect path.
+     */
+    if (esp_websocket_client_stop(agent->ws_client) != ESP_OK) {
+        ESP_LOGD(TAG, "Websocket client already stopped");
+    }
+
+    /* The link was lost rather than closed, so the conversation is resumed on a new connection */
+    ESP_LOGI(TAG, "Reconnecting after a dead link");
+    esp_err_t err = esp_agent_start(handle, NULL);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to reconnect: %x", err);
+    }
+    esp_agent_start_stop_unlock(agent);
+}
+
+esp_err_t esp_agent_get_link_health(esp_agent_handle_t handle, esp_agent_link_health_t *health)
+{
+    if (handle == NULL || health == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_stats_window_t window;
+
+    portENTER_CRITICAL(&agent->keepalive.lock);
+    health->pings_sent = agent->keepalive.pings_sent;
+    health->pongs_received = agent->keepalive.pongs_received;
+    health->missed_pongs = agent->keepalive.missed_total;
+    health->dead_links = agent->keepalive.dead_links;
+    window = agent->keepalive.rtt_ms;
+    portEXIT_CRITICAL(&agent->keepalive.lock);
+
+    health->rtt.samples = window.count;
+    health->rtt.p50_ms = esp_agent_stats_window_percentile(&window, 50);
+    health->rtt.p90_ms = esp_agent_stats_window_percentile(&window, 90);
+    health->rtt.p99_ms = esp_agent_stats_window_percentile(&window, 99);
+    health->rtt.max_ms = esp_agent_stats_window_percentile(&window, 100);
+
+    return ESP_OK;
+}
@@ -0,0 +1,224 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+#include <esp_idf_version.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#if !CONFIG_IDF_TARGET_LINUX
+#include <esp_heap_caps.h>
+#include <esp_memory_utils.h>
+#endif
+
+#include <esp_agent.h>
+#include <esp_agent_internal.h>
+#include <esp_agent_internal_mem.h>
+
+static const char *TAG = "esp_agent_mem";
+
+#if CONFIG_IDF_TARGET_LINUX
+/* A single heap on the host, the placement options have no effect */
+#define MEM_PLACEMENT_CAPS(placement) 0
+#else
+/* Values of the CONFIG_ESP_AGENT_MEM_*_PLACEMENT options */
+#define MEM_PLACEMENT_CAPS(placement) \
+    ((placement) == 1 ? (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT) : \
+     (placement) == 2 ? (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT) : \
+     (placement) == 3 ? (MALLOC_CAP_DMA | MALLOC_CAP_8BIT) : 0)
+#endif
+
+static const uint32_t g_buffer_caps[ESP_AGENT_MEM_MAX] = {
+    [ESP_AGENT_MEM_TX_TEXT] = MEM_PLACEMENT_CAPS(CONFIG_ESP_AGENT_MEM_TX_TEXT_PLACEMENT),
+    [ESP_AGENT_MEM_TX_AUDIO] = MEM_PLACEMENT_CAPS(CONFIG_ESP_AGENT_MEM_TX_AUDIO_PLACEMENT),
+    [ESP_AGENT_MEM_RX_TEXT] = MEM_PLACEMENT_CAPS(CONFIG_ESP_AGENT_MEM_RX_TEXT_PLACEMENT),
+    [ESP_AGENT_MEM_RX_AUDIO] = MEM_PLACEMENT_CAPS(CONFIG_ESP_AGENT_MEM_RX_AUDIO_PLACEMENT),
+};
+
+/* xQueueCreateWithCaps() came with ESP-IDF v5.1, the queues come from the default heap before */
+#if !CONFIG_IDF_TARGET_LINUX && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+#define MEM_QUEUE_WITH_CAPS 1
+#else
+#define MEM_QUEUE_WITH_CAPS 0
+#endif
+
+#if !MEM_QUEUE_WITH_CAPS
+#define MEM_QUEUE_CAPS 0
+#elif CONFIG_ESP_AGENT_MEM_QUEUES_SPIRAM
+#define MEM_QUEUE_CAPS (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#else
+#define MEM_QUEUE_CAPS (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#endif
+
+void esp_agent_mem_init(esp_agent_mem_t *mem)
+{
+    memset(mem, 0, sizeof(esp_agent_mem_t));
+    portMUX_INITIALIZE(&mem->lock);
+    for (int i = 0; i < ESP_AGENT_MEM_MAX; i++) {
+        mem->buffers[i].caps = g_buffer_caps[i];
+    }
+}
+
+/* One copy in so many is timed, timing them all would cost as much as the small copies themselves */
+#define MEM_COPY_SAMPLE_INTERVAL 16
+
+static void *mem_alloc(esp_agent_mem_buffer_t buffer, void *ptr, size_t size, bool *internal, bool *fallback)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    void *new_ptr = realloc(ptr, size);
+    *internal = new_ptr != NULL;
+    *fallback = false;
+#else
+    uint32_t caps = g_buffer_caps[buffer];
+    void *new_ptr = caps ? heap_caps_realloc(ptr, size, caps) : realloc(ptr, size);
+    *fallback = false;
+    if (new_ptr == NULL && caps) {
+        new_ptr = realloc(ptr, size);
+        *fallback = new_ptr != NULL;
+    }
+    *internal = new_ptr && esp_ptr_internal(new_ptr);
+#endif
+    if (*fallback) {
+        ESP_LOGD(TAG, "%u bytes for buffer %d from the default heap", (unsigned)size, buffer);
+    }
+    return new_ptr;
+}
+
+/* Must be called in the critical section. Returns whether this copy is one of those timed. */
+static bool mem_count_copy_locked(esp_agent_mem_buffer_stats_t *stats, size_t len)
+{
+    stats->copies++;
+    stats->copy_bytes += len;
+    return stats->copies % MEM_COPY_SAMPLE_INTERVAL == 1;
+}
+
+/* An allocation, and the copy into it if copy_len is not 0, in a single critical section */
+static bool mem_count(esp_agent_t *agent, esp_agent_mem_buffer_t buffer, const void *new_ptr, size_t size, bool internal, bool fallback,
+                      size_t copy_len)
+{
+    esp_agent_mem_buffer_stats_t *stats = &agent->mem.buffers[buffer];
+    bool timed = false;
+
+    portENTER_CRITICAL(&agent->mem.lock);
+    if (new_ptr) {
+        stats->allocations++;
+        stats->bytes += size;
+        if (internal) {
+            stats->internal_allocations++;
+            stats->internal_bytes += size;
+        }
+        if (fallback) {
+            stats->fallbacks++;
+        }
+        if (copy_len) {
+            timed = mem_count_copy_locked(stats, copy_len);
+        }
+    } else {
+        stats->failures++;
+    }
+    portEXIT_CRITICAL(&agent->mem.lock);
+    return timed;
+}
+
+void *esp_agent_mem_realloc(esp_agent_handle_t handle, esp_agent_mem_buffer_t buffer, void *ptr, size_t size)
+{
+    bool internal, fallback;
+    void *new_ptr = mem_alloc(buffer, ptr, size, &internal, &fallback);
+    mem_count((esp_agent_t *)handle, buffer, new_ptr, size, internal, fallback, 0);
+    return new_ptr;
+}
+
+void *esp_agent_mem_dup(esp_agent_handle_t handle, esp_agent_mem_buffer_t buffer, const void *data, size_t len)
+{
+    bool internal, fallback;
+    void *copy = mem_alloc(buffer, NULL, len, &internal, &fallback);
+    bool timed = mem_count((esp_agent_t *)handle, buffer, copy, len, internal, fallback, len);
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    if (!timed) {
+        memcpy(copy, data, len);
+        return copy;
+    }
+    int64_t start_us = esp_timer_get_time();
+    memcpy(copy, data, len);
+    esp_agent_mem_time_copy(handle, buffer, len, esp_timer_get_time() - start_us);
+    return copy;
+}
+
+bool esp_agent_mem_count_copy(esp_agent_handle_t handle, esp_agent_mem_buffer_t buffer, size_t len)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+
+    portENTER_CRITICAL(&agent->mem.lock);
+    bool timed = mem_count_copy_locked(&agent->mem.buffers[buffer], len);
+    portEXIT_CRITICAL(&agent->mem.lock);
+    return timed;
+}
+
+void esp_agent_mem_time_copy(esp_agent_handle_t handle, esp_agent_mem_buffer_t buffer, size_t len, int64_t copy_us)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_mem_buffer_stats_t *stats = &agent->mem.buffers[buffer];
+
+    portENTER_CRITICAL(&agent->mem.lock);
+    stats->timed_copy_bytes += len;
+    stats->copy_us += copy_us;
+    portEXIT_CRITICAL(&agent->mem.lock);
+}
+
+QueueHandle_t esp_agent_mem_queue_create(UBaseType_t length, UBaseType_t item_size)
+{
+#if MEM_QUEUE_WITH_CAPS
+    return xQueueCreateWithCaps(length, item_size, MEM_QUEUE_CAPS);
+#else
+    return xQueueCreate(length, item_size);
+#endif
+}
+
+void esp_agent_mem_queue_delete(QueueHandle_t queue)
+{
+#if MEM_QUEUE_WITH_CAPS
+    vQueueDeleteWithCaps(queue);
+#else
+    vQueueDelete(queue);
+#endif
+}
+
+esp_err_t esp_agent_get_mem_stats(esp_agent_handle_t handle, esp_agent_mem_stats_t *stats)
+{
+    if (handle == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_agent_t *agent = (esp_agent_t *)handle;
+
+    portENTER_CRITICAL(&agent->mem.lock);
+    memcpy(stats->buffers, agent->mem.buffers, sizeof(stats->buffers));
+    portEXIT_CRITICAL(&agent->mem.lock);
+
+#if MEM_QUEUE_WITH_CAPS && CONFIG_ESP_AGENT_MEM_QUEUES_SPIRAM
+    stats->queues_external = true;
+#else
+    stats->queues_external = false;
+#endif
+#if CONFIG_IDF_TARGET_LINUX
+    /* Not bounded on the host */
+    stats->internal_free = 0;
+    stats->internal_min_free = 0;
+    stats->external_free = 0;
+#else
+    stats->internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    stats->internal_min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    stats->external_free = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+#endif
+    return ESP_OK;
+}
@@ -11,6 +11,10 @@
 #include <esp_agent_internal_messages.h>
 #include <esp_agent_internal_events.h>
 #include <esp_agent_internal_tools.h>
+#include <esp_agent_internal_compression.h>
+#include <esp_agent_internal_connection.h>
+#include <esp_agent_internal_resume.h>
+#include <esp_agent_internal_tool_stats.h>
 
 static const char *TAG = "esp_agent_message_handlers";
 
@@ -18,6 +22,53 @@ esp_err_t esp_agent_message_handshake_ack_handler(esp_agent_handle_t handle, cJS
 esp_err_t esp_agent_message_dummy_handler(esp_agent_handle_t handle, cJSON *content, cJSON *metadata);
 esp_err_t esp_agent_message_transcript_handler(esp_agent_handle_t handle, cJSON *content, cJSON *metadata);
 esp_err_t esp_agent_message_error_handler(esp_agent_handle_t handle, cJSON *content, cJSON *metadata);
+esp_err_t esp_agent_message_usage_info_handler(esp_agent_handle_t handle, cJSON *content, cJSON *metadata);
+esp_err_t esp_agent_message_tool_call_info_handler(esp_agent_handle_t handle, cJSON *content, cJSON *metadata);
+esp_err_t esp_agent_message_tool_result_info_handler(esp_agent_handle_t handle, cJSON *content, cJSON *metadata);
+
+/* The content of the info messages is either an object or a JSON string. NULL if neither;
+ * `parsed` is to be deleted by the caller in any case.
+ */
+static cJSON *info_content_object(cJSON *content, cJSON **parsed)
+{
+    *parsed = NULL;
+    if (cJSON_IsString(content)) {
+        *parsed = cJSON_Parse(cJSON_GetStringValue(content));
+        content = *parsed;
+    }
+    return cJSON_IsObject(content) ? content : NULL;
+}
+
+static esp_err_t tool_info_process(esp_agent_handle_t handle, cJSON *content, bool result)
+{
+    if (handle == NULL || content == NULL) {
+        ESP_LOGE(TAG, "Invalid handle or content for processing tool %s info", result ? "result" : "call");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    cJSON *parsed;
+    cJSON *info = info_content_object(content, &parsed);
+    if (info == NULL) {
+        ESP_LOGW(TAG, "Unexpected tool %s info format", result ? "result" : "call");
+        cJSON_Delete(parsed);
+        return ESP_OK;
+    }
+
+    esp_err_t err = esp_agent_tool_stats_info(handle, info, result);
+    cJSON_Delete(parsed);
+    return err;
+}
+
+esp_err_t esp_agent_message_tool_call_info_handler(esp_agent_handle_t handle, cJSON *content, cJSON *metadata)
+{
+    return tool_info_process(handle, content, false);
+}
+
+esp_err_t esp_agent_message_tool_result_info_handler(esp_agent_handle_t handle, cJSON *content, cJSON *metadata)
+{
+    return tool_info_process(handle, content, true);
+}
+
 esp_err_t esp_agent_message_audio_stream_start_handler(esp_agent_handle_t handle, cJSON *content, cJSON *metadata);
 esp_err_t esp_agent_message_audio_stream_end_handler(esp_agent_handle_t handle, cJSON *content, cJSON *metadata);
 esp_err_t esp_agent_message_tool_request_handler(esp_agent_handle_t handle, cJSON *content, cJSON *metadata);
@@ -31,12 +82,14 @@ const esp_agent_message_handler_info_t esp_agent_message_handlers[] = {
     {.type = ESP_AGENT_MESSAGE_TYPE_ERROR, .handler = esp_agent_message_error_handler},
     {.type = ESP_AGENT_MESSAGE_TYPE_AUDIO_STREAM_START, .handler = esp_agent_message_audio_stream_start_handler},
     {.type = ESP_AGENT_MESSAGE_TYPE_AUDIO_STREAM_END, .handler = esp_agent_message_audio_stream_end_handler},
-    {.type = ESP_AGENT_MESSAGE_TYPE_USAGE_INFO, .handler = esp_agent_message_dummy_handler},
-    {.type = ESP_AGENT_MESSAGE_TYPE_TOOL_CALL_INFO, .handler = esp_agent_message_dummy_handler},
+    {.type = ESP_AGENT_MESSAGE_TYPE_USAGE_INFO, .handler = esp_agent_message_usage_info_handler},
+    {.type = ESP_AGENT_MESSAGE_TYPE_TOOL_CALL_INFO, .handler = esp_agent_message_tool_call_info_handler},
     {.type = ESP_AGENT_MESSAGE_TYPE_TOOL_REQUEST, .handler = esp_agent_message_tool_request_handler},
-    {.type = ESP_AGENT_MESSAGE_TYPE_TOOL_RESULT_INFO, .handler = esp_agent_message_dummy_handler},
+    {.type = ESP_AGENT_MESSAGE_TYPE_TOOL_RESULT_INFO, .handler = esp_agent_message_tool_result_info_handler},
     {.type = ESP_AGENT_MESSAGE_TYPE_TRANSACTION_END, .handler = esp_agent_message_dummy_handler},
-    {.type = ESP_AGENT_MESSAGE_TYPE_BARGE_IN, .handler = esp_agent_message_dummy_handler}
+    {.type = ESP_AGENT_MESSAGE_TYPE_BARGE_IN, .handler = esp_agent_message_dummy_handler},
+    /* Acknowledgements are processed for all messages before dispatch */
+    {.type = ESP_AGENT_MESSAGE_TYPE_ACK, .handler = esp_agent_message_dummy_handler}
 };
 const size_t esp_agent_message_handlers_count = sizeof(esp_agent_message_handlers) / sizeof(esp_agent_message_handler_info_t);
 
@@ -50,6 +103,10 @@ esp_err_t esp_agent_message_handshake_ack_handler(esp_agent_handle_t handle, cJS
 
     esp_agent_t *agent = (esp_agent_t *)handle;
     agent->handshake_state = ESP_AGENT_HANDSHAKE_DONE;
+    esp_agent_connection_ready(handle);
+    esp_agent_compression_handshake_ack(handle, content);
+    esp_agent_aggregation_handshake_ack(handle, content);
+    esp_agent_resume_handshake_ack(handle, content);
 
     cJSON *conversation_id = cJSON_GetObjectItemCaseSensitive(content, "conversationId");
     char *conv_id = cJSON_GetStringValue(conversation_id);
@@ -80,7 +137,6 @@ esp_err_t esp_agent_message_handshake_ack_handler(esp_agent_handle_t handle, cJS
     esp_err_t err = esp_agent_post_event(handle, ESP_AGENT_EVENT_START, &event_data);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to post start event");
-        free((char *)event_data.start.conversation_id);
     }
 
     return err;
@@ -124,21 +180,21 @@ esp_err_t esp_agent_message_transcript_handler(esp_agent_handle_t handle, cJSON
         event_data.text.role = ESP_AGENT_MESSAGE_ROLE_USER;
     } else if (strcmp(role_str, "assistant") == 0) {
         event_data.text.role = ESP_AGENT_MESSAGE_ROLE_ASSISTANT;
+    }
 
-        if (!generation_stage_str) {
-            event_data.text.generation_stage = ESP_AGENT_MESSAGE_GENERATION_STAGE_UNKNOWN;
-        } else if (strcmp(generation_stage_str, "speculative") == 0) {
-            event_data.text.generation_stage = ESP_AGENT_MESSAGE_GENERATION_STAGE_SPECULATIVE;
-        } else if (strcmp(generation_stage_str, "final") == 0) {
-            event_data.text.generation_stage = ESP_AGENT_MESSAGE_GENERATION_STAGE_FINAL;
-        }
+    /* User transcripts have a stage too when the server sends interim ones */
+    if (!generation_stage_str) {
+        event_data.text.generation_stage = ESP_AGENT_MESSAGE_GENERATION_STAGE_UNKNOWN;
+    } else if (strcmp(generation_stage_str, "speculative") == 0 || strcmp(generation_stage_str, "interim") == 0) {
+        event_data.text.generation_stage = ESP_AGENT_MESSAGE_GENERATION_STAGE_SPECULATIVE;
+    } else if (strcmp(generation_stage_str, "final") == 0) {
+        event_data.text.generation_stage = ESP_AGENT_MESSAGE_GENERATION_STAGE_FINAL;
     }
 
 
     esp_err_t err = esp_agent_post_event(handle, ESP_AGENT_EVENT_DATA_TYPE_TEXT, &event_data);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to post text event: 0x%x", err);
-        free((char *)event_data.text.text);
     }
     return err;
 }
@@ -165,7 +221,6 @@ esp_err_t esp_agent_message_thinking_handler(esp_agent_handle_t handle, cJSON *c
     esp_err_t err = esp_agent_post_event(handle, ESP_AGENT_EVENT_DATA_TYPE_THINKING, &event_data);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to post thinking event: 0x%x", err);
-        free((char *)event_data.thinking.thought);
         return err;
     }
     return err;
@@ -205,6 +260,47 @@ esp_err_t esp_agent_message_error_handler(esp_agent_handle_t handle, cJSON *cont
     return ESP_OK;
 }
 
+/* Usage fields are accepted in camelCase (as in the handshake) and in snake_case */
+static cJSON *usage_info_field(cJSON *usage, const char *camel_case, const char *snake_case)
+{
+    cJSON *field = cJSON_GetObjectItemCaseSensitive(usage, camel_case);
+    if (!cJSON_IsNumber(field)) {
+        field = cJSON_GetObjectItemCaseSensitive(usage, snake_case);
+    }
+    return cJSON_IsNumber(field) && field->valuedouble >= 0 ? field : NULL;
+}
+
+esp_err_t esp_agent_message_usage_info_handler(esp_agent_handle_t handle, cJSON *content, cJSON *metadata)
+{
+    if (handle == NULL || content == NULL) {
+        ESP_LOGE(TAG, "Invalid handle or content for processing usage info");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    cJSON *parsed;
+    cJSON *usage = info_content_object(content, &parsed);
+    if (usage == NULL) {
+        ESP_LOGW(TAG, "Unexpected usage info format");
+        cJSON_Delete(parsed);
+        return ESP_OK;
+    }
+
+    cJSON *input_tokens = usage_info_field(usage, "inputTokens", "input_tokens");
+    cJSON *output_tokens = usage_info_field(usage, "outputTokens", "output_tokens");
+    cJSON *server_ms = usage_info_field(usage, "serverLatencyMs", "server_latency_ms");
+
+    esp_agent_usage_report_t report = {
+        .input_tokens = input_tokens ? (uint32_t)input_tokens->valuedouble : 0,
+        .output_tokens = output_tokens ? (uint32_t)output_tokens->valuedouble : 0,
+        .server_ms = server_ms ? (int32_t)server_ms->valuedouble : -1,
+    };
+    cJSON_Delete(parsed);
+
+    ESP_LOGD(TAG, "Usage: %lu input tokens, %lu output tokens, server %ld ms", (unsigned long)report.input_tokens,
+             (unsigned long)report.output_tokens, (long)report.server_ms);
+    return esp_agent_usage_record(handle, &report);
+}
+
 esp_err_t esp_agent_message_audio_stream_start_handler(esp_agent_handle_t handle, cJSON *content, cJSON *metadata)
 {
     if (handle == NULL) {
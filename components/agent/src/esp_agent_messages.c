@@ -14,19 +14,17 @@
 
 #include <esp_agent_internal_messages.h>
 #include <esp_agent_websocket.h>
+#include <esp_agent_internal_compression.h>
+#include <esp_agent_internal_resume.h>
 
 extern const esp_agent_message_handler_info_t esp_agent_message_handlers[];
 extern size_t esp_agent_message_handlers_count;
 
 static const char *TAG = "esp_agent_messages";
 
-esp_err_t esp_agent_messages_parse_process(esp_agent_handle_t handle, char *message)
+/* `wire_len` is the size of the message as received, which is smaller than `message` if it was compressed */
+static esp_err_t messages_parse_process(esp_agent_handle_t handle, char *message, size_t wire_len, bool decompressed)
 {
-    if (!handle || !message) {
-        ESP_LOGE(TAG, "Invalid handle or message");
-        return ESP_ERR_INVALID_ARG;
-    }
-
     cJSON *json = cJSON_Parse(message);
     if (json == NULL) {
         ESP_LOGE(TAG, "Failed to parse JSON: %s", message);
@@ -50,6 +48,33 @@ esp_err_t esp_agent_messages_parse_process(esp_agent_handle_t handle, char *mess
 
     ESP_LOGD(TAG, "Message type: %s", type_str);
 
+    if (strcmp(type_str, ESP_AGENT_MESSAGE_TYPE_COMPRESSED) == 0) {
+        /* Only one level of compression, so that a message cannot recurse without bound */
+        if (decompressed) {
+            ESP_LOGE(TAG, "Nested compressed message, dropped");
+            err = ESP_ERR_NOT_SUPPORTED;
+            goto end;
+        }
+        char *original = esp_agent_compression_decompress(handle, content, metadata);
+        cJSON_Delete(json);
+        if (original == NULL) {
+            return ESP_FAIL;
+        }
+        err = messages_parse_process(handle, original, wire_len, true);
+        free(original);
+        return err;
+    }
+
+    if (!esp_agent_resume_received(handle, json)) {
+        ESP_LOGD(TAG, "Ignoring %s message received before the reconnect", type_str);
+        goto end;
+    }
+
+    if (strcmp(type_str, ESP_AGENT_MESSAGE_TYPE_TOOL_REQUEST) == 0) {
+        esp_agent_t *agent = (esp_agent_t *)handle;
+        esp_agent_transport_stats_count_message(&agent->transport_stats, ESP_AGENT_TRANSPORT_COUNTER_RX_TOOL, wire_len);
+    }
+
     for (size_t i = 0; i < esp_agent_message_handlers_count; i++) {
         if (strcmp(type_str, esp_agent_message_handlers[i].type) == 0) {
             err = esp_agent_message_handlers[i].handler(handle, content, metadata);
@@ -70,6 +95,16 @@ end:
     return err;
 }
 
+esp_err_t esp_agent_messages_parse_process(esp_agent_handle_t handle, char *message)
+{
+    if (!handle || !message) {
+        ESP_LOGE(TAG, "Invalid handle or message");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    return messages_parse_process(handle, message, strlen(message), false);
+}
+
 static inline const char *esp_agent_messages_get_audio_format_string(esp_agent_conversation_audio_format_t format)
 {
     if (format == ESP_AGENT_CONVERSATION_AUDIO_FORMAT_OPUS) {
@@ -112,6 +147,7 @@ static cJSON *esp_agent_messages_get_audio_configuration(esp_agent_handle_t hand
     cJSON_AddStringToObject(audio_input_config, "format", input_format_string);
     cJSON_AddNumberToObject(audio_input_config, "sampleRate", agent->upload_audio_config.sample_rate);
     cJSON_AddNumberToObject(audio_input_config, "frameDurationMs", agent->upload_audio_config.frame_duration);
+    esp_agent_aggregation_add_to_handshake(audio_input_config);
     cJSON_AddItemToObject(audio_configuration, "input", audio_input_config);
 
     cJSON_AddStringToObject(audio_output_config, "format", output_format_string);
@@ -166,6 +202,8 @@ char *esp_agent_messages_get_handshake(esp_agent_handle_t handle)
     }
 
     cJSON_AddStringToObject(content, "conversationType", agent->conversation_type == ESP_AGENT_CONVERSATION_SPEECH ? "audio" : "text");
+    esp_agent_compression_add_to_handshake(content);
+    esp_agent_resume_add_to_handshake(handle, content);
 
     if (agent->conversation_type == ESP_AGENT_CONVERSATION_SPEECH) {
         audio_configuration = esp_agent_messages_get_audio_configuration(handle);
@@ -259,7 +297,9 @@ char *esp_agent_messages_prepare_tool_response(esp_agent_handle_t handle, char *
     cJSON_AddItemToObject(content, "result", result);
     cJSON_AddItemToObject(tool_response_json, "content", content);
 
-    return cJSON_PrintUnformatted(tool_response_json);
+    char *tool_response_str = cJSON_PrintUnformatted(tool_response_json);
+    cJSON_Delete(tool_response_json);
+    return tool_response_str;
 
     /* To prevent unused variable warning */
     if (0) {
@@ -422,6 +462,8 @@ esp_err_t esp_agent_speech_conversation_end(esp_agent_handle_t handle)
     err = esp_agent_websocket_queue_message(agent, WS_SEND_MSG_TYPE_TEXT, speech_conversation_end_json_str, strlen(speech_conversation_end_json_str), pdMS_TO_TICKS(100));
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to queue speech conversation end: %d", err);
+    } else {
+        esp_agent_latency_mark(agent, ESP_AGENT_LATENCY_STAGE_AUDIO_STREAM_END);
     }
 
     /* Just to avoid compiler warning */
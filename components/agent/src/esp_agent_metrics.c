@@ -0,0 +1,450 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <esp_log.h>
+#include <esp_event.h>
+#include <esp_timer.h>
+
+#include <esp_agent.h>
+#include <esp_agent_internal.h>
+#include <esp_agent_internal_metrics.h>
+#include <esp_agent_internal_events.h>
+
+static const char *TAG = "esp_agent_metrics";
+
+void esp_agent_latency_tracker_init(esp_agent_latency_tracker_t *tracker)
+{
+    memset(tracker, 0, sizeof(esp_agent_latency_tracker_t));
+    portMUX_INITIALIZE(&tracker->lock);
+    tracker->state = ESP_AGENT_LATENCY_TURN_IDLE;
+}
+
+static inline bool latency_is_request_stage(esp_agent_latency_stage_t stage)
+{
+    return stage <= ESP_AGENT_LATENCY_STAGE_AUDIO_STREAM_END;
+}
+
+/* Must be called with the tracker lock held */
+static void latency_open_turn(esp_agent_latency_tracker_t *tracker, int64_t now)
+{
+    memset(tracker->timestamp_us, 0, sizeof(tracker->timestamp_us));
+    tracker->turn++;
+    tracker->turn_started_us = now;
+    tracker->state = ESP_AGENT_LATENCY_TURN_REQUEST;
+}
+
+/* Must be called with the tracker lock held */
+static void latency_complete_turn(esp_agent_latency_tracker_t *tracker, esp_agent_message_data_t *data)
+{
+    /* The turn starts at the end of user speech if known, otherwise at the earliest request stage */
+    int64_t start = tracker->timestamp_us[ESP_AGENT_LATENCY_STAGE_VAD_END];
+    if (start == 0) {
+        for (int i = 0; latency_is_request_stage(i); i++) {
+            if (tracker->timestamp_us[i] && (start == 0 || tracker->timestamp_us[i] < start)) {
+                start = tracker->timestamp_us[i];
+            }
+        }
+    }
+
+    data->latency.turn = tracker->turn;
+    for (int i = 0; i < ESP_AGENT_LATENCY_STAGE_MAX; i++) {
+        if (tracker->timestamp_us[i] == 0) {
+            data->latency.stage_ms[i] = -1;
+            continue;
+        }
+
+        int32_t offset_ms = (int32_t)((tracker->timestamp_us[i] - start) / 1000);
+        data->latency.stage_ms[i] = offset_ms;
+        if (offset_ms >= 0) {
+            esp_agent_stats_window_add(&tracker->stage_ms[i], offset_ms);
+        }
+    }
+
+    tracker->state = ESP_AGENT_LATENCY_TURN_IDLE;
+}
+
+esp_err_t esp_agent_latency_mark(esp_agent_handle_t handle, esp_agent_latency_stage_t stage)
+{
+    if (handle == NULL || stage >= ESP_AGENT_LATENCY_STAGE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_latency_tracker_t *tracker = &agent->latency;
+    esp_agent_message_data_t data = {0};
+    bool turn_complete = false;
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&tracker->lock);
+
+    if (tracker->state != ESP_AGENT_LATENCY_TURN_IDLE && now - tracker->turn_started_us > ESP_AGENT_LATENCY_TURN_TIMEOUT_US) {
+        tracker->state = ESP_AGENT_LATENCY_TURN_IDLE;
+    }
+
+    if (latency_is_request_stage(stage)) {
+        /* Uplink frames are also sent while the reply plays (and before the turn ends);
+         * they only count once the request is known to be in progress.
+         */
+        if (stage == ESP_AGENT_LATENCY_STAGE_UPLINK_LAST_FRAME) {
+            if (tracker->state == ESP_AGENT_LATENCY_TURN_REQUEST) {
+                tracker->timestamp_us[stage] = now;
+            }
+        } else {
+            if (tracker->state != ESP_AGENT_LATENCY_TURN_REQUEST) {
+                latency_open_turn(tracker, now);
+            }
+            tracker->timestamp_us[stage] = now;
+        }
+    } else if (stage > ESP_AGENT_LATENCY_STAGE_DOWNLINK_FIRST_FRAME &&
+               tracker->timestamp_us[ESP_AGENT_LATENCY_STAGE_DOWNLINK_FIRST_FRAME] == 0) {
+        /* Playback stages only count for the reply of the agent, not for local sounds played meanwhile */
+    } else if (tracker->state != ESP_AGENT_LATENCY_TURN_IDLE && tracker->timestamp_us[stage] == 0) {
+        tracker->timestamp_us[stage] = now;
+        tracker->state = ESP_AGENT_LATENCY_TURN_RESPONSE;
+
+        if (stage == ESP_AGENT_LATENCY_STAGE_FIRST_CODEC_WRITE) {
+            latency_complete_turn(tracker, &data);
+            turn_complete = true;
+        }
+    }
+
+    portEXIT_CRITICAL(&tracker->lock);
+
+    if (turn_complete) {
+        /* This is called from the audio path: the event is kept in the backlog if the event loop is full */
+        esp_err_t err = esp_agent_post_event(agent, ESP_AGENT_EVENT_LATENCY, &data);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to post latency event for turn %lu: %x", (unsigned long)data.latency.turn, err);
+        }
+    }
+
+    return ESP_OK;
+}
+
+void esp_agent_usage_init(esp_agent_usage_t *usage)
+{
+    memset(usage, 0, sizeof(esp_agent_usage_t));
+    portMUX_INITIALIZE(&usage->lock);
+    usage->turn_server_ms = -1;
+    usage->turn_network_ms = -1;
+}
+
+void esp_agent_usage_session_start(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_usage_t *usage = &agent->usage;
+
+    portENTER_CRITICAL(&usage->lock);
+    usage->session_turns = 0;
+    usage->session_input_tokens = 0;
+    usage->session_output_tokens = 0;
+    portEXIT_CRITICAL(&usage->lock);
+}
+
+esp_err_t esp_agent_usage_record(esp_agent_handle_t handle, const esp_agent_usage_report_t *report)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_latency_tracker_t *tracker = &agent->latency;
+    esp_agent_usage_t *usage = &agent->usage;
+    esp_agent_message_data_t data = {0};
+
+    /* The timestamps of the last turn are kept until the next one starts */
+    portENTER_CRITICAL(&tracker->lock);
+    uint32_t turn = tracker->turn;
+    int64_t request_us = tracker->timestamp_us[ESP_AGENT_LATENCY_STAGE_AUDIO_STREAM_END];
+    if (request_us == 0) {
+        request_us = tracker->timestamp_us[ESP_AGENT_LATENCY_STAGE_UPLINK_LAST_FRAME];
+    }
+    int64_t reply_us = tracker->timestamp_us[ESP_AGENT_LATENCY_STAGE_DOWNLINK_FIRST_FRAME];
+    portEXIT_CRITICAL(&tracker->lock);
+
+    data.usage.turn = turn;
+    data.usage.response_ms = request_us && reply_us > request_us ? (int32_t)((reply_us - request_us) / 1000) : -1;
+
+    portENTER_CRITICAL(&usage->lock);
+    if (usage->turns == 0 || usage->turn != turn) {
+        usage->turn = turn;
+        usage->turn_input_tokens = 0;
+        usage->turn_output_tokens = 0;
+        usage->turn_server_ms = -1;
+        usage->turn_network_ms = -1;
+        usage->turns++;
+        usage->session_turns++;
+    }
+    usage->turn_input_tokens += report->input_tokens;
+    usage->turn_output_tokens += report->output_tokens;
+    usage->input_tokens += report->input_tokens;
+    usage->output_tokens += report->output_tokens;
+    usage->session_input_tokens += report->input_tokens;
+    usage->session_output_tokens += report->output_tokens;
+    /* One sample per turn: the server time of the first reply, which the response time is measured to */
+    if (usage->turn_server_ms < 0 && report->server_ms >= 0) {
+        usage->turn_server_ms = report->server_ms;
+        esp_agent_stats_window_add(&usage->server_ms, usage->turn_server_ms);
+    }
+    if (usage->turn_network_ms < 0 && usage->turn_server_ms >= 0 && data.usage.response_ms >= 0) {
+        usage->turn_network_ms = data.usage.response_ms > usage->turn_server_ms ? data.usage.response_ms - usage->turn_server_ms : 0;
+        esp_agent_stats_window_add(&usage->network_ms, usage->turn_network_ms);
+    }
+    data.usage.input_tokens = usage->turn_input_tokens;
+    data.usage.output_tokens = usage->turn_output_tokens;
+    data.usage.server_ms = usage->turn_server_ms;
+    data.usage.network_ms = usage->turn_network_ms;
+    portEXIT_CRITICAL(&usage->lock);
+
+    return esp_agent_post_event(agent, ESP_AGENT_EVENT_USAGE, &data);
+}
+
+esp_err_t esp_agent_get_usage_stats(esp_agent_handle_t handle, esp_agent_usage_stats_t *stats)
+{
+    if (handle == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_usage_t *usage = &agent->usage;
+    esp_agent_stats_window_t server_window;
+    esp_agent_stats_window_t network_window;
+
+    portENTER_CRITICAL(&usage->lock);
+    stats->turns = usage->turns;
+    stats->input_tokens = usage->input_tokens;
+    stats->output_tokens = usage->output_tokens;
+    stats->session_turns = usage->session_turns;
+    stats->session_input_tokens = usage->session_input_tokens;
+    stats->session_output_tokens = usage->session_output_tokens;
+    server_window = usage->server_ms;
+    network_window = usage->network_ms;
+    portEXIT_CRITICAL(&usage->lock);
+
+    const esp_agent_stats_window_t *windows[] = { &server_window, &network_window };
+    esp_agent_latency_percentiles_t *percentiles[] = { &stats->server, &stats->network };
+    for (int i = 0; i < 2; i++) {
+        percentiles[i]->samples = windows[i]->count;
+        percentiles[i]->p50_ms = esp_agent_stats_window_percentile(windows[i], 50);
+        percentiles[i]->p90_ms = esp_agent_stats_window_percentile(windows[i], 90);
+        percentiles[i]->p99_ms = esp_agent_stats_window_percentile(windows[i], 99);
+        percentiles[i]->max_ms = esp_agent_stats_window_percentile(windows[i], 100);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t esp_agent_latency_get_percentiles(esp_agent_handle_t handle, esp_agent_latency_stage_t stage, esp_agent_latency_percentiles_t *percentiles)
+{
+    if (handle == NULL || stage >= ESP_AGENT_LATENCY_STAGE_MAX || percentiles == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_stats_window_t window;
+
+    /* Copy out so that sorting happens outside the critical section */
+    portENTER_CRITICAL(&agent->latency.lock);
+    window = agent->latency.stage_ms[stage];
+    portEXIT_CRITICAL(&agent->latency.lock);
+
+    percentiles->samples = window.count;
+    percentiles->p50_ms = esp_agent_stats_window_percentile(&window, 50);
+    percentiles->p90_ms = esp_agent_stats_window_percentile(&window, 90);
+    percentiles->p99_ms = esp_agent_stats_window_percentile(&window, 99);
+    percentiles->max_ms = esp_agent_stats_window_percentile(&window, 100);
+
+    return ESP_OK;
+}
+
+void esp_agent_transport_stats_init(esp_agent_transport_stats_internal_t *stats)
+{
+    memset(stats, 0, sizeof(esp_agent_transport_stats_internal_t));
+    portMUX_INITIALIZE(&stats->lock);
+    stats->reset_at_us = esp_timer_get_time();
+}
+
+void esp_agent_transport_stats_count_message(esp_agent_transport_stats_internal_t *stats, esp_agent_transport_counter_t counter, size_t len)
+{
+    if (counter >= ESP_AGENT_TRANSPORT_COUNTER_MAX) {
+        return;
+    }
+
+    portENTER_CRITICAL(&stats->lock);
+    stats->messages[counter]++;
+    stats->bytes[counter] += len;
+    portEXIT_CRITICAL(&stats->lock);
+}
+
+void esp_agent_transport_stats_count_copy(esp_agent_transport_stats_internal_t *stats, size_t bytes, uint32_t allocations)
+{
+    portENTER_CRITICAL(&stats->lock);
+    stats->bytes_copied += bytes;
+    stats->allocations += allocations;
+    portEXIT_CRITICAL(&stats->lock);
+}
+
+void esp_agent_transport_stats_count_drop(esp_agent_transport_stats_internal_t *stats, bool tx)
+{
+    portENTER_CRITICAL(&stats->lock);
+    if (tx) {
+        stats->tx_dropped++;
+    } else {
+        stats->rx_dropped++;
+    }
+    portEXIT_CRITICAL(&stats->lock);
+}
+
+void esp_agent_transport_stats_count_queue_latency(esp_agent_transport_stats_internal_t *stats, esp_agent_transport_queue_t queue, int64_t queued_at_us)
+{
+    if (queue >= ESP_AGENT_TRANSPORT_QUEUE_MAX) {
+        return;
+    }
+
+    int64_t latency_us = esp_timer_get_time() - queued_at_us;
+    if (latency_us < 0) {
+        latency_us = 0;
+    } else if (latency_us > UINT32_MAX) {
+        latency_us = UINT32_MAX;
+    }
+
+    portENTER_CRITICAL(&stats->lock);
+    esp_agent_stats_window_add(&stats->queue_latency_us[queue], (uint32_t)latency_us);
+    portEXIT_CRITICAL(&stats->lock);
+}
+
+void esp_agent_transport_stats_count_compression(esp_agent_transport_stats_internal_t *stats, bool tx, size_t original_len, size_t compressed_len, uint32_t cpu_us)
+{
+    esp_agent_compression_stats_t *compression = tx ? &stats->tx_compression : &stats->rx_compression;
+
+    portENTER_CRITICAL(&stats->lock);
+    compression->messages++;
+    compression->original_bytes += original_len;
+    compression->compressed_bytes += compressed_len;
+    compression->cpu_us += cpu_us;
+    portEXIT_CRITICAL(&stats->lock);
+}
+
+void esp_agent_transport_stats_count_audio_uplink(esp_agent_transport_stats_internal_t *stats, uint32_t frames, size_t overhead_bytes, uint32_t added_latency_us)
+{
+    portENTER_CRITICAL(&stats->lock);
+    stats->audio_frames += frames;
+    stats->audio_messages++;
+    stats->audio_overhead_bytes += overhead_bytes;
+    esp_agent_stats_window_add(&stats->audio_added_latency_us, added_latency_us);
+    portEXIT_CRITICAL(&stats->lock);
+}
+
+void esp_agent_transport_stats_count_write(esp_agent_transport_stats_internal_t *stats, uint32_t write_us, bool stalled, bool deadline_expired)
+{
+    portENTER_CRITICAL(&stats->lock);
+    esp_agent_stats_window_add(&stats->write_time_us, write_us);
+    if (stalled) {
+        stats->stalls++;
+        stats->stall_us += write_us;
+    }
+    if (deadline_expired) {
+        stats->deadline_expired++;
+    }
+    portEXIT_CRITICAL(&stats->lock);
+}
+
+void esp_agent_transport_stats_count_fragmented(esp_agent_transport_stats_internal_t *stats, uint32_t fragments)
+{
+    portENTER_CRITICAL(&stats->lock);
+    stats->fragmented_messages++;
+    stats->fragments += fragments;
+    portEXIT_CRITICAL(&stats->lock);
+}
+
+esp_err_t esp_agent_get_transport_stats(esp_agent_handle_t handle, esp_agent_transport_stats_t *stats)
+{
+    if (handle == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_stats_window_t windows[ESP_AGENT_TRANSPORT_QUEUE_MAX];
+    esp_agent_stats_window_t added_latency;
+    esp_agent_stats_window_t write_time;
+
+    portENTER_CRITICAL(&agent->transport_stats.lock);
+    stats->elapsed_us = esp_timer_get_time() - agent->transport_stats.reset_at_us;
+    memcpy(stats->messages, agent->transport_stats.messages, sizeof(stats->messages));
+    memcpy(stats->bytes, agent->transport_stats.bytes, sizeof(stats->bytes));
+    stats->tx_dropped = agent->transport_stats.tx_dropped;
+    stats->rx_dropped = agent->transport_stats.rx_dropped;
+    stats->bytes_copied = agent->transport_stats.bytes_copied;
+    stats->allocations = agent->transport_stats.allocations;
+    memcpy(windows, agent->transport_stats.queue_latency_us, sizeof(windows));
+    stats->tx_compression = agent->transport_stats.tx_compression;
+    stats->rx_compression = agent->transport_stats.rx_compression;
+    stats->audio_uplink.frames = agent->transport_stats.audio_frames;
+    stats->audio_uplink.messages = agent->transport_stats.audio_messages;
+    stats->audio_uplink.overhead_bytes = agent->transport_stats.audio_overhead_bytes;
+    added_latency = agent->transport_stats.audio_added_latency_us;
+    stats->send_path.fragmented_messages = agent->transport_stats.fragmented_messages;
+    stats->send_path.fragments = agent->transport_stats.fragments;
+    stats->send_path.stalls = agent->transport_stats.stalls;
+    stats->send_path.stall_ms = agent->transport_stats.stall_us / 1000;
+    stats->send_path.deadline_expired = agent->transport_stats.deadline_expired;
+    write_time = agent->transport_stats.write_time_us;
+    portEXIT_CRITICAL(&agent->transport_stats.lock);
+
+    stats->audio_uplink.window_ms = agent->aggregation.window_us / 1000;
+    stats->audio_uplink.added_latency.samples = added_latency.count;
+    stats->audio_uplink.added_latency.p50_us = esp_agent_stats_window_percentile(&added_latency, 50);
+    stats->audio_uplink.added_latency.p99_us = esp_agent_stats_window_percentile(&added_latency, 99);
+    stats->audio_uplink.added_latency.max_us = esp_agent_stats_window_percentile(&added_latency, 100);
+    stats->send_path.write_time.samples = write_time.count;
+    stats->send_path.write_time.p50_us = esp_agent_stats_window_percentile(&write_time, 50);
+    stats->send_path.write_time.p99_us = esp_agent_stats_window_percentile(&write_time, 99);
+    stats->send_path.write_time.max_us = esp_agent_stats_window_percentile(&write_time, 100);
+
+    stats->compression_memory = agent->compression.deflate_memory + agent->compression.inflate_memory;
+
+    for (int i = 0; i < ESP_AGENT_TRANSPORT_QUEUE_MAX; i++) {
+        stats->queue_latency[i].samples = windows[i].count;
+        stats->queue_latency[i].p50_us = esp_agent_stats_window_percentile(&windows[i], 50);
+        stats->queue_latency[i].p99_us = esp_agent_stats_window_percentile(&windows[i], 99);
+        stats->queue_latency[i].max_us = esp_agent_stats_window_percentile(&windows[i], 100);
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t esp_agent_reset_transport_stats(esp_agent_handle_t handle)
+{
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_transport_stats_internal_t *stats = &agent->transport_stats;
+
+    portENTER_CRITICAL(&stats->lock);
+    memset(stats->messages, 0, sizeof(stats->messages));
+    memset(stats->bytes, 0, sizeof(stats->bytes));
+    stats->tx_dropped = 0;
+    stats->rx_dropped = 0;
+    stats->bytes_copied = 0;
+    stats->allocations = 0;
+    memset(stats->queue_latency_us, 0, sizeof(stats->queue_latency_us));
+    memset(&stats->tx_compression, 0, sizeof(stats->tx_compression));
+    memset(&stats->rx_compression, 0, sizeof(stats->rx_compression));
+    stats->audio_frames = 0;
+    stats->audio_messages = 0;
+    stats->audio_overhead_bytes = 0;
+    memset(&stats->audio_added_latency_us, 0, sizeof(stats->audio_added_latency_us));
+    stats->fragmented_messages = 0;
+    stats->fragments = 0;
+    stats->stalls = 0;
+    stats->stall_us = 0;
+    stats->deadline_expired = 0;
+    memset(&stats->write_time_us, 0, sizeof(stats->write_time_us));
+    stats->reset_at_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&stats->lock);
+
+    return ESP_OK;
+}
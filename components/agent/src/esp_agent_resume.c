@@ -0,0 +1,444 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <cJSON.h>
+
+#include <esp_agent.h>
+#include <esp_agent_internal.h>
+#include <esp_agent_internal_resume.h>
+#include <esp_agent_websocket.h>
+
+#if CONFIG_ESP_AGENT_RESUME
+
+static const char *TAG = "esp_agent_resume";
+
+/* Longest "{"seq":N,"ack":N," prefix */
+#define RESUME_PREFIX_MAX_LEN 40
+
+static void resume_entry_free(esp_agent_resume_entry_t *entry)
+{
+    free(entry->payload);
+    entry->payload = NULL;
+    entry->len = 0;
+}
+
+/* Called with the lock held */
+static void resume_release(esp_agent_resume_t *resume, uint32_t ack)
+{
+    while (resume->count && resume->entries[resume->head].seq <= ack) {
+        resume_entry_free(&resume->entries[resume->head]);
+        resume->head = (resume->head + 1) % CONFIG_ESP_AGENT_RESUME_BUFFER_SIZE;
+        resume->count--;
+    }
+}
+
+/* Called with the lock held */
+static void resume_reset(esp_agent_resume_t *resume)
+{
+    resume_release(resume, UINT32_MAX);
+    resume->head = 0;
+    resume->next_tx_seq = 1;
+    resume->last_rx_seq = 0;
+    resume->unacked_rx = 0;
+}
+
+esp_err_t esp_agent_resume_init(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_resume_t *resume = &agent->resume;
+
+    memset(resume, 0, sizeof(esp_agent_resume_t));
+    resume->next_tx_seq = 1;
+
+    resume->entries = calloc(CONFIG_ESP_AGENT_RESUME_BUFFER_SIZE, sizeof(esp_agent_resume_entry_t));
+    if (resume->entries == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    resume->lock = xSemaphoreCreateMutex();
+    if (resume->lock == NULL) {
+        free(resume->entries);
+        resume->entries = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void esp_agent_resume_deinit(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_resume_t *resume = &agent->resume;
+
+    if (resume->entries) {
+        resume_release(resume, UINT32_MAX);
+        free(resume->entries);
+        resume->entries = NULL;
+    }
+    if (resume->lock) {
+        vSemaphoreDelete(resume->lock);
+        resume->lock = NULL;
+    }
+    resume->negotiated = false;
+}
+
+/* Sequence numbers are integers from 0 to UINT32_MAX, anything else is ignored rather than cast */
+static bool resume_seq_value(const cJSON *item, uint32_t *value)
+{
+    if (!cJSON_IsNumber(item) || !(item->valuedouble >= 0 && item->valuedouble <= UINT32_MAX)) {
+        return false;
+    }
+    uint32_t seq = (uint32_t)item->valuedouble;
+    if ((double)seq != item->valuedouble) {
+        return false;
+    }
+    *value = seq;
+    return true;
+}
+
+void esp_agent_resume_add_to_handshake(esp_agent_handle_t handle, cJSON *content)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_resume_t *resume = &agent->resume;
+
+    cJSON *json = cJSON_CreateObject();
+    if (json == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(resume->lock, portMAX_DELAY);
+    cJSON_AddNumberToObject(json, "lastReceivedSeq", resume->last_rx_seq);
+    cJSON_AddNumberToObject(json, "nextSeq", resume->next_tx_seq);
+    /* Text queued from now on waits for the ack, which tells whether it is sequenced */
+    resume->awaiting_ack = true;
+    resume->replay_pending = false;
+    xSemaphoreGive(resume->lock);
+    cJSON_AddNumberToObject(json, "bufferSize", CONFIG_ESP_AGENT_RESUME_BUFFER_SIZE);
+    cJSON_AddItemToObject(content, "resume", json);
+}
+
+void esp_agent_resume_handshake_ack(esp_agent_handle_t handle, cJSON *content)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_resume_t *resume = &agent->resume;
+    cJSON *json = cJSON_GetObjectItemCaseSensitive(content, "resume");
+
+    if (!cJSON_IsObject(json)) {
+        xSemaphoreTake(resume->lock, portMAX_DELAY);
+        resume_reset(resume);
+        resume->disconnected_at_us = 0;
+        resume->awaiting_ack = false;
+        xSemaphoreGive(resume->lock);
+        ESP_LOGI(TAG, "Message sequencing not supported by the server");
+        return;
+    }
+
+    /* The server resumes only the same conversation, otherwise both sides start over */
+    bool accepted = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(json, "accepted"));
+    uint32_t last_received = 0;
+    int64_t now = esp_timer_get_time();
+
+    xSemaphoreTake(resume->lock, portMAX_DELAY);
+    if (!accepted) {
+        resume_reset(resume);
+    } else {
+        if (resume_seq_value(cJSON_GetObjectItemCaseSensitive(json, "lastReceivedSeq"), &last_received)) {
+            resume_release(resume, last_received);
+        }
+        if (resume->disconnected_at_us) {
+            resume->resumes++;
+            esp_agent_stats_window_add(&resume->recovery_ms, (uint32_t)((now - resume->disconnected_at_us) / 1000));
+        }
+    }
+    resume->disconnected_at_us = 0;
+    /* The send task replays first, then sequences the held and later messages */
+    resume->negotiated = true;
+    resume->replay_pending = accepted;
+    resume->awaiting_ack = false;
+    size_t unacked = resume->count;
+    xSemaphoreGive(resume->lock);
+
+    if (accepted) {
+        ESP_LOGI(TAG, "Conversation resumed, %u messages to replay", (unsigned)unacked);
+    } else {
+        ESP_LOGI(TAG, "Message sequencing enabled");
+    }
+}
+
+bool esp_agent_resume_holding(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_resume_t *resume = &agent->resume;
+
+    xSemaphoreTake(resume->lock, portMAX_DELAY);
+    bool holding = resume->awaiting_ack;
+    xSemaphoreGive(resume->lock);
+    return holding;
+}
+
+esp_agent_resume_entry_t *esp_agent_resume_take_replay(esp_agent_handle_t handle, size_t *count)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_resume_t *resume = &agent->resume;
+    esp_agent_resume_entry_t *replay = NULL;
+
+    *count = 0;
+    xSemaphoreTake(resume->lock, portMAX_DELAY);
+    /* Copied, so that the lock is not held while sending */
+    if (resume->replay_pending && resume->count) {
+        replay = calloc(resume->count, sizeof(esp_agent_resume_entry_t));
+    }
+    for (size_t i = 0; replay && i < resume->count; i++) {
+        const esp_agent_resume_entry_t *entry = &resume->entries[(resume->head + i) % CONFIG_ESP_AGENT_RESUME_BUFFER_SIZE];
+        replay[i].payload = malloc(entry->len);
+        if (replay[i].payload == NULL) {
+            break;
+        }
+        memcpy(replay[i].payload, entry->payload, entry->len);
+        replay[i].seq = entry->seq;
+        replay[i].len = entry->len;
+        (*count)++;
+    }
+    resume->replay_pending = false;
+    xSemaphoreGive(resume->lock);
+
+    if (replay && *count == 0) {
+        free(replay);
+        replay = NULL;
+    }
+    return replay;
+}
+
+void esp_agent_resume_replayed(esp_agent_handle_t handle, size_t messages, size_t bytes)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_resume_t *resume = &agent->resume;
+
+    xSemaphoreTake(resume->lock, portMAX_DELAY);
+    resume->replayed_messages += messages;
+    resume->replayed_bytes += bytes;
+    xSemaphoreGive(resume->lock);
+    ESP_LOGI(TAG, "Replayed %u messages (%u bytes)", (unsigned)messages, (unsigned)bytes);
+}
+
+char *esp_agent_resume_sequence(esp_agent_handle_t handle, const char *message, size_t len, size_t *out_len)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_resume_t *resume = &agent->resume;
+
+    if (!resume->negotiated || len < 2 || message[0] != '{') {
+        return NULL;
+    }
+
+    /* Allocated first, so that a sequence number is not lost on failure */
+    char *sequenced = malloc(len + RESUME_PREFIX_MAX_LEN);
+    char *copy = malloc(len + RESUME_PREFIX_MAX_LEN);
+    if (sequenced == NULL || copy == NULL) {
+        free(sequenced);
+        free(copy);
+        return NULL;
+    }
+
+    esp_agent_resume_entry_t evicted = {0};
+
+    xSemaphoreTake(resume->lock, portMAX_DELAY);
+    uint32_t seq = resume->next_tx_seq++;
+    /* Acknowledges the received messages too */
+    int prefix_len = snprintf(sequenced, RESUME_PREFIX_MAX_LEN, "{\"seq\":%lu,\"ack\":%lu%s", (unsigned long)seq,
+                              (unsigned long)resume->last_rx_seq, message[1] == '}' ? "" : ",");
+    resume->unacked_rx = 0;
+    memcpy(sequenced + prefix_len, message + 1, len - 1);
+    *out_len = prefix_len + len - 1;
+    memcpy(copy, sequenced, *out_len);
+
+    if (resume->count == CONFIG_ESP_AGENT_RESUME_BUFFER_SIZE) {
+        evicted = resume->entries[resume->head];
+        resume->entries[resume->head].payload = NULL;
+        resume->head = (resume->head + 1) % CONFIG_ESP_AGENT_RESUME_BUFFER_SIZE;
+        resume->count--;
+        resume->evicted++;
+    }
+    esp_agent_resume_entry_t *entry = &resume->entries[(resume->head + resume->count) % CONFIG_ESP_AGENT_RESUME_BUFFER_SIZE];
+    entry->seq = seq;
+    entry->payload = copy;
+    entry->len = *out_len;
+    resume->count++;
+    xSemaphoreGive(resume->lock);
+
+    if (evicted.payload) {
+        ESP_LOGW(TAG, "Retransmit buffer full, message %lu can no longer be replayed", (unsigned long)evicted.seq);
+        resume_entry_free(&evicted);
+    }
+
+    return sequenced;
+}
+
+bool esp_agent_resume_received(esp_agent_handle_t handle, cJSON *json)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_resume_t *resume = &agent->resume;
+
+    if (!resume->negotiated) {
+        return true;
+    }
+
+    cJSON *ack = cJSON_GetObjectItemCaseSensitive(json, "ack");
+    cJSON *seq = cJSON_GetObjectItemCaseSensitive(json, "seq");
+    bool process = true;
+    bool send_ack = false;
+    uint32_t last_rx_seq = 0;
+
+    uint32_t value = 0;
+
+    xSemaphoreTake(resume->lock, portMAX_DELAY);
+    if (resume_seq_value(ack, &value)) {
+        resume_release(resume, value);
+    }
+    if (resume_seq_value(seq, &value)) {
+        uint32_t rx_seq = value;
+        if (rx_seq <= resume->last_rx_seq) {
+            /* Replayed by the server, but received before the disconnect */
+            resume->duplicates++;
+            process = false;
+        } else {
+            if (rx_seq > resume->last_rx_seq + 1) {
+                resume->gaps += rx_seq - resume->last_rx_seq - 1;
+            }
+            resume->last_rx_seq = rx_seq;
+            if (++resume->unacked_rx >= CONFIG_ESP_AGENT_RESUME_ACK_EVERY) {
+                resume->unacked_rx = 0;
+                send_ack = true;
+            }
+        }
+    }
+    last_rx_seq = resume->last_rx_seq;
+    xSemaphoreGive(resume->lock);
+
+    /* Received messages are acknowledged with the next message sent, or on their own if the device is quiet */
+    if (send_ack) {
+        char ack_json[48];
+        int ack_len = snprintf(ack_json, sizeof(ack_json), "{\"type\":\"" ESP_AGENT_MESSAGE_TYPE_ACK "\",\"ack\":%lu}", (unsigned long)last_rx_seq);
+        esp_agent_websocket_queue_message(agent, WS_SEND_MSG_TYPE_TEXT_UNSEQUENCED, ack_json, ack_len, 0);
+    }
+
+    return process;
+}
+
+void esp_agent_resume_disconnected(esp_agent_handle_t handle, bool unexpected)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_resume_t *resume = &agent->resume;
+
+    xSemaphoreTake(resume->lock, portMAX_DELAY);
+    if (unexpected && resume->negotiated && resume->disconnected_at_us == 0) {
+        resume->disconnected_at_us = esp_timer_get_time();
+    }
+    resume->negotiated = false;
+    /* Held text is dropped by the send task like the rest of the queue, the replay waits for the next ack */
+    resume->awaiting_ack = false;
+    resume->replay_pending = false;
+    xSemaphoreGive(resume->lock);
+}
+
+esp_err_t esp_agent_get_resume_stats(esp_agent_handle_t handle, esp_agent_resume_stats_t *stats)
+{
+    if (handle == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_resume_t *resume = &agent->resume;
+    esp_agent_stats_window_t recovery_window;
+
+    xSemaphoreTake(resume->lock, portMAX_DELAY);
+    stats->negotiated = resume->negotiated;
+    stats->tx_seq = resume->next_tx_seq - 1;
+    stats->rx_seq = resume->last_rx_seq;
+    stats->unacked = resume->count;
+    stats->resumes = resume->resumes;
+    stats->replayed_messages = resume->replayed_messages;
+    stats->replayed_bytes = resume->replayed_bytes;
+    stats->duplicates = resume->duplicates;
+    stats->gaps = resume->gaps;
+    stats->evicted = resume->evicted;
+    recovery_window = resume->recovery_ms;
+    xSemaphoreGive(resume->lock);
+
+    stats->recovery.samples = recovery_window.count;
+    stats->recovery.p50_ms = esp_agent_stats_window_percentile(&recovery_window, 50);
+    stats->recovery.p90_ms = esp_agent_stats_window_percentile(&recovery_window, 90);
+    stats->recovery.p99_ms = esp_agent_stats_window_percentile(&recovery_window, 99);
+    stats->recovery.max_ms = esp_agent_stats_window_percentile(&recovery_window, 100);
+
+    return ESP_OK;
+}
+
+#else /* CONFIG_ESP_AGENT_RESUME */
+
+esp_err_t esp_agent_resume_init(esp_agent_handle_t handle)
+{
+    return ESP_OK;
+}
+
+void esp_agent_resume_deinit(esp_agent_handle_t handle)
+{
+}
+
+void esp_agent_resume_add_to_handshake(esp_agent_handle_t handle, cJSON *content)
+{
+}
+
+void esp_agent_resume_handshake_ack(esp_agent_handle_t handle, cJSON *content)
+{
+}
+
+bool esp_agent_resume_holding(esp_agent_handle_t handle)
+{
+    return false;
+}
+
+esp_agent_resume_entry_t *esp_agent_resume_take_replay(esp_agent_handle_t handle, size_t *count)
+{
+    *count = 0;
+    return NULL;
+}
+
+void esp_agent_resume_replayed(esp_agent_handle_t handle, size_t messages, size_t bytes)
+{
+}
+
+char *esp_agent_resume_sequence(esp_agent_handle_t handle, const char *message, size_t len, size_t *out_len)
+{
+    return NULL;
+}
+
+bool esp_agent_resume_received(esp_agent_handle_t handle, cJSON *json)
+{
+    return true;
+}
+
+void esp_agent_resume_disconnected(esp_agent_handle_t handle, bool unexpected)
+{
+}
+
+esp_err_t esp_agent_get_resume_stats(esp_agent_handle_t handle, esp_agent_resume_stats_t *stats)
+{
+    if (handle == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(stats, 0, sizeof(esp_agent_resume_stats_t));
+    return ESP_OK;
+}
+
+#endif /* CONFIG_ESP_AGENT_RESUME */
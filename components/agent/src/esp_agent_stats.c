@@ -0,0 +1,51 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <esp_agent_internal_stats.h>
+
+void esp_agent_stats_window_add(esp_agent_stats_window_t *window, uint32_t value)
+{
+    if (window == NULL) {
+        return;
+    }
+
+    window->samples[window->next] = value;
+    window->next = (window->next + 1) % ESP_AGENT_STATS_WINDOW_SIZE;
+    if (window->count < ESP_AGENT_STATS_WINDOW_SIZE) {
+        window->count++;
+    }
+}
+
+uint32_t esp_agent_stats_window_percentile(const esp_agent_stats_window_t *window, uint8_t percentile)
+{
+    if (window == NULL || window->count == 0) {
+        return 0;
+    }
+
+    if (percentile > 100) {
+        percentile = 100;
+    }
+
+    /* The window is small, an insertion sort of a copy is cheaper than keeping it ordered */
+    uint32_t sorted[ESP_AGENT_STATS_WINDOW_SIZE];
+    size_t count = window->count;
+    memcpy(sorted, window->samples, count * sizeof(uint32_t));
+
+    for (size_t i = 1; i < count; i++) {
+        uint32_t value = sorted[i];
+        size_t j = i;
+        while (j > 0 && sorted[j - 1] > value) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = value;
+    }
+
+    size_t rank = (percentile * count + 99) / 100;
+    return sorted[rank ? rank - 1 : 0];
+}
@@ -0,0 +1,227 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <esp_agent.h>
+#include <esp_agent_internal.h>
+#include <esp_agent_internal_tool_dedup.h>
+#include <esp_agent_websocket.h>
+
+/* Queueing a cached response from the message task must not stall it for long */
+#define TOOL_DEDUP_QUEUE_TIMEOUT_MS 1000
+
+void esp_agent_tool_dedup_init(esp_agent_tool_dedup_t *dedup)
+{
+    memset(dedup, 0, sizeof(esp_agent_tool_dedup_t));
+    portMUX_INITIALIZE(&dedup->lock);
+}
+
+#if CONFIG_ESP_AGENT_TOOL_DEDUP_WINDOW_MS
+
+static const char *TAG = "esp_agent_tool_dedup";
+
+#define TOOL_DEDUP_WINDOW_US (CONFIG_ESP_AGENT_TOOL_DEDUP_WINDOW_MS * 1000LL)
+
+void esp_agent_tool_dedup_deinit(esp_agent_tool_dedup_t *dedup)
+{
+    for (int i = 0; i < ESP_AGENT_TOOL_DEDUP_ENTRIES; i++) {
+        free(dedup->entries[i].request_id);
+        free(dedup->entries[i].response);
+        dedup->entries[i].request_id = NULL;
+        dedup->entries[i].response = NULL;
+    }
+}
+
+/* Called with the lock held */
+static esp_agent_tool_dedup_entry_t *tool_dedup_find(esp_agent_tool_dedup_t *dedup, const char *request_id)
+{
+    for (int i = 0; i < ESP_AGENT_TOOL_DEDUP_ENTRIES; i++) {
+        if (dedup->entries[i].request_id && strcmp(dedup->entries[i].request_id, request_id) == 0) {
+            return &dedup->entries[i];
+        }
+    }
+    return NULL;
+}
+
+bool esp_agent_tool_dedup_check(esp_agent_handle_t handle, const char *request_id)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_tool_dedup_t *dedup = &agent->tool_dedup;
+    int64_t now = esp_timer_get_time();
+    char *response = NULL;
+    char *evicted_id = NULL;
+    char *evicted_response = NULL;
+    bool duplicate = false;
+
+    if (request_id == NULL) {
+        return false;
+    }
+
+    /* Allocated first, the lock disables interrupts */
+    char *id = strdup(request_id);
+
+    portENTER_CRITICAL(&dedup->lock);
+    dedup->requests++;
+    esp_agent_tool_dedup_entry_t *entry = tool_dedup_find(dedup, request_id);
+    if (entry && now - entry->stored_us <= TOOL_DEDUP_WINDOW_US) {
+        duplicate = true;
+        dedup->duplicates++;
+        if (entry->response) {
+            /* Copied outside the lock, the entry cannot be reused while held by this task */
+            response = entry->response;
+            entry->response = NULL;
+        } else {
+            dedup->in_flight_duplicates++;
+        }
+    } else if (id) {
+        /* Reuse the entry of an expired request, otherwise the oldest one */
+        if (entry == NULL) {
+            entry = &dedup->entries[0];
+            for (int i = 0; i < ESP_AGENT_TOOL_DEDUP_ENTRIES; i++) {
+                if (dedup->entries[i].request_id == NULL) {
+                    entry = &dedup->entries[i];
+                    break;
+                }
+                if (dedup->entries[i].stored_us < entry->stored_us) {
+                    entry = &dedup->entries[i];
+                }
+            }
+            if (entry->request_id && now - entry->stored_us <= TOOL_DEDUP_WINDOW_US) {
+                dedup->evicted++;
+            }
+        }
+        evicted_id = entry->request_id;
+        evicted_response = entry->response;
+        entry->request_id = id;
+        entry->response = NULL;
+        entry->stored_us = now;
+        id = NULL;
+    }
+    portEXIT_CRITICAL(&dedup->lock);
+
+    free(id);
+    free(evicted_id);
+    free(evicted_response);
+
+    if (!duplicate) {
+        return false;
+    }
+    if (response == NULL) {
+        ESP_LOGW(TAG, "Duplicate tool request %s while the tool is running, ignored", request_id);
+        return true;
+    }
+
+    ESP_LOGW(TAG, "Duplicate tool request %s, answering with the cached response", request_id);
+    if (esp_agent_websocket_queue_message(agent, WS_SEND_MSG_TYPE_TEXT, response, strlen(response),
+                                          pdMS_TO_TICKS(TOOL_DEDUP_QUEUE_TIMEOUT_MS)) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to queue cached tool response");
+    } else {
+        esp_agent_transport_stats_count_message(&agent->transport_stats, ESP_AGENT_TRANSPORT_COUNTER_TX_TOOL, strlen(response));
+    }
+
+    /* Put the response back for further duplicates */
+    portENTER_CRITICAL(&dedup->lock);
+    entry = tool_dedup_find(dedup, request_id);
+    if (entry && entry->response == NULL) {
+        entry->response = response;
+        response = NULL;
+    }
+    portEXIT_CRITICAL(&dedup->lock);
+    free(response);
+
+    return true;
+}
+
+void esp_agent_tool_dedup_store(esp_agent_handle_t handle, const char *request_id, const char *response)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_tool_dedup_t *dedup = &agent->tool_dedup;
+    char *copy = response ? strdup(response) : NULL;
+    char *forgotten_id = NULL;
+
+    if (request_id == NULL) {
+        free(copy);
+        return;
+    }
+
+    portENTER_CRITICAL(&dedup->lock);
+    esp_agent_tool_dedup_entry_t *entry = tool_dedup_find(dedup, request_id);
+    if (entry && copy) {
+        free(entry->response);      /* NULL, the tool ran once */
+        entry->response = copy;
+        entry->stored_us = esp_timer_get_time();
+        copy = NULL;
+    } else if (entry) {
+        /* Nothing to answer a duplicate with, so let it run the tool */
+        forgotten_id = entry->request_id;
+        entry->request_id = NULL;
+    }
+    portEXIT_CRITICAL(&dedup->lock);
+
+    free(copy);
+    free(forgotten_id);
+}
+
+esp_err_t esp_agent_get_tool_dedup_stats(esp_agent_handle_t handle, esp_agent_tool_dedup_stats_t *stats)
+{
+    if (handle == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_tool_dedup_t *dedup = &agent->tool_dedup;
+
+    memset(stats, 0, sizeof(esp_agent_tool_dedup_stats_t));
+    portENTER_CRITICAL(&dedup->lock);
+    stats->requests = dedup->requests;
+    stats->duplicates = dedup->duplicates;
+    stats->in_flight_duplicates = dedup->in_flight_duplicates;
+    stats->evicted = dedup->evicted;
+    for (int i = 0; i < ESP_AGENT_TOOL_DEDUP_ENTRIES; i++) {
+        if (dedup->entries[i].request_id) {
+            stats->entries++;
+            stats->bytes += strlen(dedup->entries[i].request_id) + 1;
+        }
+        if (dedup->entries[i].response) {
+            stats->bytes += strlen(dedup->entries[i].response) + 1;
+        }
+    }
+    portEXIT_CRITICAL(&dedup->lock);
+
+    return ESP_OK;
+}
+
+#else /* CONFIG_ESP_AGENT_TOOL_DEDUP_WINDOW_MS */
+
+void esp_agent_tool_dedup_deinit(esp_agent_tool_dedup_t *dedup)
+{
+}
+
+bool esp_agent_tool_dedup_check(esp_agent_handle_t handle, const char *request_id)
+{
+    return false;
+}
+
+void esp_agent_tool_dedup_store(esp_agent_handle_t handle, const char *request_id, const char *response)
+{
+}
+
+esp_err_t esp_agent_get_tool_dedup_stats(esp_agent_handle_t handle, esp_agent_tool_dedup_stats_t *stats)
+{
+    if (handle == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(stats, 0, sizeof(esp_agent_tool_dedup_stats_t));
+    return ESP_OK;
+}
+
+#endif /* CONFIG_ESP_AGENT_TOOL_DEDUP_WINDOW_MS */
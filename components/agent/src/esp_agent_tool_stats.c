@@ -0,0 +1,215 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <cJSON.h>
+
+#include <esp_agent.h>
+#include <esp_agent_internal.h>
+#include <esp_agent_internal_events.h>
+#include <esp_agent_internal_tool_stats.h>
+
+static const char *TAG = "esp_agent_tool_stats";
+
+static const uint32_t g_histogram_bounds_ms[ESP_AGENT_TOOL_HISTOGRAM_BUCKETS - 1] = { 10, 50, 100, 250, 500, 1000, 2500 };
+
+void esp_agent_tool_stats_init(esp_agent_tool_stats_table_t *table)
+{
+    memset(table, 0, sizeof(esp_agent_tool_stats_table_t));
+    portMUX_INITIALIZE(&table->lock);
+}
+
+/* Called with the lock held, with the name already truncated by tool_stats_key(). NULL if the table is full. */
+static esp_agent_tool_stats_t *tool_stats_find(esp_agent_tool_stats_table_t *table, const char key[ESP_AGENT_TOOL_STATS_NAME_LEN])
+{
+    for (size_t i = 0; i < table->count; i++) {
+        if (strcmp(table->tools[i].name, key) == 0) {
+            return &table->tools[i];
+        }
+    }
+    if (table->count == CONFIG_ESP_AGENT_TOOL_STATS_MAX) {
+        return NULL;
+    }
+
+    esp_agent_tool_stats_t *tool = &table->tools[table->count++];
+    memset(tool, 0, sizeof(esp_agent_tool_stats_t));
+    memcpy(tool->name, key, sizeof(tool->name));
+    return tool;
+}
+
+/* Copies the name as stored in the table, outside of the lock */
+static void tool_stats_key(char key[ESP_AGENT_TOOL_STATS_NAME_LEN], const char *name)
+{
+    memset(key, 0, ESP_AGENT_TOOL_STATS_NAME_LEN);
+    strncpy(key, name, ESP_AGENT_TOOL_STATS_NAME_LEN - 1);
+}
+
+void esp_agent_tool_stats_record(esp_agent_handle_t handle, const char *name, esp_agent_tool_timing_source_t source, uint32_t duration_ms)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_tool_stats_table_t *table = &agent->tool_stats;
+
+    if (name == NULL || source >= ESP_AGENT_TOOL_TIMING_MAX) {
+        return;
+    }
+
+    int bucket = 0;
+    while (bucket < ESP_AGENT_TOOL_HISTOGRAM_BUCKETS - 1 && duration_ms >= g_histogram_bounds_ms[bucket]) {
+        bucket++;
+    }
+    char key[ESP_AGENT_TOOL_STATS_NAME_LEN];
+    tool_stats_key(key, name);
+
+    portENTER_CRITICAL(&table->lock);
+    esp_agent_tool_stats_t *tool = tool_stats_find(table, key);
+    if (tool) {
+        esp_agent_tool_timing_t *timing = &tool->timing[source];
+        timing->calls++;
+        timing->total_ms += duration_ms;
+        if (duration_ms > timing->max_ms) {
+            timing->max_ms = duration_ms;
+        }
+        timing->histogram[bucket]++;
+    }
+    portEXIT_CRITICAL(&table->lock);
+}
+
+void esp_agent_tool_stats_record_stack(esp_agent_handle_t handle, const char *name, uint32_t stack_size, uint32_t free_bytes)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_tool_stats_table_t *table = &agent->tool_stats;
+
+    if (name == NULL) {
+        return;
+    }
+    char key[ESP_AGENT_TOOL_STATS_NAME_LEN];
+    tool_stats_key(key, name);
+
+    portENTER_CRITICAL(&table->lock);
+    esp_agent_tool_stats_t *tool = tool_stats_find(table, key);
+    if (tool) {
+        /* The stack size may change if the tool is registered again */
+        if (tool->stack_size != stack_size || free_bytes < tool->stack_min_free) {
+            tool->stack_min_free = free_bytes;
+        }
+        tool->stack_size = stack_size;
+    }
+    portEXIT_CRITICAL(&table->lock);
+}
+
+/* Field names of the server messages are not fixed, so the usual spellings are accepted */
+static cJSON *tool_info_field(cJSON *content, const char *const names[])
+{
+    for (int i = 0; names[i]; i++) {
+        cJSON *field = cJSON_GetObjectItemCaseSensitive(content, names[i]);
+        if (field && !cJSON_IsNull(field)) {
+            return field;
+        }
+    }
+    return NULL;
+}
+
+esp_err_t esp_agent_tool_stats_info(esp_agent_handle_t handle, cJSON *content, bool result)
+{
+    static const char *const name_fields[] = { "tool_name", "toolName", "name", NULL };
+    static const char *const call_id_fields[] = { "call_id", "callId", "tool_call_id", "request_id", NULL };
+    static const char *const timestamp_fields[] = { "timestamp", "timestamp_ms", "timestampMs", NULL };
+    static const char *const duration_fields[] = { "duration_ms", "durationMs", NULL };
+
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_tool_stats_table_t *table = &agent->tool_stats;
+    int64_t now = esp_timer_get_time();
+
+    char *name = cJSON_GetStringValue(tool_info_field(content, name_fields));
+    char *call_id = cJSON_GetStringValue(tool_info_field(content, call_id_fields));
+    cJSON *timestamp = tool_info_field(content, timestamp_fields);
+    cJSON *duration = tool_info_field(content, duration_fields);
+    if (name == NULL) {
+        ESP_LOGW(TAG, "Tool %s info without a tool name", result ? "result" : "call");
+        return ESP_OK;
+    }
+
+    int64_t server_timestamp_ms = cJSON_IsNumber(timestamp) ? (int64_t)timestamp->valuedouble : -1;
+    int32_t duration_ms = cJSON_IsNumber(duration) ? (int32_t)duration->valuedouble : -1;
+
+    /* Pending calls are matched by the call id as stored in the slots */
+    char id[ESP_AGENT_TOOL_STATS_CALL_ID_LEN] = {0};
+    if (call_id) {
+        strncpy(id, call_id, sizeof(id) - 1);
+    }
+
+    portENTER_CRITICAL(&table->lock);
+    if (call_id && !result) {
+        /* The oldest call is forgotten if its result never came */
+        esp_agent_tool_stats_pending_t *slot = &table->pending[0];
+        for (int i = 0; i < ESP_AGENT_TOOL_STATS_PENDING; i++) {
+            if (table->pending[i].call_id[0] == '\0') {
+                slot = &table->pending[i];
+                break;
+            }
+            if (table->pending[i].started_us < slot->started_us) {
+                slot = &table->pending[i];
+            }
+        }
+        memcpy(slot->call_id, id, sizeof(slot->call_id));
+        slot->started_us = now;
+        slot->server_timestamp_ms = server_timestamp_ms;
+    } else if (call_id) {
+        for (int i = 0; i < ESP_AGENT_TOOL_STATS_PENDING; i++) {
+            esp_agent_tool_stats_pending_t *slot = &table->pending[i];
+            if (slot->call_id[0] == '\0' || strcmp(slot->call_id, id) != 0) {
+                continue;
+            }
+            /* Server timestamps exclude the network jitter of the two messages, if both are present */
+            if (duration_ms < 0 && server_timestamp_ms >= 0 && slot->server_timestamp_ms >= 0) {
+                duration_ms = (int32_t)(server_timestamp_ms - slot->server_timestamp_ms);
+            }
+            if (duration_ms < 0) {
+                duration_ms = (int32_t)((now - slot->started_us) / 1000);
+            }
+            slot->call_id[0] = '\0';
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&table->lock);
+
+    if (result && duration_ms >= 0) {
+        esp_agent_tool_stats_record(handle, name, ESP_AGENT_TOOL_TIMING_CLOUD, duration_ms);
+    }
+
+    esp_agent_message_data_t event_data = {
+        .tool_info = {
+            .name = strdup(name),
+            .call_id = call_id ? strdup(call_id) : NULL,
+            .result = result,
+            .server_timestamp_ms = server_timestamp_ms,
+            .duration_ms = result ? duration_ms : -1,
+        },
+    };
+    return esp_agent_post_event(agent, ESP_AGENT_EVENT_TOOL_INFO, &event_data);
+}
+
+esp_err_t esp_agent_get_tool_stats(esp_agent_handle_t handle, esp_agent_tool_stats_t *stats, size_t max_tools, size_t *num_tools)
+{
+    if (handle == NULL || stats == NULL || num_tools == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_tool_stats_table_t *table = &agent->tool_stats;
+
+    portENTER_CRITICAL(&table->lock);
+    size_t count = table->count < max_tools ? table->count : max_tools;
+    memcpy(stats, table->tools, count * sizeof(esp_agent_tool_stats_t));
+    portEXIT_CRITICAL(&table->lock);
+
+    *num_tools = count;
+    return ESP_OK;
+}
@@ -7,81 +7,669 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
 #include <esp_log.h>
 #include <esp_check.h>
+#include <esp_timer.h>
 
 #include <esp_agent.h>
 #include <esp_agent_internal_tools.h>
 #include <esp_agent_websocket.h>
 #include <esp_agent_internal_messages.h>
+#include <esp_agent_internal_events.h>
+#include <esp_agent_internal_tool_stats.h>
+#include <esp_agent_internal_tool_dedup.h>
 
 static const char *TAG = "esp_agent_tools";
 
-typedef struct {
+typedef struct esp_agent_tool_request {
     char *request_id;
     char *tool_name;
     esp_agent_tool_param_t *parameters;
     size_t num_parameters;
     esp_agent_tool_handler_t tool_handler;
     void *user_data;
+    uint32_t cache_ttl_ms;
+    uint32_t cache_generation;      /* Of the cache when the tool started */
+    uint32_t stack_size;            /* 0 if the tool runs inline */
+    UBaseType_t priority;
+    BaseType_t core_id;
+    esp_agent_tool_serial_t *serial;    /* Referenced by the request, NULL if the tool is reentrant */
     esp_agent_handle_t handle;
+    struct esp_agent_tool_request *next;    /* In the pending calls */
 } tool_request_t;
 
-static void execute_tool_task(void *pvParameters)
+/* Queueing a response answered from the message task must not stall it for long */
+#define LOCAL_TOOL_RESPONSE_QUEUE_TIMEOUT_MS 1000
+
+static void free_parameters(esp_agent_tool_param_t *parameters, size_t num_parameters)
 {
-    tool_request_t *request = (tool_request_t *)pvParameters;
-    if (request == NULL) {
-        ESP_LOGE(TAG, "Invalid request");
-        vTaskDelete(NULL);
+    if (parameters == NULL) {
         return;
     }
+    for (size_t i = 0; i < num_parameters; i++) {
+        if (parameters[i].name) {
+            free((char *)parameters[i].name);
+        }
+        if (parameters[i].type == ESP_AGENT_PARAM_TYPE_STRING && parameters[i].value.s) {
+            free((char *)parameters[i].value.s);
+        }
+    }
+    free(parameters);
+}
+
+static void tool_request_free(tool_request_t *request)
+{
+    free(request->request_id);
+    free(request->tool_name);
+    free_parameters(request->parameters, request->num_parameters);
+    free(request);
+}
+
+static void tool_cache_store(esp_agent_t *agent, tool_request_t *request, char **result, uint32_t run_ms);
+static void tool_serial_release(esp_agent_t *agent, esp_agent_tool_serial_t *serial);
 
+/* Runs the tool and sends its response, then frees the request */
+static void run_tool_request(tool_request_t *request, TickType_t queue_timeout)
+{
     esp_agent_t *agent = (esp_agent_t *)request->handle;
     char *tool_result = NULL;
     ESP_LOGD(TAG, "Executing tool: %s", request->tool_name);
+    int64_t start = esp_timer_get_time();
     esp_err_t err = request->tool_handler(agent, request->tool_name, request->parameters, request->num_parameters, request->user_data, &tool_result);
+    uint32_t run_ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+    esp_agent_tool_stats_record(agent, request->tool_name, ESP_AGENT_TOOL_TIMING_LOCAL, run_ms);
+    if (request->stack_size) {
+        /* In bytes on ESP-IDF */
+        esp_agent_tool_stats_record_stack(agent, request->tool_name, request->stack_size, uxTaskGetStackHighWaterMark(NULL));
+    }
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to execute tool: 0x%x", err);
     }
     char *tool_response_json_str = esp_agent_messages_prepare_tool_response(agent, request->request_id, err, tool_result);
     if (tool_response_json_str == NULL) {
         ESP_LOGE(TAG, "Failed to prepare tool response");
+        esp_agent_tool_dedup_store(agent, request->request_id, NULL);
         goto end;
     }
     ESP_LOGD(TAG, "Tool response: %s", tool_response_json_str);
+    esp_agent_tool_dedup_store(agent, request->request_id, tool_response_json_str);
+    /* Cached before the response goes out, so that a request the server sends on it finds the result */
+    if (err == ESP_OK && request->cache_ttl_ms) {
+        tool_cache_store(agent, request, &tool_result, run_ms);
+    }
 
-    esp_err_t queue_err = esp_agent_websocket_queue_message(agent, WS_SEND_MSG_TYPE_TEXT, tool_response_json_str, strlen(tool_response_json_str), portMAX_DELAY);
+    esp_err_t queue_err = esp_agent_websocket_queue_message(agent, WS_SEND_MSG_TYPE_TEXT, tool_response_json_str, strlen(tool_response_json_str), queue_timeout);
     if (queue_err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to queue tool response: %d", queue_err);
+    } else {
+        esp_agent_transport_stats_count_message(&agent->transport_stats, ESP_AGENT_TRANSPORT_COUNTER_TX_TOOL, strlen(tool_response_json_str));
     }
     free(tool_response_json_str);
 
 end:
-    if (request->request_id) {
-        free(request->request_id);
+    free(tool_result);
+    tool_request_free(request);
+}
+
+/* Called with the execution lock held. The first pending call which may run now, taken out of the list and
+ * counted as running, NULL if none. A call to a non-reentrant tool waiting for the previous one does not
+ * hold back the calls behind it.
+ */
+static tool_request_t *tool_exec_next(esp_agent_tool_exec_t *exec)
+{
+    if (exec->running >= CONFIG_ESP_AGENT_TOOL_MAX_CONCURRENT) {
+        return NULL;
+    }
+
+    tool_request_t *prev = NULL;
+    for (tool_request_t *request = exec->pending; request != NULL; prev = request, request = request->next) {
+        if (request->serial && request->serial->busy) {
+            continue;
+        }
+        if (prev) {
+            prev->next = request->next;
+        } else {
+            exec->pending = request->next;
+        }
+        if (exec->pending_tail == request) {
+            exec->pending_tail = prev;
+        }
+        request->next = NULL;
+        if (request->serial) {
+            request->serial->busy = true;
+        }
+        if (++exec->running > exec->max_running) {
+            exec->max_running = exec->running;
+        }
+        return request;
+    }
+    return NULL;
+}
+
+/* A call ended or could not start: its slot and its tool are free for the next one */
+static void tool_exec_end(esp_agent_t *agent, esp_agent_tool_serial_t *serial)
+{
+    portENTER_CRITICAL(&agent->tool_exec.lock);
+    agent->tool_exec.running--;
+    if (serial) {
+        serial->busy = false;
+    }
+    portEXIT_CRITICAL(&agent->tool_exec.lock);
+
+    tool_serial_release(agent, serial);
+}
+
+static void execute_tool_task(void *pvParameters);
+
+/* Create the tasks of the pending calls which may run now */
+static void tool_exec_dispatch(esp_agent_t *agent)
+{
+    while (true) {
+        portENTER_CRITICAL(&agent->tool_exec.lock);
+        tool_request_t *request = tool_exec_next(&agent->tool_exec);
+        portEXIT_CRITICAL(&agent->tool_exec.lock);
+        if (request == NULL) {
+            return;
+        }
+
+        if (xTaskCreatePinnedToCore(execute_tool_task, "execute_tool_task", request->stack_size, request,
+                                    request->priority, NULL, request->core_id) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create the task of tool %s (%lu bytes of stack)", request->tool_name,
+                     (unsigned long)request->stack_size);
+            esp_agent_tool_dedup_store(agent, request->request_id, NULL);
+            tool_exec_end(agent, request->serial);
+            tool_request_free(request);
+        }
+    }
+}
+
+static void execute_tool_task(void *pvParameters)
+{
+    tool_request_t *request = (tool_request_t *)pvParameters;
+    esp_agent_t *agent = (esp_agent_t *)request->handle;
+    esp_agent_tool_serial_t *serial = request->serial;
+
+    /* The calls from the server are dispatched one at a time, only esp_agent_run_local_tool() may hold it */
+    if (serial) {
+        xSemaphoreTake(serial->mutex, portMAX_DELAY);
+    }
+    run_tool_request(request, portMAX_DELAY);
+    if (serial) {
+        xSemaphoreGive(serial->mutex);
+    }
+
+    tool_exec_end(agent, serial);
+    tool_exec_dispatch(agent);
+    vTaskDelete(NULL);
+}
+
+static esp_agent_tool_param_t *copy_parameters(const esp_agent_tool_param_t *params, size_t num_params)
+{
+    esp_agent_tool_param_t *copy = calloc(num_params, sizeof(esp_agent_tool_param_t));
+    if (copy == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < num_params; i++) {
+        copy[i].type = params[i].type;
+        copy[i].value = params[i].value;
+        copy[i].name = params[i].name ? strdup(params[i].name) : NULL;
+        if (params[i].type == ESP_AGENT_PARAM_TYPE_STRING && params[i].value.s) {
+            copy[i].value.s = strdup(params[i].value.s);
+        }
+        if ((params[i].name && copy[i].name == NULL) ||
+            (params[i].type == ESP_AGENT_PARAM_TYPE_STRING && params[i].value.s && copy[i].value.s == NULL)) {
+            free_parameters(copy, num_params);
+            return NULL;
+        }
+    }
+    return copy;
+}
+
+/* The server may send the parameters in any order */
+static bool parameters_match(const esp_agent_tool_param_t *a, size_t num_a, const esp_agent_tool_param_t *b, size_t num_b)
+{
+    if (num_a != num_b) {
+        return false;
+    }
+    for (size_t i = 0; i < num_a; i++) {
+        const esp_agent_tool_param_t *match = NULL;
+        for (size_t j = 0; j < num_b; j++) {
+            if (a[i].name && b[j].name && strcmp(a[i].name, b[j].name) == 0) {
+                match = &b[j];
+                break;
+            }
+        }
+        if (match == NULL || match->type != a[i].type) {
+            return false;
+        }
+        switch (a[i].type) {
+        case ESP_AGENT_PARAM_TYPE_INT:
+            if (a[i].value.i != match->value.i) {
+                return false;
+            }
+            break;
+        case ESP_AGENT_PARAM_TYPE_BOOL:
+            if (a[i].value.b != match->value.b) {
+                return false;
+            }
+            break;
+        case ESP_AGENT_PARAM_TYPE_STRING:
+            if (a[i].value.s == NULL || match->value.s == NULL || strcmp(a[i].value.s, match->value.s) != 0) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+static void local_tool_result_free(esp_agent_local_tool_result_t *local_result)
+{
+    free(local_result->tool_name);
+    free_parameters(local_result->parameters, local_result->num_parameters);
+    free(local_result->request_id);
+    free(local_result->result);
+}
+
+/* Move the result out of the agent, which is left empty. Must be called with the lock held. */
+static void local_tool_result_take(esp_agent_local_tool_result_t *slot, esp_agent_local_tool_result_t *local_result)
+{
+    *local_result = *slot;
+    slot->tool_name = NULL;
+    slot->parameters = NULL;
+    slot->num_parameters = 0;
+    slot->running = false;
+    slot->request_id = NULL;
+    slot->result = NULL;
+}
+
+esp_err_t esp_agent_tools_init(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+
+    memset(&agent->tool_cache, 0, sizeof(esp_agent_tool_cache_t));
+    agent->tool_cache.lock = xSemaphoreCreateMutex();
+
+    memset(&agent->tool_exec, 0, sizeof(esp_agent_tool_exec_t));
+    portMUX_INITIALIZE(&agent->tool_exec.lock);
+
+    memset(&agent->local_tool_result, 0, sizeof(esp_agent_local_tool_result_t));
+    agent->local_tool_result.lock = xSemaphoreCreateMutex();
+
+    return agent->tool_cache.lock && agent->local_tool_result.lock ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+static void tool_cache_entry_free(esp_agent_tool_cache_entry_t *entry)
+{
+    free(entry->tool_name);
+    free_parameters(entry->parameters, entry->num_parameters);
+    free(entry->result);
+    memset(entry, 0, sizeof(esp_agent_tool_cache_entry_t));
+}
+
+/* Drop a reference to the serialization mutex of a tool, deleting it with the last one */
+static void tool_serial_release(esp_agent_t *agent, esp_agent_tool_serial_t *serial)
+{
+    if (serial == NULL) {
+        return;
+    }
+
+    portENTER_CRITICAL(&agent->tool_exec.lock);
+    bool last = --serial->refs == 0;
+    portEXIT_CRITICAL(&agent->tool_exec.lock);
+
+    if (last) {
+        vSemaphoreDelete(serial->mutex);
+        free(serial);
+    }
+}
+
+static void tool_schema_free(esp_agent_tool_param_schema_t *schema, size_t num_schema)
+{
+    if (schema == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < num_schema; i++) {
+        free((char *)schema[i].name);
     }
-    if (request->tool_name) {
-        free(request->tool_name);
+    free(schema);
+}
+
+static esp_agent_tool_param_schema_t *tool_schema_copy(const esp_agent_tool_param_schema_t *schema, size_t num_schema)
+{
+    esp_agent_tool_param_schema_t *copy = calloc(num_schema, sizeof(esp_agent_tool_param_schema_t));
+    if (copy == NULL) {
+        return NULL;
     }
-    if (request->parameters) {
-        for (size_t i = 0; i < request->num_parameters; i++) {
-            if (request->parameters[i].name) {
-                free((char *)request->parameters[i].name);
+    for (size_t i = 0; i < num_schema; i++) {
+        copy[i] = schema[i];
+        copy[i].name = strdup(schema[i].name);
+        if (copy[i].name == NULL) {
+            tool_schema_free(copy, num_schema);
+            return NULL;
+        }
+    }
+    return copy;
+}
+
+static const char *tool_param_type_name(esp_agent_tool_param_type_t type)
+{
+    switch (type) {
+    case ESP_AGENT_PARAM_TYPE_INT:
+        return "number";
+    case ESP_AGENT_PARAM_TYPE_STRING:
+        return "string";
+    case ESP_AGENT_PARAM_TYPE_BOOL:
+        return "boolean";
+    default:
+        return "unknown";
+    }
+}
+
+/* Check the request against the declared parameters. On a violation, the error is written as a JSON object. */
+static bool tool_params_validate(const local_tool_node_t *tool_node, const esp_agent_tool_param_t *parameters, size_t num_parameters,
+                                 char *error, size_t error_len)
+{
+    for (size_t i = 0; i < tool_node->num_schema; i++) {
+        const esp_agent_tool_param_schema_t *schema = &tool_node->schema[i];
+        const esp_agent_tool_param_t *param = NULL;
+        for (size_t j = 0; j < num_parameters; j++) {
+            if (parameters[j].name && strcmp(parameters[j].name, schema->name) == 0) {
+                param = &parameters[j];
+                break;
             }
-            if (request->parameters[i].type == ESP_AGENT_PARAM_TYPE_STRING && request->parameters[i].value.s) {
-                free((char *)request->parameters[i].value.s);
+        }
+
+        if (param == NULL) {
+            if (!schema->required) {
+                continue;
             }
+            snprintf(error, error_len, "{\"error\":\"invalid_arguments\",\"parameter\":\"%s\",\"reason\":\"missing\"}", schema->name);
+            return false;
+        }
+        if (param->type != schema->type) {
+            snprintf(error, error_len, "{\"error\":\"invalid_arguments\",\"parameter\":\"%s\",\"reason\":\"wrong_type\",\"expected\":\"%s\"}",
+                     schema->name, tool_param_type_name(schema->type));
+            return false;
+        }
+        if (!schema->has_range) {
+            continue;
+        }
+
+        long value = 0;
+        if (param->type == ESP_AGENT_PARAM_TYPE_INT) {
+            value = param->value.i;
+        } else if (param->type == ESP_AGENT_PARAM_TYPE_STRING) {
+            value = param->value.s ? (long)strlen(param->value.s) : 0;
+        } else {
+            continue;
+        }
+        if (value < schema->min || value > schema->max) {
+            snprintf(error, error_len, "{\"error\":\"invalid_arguments\",\"parameter\":\"%s\",\"reason\":\"%s\",\"min\":%d,\"max\":%d}",
+                     schema->name, param->type == ESP_AGENT_PARAM_TYPE_STRING ? "length_out_of_range" : "out_of_range",
+                     schema->min, schema->max);
+            return false;
         }
-        free(request->parameters);
     }
-    if (tool_result) {
-        free(tool_result);
+    return true;
+}
+
+static void local_tool_node_free(esp_agent_t *agent, local_tool_node_t *tool_node)
+{
+    tool_schema_free(tool_node->schema, tool_node->num_schema);
+    tool_serial_release(agent, tool_node->serial);
+    free(tool_node->name);
+    free(tool_node);
+}
+
+void esp_agent_tools_deinit(esp_agent_handle_t handle)
+{
+    esp_agent_t *agent = (esp_agent_t *)handle;
+
+    local_tool_node_t *tool_node = agent->local_tools;
+    while (tool_node != NULL) {
+        local_tool_node_t *next_node = tool_node->next;
+        local_tool_node_free(agent, tool_node);
+        tool_node = next_node;
     }
-    free(request);
-    vTaskDelete(NULL);
+    agent->local_tools = NULL;
+
+    /* Calls which never got a slot */
+    while (agent->tool_exec.pending != NULL) {
+        tool_request_t *request = agent->tool_exec.pending;
+        agent->tool_exec.pending = request->next;
+        tool_serial_release(agent, request->serial);
+        tool_request_free(request);
+    }
+    agent->tool_exec.pending_tail = NULL;
+
+    if (agent->local_tool_result.lock) {
+        esp_agent_local_tool_result_t local_result;
+        local_tool_result_take(&agent->local_tool_result, &local_result);
+        local_tool_result_free(&local_result);
+        vSemaphoreDelete(agent->local_tool_result.lock);
+        agent->local_tool_result.lock = NULL;
+    }
+
+    if (agent->tool_cache.lock == NULL) {
+        return;
+    }
+    for (int i = 0; i < CONFIG_ESP_AGENT_TOOL_CACHE_ENTRIES; i++) {
+        tool_cache_entry_free(&agent->tool_cache.entries[i]);
+    }
+    vSemaphoreDelete(agent->tool_cache.lock);
+    agent->tool_cache.lock = NULL;
+}
+
+/* Takes the parameters and the result of the request */
+static void tool_cache_store(esp_agent_t *agent, tool_request_t *request, char **result, uint32_t run_ms)
+{
+    esp_agent_tool_cache_t *cache = &agent->tool_cache;
+    int64_t now = esp_timer_get_time();
+
+    if (*result == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(cache->lock, portMAX_DELAY);
+    if (cache->generation != request->cache_generation) {
+        /* Invalidated while the tool ran, the result may be stale already */
+        xSemaphoreGive(cache->lock);
+        return;
+    }
+    /* An entry of the same call, else a free or expired one, else the one expiring first */
+    esp_agent_tool_cache_entry_t *entry = &cache->entries[0];
+    for (int i = 0; i < CONFIG_ESP_AGENT_TOOL_CACHE_ENTRIES; i++) {
+        esp_agent_tool_cache_entry_t *candidate = &cache->entries[i];
+        if (candidate->tool_name && strcmp(candidate->tool_name, request->tool_name) == 0 &&
+                parameters_match(candidate->parameters, candidate->num_parameters, request->parameters, request->num_parameters)) {
+            entry = candidate;
+            break;
+        }
+        if (candidate->tool_name == NULL || candidate->expires_us < entry->expires_us) {
+            entry = candidate;
+        }
+    }
+    tool_cache_entry_free(entry);
+    entry->tool_name = request->tool_name;
+    entry->parameters = request->parameters;
+    entry->num_parameters = request->num_parameters;
+    entry->result = *result;
+    entry->expires_us = now + request->cache_ttl_ms * 1000LL;
+    entry->run_ms = run_ms;
+    xSemaphoreGive(cache->lock);
+
+    request->tool_name = NULL;
+    request->parameters = NULL;
+    request->num_parameters = 0;
+    *result = NULL;
+}
+
+/* A copy of the cached result of the same call, NULL if none. On a miss, `generation` is the one the result of the call is stored for. */
+static char *tool_cache_lookup(esp_agent_t *agent, const char *tool_name, esp_agent_tool_param_t *parameters, size_t num_parameters,
+                               uint32_t *generation)
+{
+    esp_agent_tool_cache_t *cache = &agent->tool_cache;
+    int64_t now = esp_timer_get_time();
+    char *result = NULL;
+
+    xSemaphoreTake(cache->lock, portMAX_DELAY);
+    *generation = cache->generation;
+    for (int i = 0; i < CONFIG_ESP_AGENT_TOOL_CACHE_ENTRIES; i++) {
+        esp_agent_tool_cache_entry_t *entry = &cache->entries[i];
+        if (entry->tool_name && strcmp(entry->tool_name, tool_name) == 0 && now < entry->expires_us &&
+                parameters_match(entry->parameters, entry->num_parameters, parameters, num_parameters)) {
+            result = strdup(entry->result);
+            if (result) {
+                cache->hits++;
+                cache->saved_ms += entry->run_ms;
+            }
+            break;
+        }
+    }
+    if (result == NULL) {
+        cache->misses++;
+    }
+    xSemaphoreGive(cache->lock);
+
+    return result;
+}
+
+esp_err_t esp_agent_invalidate_tool_cache(esp_agent_handle_t handle, const char *name)
+{
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_tool_cache_t *cache = &agent->tool_cache;
+
+    xSemaphoreTake(cache->lock, portMAX_DELAY);
+    for (int i = 0; i < CONFIG_ESP_AGENT_TOOL_CACHE_ENTRIES; i++) {
+        esp_agent_tool_cache_entry_t *entry = &cache->entries[i];
+        if (entry->tool_name && (name == NULL || strcmp(entry->tool_name, name) == 0)) {
+            tool_cache_entry_free(entry);
+            cache->invalidated++;
+        }
+    }
+    cache->generation++;
+    xSemaphoreGive(cache->lock);
+
+    return ESP_OK;
+}
+
+esp_err_t esp_agent_get_tool_cache_stats(esp_agent_handle_t handle, esp_agent_tool_cache_stats_t *stats)
+{
+    if (handle == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_tool_cache_t *cache = &agent->tool_cache;
+    int64_t now = esp_timer_get_time();
+
+    memset(stats, 0, sizeof(esp_agent_tool_cache_stats_t));
+    xSemaphoreTake(cache->lock, portMAX_DELAY);
+    stats->hits = cache->hits;
+    stats->misses = cache->misses;
+    stats->invalidated = cache->invalidated;
+    stats->saved_ms = cache->saved_ms;
+    for (int i = 0; i < CONFIG_ESP_AGENT_TOOL_CACHE_ENTRIES; i++) {
+        if (cache->entries[i].tool_name && now < cache->entries[i].expires_us) {
+            stats->entries++;
+        }
+    }
+    xSemaphoreGive(cache->lock);
+
+    return ESP_OK;
+}
+
+esp_err_t esp_agent_get_tool_exec_stats(esp_agent_handle_t handle, esp_agent_tool_exec_stats_t *stats)
+{
+    if (handle == NULL || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_tool_exec_t *exec = &agent->tool_exec;
+
+    portENTER_CRITICAL(&exec->lock);
+    stats->running = exec->running;
+    stats->max_running = exec->max_running;
+    stats->slot_waits = exec->slot_waits;
+    stats->serialized_waits = exec->serialized_waits;
+    stats->validated = exec->validated;
+    stats->rejected = exec->rejected;
+    stats->validation_us = exec->validation_us;
+    portEXIT_CRITICAL(&exec->lock);
+
+    return ESP_OK;
+}
+
+/* Queue the response to a tool request answered without running the tool */
+static void send_tool_response(esp_agent_t *agent, const char *request_id, esp_err_t status, char *result)
+{
+    char *tool_response_json_str = esp_agent_messages_prepare_tool_response(agent, (char *)request_id, status, result);
+    esp_agent_tool_dedup_store(agent, request_id, tool_response_json_str);
+    if (tool_response_json_str == NULL) {
+        ESP_LOGE(TAG, "Failed to prepare tool response");
+    } else if (esp_agent_websocket_queue_message(agent, WS_SEND_MSG_TYPE_TEXT, tool_response_json_str, strlen(tool_response_json_str),
+                                                 pdMS_TO_TICKS(LOCAL_TOOL_RESPONSE_QUEUE_TIMEOUT_MS)) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to queue tool response");
+    } else {
+        esp_agent_transport_stats_count_message(&agent->transport_stats, ESP_AGENT_TRANSPORT_COUNTER_TX_TOOL, strlen(tool_response_json_str));
+    }
+    free(tool_response_json_str);
+}
+
+/* Answer a tool request from the server with the result of the same tool run on the device, if any.
+ * If the tool is still running there, the request is answered by esp_agent_run_local_tool() when it returns.
+ */
+static bool answer_from_local_result(esp_agent_t *agent, const char *request_id, const char *tool_name,
+                                     esp_agent_tool_param_t *parameters, size_t num_parameters)
+{
+    esp_agent_local_tool_result_t *slot = &agent->local_tool_result;
+    esp_agent_local_tool_result_t local_result = {0};
+    int64_t now = esp_timer_get_time();
+
+    if (slot->lock == NULL || request_id == NULL) {
+        return false;
+    }
+
+    xSemaphoreTake(slot->lock, portMAX_DELAY);
+    bool found = slot->tool_name != NULL && strcmp(slot->tool_name, tool_name) == 0 &&
+                 (slot->running ? slot->request_id == NULL : now - slot->ran_at_us <= CONFIG_ESP_AGENT_LOCAL_TOOL_RESULT_TTL_MS * 1000LL) &&
+                 parameters_match(slot->parameters, slot->num_parameters, parameters, num_parameters);
+    bool running = found && slot->running;
+    if (running) {
+        slot->request_id = strdup(request_id);
+        found = slot->request_id != NULL;
+    } else if (found) {
+        /* Each local run answers a single request */
+        local_tool_result_take(slot, &local_result);
+    }
+    xSemaphoreGive(slot->lock);
+
+    if (!found) {
+        return false;
+    }
+    if (running) {
+        ESP_LOGI(TAG, "Tool %s requested by the server while it runs on the device, answering when it returns", tool_name);
+        return true;
+    }
+
+    ESP_LOGI(TAG, "Tool %s requested by the server %lld ms after it ran on the device, answering with that result",
+             tool_name, (long long)((now - local_result.ran_at_us) / 1000));
+
+    send_tool_response(agent, request_id, local_result.status, local_result.result);
+    local_tool_result_free(&local_result);
+    return true;
 }
 
 esp_err_t esp_agent_execute_tool(esp_agent_handle_t handle, char *request_id, char *tool_name, esp_agent_tool_param_t *parameters, size_t num_parameters)
@@ -95,9 +683,51 @@ esp_err_t esp_agent_execute_tool(esp_agent_handle_t handle, char *request_id, ch
     while (tool_node != NULL) {
         if (strcmp(tool_node->name, tool_name) == 0) {
             ESP_LOGD(TAG, "Found tool: %s", tool_name);
+            /* A request repeated after a reconnect or a server retry must not run the tool twice */
+            if (esp_agent_tool_dedup_check(agent, request_id)) {
+                free_parameters(parameters, num_parameters);
+                return ESP_OK;
+            }
+            /* Rejected from here, a malformed request costs neither a task nor a call to the tool */
+            if (tool_node->schema) {
+                char error[160];
+                int64_t start = esp_timer_get_time();
+                bool valid = tool_params_validate(tool_node, parameters, num_parameters, error, sizeof(error));
+                int64_t spent_us = esp_timer_get_time() - start;
+
+                portENTER_CRITICAL(&agent->tool_exec.lock);
+                agent->tool_exec.validated++;
+                agent->tool_exec.rejected += valid ? 0 : 1;
+                agent->tool_exec.validation_us += spent_us;
+                portEXIT_CRITICAL(&agent->tool_exec.lock);
+
+                if (!valid) {
+                    ESP_LOGW(TAG, "Tool %s request rejected: %s", tool_name, error);
+                    send_tool_response(agent, request_id, ESP_ERR_INVALID_ARG, error);
+                    free_parameters(parameters, num_parameters);
+                    return ESP_OK;
+                }
+            }
+            if (answer_from_local_result(agent, request_id, tool_name, parameters, num_parameters)) {
+                free_parameters(parameters, num_parameters);
+                return ESP_OK;
+            }
+            uint32_t cache_generation = 0;
+            if (tool_node->cache_ttl_ms) {
+                char *cached_result = tool_cache_lookup(agent, tool_name, parameters, num_parameters, &cache_generation);
+                if (cached_result) {
+                    ESP_LOGI(TAG, "Tool %s answered from the cache", tool_name);
+                    send_tool_response(agent, request_id, ESP_OK, cached_result);
+                    free(cached_result);
+                    free_parameters(parameters, num_parameters);
+                    return ESP_OK;
+                }
+            }
+
             tool_request_t *request = malloc(sizeof(tool_request_t));
             if (request == NULL) {
                 ESP_LOGE(TAG, "Failed to allocate memory for tool request");
+                esp_agent_tool_dedup_store(agent, request_id, NULL);
                 return ESP_ERR_NO_MEM;
             }
             request->request_id = strdup(request_id);
@@ -106,9 +736,49 @@ esp_err_t esp_agent_execute_tool(esp_agent_handle_t handle, char *request_id, ch
             request->num_parameters = num_parameters;
             request->tool_handler = tool_node->tool_handler;
             request->user_data = tool_node->user_data;
+            request->cache_ttl_ms = tool_node->cache_ttl_ms;
+            request->cache_generation = cache_generation;
+            request->stack_size = tool_node->exec_mode == ESP_AGENT_TOOL_EXEC_INLINE ? 0 : tool_node->stack_size;
+            request->priority = tool_node->priority;
+            request->core_id = tool_node->core_id;
+            request->serial = request->stack_size ? tool_node->serial : NULL;
             request->handle = handle;
+            request->next = NULL;
 
-            xTaskCreate(execute_tool_task, "execute_tool_task", 4096, request, 5, NULL);
+            esp_agent_message_data_t event_data = {
+                .tool = {
+                    .name = strdup(tool_name),
+                    .request_id = request_id ? strdup(request_id) : NULL,
+                },
+            };
+            esp_agent_post_event(agent, ESP_AGENT_EVENT_TOOL_CALL, &event_data);
+
+            if (request->stack_size == 0) {
+                /* Never blocks the message task for long, not even on a full send queue */
+                run_tool_request(request, pdMS_TO_TICKS(LOCAL_TOOL_RESPONSE_QUEUE_TIMEOUT_MS));
+                return ESP_OK;
+            }
+
+            /* Queued in arrival order, a task is only created once the call may run */
+            esp_agent_tool_exec_t *exec = &agent->tool_exec;
+            portENTER_CRITICAL(&exec->lock);
+            if (request->serial) {
+                request->serial->refs++;
+            }
+            if (request->serial && request->serial->busy) {
+                exec->serialized_waits++;
+            } else if (exec->running >= CONFIG_ESP_AGENT_TOOL_MAX_CONCURRENT) {
+                exec->slot_waits++;
+            }
+            if (exec->pending_tail) {
+                exec->pending_tail->next = request;
+            } else {
+                exec->pending = request;
+            }
+            exec->pending_tail = request;
+            portEXIT_CRITICAL(&exec->lock);
+
+            tool_exec_dispatch(agent);
             return ESP_OK;
         }
         tool_node = tool_node->next;
@@ -119,11 +789,34 @@ esp_err_t esp_agent_execute_tool(esp_agent_handle_t handle, char *request_id, ch
 
 esp_err_t esp_agent_register_local_tool(esp_agent_handle_t handle, const char *name, esp_agent_tool_handler_t tool_handler, void *user_data)
 {
-    if (handle == NULL || name == NULL || tool_handler == NULL) {
+    esp_agent_tool_config_t config = {
+        .name = name,
+        .handler = tool_handler,
+        .user_data = user_data,
+    };
+    return esp_agent_register_local_tool_with_config(handle, &config);
+}
+
+esp_err_t esp_agent_register_local_tool_with_config(esp_agent_handle_t handle, const esp_agent_tool_config_t *config)
+{
+    if (handle == NULL || config == NULL || config->name == NULL || config->handler == NULL ||
+            (config->params == NULL && config->num_params > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < config->num_params; i++) {
+        if (config->params[i].name == NULL || config->params[i].type >= ESP_AGENT_PARAM_TYPE_MAX ||
+                (config->params[i].has_range && config->params[i].min > config->params[i].max)) {
+            ESP_LOGE(TAG, "Invalid declaration of parameter %u of tool '%s'", (unsigned)i, config->name);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    if (config->pin_to_core && (config->core_id < 0 || config->core_id >= portNUM_PROCESSORS)) {
+        ESP_LOGE(TAG, "Invalid core %d for tool '%s'", config->core_id, config->name);
         return ESP_ERR_INVALID_ARG;
     }
 
     esp_agent_t *agent = (esp_agent_t *)handle;
+    const char *name = config->name;
 
     // Check for duplicate tool names
     local_tool_node_t *existing_node = agent->local_tools;
@@ -148,13 +841,46 @@ esp_err_t esp_agent_register_local_tool(esp_agent_handle_t handle, const char *n
         return ESP_ERR_NO_MEM;
     }
 
-    new_node->tool_handler = tool_handler;
-    new_node->user_data = user_data;
+    new_node->tool_handler = config->handler;
+    new_node->user_data = config->user_data;
+    new_node->cache_ttl_ms = config->cache_ttl_ms;
+    new_node->exec_mode = config->exec_mode;
+    new_node->stack_size = config->stack_size ? config->stack_size : CONFIG_ESP_AGENT_TOOL_TASK_STACK_SIZE;
+    new_node->priority = config->priority ? config->priority : CONFIG_ESP_AGENT_TOOL_TASK_PRIORITY;
+    new_node->core_id = config->pin_to_core ? config->core_id : tskNO_AFFINITY;
+    new_node->schema = NULL;
+    new_node->num_schema = 0;
+    new_node->serial = NULL;
+    if (config->params && config->num_params) {
+        new_node->schema = tool_schema_copy(config->params, config->num_params);
+        if (new_node->schema == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate the parameters of tool %s", name);
+            free(new_node->name);
+            free(new_node);
+            return ESP_ERR_NO_MEM;
+        }
+        new_node->num_schema = config->num_params;
+    }
+    if (config->non_reentrant) {
+        new_node->serial = calloc(1, sizeof(esp_agent_tool_serial_t));
+        if (new_node->serial) {
+            new_node->serial->mutex = xSemaphoreCreateMutex();
+            new_node->serial->refs = 1;
+        }
+        if (new_node->serial == NULL || new_node->serial->mutex == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate the serialization mutex of tool %s", name);
+            free(new_node->serial);
+            tool_schema_free(new_node->schema, new_node->num_schema);
+            free(new_node->name);
+            free(new_node);
+            return ESP_ERR_NO_MEM;
+        }
+    }
 
     new_node->next = agent->local_tools;
     agent->local_tools = new_node;
 
-    ESP_LOGI(TAG, "Registered local tool: %s", name);
+    ESP_LOGI(TAG, "Registered local tool: %s%s", name, new_node->exec_mode == ESP_AGENT_TOOL_EXEC_INLINE ? " (inline)" : "");
     return ESP_OK;
 }
 
@@ -178,10 +904,9 @@ esp_err_t esp_agent_unregister_local_tool(esp_agent_handle_t handle, const char
                 prev_node->next = tool_node->next;
             }
 
-            if (tool_node->name) {
-                free(tool_node->name);
-            }
-            free(tool_node);
+            /* Calls still running keep the serialization mutex */
+            local_tool_node_free(agent, tool_node);
+            esp_agent_invalidate_tool_cache(handle, name);
 
             ESP_LOGI(TAG, "Unregistered local tool: %s", name);
             return ESP_OK;
@@ -193,3 +918,141 @@ esp_err_t esp_agent_unregister_local_tool(esp_agent_handle_t handle, const char
     ESP_LOGW(TAG, "Tool with name '%s' not found", name);
     return ESP_ERR_NOT_FOUND;
 }
+
+#if CONFIG_ESP_AGENT_LOCAL_TOOL_RESULT_TTL_MS
+/* Store a local run before the tool runs. Returns the number of the run, 0 if it is not stored:
+ * the server request will then run the tool again.
+ */
+static uint32_t local_tool_result_start(esp_agent_t *agent, const char *name, const esp_agent_tool_param_t params[], size_t num_params)
+{
+    esp_agent_local_tool_result_t *slot = &agent->local_tool_result;
+    esp_agent_local_tool_result_t local_result = {
+        .tool_name = strdup(name),
+        .parameters = num_params ? copy_parameters(params, num_params) : NULL,
+        .num_parameters = num_params,
+    };
+    esp_agent_local_tool_result_t previous = {0};
+    uint32_t run = 0;
+
+    if (local_result.tool_name == NULL || (num_params && local_result.parameters == NULL)) {
+        ESP_LOGW(TAG, "Failed to allocate memory for the result of %s", name);
+        local_tool_result_free(&local_result);
+        return 0;
+    }
+
+    xSemaphoreTake(slot->lock, portMAX_DELAY);
+    /* A run still in progress keeps its place, a request may be waiting for it */
+    if (!slot->running) {
+        local_tool_result_take(slot, &previous);
+        /* 0 stands for a run which is not stored */
+        if (++slot->run == 0) {
+            slot->run = 1;
+        }
+        run = slot->run;
+        slot->tool_name = local_result.tool_name;
+        slot->parameters = local_result.parameters;
+        slot->num_parameters = local_result.num_parameters;
+        slot->running = true;
+        local_result.tool_name = NULL;
+        local_result.parameters = NULL;
+        local_result.num_parameters = 0;
+    }
+    xSemaphoreGive(slot->lock);
+
+    local_tool_result_free(&previous);
+    local_tool_result_free(&local_result);
+    return run;
+}
+
+/* Keep the result of a local run, or answer the server request received while it ran. Takes the result. */
+static void local_tool_result_end(esp_agent_t *agent, uint32_t run, esp_err_t status, char *result, int64_t ran_at_us)
+{
+    esp_agent_local_tool_result_t *slot = &agent->local_tool_result;
+    esp_agent_local_tool_result_t answered = {0};
+
+    if (run != 0) {
+        xSemaphoreTake(slot->lock, portMAX_DELAY);
+        if (slot->run == run && slot->running) {
+            slot->running = false;
+            slot->status = status;
+            slot->result = result;
+            slot->ran_at_us = ran_at_us;
+            result = NULL;
+            if (slot->request_id) {
+                local_tool_result_take(slot, &answered);
+            }
+        }
+        xSemaphoreGive(slot->lock);
+    }
+    free(result);
+
+    if (answered.request_id) {
+        ESP_LOGI(TAG, "Tool %s returned on the device, answering the request received meanwhile", answered.tool_name);
+        send_tool_response(agent, answered.request_id, answered.status, answered.result);
+        local_tool_result_free(&answered);
+    }
+}
+#endif
+
+esp_err_t esp_agent_run_local_tool(esp_agent_handle_t handle, const char *name, const esp_agent_tool_param_t params[], size_t num_params)
+{
+    if (handle == NULL || name == NULL || (params == NULL && num_params > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    local_tool_node_t *tool_node = agent->local_tools;
+    while (tool_node != NULL && strcmp(tool_node->name, name) != 0) {
+        tool_node = tool_node->next;
+    }
+    if (tool_node == NULL) {
+        ESP_LOGE(TAG, "Tool with name '%s' not found", name);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+#if CONFIG_ESP_AGENT_LOCAL_TOOL_RESULT_TTL_MS
+    /* Stored first, so that a server request for the same call waits for this run rather than runs the tool again */
+    uint32_t run = local_tool_result_start(agent, name, params, num_params);
+#endif
+
+    /* One at a time with the calls from the server to a non-reentrant tool */
+    esp_agent_tool_serial_t *serial = tool_node->serial;
+    if (serial) {
+        portENTER_CRITICAL(&agent->tool_exec.lock);
+        serial->refs++;
+        portEXIT_CRITICAL(&agent->tool_exec.lock);
+        if (xSemaphoreTake(serial->mutex, 0) != pdTRUE) {
+            portENTER_CRITICAL(&agent->tool_exec.lock);
+            agent->tool_exec.serialized_waits++;
+            portEXIT_CRITICAL(&agent->tool_exec.lock);
+            xSemaphoreTake(serial->mutex, portMAX_DELAY);
+        }
+    }
+
+    int64_t start = esp_timer_get_time();
+    char *tool_result = NULL;
+    esp_err_t err = tool_node->tool_handler(handle, tool_node->name, (esp_agent_tool_param_t *)params, num_params, tool_node->user_data, &tool_result);
+    int64_t end = esp_timer_get_time();
+    if (serial) {
+        xSemaphoreGive(serial->mutex);
+        tool_serial_release(agent, serial);
+    }
+    ESP_LOGI(TAG, "Ran tool %s on the device in %lld us: 0x%x", name, (long long)(end - start), err);
+    esp_agent_tool_stats_record(handle, name, ESP_AGENT_TOOL_TIMING_LOCAL, (uint32_t)((end - start) / 1000));
+
+    esp_agent_message_data_t event_data = {
+        .tool = {
+            .name = strdup(name),
+            .request_id = NULL,
+        },
+    };
+    esp_agent_post_event(agent, ESP_AGENT_EVENT_TOOL_CALL, &event_data);
+
+#if CONFIG_ESP_AGENT_LOCAL_TOOL_RESULT_TTL_MS
+    local_tool_result_end(agent, run, err, tool_result, end);
+#else
+    free(tool_result);
+#endif
+
+    return err;
+}
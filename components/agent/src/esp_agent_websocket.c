@@ -31,18 +31,317 @@ static const char *TAG = "esp_agent_ws";
 
 #define ACCESS_TOKEN_EXPIRATION_SECONDS 3600
 
-void esp_agent_websocket_send_task(void *pvParameters)
+/* A write blocked for longer than this counts as a stall of the send path */
+#define WS_WRITE_STALL_US (50 * 1000)
+#define WS_WRITE_DEADLINE_US (CONFIG_ESP_AGENT_WRITE_DEADLINE_MS * 1000LL)
+
+/* Text the send task holds while waiting for the handshake ack, more waits in the send queue */
+#if CONFIG_ESP_AGENT_RESUME
+#define WS_HELD_MAX CONFIG_ESP_AGENT_RESUME_BUFFER_SIZE
+#else
+#define WS_HELD_MAX 1
+#endif
+
+/* Longest wait of esp_agent_stop() for the send task to empty its queue, past a blocked write */
+#define WS_PURGE_WAIT_MS (CONFIG_ESP_AGENT_WRITE_DEADLINE_MS + 500)
+
+/* Reassembly buffer capacity kept between sessions, larger buffers are released on disconnect */
+#define RX_BUFFER_PARKED_MAX (4 * 1024)
+
+/* Write progress of the connection, kept by the send task across messages */
+typedef struct {
+    int64_t progress_us;        /* Last write that completed, the connect, or the start of a message after a complete one */
+    bool completed;             /* The last message was written in full */
+} ws_send_progress_t;
+
+/* Client frames carry a 4 byte mask key after the 2 byte header and the extended length */
+static size_t ws_frame_header_len(size_t payload_len)
+{
+    return 2 + 4 + (payload_len > UINT16_MAX ? 8 : payload_len > 125 ? 2 : 0);
+}
+
+/* Write one websocket frame, within what is left of the write deadline since the last progress */
+static int ws_write(esp_agent_t *agent, ws_transport_opcodes_t opcode, const char *data, size_t len, bool fragment, int64_t *progress_us)
+{
+    int64_t start_us = esp_timer_get_time();
+    int64_t left_us = WS_WRITE_DEADLINE_US - (start_us - *progress_us);
+    TickType_t timeout = left_us > 0 ? pdMS_TO_TICKS(left_us / 1000) : 0;
+    if (timeout == 0) {
+        timeout = 1;
+    }
+
+    int ret;
+    if (fragment) {
+        ret = esp_websocket_client_send_with_exact_opcode(agent->ws_client, opcode, (const uint8_t *)data, len, timeout);
+    } else {
+        ret = esp_websocket_client_send_with_opcode(agent->ws_client, opcode, (const uint8_t *)data, len, timeout);
+    }
+
+    int64_t end_us = esp_timer_get_time();
+    int64_t write_us = end_us - start_us;
+    bool deadline_expired = ret < 0 && end_us - *progress_us >= WS_WRITE_DEADLINE_US;
+    if (deadline_expired) {
+        ESP_LOGE(TAG, "No write progress for %d ms", CONFIG_ESP_AGENT_WRITE_DEADLINE_MS);
+    }
+    esp_agent_transport_stats_count_write(&agent->transport_stats, write_us > UINT32_MAX ? UINT32_MAX : (uint32_t)write_us,
+                                          write_us > WS_WRITE_STALL_US, deadline_expired);
+    if (ret >= 0) {
+        *progress_us = end_us;
+    }
+    return ret;
+}
+
+/* Control frames may be sent between the fragments of a message, so that a long message does not delay keep-alive pings */
+static void ws_send_pending_ping(esp_agent_t *agent, int64_t *progress_us)
 {
-    esp_agent_t *agent = (esp_agent_t *)pvParameters;
     ws_send_message_t *msg = NULL;
+
+    if (xQueuePeek(agent->send_queue, &msg, 0) != pdTRUE || msg == NULL || msg->type != WS_SEND_MSG_TYPE_PING) {
+        return;
+    }
+    /* Only the send task takes messages from the queue, esp_agent_stop() leaves the purge to it */
+    ws_send_message_t *taken = NULL;
+    if (xQueueReceive(agent->send_queue, &taken, 0) != pdTRUE || taken != msg) {
+        ESP_LOGE(TAG, "Send queue changed under the send task");
+        if (taken) {
+            xQueueSendToFront(agent->send_queue, &taken, 0);
+        }
+        return;
+    }
+    esp_agent_transport_stats_count_queue_latency(&agent->transport_stats, ESP_AGENT_TRANSPORT_QUEUE_SEND, msg->queued_at_us);
+    if (ws_write(agent, WS_TRANSPORT_OPCODES_PING, msg->payload, msg->len, false, progress_us) < 0) {
+        esp_agent_transport_stats_count_drop(&agent->transport_stats, true);
+    }
+    free(msg->payload);
+    free(msg);
+}
+
+/* Close the connection in the middle of a fragmented message. The next message cannot go on it, as a
+ * new data frame may not start before the last fragment (RFC 6455 5.4), and the server drops the
+ * unfinished message rather than waiting for its last fragment. The close waits for the websocket
+ * task, which is stopped without the handshake if the server does not answer.
+ */
+static void ws_abort_message(esp_agent_t *agent)
+{
+    if (esp_websocket_client_is_connected(agent->ws_client)) {
+        esp_websocket_client_close(agent->ws_client, pdMS_TO_TICKS(100));
+    }
+}
+
+/* Send a message, in fragments of CONFIG_ESP_AGENT_SEND_FRAGMENT_SIZE if it is larger */
+static int ws_send(esp_agent_t *agent, ws_send_message_t *msg, ws_transport_opcodes_t opcode, int64_t *progress_us)
+{
+    if (opcode == WS_TRANSPORT_OPCODES_PING || msg->len <= CONFIG_ESP_AGENT_SEND_FRAGMENT_SIZE) {
+        return ws_write(agent, opcode, msg->payload, msg->len, false, progress_us);
+    }
+
+    size_t offset = 0;
+    uint32_t fragments = 0;
+    while (offset < msg->len) {
+        size_t chunk = msg->len - offset;
+        if (chunk > CONFIG_ESP_AGENT_SEND_FRAGMENT_SIZE) {
+            chunk = CONFIG_ESP_AGENT_SEND_FRAGMENT_SIZE;
+        }
+        bool last = offset + chunk == msg->len;
+        ws_transport_opcodes_t frame_opcode = offset == 0 ? opcode : WS_TRANSPORT_OPCODES_CONT;
+        if (last) {
+            frame_opcode |= WS_TRANSPORT_OPCODES_FIN;
+        }
+
+        if (ws_write(agent, frame_opcode, msg->payload + offset, chunk, true, progress_us) < 0) {
+            if (fragments > 0) {
+                ESP_LOGE(TAG, "Fragment %lu of a %u byte message failed, closing the connection", (unsigned long)fragments,
+                         (unsigned)msg->len);
+                ws_abort_message(agent);
+            }
+            return -1;
+        }
+        offset += chunk;
+        fragments++;
+
+        if (!last) {
+            ws_send_pending_ping(agent, progress_us);
+            if (xEventGroupGetBits(agent->event_group) & SEND_TASK_STOP_BIT) {
+                ws_abort_message(agent);
+                return -1;
+            }
+        }
+    }
+
+    esp_agent_transport_stats_count_fragmented(&agent->transport_stats, fragments);
+    return (int)offset;
+}
+
+/* Send a message taken from the send queue, then free it. Returns whether it was sent */
+static bool ws_send_message(esp_agent_t *agent, ws_send_message_t *msg, ws_send_progress_t *progress)
+{
     int ws_ret = -1;
-    esp_err_t ret = ESP_OK;
     ws_transport_opcodes_t send_opcode;
+    uint32_t frames = 0;
+    int64_t collected_us = 0;
+    int64_t send_us = 0;
 
-    ESP_LOGD(TAG, "WebSocket Send Task Started");
+    esp_agent_transport_stats_count_queue_latency(&agent->transport_stats, ESP_AGENT_TRANSPORT_QUEUE_SEND, msg->queued_at_us);
+
+    if (!esp_websocket_client_is_connected(agent->ws_client)) {
+        ESP_LOGE(TAG, "WebSocket not connected, dropping message");
+        esp_agent_transport_stats_count_drop(&agent->transport_stats, true);
+        goto deallocate_message;
+    }
+
+    switch (msg->type) {
+        case WS_SEND_MSG_TYPE_TEXT:
+        case WS_SEND_MSG_TYPE_TEXT_UNSEQUENCED:
+            send_opcode = WS_TRANSPORT_OPCODES_TEXT;
+            break;
+        case WS_SEND_MSG_TYPE_BINARY:
+            send_opcode = WS_TRANSPORT_OPCODES_BINARY;
+            break;
+        case WS_SEND_MSG_TYPE_PING:
+            send_opcode = WS_TRANSPORT_OPCODES_PING;
+            break;
+        default:
+            goto deallocate_message;
+    }
+
+    /* Sequenced here, so that sequence numbers follow the order in which messages are sent */
+    if (msg->type == WS_SEND_MSG_TYPE_TEXT) {
+        size_t sequenced_len = 0;
+        char *sequenced = esp_agent_resume_sequence(agent, msg->payload, msg->len, &sequenced_len);
+        if (sequenced) {
+            free(msg->payload);
+            msg->payload = sequenced;
+            msg->len = sequenced_len;
+        }
+    }
+
+    /* Compressed here rather than when queued, so that callers do not pay for it */
+    if (msg->type == WS_SEND_MSG_TYPE_TEXT || msg->type == WS_SEND_MSG_TYPE_TEXT_UNSEQUENCED) {
+        size_t compressed_len = 0;
+        char *compressed = esp_agent_compression_compress(agent, msg->payload, msg->len, &compressed_len);
+        if (compressed) {
+            free(msg->payload);
+            msg->payload = compressed;
+            msg->len = compressed_len;
+        }
+    }
+
+    /* Audio frames waiting behind this one go in the same message */
+    if (msg->type == WS_SEND_MSG_TYPE_BINARY) {
+        collected_us = esp_timer_get_time();
+        frames = esp_agent_aggregation_collect(agent, msg);
+        collected_us = esp_timer_get_time() - collected_us;
+        if (frames == 0) {
+            esp_agent_transport_stats_count_drop(&agent->transport_stats, true);
+            goto deallocate_message;
+        }
+    }
+
+    /* The write deadline runs from the last progress of the connection: the connect, or the last
+     * message written in full, as the time spent waiting for the next one is not a stall. After a
+     * failed write, the next message only gets what is left of it.
+     */
+    send_us = esp_timer_get_time();
+    if (xEventGroupClearBits(agent->event_group, SEND_PROGRESS_RESET_BIT) & SEND_PROGRESS_RESET_BIT || progress->completed) {
+        progress->progress_us = send_us;
+    }
+    ws_ret = ws_send(agent, msg, send_opcode, &progress->progress_us);
+    progress->completed = ws_ret >= 0;
+    send_us = esp_timer_get_time() - send_us;
+    if (ws_ret < 0) {
+        ESP_LOGE(TAG, "Failed to send message: %d", ws_ret);
+        esp_agent_transport_stats_count_drop(&agent->transport_stats, true);
+    } else if (msg->type == WS_SEND_MSG_TYPE_PING) {
+        /* Keep-alive pings are not counted as messages */
+    } else if (msg->type == WS_SEND_MSG_TYPE_BINARY) {
+        esp_agent_connection_activity(agent);
+        esp_agent_transport_stats_count_message(&agent->transport_stats, ESP_AGENT_TRANSPORT_COUNTER_TX_AUDIO, msg->len);
+        size_t prefix_len = agent->aggregation.negotiated ? frames * 2 : 0;
+        esp_agent_transport_stats_count_audio_uplink(&agent->transport_stats, frames, ws_frame_header_len(msg->len) + prefix_len,
+                                                     (uint32_t)collected_us);
+        esp_agent_aggregation_sent(agent, frames, send_us);
+        esp_agent_latency_mark(agent, ESP_AGENT_LATENCY_STAGE_UPLINK_LAST_FRAME);
+    } else {
+        esp_agent_connection_activity(agent);
+        esp_agent_transport_stats_count_message(&agent->transport_stats, ESP_AGENT_TRANSPORT_COUNTER_TX_TEXT, msg->len);
+    }
+
+deallocate_message:
+    if (msg->payload) {
+        free(msg->payload);
+    }
+    free(msg);
+    return ws_ret >= 0;
+}
+
+/* Once the server accepted the resume: the messages it missed, then the text held until the ack */
+static void ws_send_resumed(esp_agent_t *agent, ws_send_message_t **held, size_t *held_count, ws_send_progress_t *progress)
+{
+    size_t count = 0;
+    size_t replayed = 0;
+    size_t replayed_bytes = 0;
+    esp_agent_resume_entry_t *replay = esp_agent_resume_take_replay(agent, &count);
+
+    for (size_t i = 0; i < count; i++) {
+        ws_send_message_t *msg = malloc(sizeof(ws_send_message_t));
+        if (msg == NULL) {
+            free(replay[i].payload);
+            continue;
+        }
+        /* Already sequenced, sent as is */
+        *msg = (ws_send_message_t) {
+            .type = WS_SEND_MSG_TYPE_TEXT_UNSEQUENCED,
+            .payload = replay[i].payload,
+            .len = replay[i].len,
+            .queued_at_us = esp_timer_get_time(),
+        };
+        size_t len = replay[i].len;
+        if (ws_send_message(agent, msg, progress)) {
+            replayed++;
+            replayed_bytes += len;
+        }
+    }
+    free(replay);
+    if (count) {
+        esp_agent_resume_replayed(agent, replayed, replayed_bytes);
+    }
+
+    for (size_t i = 0; i < *held_count; i++) {
+        ws_send_message(agent, held[i], progress);
+    }
+    *held_count = 0;
+}
+
+/* Drop the queued and held messages of a stopped session */
+static void ws_send_queue_purge(esp_agent_t *agent, ws_send_message_t **held, size_t *held_count)
+{
+    ws_send_message_t *msg = NULL;
+
+    while (xQueueReceive(agent->send_queue, &msg, 0) == pdTRUE) {
+        if (msg) {
+            free(msg->payload);
+            free(msg);
+        }
+    }
+    for (size_t i = 0; i < *held_count; i++) {
+        free(held[i]->payload);
+        free(held[i]);
+    }
+    *held_count = 0;
+}
+
+void esp_agent_websocket_send_task(void *pvParameters)
+{
+    esp_agent_t *agent = (esp_agent_t *)pvParameters;
+    ws_send_message_t *msg = NULL;
+    ws_send_message_t *held[WS_HELD_MAX];
+    size_t held_count = 0;
+    ws_send_progress_t progress = {
+        .progress_us = esp_timer_get_time(),
+        .completed = true,
+    };
 
-    /* Just to avoid compiler warning */
-    if (ret) {}
+    ESP_LOGD(TAG, "WebSocket Send Task Started");
 
     while (1) {
         /* Check for stop event first (non-blocking) */
@@ -51,39 +350,40 @@ void esp_agent_websocket_send_task(void *pvParameters)
             ESP_LOGD(TAG, "WebSocket Send Task received stop signal, exiting");
             break;
         }
+        if (bits & SEND_QUEUE_PURGE_BIT) {
+            ws_send_queue_purge(agent, held, &held_count);
+            xEventGroupClearBits(agent->event_group, SEND_QUEUE_PURGE_BIT);
+            xEventGroupSetBits(agent->event_group, SEND_QUEUE_PURGED_BIT);
+        }
+
+        bool holding = esp_agent_resume_holding(agent);
+        if (!holding) {
+            ws_send_resumed(agent, held, &held_count, &progress);
+        } else if (held_count == WS_HELD_MAX) {
+            /* The rest waits in the send queue until the ack */
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
 
         /* Try to receive message with timeout */
-        if (xQueueReceive(agent->send_queue, &msg, pdMS_TO_TICKS(100)) == pdTRUE) {
+        if (xQueueReceive(agent->send_queue, &msg, pdMS_TO_TICKS(holding ? 10 : 100)) == pdTRUE) {
             if (msg == NULL) {
                 continue;
             }
-
-            ESP_GOTO_ON_FALSE(esp_websocket_client_is_connected(agent->ws_client), ESP_ERR_INVALID_STATE, deallocate_message, TAG, "WebSocket not connected, dropping message");
-
-            switch (msg->type) {
-                case WS_SEND_MSG_TYPE_TEXT:
-                    send_opcode = WS_TRANSPORT_OPCODES_TEXT;
-                    break;
-                case WS_SEND_MSG_TYPE_BINARY:
-                    send_opcode = WS_TRANSPORT_OPCODES_BINARY;
-                    break;
-                default:
-                    goto deallocate_message;
-            }
-
-            ws_ret = esp_websocket_client_send_with_opcode(agent->ws_client, send_opcode, (const uint8_t *)msg->payload, msg->len, pdMS_TO_TICKS(5000));
-            if (ws_ret < 0) {
-                ESP_LOGE(TAG, "Failed to send message: %d", ws_ret);
-            }
-
-        deallocate_message:
-            if (msg->payload) {
-                free(msg->payload);
+            if (msg->type == WS_SEND_MSG_TYPE_TEXT) {
+                if (esp_agent_resume_holding(agent)) {
+                    held[held_count++] = msg;
+                    continue;
+                }
+                /* The ack may have arrived since the check above, the replay goes first */
+                ws_send_resumed(agent, held, &held_count, &progress);
             }
-            free(msg);
+            ws_send_message(agent, msg, &progress);
         }
     }
 
+    ws_send_queue_purge(agent, held, &held_count);
+
     ESP_LOGD(TAG, "WebSocket Send Task exiting cleanly");
     vTaskDelete(NULL);
 }
@@ -96,7 +396,7 @@ esp_err_t esp_agent_websocket_queue_message(esp_agent_handle_t handle, ws_send_m
 
     esp_agent_t *agent = (esp_agent_t *)handle;
 
-    if (!agent->started) {
+    if (!esp_agent_is_started(agent)) {
         ESP_LOGW(TAG, "Agent not started, cannot queue message");
         return ESP_ERR_INVALID_STATE;
     }
@@ -114,13 +414,23 @@ esp_err_t esp_agent_websocket_queue_message(esp_agent_handle_t handle, ws_send_m
 
     esp_err_t ret = ESP_OK;
 
-    msg->payload = malloc(len);
+    bool text = type == WS_SEND_MSG_TYPE_TEXT || type == WS_SEND_MSG_TYPE_TEXT_UNSEQUENCED;
+    msg->payload = esp_agent_mem_dup(agent, text ? ESP_AGENT_MEM_TX_TEXT : ESP_AGENT_MEM_TX_AUDIO, payload, len);
     ESP_GOTO_ON_FALSE(msg->payload, ESP_ERR_NO_MEM, error, TAG, "Failed to allocate memory for payload");
-    memcpy(msg->payload, payload, len);
     msg->type = type;
     msg->len = len;
-
-    ESP_GOTO_ON_FALSE(xQueueSend(agent->send_queue, &msg, timeout), ESP_ERR_TIMEOUT, error, TAG, "Failed to queue message (queue full), dropping");
+    msg->queued_at_us = esp_timer_get_time();
+    esp_agent_transport_stats_count_copy(&agent->transport_stats, len, 2);
+
+    /* Pings go ahead of the queued messages, or a queue full of audio would delay them into a missed pong */
+    BaseType_t queued = type == WS_SEND_MSG_TYPE_PING ? xQueueSendToFront(agent->send_queue, &msg, timeout) :
+                        xQueueSend(agent->send_queue, &msg, timeout);
+    if (queued != pdTRUE) {
+        ESP_LOGE(TAG, "Failed to queue message (queue full), dropping");
+        esp_agent_transport_stats_count_drop(&agent->transport_stats, true);
+        ret = ESP_ERR_TIMEOUT;
+        goto error;
+    }
 
     ESP_LOGV(TAG, "Queued %s message: %d bytes", type == WS_SEND_MSG_TYPE_TEXT ? "text" : "binary", len);
     return ret;
@@ -169,6 +479,7 @@ esp_err_t esp_agent_websocket_start(esp_agent_handle_t handle)
     size_t access_token_len = 0;
     char *ws_uri = NULL;
     size_t ws_uri_len = 0;
+    bool token_cached = false;
     const int64_t access_token_margin_us = (int64_t)(ACCESS_TOKEN_EXPIRATION_SECONDS - 10) * 1000000LL;
     /* Check if access token is expired or not set, leave 10 seconds margin */
     if (agent->access_token == NULL || (esp_timer_get_time() - agent->access_token_timestamp > access_token_margin_us)) {
@@ -180,6 +491,7 @@ esp_err_t esp_agent_websocket_start(esp_agent_handle_t handle)
         agent->access_token_timestamp = esp_timer_get_time();
         ESP_LOGD(TAG, "Access token: %s", agent->access_token);
     } else {
+        token_cached = true;
         ESP_LOGI(TAG, "Using existing access token, will expire in %lld seconds", (ACCESS_TOKEN_EXPIRATION_SECONDS - (esp_timer_get_time() - agent->access_token_timestamp) / 1000000));
     }
 
@@ -189,6 +501,7 @@ esp_err_t esp_agent_websocket_start(esp_agent_handle_t handle)
     esp_websocket_client_set_uri(agent->ws_client, ws_uri);
 
     ESP_LOGI(TAG, "Starting agent");
+    esp_agent_connection_connecting(agent, token_cached && agent->conversation_id != NULL);
 
     ESP_GOTO_ON_ERROR(esp_websocket_client_start(agent->ws_client), end, TAG, "Failed to start websocket client");
 
@@ -199,16 +512,12 @@ end:
     return ret;
 }
 
-/* Start the agent connection */
-esp_err_t esp_agent_start(esp_agent_handle_t handle, const char *conversation_id)
+static esp_err_t agent_start(esp_agent_t *agent, const char *conversation_id)
 {
-    if (handle == NULL) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_handle_t handle = (esp_agent_handle_t)agent;
+    int64_t call_start_us = esp_timer_get_time();
 
-    if (agent->started) {
+    if (esp_agent_is_started(agent)) {
         ESP_LOGW(TAG, "Agent already started");
         return ESP_OK;
     }
@@ -243,52 +552,86 @@ esp_err_t esp_agent_start(esp_agent_handle_t handle, const char *conversation_id
         return err;
     }
 
-    agent->started = true;
+    esp_agent_set_started(agent);
+    esp_agent_usage_session_start(handle);
+    esp_agent_connection_started(handle, esp_timer_get_time() - call_start_us);
     return ESP_OK;
 }
 
-/* Stop the agent connection */
-esp_err_t esp_agent_stop(esp_agent_handle_t handle)
+/* Start the agent connection */
+esp_err_t esp_agent_start(esp_agent_handle_t handle, const char *conversation_id)
 {
     if (handle == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
 
     esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_start_stop_lock(agent);
+    esp_err_t err = agent_start(agent, conversation_id);
+    esp_agent_start_stop_unlock(agent);
+    return err;
+}
+
+static esp_err_t agent_stop(esp_agent_t *agent)
+{
+    esp_agent_handle_t handle = (esp_agent_handle_t)agent;
+    int64_t call_start_us = esp_timer_get_time();
 
-    if (!agent->started) {
+    if (!esp_agent_is_started(agent)) {
         ESP_LOGW(TAG, "Agent not started");
         return ESP_OK;
     }
 
     ESP_LOGI(TAG, "Stopping agent");
 
-    /* Stop websocket connection */
-    if (agent->connected) {
+    /* Text and speech of this conversation still waiting for the event loop are not delivered */
+    esp_agent_events_backlog_clear(handle);
+
+    esp_agent_keepalive_stop(handle);
+    esp_agent_connection_closed(handle);
+    esp_agent_resume_disconnected(handle, false);
+
+    /* Stop websocket connection. A connect still in progress is stopped too, or the next start
+     * would find the websocket task running. The client itself is kept for the next session.
+     */
+    if (esp_agent_is_connected(agent)) {
         esp_websocket_client_close(agent->ws_client, pdMS_TO_TICKS(100));
-        esp_websocket_client_stop(agent->ws_client);
     }
+    esp_websocket_client_stop(agent->ws_client);
 
-    agent->started = false;
-    agent->connected = false;
+    esp_agent_clear_started(agent);
     agent->handshake_state = ESP_AGENT_HANDSHAKE_NOT_DONE;
 
-    // Purge any remaining messages in send queue
-    if (agent->send_queue) {
-        ws_send_message_t *msg = NULL;
-        while (xQueueReceive(agent->send_queue, &msg, 0) == pdTRUE) {
-            if (msg) {
-                if (msg->payload) {
-                    free(msg->payload);
-                }
-                free(msg);
-            }
-        }
+    /* Purge any remaining messages in send queue. The send task does it, as it may be taking a
+     * message from the queue right now; the NULL message wakes it up.
+     */
+    ws_send_message_t *wakeup = NULL;
+    xEventGroupClearBits(agent->event_group, SEND_QUEUE_PURGED_BIT);
+    xEventGroupSetBits(agent->event_group, SEND_QUEUE_PURGE_BIT);
+    xQueueSendToFront(agent->send_queue, &wakeup, 0);
+    EventBits_t bits = xEventGroupWaitBits(agent->event_group, SEND_QUEUE_PURGED_BIT, pdTRUE, pdTRUE, pdMS_TO_TICKS(WS_PURGE_WAIT_MS));
+    if (!(bits & SEND_QUEUE_PURGED_BIT)) {
+        ESP_LOGW(TAG, "Send queue not purged within %d ms", WS_PURGE_WAIT_MS);
     }
 
+    esp_agent_connection_stopped(handle, esp_timer_get_time() - call_start_us);
     return ESP_OK;
 }
 
+/* Stop the agent connection */
+esp_err_t esp_agent_stop(esp_agent_handle_t handle)
+{
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_agent_t *agent = (esp_agent_t *)handle;
+    esp_agent_start_stop_lock(agent);
+    esp_err_t err = agent_stop(agent);
+    esp_agent_start_stop_unlock(agent);
+    return err;
+}
+
 static esp_err_t send_handshake(esp_agent_handle_t handle)
 {
     if (handle == NULL) {
@@ -309,7 +652,8 @@ static esp_err_t send_handshake(esp_agent_handle_t handle)
     ESP_LOGD(TAG, "Sending Handshake: %s", handshake_json_str);
 
     ESP_LOGI(TAG, "Sending handshake for conversation mode: %s", agent->conversation_type == ESP_AGENT_CONVERSATION_SPEECH ? "audio" : "text");
-    ret = esp_agent_websocket_queue_message(agent, WS_SEND_MSG_TYPE_TEXT, handshake_json_str, strlen(handshake_json_str), portMAX_DELAY);
+    /* Not sequenced, and not held like the text queued until its ack */
+    ret = esp_agent_websocket_queue_message(agent, WS_SEND_MSG_TYPE_TEXT_UNSEQUENCED, handshake_json_str, strlen(handshake_json_str), portMAX_DELAY);
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "Failed to queue handshake: %d", ret);
         goto end;
@@ -324,71 +668,112 @@ end:
     return ret;
 }
 
+void esp_agent_websocket_rx_buffer_free(esp_agent_rx_buffer_t *rx_buffer)
+{
+    free(rx_buffer->data);
+    rx_buffer->data = NULL;
+    rx_buffer->len = 0;
+    rx_buffer->capacity = 0;
+}
+
+/* Keep the reassembly buffer for the next session, unless a large message grew it */
+static void rx_buffer_park(esp_agent_rx_buffer_t *rx_buffer)
+{
+    if (rx_buffer->capacity > RX_BUFFER_PARKED_MAX) {
+        esp_agent_websocket_rx_buffer_free(rx_buffer);
+        return;
+    }
+    rx_buffer->len = 0;
+    if (rx_buffer->data) {
+        rx_buffer->data[0] = '\0';
+    }
+}
+
 /* Websocket event handler */
 void esp_agent_websocket_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
 {
     ESP_LOGD(TAG, "WebSocket event: %d", event_id);
-    static char *message_buffer = NULL;
-    static size_t message_buffer_size = 0;
-    static size_t message_buffer_capacity = 0;
 
     esp_agent_t *agent = (esp_agent_t *)handler_args;
+    esp_agent_rx_buffer_t *rx_buffer = &agent->rx_buffer;
     esp_websocket_event_data_t *data = (esp_websocket_event_data_t *)event_data;
 
     switch (event_id) {
         case WEBSOCKET_EVENT_CONNECTED:
             ESP_LOGI(TAG, "WebSocket connected");
+            xEventGroupSetBits(agent->event_group, SEND_PROGRESS_RESET_BIT);
             if (agent->handshake_state == ESP_AGENT_HANDSHAKE_NOT_DONE) {
                 send_handshake(agent);
             }
-            agent->connected = true;
+            esp_agent_set_connected(agent);
+            esp_agent_keepalive_start(agent);
             esp_agent_post_event(agent, ESP_AGENT_EVENT_CONNECTED, NULL);
             break;
 
         case WEBSOCKET_EVENT_DATA:
+            if (data->op_code == WS_TRANSPORT_OPCODES_TEXT || data->op_code == WS_TRANSPORT_OPCODES_BINARY) {
+                esp_agent_connection_activity(agent);
+            }
+
             if (data->op_code == WS_TRANSPORT_OPCODES_TEXT) {
                 ESP_LOGD(TAG, "Received text chunk: %.*s", data->data_len, (char *)data->data_ptr);
 
                 // Reallocate buffer if needed
-                size_t new_size = message_buffer_size + data->data_len;
-                if (new_size >= message_buffer_capacity) {
-                    size_t new_capacity = message_buffer_capacity * 2;
+                size_t new_size = rx_buffer->len + data->data_len;
+                if (new_size >= rx_buffer->capacity) {
+                    size_t new_capacity = rx_buffer->capacity * 2;
                     if (new_capacity < new_size + 1) {
                         new_capacity = new_size + 1;
                     }
 
-                    char *new_buffer = realloc(message_buffer, new_capacity);
+                    char *new_buffer = esp_agent_mem_realloc(agent, ESP_AGENT_MEM_RX_TEXT, rx_buffer->data, new_capacity);
                     if (new_buffer == NULL) {
                         ESP_LOGE(TAG, "Failed to reallocate message buffer");
+                        esp_agent_transport_stats_count_drop(&agent->transport_stats, false);
                         break;
                     }
-                    message_buffer = new_buffer;
-                    message_buffer_capacity = new_capacity;
+                    rx_buffer->data = new_buffer;
+                    rx_buffer->capacity = new_capacity;
+                    esp_agent_transport_stats_count_copy(&agent->transport_stats, 0, 1);
                 }
 
-                memcpy(message_buffer + message_buffer_size,
+                bool timed = esp_agent_mem_count_copy(agent, ESP_AGENT_MEM_RX_TEXT, data->data_len);
+                int64_t copy_start_us = timed ? esp_timer_get_time() : 0;
+                memcpy(rx_buffer->data + rx_buffer->len,
                        data->data_ptr, data->data_len);
-                message_buffer_size += data->data_len;
-                message_buffer[message_buffer_size] = '\0';
+                if (timed) {
+                    esp_agent_mem_time_copy(agent, ESP_AGENT_MEM_RX_TEXT, data->data_len, esp_timer_get_time() - copy_start_us);
+                }
+                rx_buffer->len += data->data_len;
+                rx_buffer->data[rx_buffer->len] = '\0';
+                esp_agent_transport_stats_count_copy(&agent->transport_stats, data->data_len, 0);
 
                 // Check if we have a complete JSON message
-                cJSON *test_json = cJSON_Parse(message_buffer);
+                cJSON *test_json = cJSON_Parse(rx_buffer->data);
                 if (test_json != NULL) {
                     // Valid JSON found - process it
-                    char *complete_message = strdup(message_buffer);
-                    if (complete_message != NULL) {
-                        int err = xQueueSend(agent->message_queue, &complete_message, pdMS_TO_TICKS(10));
+                    esp_agent_transport_stats_count_message(&agent->transport_stats, ESP_AGENT_TRANSPORT_COUNTER_RX_TEXT, rx_buffer->len);
+                    esp_agent_rx_message_t rx_message = {
+                        .message = esp_agent_mem_dup(agent, ESP_AGENT_MEM_RX_TEXT, rx_buffer->data, rx_buffer->len + 1),
+                        .queued_at_us = esp_timer_get_time(),
+                    };
+                    if (rx_message.message != NULL) {
+                        esp_agent_transport_stats_count_copy(&agent->transport_stats, rx_buffer->len + 1, 1);
+                        int err = xQueueSend(agent->message_queue, &rx_message, pdMS_TO_TICKS(10));
                         if (err != pdTRUE) {
                             ESP_LOGE(TAG, "Failed to send complete message to queue");
-                            free(complete_message);
+                            esp_agent_transport_stats_count_drop(&agent->transport_stats, false);
+                            free(rx_message.message);
                         }
+                    } else {
+                        esp_agent_transport_stats_count_drop(&agent->transport_stats, false);
                     }
 
-                    message_buffer_size = 0;
-                    message_buffer[0] = '\0';
+                    rx_buffer->len = 0;
+                    rx_buffer->data[0] = '\0';
 
                     cJSON_Delete(test_json);
-                } else if (message_buffer_size > 64 * 1024) { // 64KB limit
+                } else if (rx_buffer->len > 64 * 1024) { // 64KB limit
                         // Check if buffer is getting too large (prevent memory issues)
 
                         /* FIXME: EDGE CASE: If there is beginning of a valid JSON mesage while this happens,
@@ -397,19 +782,25 @@ void esp_agent_websocket_event_handler(void *handler_args, esp_event_base_t base
                          * starts with `{"type"`
                          */
                         ESP_LOGW(TAG, "Incoming text message buffer too large, resetting");
-                        message_buffer_size = 0;
-                        message_buffer[0] = '\0';
+                        rx_buffer->len = 0;
+                        rx_buffer->data[0] = '\0';
                 }
 
+            } else if (data->op_code == WS_TRANSPORT_OPCODES_PONG) {
+                esp_agent_keepalive_pong_received(agent, (const uint8_t *)data->data_ptr, data->data_len);
             } else if (data->op_code == WS_TRANSPORT_OPCODES_BINARY) {
                 ESP_LOGV(TAG, "Received speech data: %d bytes", data->data_len);
-                uint8_t *audio_buf = malloc(data->data_len);
+                esp_agent_latency_mark(agent, ESP_AGENT_LATENCY_STAGE_DOWNLINK_FIRST_FRAME);
+
+                esp_agent_transport_stats_count_message(&agent->transport_stats, ESP_AGENT_TRANSPORT_COUNTER_RX_AUDIO, data->data_len);
+                uint8_t *audio_buf = esp_agent_mem_dup(agent, ESP_AGENT_MEM_RX_AUDIO, data->data_ptr, data->data_len);
                 if (!audio_buf) {
                     ESP_LOGE(TAG, "Failed to allocate %d bytes for speech data", data->data_len);
+                    esp_agent_transport_stats_count_drop(&agent->transport_stats, false);
                     break;
                 }
 
-                memcpy(audio_buf, (char *)data->data_ptr, data->data_len);
+                esp_agent_transport_stats_count_copy(&agent->transport_stats, data->data_len, 1);
                 esp_agent_message_data_t message_data = {
                     .speech = {
                         .data = audio_buf,
@@ -425,19 +816,19 @@ void esp_agent_websocket_event_handler(void *handler_args, esp_event_base_t base
         case WEBSOCKET_EVENT_CLOSED:
         case WEBSOCKET_EVENT_FINISH: /* This event is emitted when websocket task stops processing */
             ESP_LOGE(TAG, "WebSocket disconnected: %d", event_id);
-            agent->connected = false;
-            agent->started = false;
+            /* Still started if the connection was lost rather than stopped */
+            esp_agent_resume_disconnected(agent, esp_agent_clear_started(agent));
+            esp_agent_keepalive_stop(agent);
+            esp_agent_connection_closed(agent);
+            /* Compression and aggregation are negotiated again in the next handshake */
+            agent->compression.negotiated = false;
+            agent->aggregation.negotiated = false;
             /* Perform handshake again on reconnect */
             agent->handshake_state = ESP_AGENT_HANDSHAKE_NOT_DONE;
             esp_agent_post_event(agent, ESP_AGENT_EVENT_DISCONNECTED, NULL);
 
-            // Reset message buffer on error
-            if (message_buffer) {
-                free(message_buffer);
-                message_buffer = NULL;
-                message_buffer_size = 0;
-                message_buffer_capacity = 0;
-            }
+            // Drop any partial message
+            rx_buffer_park(rx_buffer);
             break;
 
         default:
@@ -0,0 +1,57 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Console for the linux target, without the REPL: commands are registered with esp_console
+ * and can be run with esp_console_run(), e.g. by the host tests.
+ */
+
+#include <esp_log.h>
+#include <esp_check.h>
+
+#include <agent_console.h>
+#include <agent_console_task_stats.h>
+
+static const char *TAG = "agent_console";
+
+static bool g_initialized = false;
+
+esp_err_t agent_console_init(void)
+{
+    if (g_initialized) {
+        ESP_LOGE(TAG, "Console already initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_console_config_t console_config = ESP_CONSOLE_CONFIG_DEFAULT();
+    ESP_RETURN_ON_ERROR(esp_console_init(&console_config), TAG, "Failed to initialize the console");
+    esp_console_register_help_command();
+    g_initialized = true;
+
+    return agent_console_register_default_commands();
+}
+
+esp_err_t agent_console_register_default_commands(void)
+{
+    if (!g_initialized) {
+        ESP_LOGE(TAG, "Console not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+#if CONFIG_AGENT_CONSOLE_TASK_STATS
+    ESP_RETURN_ON_ERROR(agent_console_register_task_stats_command(), TAG, "Failed to register task-stats command");
+#endif
+    return ESP_OK;
+}
+
+esp_err_t agent_console_register_command(const esp_console_cmd_t *cmd)
+{
+    if (!g_initialized) {
+        ESP_LOGE(TAG, "Console not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+    return esp_console_cmd_register(cmd);
+}
@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_err.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Per-task values captured in a snapshot */
+typedef struct {
+    TaskHandle_t handle;
+    char name[configMAX_TASK_NAME_LEN];
+    uint32_t run_time;                  /* Run time counter at the time of the snapshot */
+    uint32_t stack_hwm;                 /* Minimum free stack ever, in bytes */
+    UBaseType_t priority;
+    BaseType_t core_id;
+} task_stats_entry_t;
+
+/* All tasks at one point in time */
+typedef struct {
+    task_stats_entry_t *entries;
+    size_t count;
+    size_t capacity;
+    uint32_t total_run_time;
+} task_stats_snapshot_t;
+
+/**
+ * @brief Capture the state of all tasks into the snapshot
+ *
+ * The snapshot buffer is (re)allocated as needed and can be reused across calls.
+ *
+ * @param[in,out] snapshot Snapshot to fill
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t task_stats_snapshot_take(task_stats_snapshot_t *snapshot);
+
+/**
+ * @brief Free the memory held by the snapshot
+ *
+ * @param[in] snapshot Snapshot to free
+ */
+void task_stats_snapshot_free(task_stats_snapshot_t *snapshot);
+
+/**
+ * @brief Format the per-task CPU share between two snapshots as a table
+ *
+ * Tasks are matched by handle and sorted by CPU share, highest first. Tasks which do not
+ * exist in both snapshots are reported with the values from the end snapshot and no CPU share.
+ * This does not call into FreeRTOS and can be exercised on a host build.
+ *
+ * @param[in] start Snapshot at the start of the window
+ * @param[in] end Snapshot at the end of the window
+ * @param[in] num_cores Number of cores the run time is distributed over
+ * @param[out] buf Output buffer
+ * @param[in] buf_len Size of the output buffer
+ * @return Number of characters written (excluding the terminator)
+ */
+size_t task_stats_format(const task_stats_snapshot_t *start, const task_stats_snapshot_t *end, int num_cores, char *buf, size_t buf_len);
+
+/**
+ * @brief Register the `task-stats` console command and start background sampling
+ *
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t agent_console_register_task_stats_command(void);
+
+#ifdef __cplusplus
+}
+#endif
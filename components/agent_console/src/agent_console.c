@@ -14,6 +14,7 @@
 #include <esp_rmaker_common_console.h>
 
 #include <agent_console.h>
+#include <agent_console_task_stats.h>
 
 static const char *TAG = "agent_console";
 
@@ -106,6 +107,9 @@ esp_err_t agent_console_register_default_commands(void)
     }
 
     esp_rmaker_common_register_commands();
+#if CONFIG_AGENT_CONSOLE_TASK_STATS
+    ESP_RETURN_ON_ERROR(agent_console_register_task_stats_command(), TAG, "Failed to register task-stats command");
+#endif
     return ESP_OK;
 }
 
@@ -0,0 +1,306 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#include <esp_log.h>
+#include <esp_check.h>
+
+#include <agent_console.h>
+#include <agent_console_task_stats.h>
+
+#if CONFIG_AGENT_CONSOLE_TASK_STATS
+
+static const char *TAG = "agent_console_task_stats";
+
+/* Headroom for tasks created between counting and capturing */
+#define TASK_STATS_EXTRA_ENTRIES 4
+#define TASK_STATS_LINE_LEN 64
+#define TASK_STATS_DEFAULT_WINDOW_MS 1000
+#define TASK_STATS_MAX_WINDOW_MS 60000
+
+#define TASK_STATS_SAMPLER_STACK_SIZE 3072
+#define TASK_STATS_SAMPLER_PRIORITY 1
+
+typedef struct {
+    const task_stats_entry_t *entry;
+    uint32_t cpu_permille;
+    bool has_cpu;
+} task_stats_row_t;
+
+typedef struct {
+    SemaphoreHandle_t lock;
+    task_stats_snapshot_t snapshots[2];
+    size_t latest;              /* Index of the most recent snapshot */
+    size_t num_taken;           /* Number of snapshots taken, saturates at 2 */
+} task_stats_data_t;
+
+static task_stats_data_t g_task_stats;
+
+static const task_stats_entry_t *task_stats_find_entry(const task_stats_snapshot_t *snapshot, TaskHandle_t handle)
+{
+    if (snapshot == NULL) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < snapshot->count; i++) {
+        if (snapshot->entries[i].handle == handle) {
+            return &snapshot->entries[i];
+        }
+    }
+    return NULL;
+}
+
+static int task_stats_compare_rows(const void *a, const void *b)
+{
+    const task_stats_row_t *row_a = (const task_stats_row_t *)a;
+    const task_stats_row_t *row_b = (const task_stats_row_t *)b;
+
+    if (row_a->cpu_permille != row_b->cpu_permille) {
+        return row_a->cpu_permille < row_b->cpu_permille ? 1 : -1;
+    }
+    return strncmp(row_a->entry->name, row_b->entry->name, sizeof(row_a->entry->name));
+}
+
+size_t task_stats_format(const task_stats_snapshot_t *start, const task_stats_snapshot_t *end, int num_cores, char *buf, size_t buf_len)
+{
+    if (end == NULL || buf == NULL || buf_len == 0) {
+        return 0;
+    }
+    buf[0] = '\0';
+
+    task_stats_row_t *rows = calloc(end->count ? end->count : 1, sizeof(task_stats_row_t));
+    if (rows == NULL) {
+        return 0;
+    }
+
+    /* Run time counters are unsigned and the subtraction handles a single wrap-around */
+    uint32_t window = start ? end->total_run_time - start->total_run_time : 0;
+    uint64_t window_all_cores = (uint64_t)window * (num_cores > 0 ? num_cores : 1);
+
+    for (size_t i = 0; i < end->count; i++) {
+        const task_stats_entry_t *entry = &end->entries[i];
+        const task_stats_entry_t *prev = task_stats_find_entry(start, entry->handle);
+
+        rows[i].entry = entry;
+        if (prev && window_all_cores) {
+            uint32_t delta = entry->run_time - prev->run_time;
+            rows[i].cpu_permille = (uint32_t)(((uint64_t)delta * 1000) / window_all_cores);
+            rows[i].has_cpu = true;
+        }
+    }
+
+    qsort(rows, end->count, sizeof(task_stats_row_t), task_stats_compare_rows);
+
+    size_t len = 0;
+    int written = snprintf(buf, buf_len, "%-16s %6s %10s %5s %4s\n", "Task", "CPU%", "Stack free", "Core", "Prio");
+    len += (written > 0) ? written : 0;
+
+    for (size_t i = 0; i < end->count && len < buf_len; i++) {
+        const task_stats_entry_t *entry = rows[i].entry;
+        char cpu[12] = "-";
+        char core[8] = "any";
+
+        if (rows[i].has_cpu) {
+            snprintf(cpu, sizeof(cpu), "%lu.%lu", (unsigned long)(rows[i].cpu_permille / 10), (unsigned long)(rows[i].cpu_permille % 10));
+        }
+        if (entry->core_id >= 0 && entry->core_id < num_cores) {
+            snprintf(core, sizeof(core), "%d", (int)entry->core_id);
+        }
+
+        written = snprintf(buf + len, buf_len - len, "%-16.16s %6s %10lu %5s %4u\n",
+                           entry->name, cpu, (unsigned long)entry->stack_hwm, core, (unsigned int)entry->priority);
+        len += (written > 0) ? written : 0;
+    }
+
+    if (len < buf_len) {
+        /* The run time counter is driven by esp_timer, i.e. in microseconds */
+        written = snprintf(buf + len, buf_len - len, "Window: %lu ms, %u tasks\n", (unsigned long)(window / 1000), (unsigned int)end->count);
+        len += (written > 0) ? written : 0;
+    }
+
+    free(rows);
+    return len < buf_len ? len : buf_len - 1;
+}
+
+esp_err_t task_stats_snapshot_take(task_stats_snapshot_t *snapshot)
+{
+    if (snapshot == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    UBaseType_t num_tasks = uxTaskGetNumberOfTasks() + TASK_STATS_EXTRA_ENTRIES;
+
+    if (snapshot->capacity < num_tasks) {
+        task_stats_entry_t *entries = realloc(snapshot->entries, num_tasks * sizeof(task_stats_entry_t));
+        if (entries == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate task stats snapshot");
+            return ESP_ERR_NO_MEM;
+        }
+        snapshot->entries = entries;
+        snapshot->capacity = num_tasks;
+    }
+
+    TaskStatus_t *status = malloc(num_tasks * sizeof(TaskStatus_t));
+    if (status == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate task status array");
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t total_run_time = 0;
+    UBaseType_t count = uxTaskGetSystemState(status, num_tasks, &total_run_time);
+    if (count == 0) {
+        ESP_LOGW(TAG, "Task status array too small");
+        free(status);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        task_stats_entry_t *entry = &snapshot->entries[i];
+        entry->handle = status[i].xHandle;
+        snprintf(entry->name, sizeof(entry->name), "%s", status[i].pcTaskName);
+        entry->run_time = status[i].ulRunTimeCounter;
+        entry->stack_hwm = status[i].usStackHighWaterMark;
+        entry->priority = status[i].uxCurrentPriority;
+        entry->core_id = status[i].xCoreID;
+    }
+    snapshot->count = count;
+    snapshot->total_run_time = total_run_time;
+
+    free(status);
+    return ESP_OK;
+}
+
+void task_stats_snapshot_free(task_stats_snapshot_t *snapshot)
+{
+    if (snapshot == NULL) {
+        return;
+    }
+
+    if (snapshot->entries) {
+        free(snapshot->entries);
+    }
+    snapshot->entries = NULL;
+    snapshot->count = 0;
+    snapshot->capacity = 0;
+}
+
+static void task_stats_print(const task_stats_snapshot_t *start, const task_stats_snapshot_t *end)
+{
+    size_t buf_len = (end->count + 4) * TASK_STATS_LINE_LEN;
+    char *buf = malloc(buf_len);
+    if (buf == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate output buffer");
+        return;
+    }
+
+    task_stats_format(start, end, portNUM_PROCESSORS, buf, buf_len);
+    printf("%s", buf);
+    free(buf);
+}
+
+static esp_err_t task_stats_sample_window(uint32_t window_ms)
+{
+    task_stats_snapshot_t start = {0};
+    task_stats_snapshot_t end = {0};
+    esp_err_t ret = ESP_OK;
+
+    ESP_GOTO_ON_ERROR(task_stats_snapshot_take(&start), exit, TAG, "Failed to take start snapshot");
+    vTaskDelay(pdMS_TO_TICKS(window_ms));
+    ESP_GOTO_ON_ERROR(task_stats_snapshot_take(&end), exit, TAG, "Failed to take end snapshot");
+
+    task_stats_print(&start, &end);
+
+exit:
+    task_stats_snapshot_free(&start);
+    task_stats_snapshot_free(&end);
+    return ret;
+}
+
+static void task_stats_sampler_task(void *arg)
+{
+    while (true) {
+        if (xSemaphoreTake(g_task_stats.lock, portMAX_DELAY) == pdTRUE) {
+            size_t next = g_task_stats.num_taken ? g_task_stats.latest ^ 1 : 0;
+            if (task_stats_snapshot_take(&g_task_stats.snapshots[next]) == ESP_OK) {
+                g_task_stats.latest = next;
+                if (g_task_stats.num_taken < 2) {
+                    g_task_stats.num_taken++;
+                }
+            }
+            xSemaphoreGive(g_task_stats.lock);
+        }
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_AGENT_CONSOLE_TASK_STATS_PERIOD_MS));
+    }
+
+    vTaskDelete(NULL);
+}
+
+static esp_err_t task_stats_cmd_handler(int argc, char **argv)
+{
+    if (argc > 2) {
+        ESP_LOGE(TAG, "Usage: task-stats [window_ms]");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (argc == 2) {
+        int window_ms = atoi(argv[1]);
+        if (window_ms <= 0 || window_ms > TASK_STATS_MAX_WINDOW_MS) {
+            ESP_LOGE(TAG, "Window must be between 1 and %d ms", TASK_STATS_MAX_WINDOW_MS);
+            return ESP_ERR_INVALID_ARG;
+        }
+        return task_stats_sample_window(window_ms);
+    }
+
+    /* Report the last background window if there is one, otherwise sample a fresh window */
+    if (g_task_stats.lock && xSemaphoreTake(g_task_stats.lock, portMAX_DELAY) == pdTRUE) {
+        if (g_task_stats.num_taken == 2) {
+            task_stats_print(&g_task_stats.snapshots[g_task_stats.latest ^ 1], &g_task_stats.snapshots[g_task_stats.latest]);
+            xSemaphoreGive(g_task_stats.lock);
+            return ESP_OK;
+        }
+        xSemaphoreGive(g_task_stats.lock);
+    }
+
+    return task_stats_sample_window(TASK_STATS_DEFAULT_WINDOW_MS);
+}
+
+esp_err_t agent_console_register_task_stats_command(void)
+{
+    esp_console_cmd_t cmd = {
+        .command = "task-stats",
+        .help = "Show per-task CPU share, minimum free stack, core and priority\n"
+                "Without arguments, the last background sampling window is reported\n"
+                "Usage: task-stats [window_ms]",
+        .func = task_stats_cmd_handler,
+    };
+
+    ESP_RETURN_ON_ERROR(agent_console_register_command(&cmd), TAG, "Failed to register task-stats command");
+
+    if (CONFIG_AGENT_CONSOLE_TASK_STATS_PERIOD_MS > 0 && g_task_stats.lock == NULL) {
+        g_task_stats.lock = xSemaphoreCreateMutex();
+        if (g_task_stats.lock == NULL) {
+            ESP_LOGE(TAG, "Failed to create task stats lock");
+            return ESP_ERR_NO_MEM;
+        }
+
+        if (xTaskCreate(task_stats_sampler_task, "task_stats", TASK_STATS_SAMPLER_STACK_SIZE, NULL, TASK_STATS_SAMPLER_PRIORITY, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create task stats sampler task");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    return ESP_OK;
+}
+
+#endif /* CONFIG_AGENT_CONSOLE_TASK_STATS */
@@ -42,6 +42,8 @@ typedef struct audio_playback_s {
     size_t asp_embed_data_len;
     esp_asp_handle_t asp_handle;
     bool started;
+    audio_playback_event_cb_t event_cb;
+    void *cb_user_data;
 } audio_playback_t;
 
 static esp_gmf_err_io_t playback_inport_acquire_read(void *handle, esp_gmf_data_bus_block_t *blk, int wanted_size, int block_ticks)
@@ -72,8 +74,14 @@ static esp_gmf_err_io_t playback_inport_release_read(void *handle, esp_gmf_data_
     return ESP_GMF_IO_OK;
 }
 
+/* The last element asks for its output buffer once the decoder has produced a frame */
 static esp_gmf_err_io_t playback_outport_acquire_write(void *handle, esp_gmf_data_bus_block_t *blk, int wanted_size, int block_ticks)
 {
+    audio_playback_t *playback = (audio_playback_t *)handle;
+
+    if (playback->event_cb && wanted_size > 0) {
+        playback->event_cb((audio_playback_handle_t)playback, AUDIO_PLAYBACK_EVENT_FRAME_DECODED, playback->cb_user_data);
+    }
     return ESP_GMF_IO_OK;
 }
 
@@ -81,9 +89,18 @@ static esp_gmf_err_io_t playback_outport_release_write(void *handle, esp_gmf_dat
 {
     audio_playback_t *playback = (audio_playback_t *)handle;
 
+    if (blk->valid_size <= 0) {
+        return ESP_GMF_IO_OK;
+    }
+
     ESP_LOGD(TAG, "Writing audio data to codec device: %d", blk->valid_size);
     esp_codec_dev_write(playback->out_dev_handle, blk->buf, blk->valid_size);
 
+    /* After the codec accepted the frame, which waits for room in the I2S DMA buffers */
+    if (playback->event_cb) {
+        playback->event_cb((audio_playback_handle_t)playback, AUDIO_PLAYBACK_EVENT_CODEC_WRITE, playback->cb_user_data);
+    }
+
     return ESP_GMF_IO_OK;
 }
 
@@ -532,6 +549,20 @@ esp_err_t audio_playback_remaining_bytes(audio_playback_handle_t *handle, size_t
     return ESP_OK;
 }
 
+esp_err_t audio_playback_add_event_cb(audio_playback_handle_t handle, audio_playback_event_cb_t cb, void *user_data)
+{
+    if (!handle || !cb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    audio_playback_t *playback = (audio_playback_t *)handle;
+
+    playback->event_cb = cb;
+    playback->cb_user_data = user_data;
+
+    return ESP_OK;
+}
+
 esp_err_t play_media(audio_playback_handle_t *handle, const char *media_url, const uint8_t *data, size_t len, bool sync)
 {
     if (handle == NULL || media_url == NULL) {
@@ -27,6 +27,17 @@ typedef struct {
     esp_codec_dev_handle_t out_dev_handle;
 } audio_playback_config_t;
 
+typedef enum {
+    AUDIO_PLAYBACK_EVENT_FRAME_DECODED,     /* A frame was decoded and its output buffer requested */
+    AUDIO_PLAYBACK_EVENT_CODEC_WRITE,       /* A decoded frame was accepted by the codec device */
+    AUDIO_PLAYBACK_EVENT_MAX,
+} audio_playback_event_t;
+
+/* Called from the playback pipeline task for every frame, so it should return quickly.
+ * Only the stream written with audio_playback_write() raises events, media playback does not.
+ */
+typedef void (*audio_playback_event_cb_t)(audio_playback_handle_t handle, audio_playback_event_t event, void *user_data);
+
 audio_playback_handle_t audio_playback_init(const audio_playback_config_t *config);
 
 esp_err_t audio_playback_deinit(audio_playback_handle_t *handle);
@@ -37,6 +48,8 @@ esp_err_t audio_playback_write(audio_playback_handle_t *handle, const uint8_t *d
 
 esp_err_t audio_playback_remaining_bytes(audio_playback_handle_t *handle, size_t *remaining_bytes);
 
+esp_err_t audio_playback_add_event_cb(audio_playback_handle_t handle, audio_playback_event_cb_t cb, void *user_data);
+
 /**
  * @brief Play media data using ESP-GMF audio simple player
  *
@@ -0,0 +1,230 @@
+/**
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Playback for the linux target, without the GMF pipeline.
+ *
+ * Frames are written to the output codec device as they are, in the order of
+ * audio_playback_write(), from a task as the pipeline does. The decoder is a pass-through,
+ * so both events are raised for every frame. Media (the chimes) is not played.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+
+#include <esp_log.h>
+
+#include "audio_playback.h"
+
+static const char *TAG = "audio_playback";
+
+#define AUDIO_PLAYBACK_QUEUE_LEN 16
+#define AUDIO_PLAYBACK_TASK_STACK_SIZE 4096
+
+typedef struct {
+    esp_codec_dev_handle_t out_dev_handle;
+    audio_playback_audio_info_t audio_in_info;
+    esp_codec_dev_sample_info_t out_codec_info;
+    QueueHandle_t frames;
+    TaskHandle_t task_handle;
+    volatile bool started;
+    portMUX_TYPE lock;
+    size_t queued_bytes;
+    audio_playback_event_cb_t event_cb;
+    void *cb_user_data;
+} audio_playback_t;
+
+typedef struct {
+    size_t len;
+    uint8_t data[];
+} audio_playback_frame_t;
+
+static void playback_task(void *arg)
+{
+    audio_playback_t *playback = (audio_playback_t *)arg;
+    audio_playback_frame_t *frame = NULL;
+
+    while (playback->started) {
+        if (xQueueReceive(playback->frames, &frame, pdMS_TO_TICKS(100)) != pdTRUE) {
+            continue;
+        }
+
+        if (playback->event_cb) {
+            playback->event_cb((audio_playback_handle_t)playback, AUDIO_PLAYBACK_EVENT_FRAME_DECODED, playback->cb_user_data);
+        }
+
+        ESP_LOGD(TAG, "Writing audio data to codec device: %u", (unsigned)frame->len);
+        esp_codec_dev_write(playback->out_dev_handle, frame->data, frame->len);
+
+        if (playback->event_cb) {
+            playback->event_cb((audio_playback_handle_t)playback, AUDIO_PLAYBACK_EVENT_CODEC_WRITE, playback->cb_user_data);
+        }
+
+        portENTER_CRITICAL(&playback->lock);
+        playback->queued_bytes -= frame->len;
+        portEXIT_CRITICAL(&playback->lock);
+        free(frame);
+    }
+
+    playback->task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+audio_playback_handle_t audio_playback_init(const audio_playback_config_t *config)
+{
+    if (config == NULL || config->out_dev_handle == NULL) {
+        ESP_LOGE(TAG, "Invalid config for audio_playback");
+        return NULL;
+    }
+
+    audio_playback_t *playback = (audio_playback_t *)calloc(1, sizeof(audio_playback_t));
+    if (playback == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate memory for audio playback");
+        return NULL;
+    }
+
+    playback->out_dev_handle = config->out_dev_handle;
+    playback->audio_in_info = config->audio_in_info;
+    playback->out_codec_info = config->out_codec_info;
+    portMUX_INITIALIZE(&playback->lock);
+    playback->frames = xQueueCreate(AUDIO_PLAYBACK_QUEUE_LEN, sizeof(audio_playback_frame_t *));
+    if (playback->frames == NULL) {
+        ESP_LOGE(TAG, "Failed to create the frame queue");
+        free(playback);
+        return NULL;
+    }
+
+    return (audio_playback_handle_t)playback;
+}
+
+esp_err_t audio_playback_deinit(audio_playback_handle_t *handle)
+{
+    if (handle == NULL) {
+        ESP_LOGE(TAG, "Invalid playback handle");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ESP_LOGI(TAG, "Deinitializing audio playback");
+    audio_playback_t *playback = (audio_playback_t *)handle;
+
+    playback->started = false;
+    while (playback->task_handle) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    audio_playback_frame_t *frame = NULL;
+    while (xQueueReceive(playback->frames, &frame, 0) == pdTRUE) {
+        free(frame);
+    }
+    vQueueDelete(playback->frames);
+    free(playback);
+
+    ESP_LOGI(TAG, "Audio playback deinitialized");
+    return ESP_OK;
+}
+
+esp_err_t audio_playback_start(audio_playback_handle_t *handle)
+{
+    if (handle == NULL) {
+        ESP_LOGE(TAG, "Invalid playback handle");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    audio_playback_t *playback = (audio_playback_t *)handle;
+
+    if (playback->started) {
+        ESP_LOGW(TAG, "Playback already started");
+        return ESP_OK;
+    }
+
+    playback->started = true;
+    if (xTaskCreate(playback_task, "audio_playback", AUDIO_PLAYBACK_TASK_STACK_SIZE, playback, 5, &playback->task_handle) != pdPASS) {
+        playback->started = false;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t audio_playback_write(audio_playback_handle_t *handle, const uint8_t *data, size_t len)
+{
+    if (handle == NULL || data == NULL || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    audio_playback_t *playback = (audio_playback_t *)handle;
+
+    if (!playback->started) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    audio_playback_frame_t *frame = malloc(sizeof(audio_playback_frame_t) + len);
+    if (frame == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    frame->len = len;
+    memcpy(frame->data, data, len);
+
+    portENTER_CRITICAL(&playback->lock);
+    playback->queued_bytes += len;
+    portEXIT_CRITICAL(&playback->lock);
+
+    /* Blocks while the codec is behind, as the data bus of the pipeline does */
+    if (xQueueSend(playback->frames, &frame, portMAX_DELAY) != pdTRUE) {
+        portENTER_CRITICAL(&playback->lock);
+        playback->queued_bytes -= len;
+        portEXIT_CRITICAL(&playback->lock);
+        free(frame);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t audio_playback_remaining_bytes(audio_playback_handle_t *handle, size_t *remaining_bytes)
+{
+    if (handle == NULL || remaining_bytes == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    audio_playback_t *playback = (audio_playback_t *)handle;
+
+    portENTER_CRITICAL(&playback->lock);
+    *remaining_bytes = playback->queued_bytes;
+    portEXIT_CRITICAL(&playback->lock);
+    return ESP_OK;
+}
+
+esp_err_t audio_playback_add_event_cb(audio_playback_handle_t handle, audio_playback_event_cb_t cb, void *user_data)
+{
+    if (!handle || !cb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    audio_playback_t *playback = (audio_playback_t *)handle;
+
+    playback->event_cb = cb;
+    playback->cb_user_data = user_data;
+
+    return ESP_OK;
+}
+
+esp_err_t audio_playback_play_media_sync(audio_playback_handle_t *handle, const char *media_url, const uint8_t *data, size_t len)
+{
+    if (handle == NULL || media_url == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ESP_LOGI(TAG, "Playing media: %s (not decoded on the linux target)", media_url);
+    return ESP_OK;
+}
+
+esp_err_t audio_playback_play_media_async(audio_playback_handle_t *handle, const char *media_url, const uint8_t *data, size_t len)
+{
+    return audio_playback_play_media_sync(handle, media_url, data, len);
+}
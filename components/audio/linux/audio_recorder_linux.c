@@ -0,0 +1,250 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Recorder for the linux target, without the GMF pipeline and the AFE.
+ *
+ * Frames are read from the input codec device as they are and passed on without encoding.
+ * There is no wake word or VAD: the input is speech for as long as the device returns samples,
+ * so a file backed microphone is one utterance, which starts with WAKEUP_START and VAD_START and
+ * ends with VAD_END and WAKEUP_END when the device fails to read. The next samples read start the
+ * next utterance.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+
+#include <audio_recorder.h>
+
+static const char *TAG = "audio_recorder";
+
+#define AUDIO_RECORDER_QUEUE_LEN 8
+#define AUDIO_RECORDER_TASK_STACK_SIZE 4096
+
+typedef struct {
+    esp_codec_dev_handle_t in_dev_handle;
+    uint16_t sample_rate;
+    uint8_t frame_duration_ms;
+    size_t frame_len;
+    QueueHandle_t frames;
+    TaskHandle_t task_handle;
+    volatile bool running;
+    volatile bool sleep_requested;
+    bool speaking;
+    audio_recorder_event_cb_t event_cb;
+    void *cb_user_data;
+} audio_recorder_t;
+
+typedef struct {
+    size_t len;
+    uint8_t data[];
+} audio_recorder_frame_t;
+
+static void recorder_raise(audio_recorder_t *recorder, audio_recorder_event_t event)
+{
+    if (recorder->event_cb) {
+        recorder->event_cb((audio_recorder_handle_t)recorder, event, recorder->cb_user_data);
+    }
+}
+
+static void recorder_utterance_end(audio_recorder_t *recorder)
+{
+    if (recorder->speaking) {
+        recorder->speaking = false;
+        ESP_LOGI(TAG, "Wakeup end");
+        recorder_raise(recorder, AUDIO_RECORDER_EVENT_VAD_END);
+        recorder_raise(recorder, AUDIO_RECORDER_EVENT_WAKEUP_END);
+    }
+}
+
+static void recorder_task(void *arg)
+{
+    audio_recorder_t *recorder = (audio_recorder_t *)arg;
+    audio_recorder_frame_t *frame = NULL;
+
+    while (recorder->running) {
+        if (frame == NULL) {
+            frame = malloc(sizeof(audio_recorder_frame_t) + recorder->frame_len);
+            if (frame == NULL) {
+                vTaskDelay(pdMS_TO_TICKS(recorder->frame_duration_ms));
+                continue;
+            }
+        }
+
+        if (esp_codec_dev_read(recorder->in_dev_handle, frame->data, recorder->frame_len) != 0) {
+            recorder_utterance_end(recorder);
+            recorder->sleep_requested = false;
+            vTaskDelay(pdMS_TO_TICKS(recorder->frame_duration_ms));
+            continue;
+        }
+        /* The rest of the utterance is skipped after audio_recorder_trigger_sleep() */
+        if (recorder->sleep_requested) {
+            recorder_utterance_end(recorder);
+            continue;
+        }
+        if (!recorder->speaking) {
+            recorder->speaking = true;
+            ESP_LOGI(TAG, "Wakeup start");
+            recorder_raise(recorder, AUDIO_RECORDER_EVENT_WAKEUP_START);
+            recorder_raise(recorder, AUDIO_RECORDER_EVENT_VAD_START);
+        }
+
+        frame->len = recorder->frame_len;
+        /* Blocks while the reader is behind, as the FIFO of the pipeline does */
+        while (recorder->running && xQueueSend(recorder->frames, &frame, pdMS_TO_TICKS(100)) != pdTRUE) {
+        }
+        if (recorder->running) {
+            frame = NULL;
+        }
+    }
+
+    free(frame);
+    recorder->task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+audio_recorder_handle_t audio_recorder_init(const audio_recorder_config_t *config)
+{
+    if (config == NULL || config->format == NULL || config->in_dev_handle == NULL ||
+        config->sample_rate == 0 || config->frame_duration_ms == 0) {
+        ESP_LOGE(TAG, "Invalid config for audio_recorder");
+        return NULL;
+    }
+
+    audio_recorder_t *recorder = (audio_recorder_t *)calloc(1, sizeof(audio_recorder_t));
+    if (recorder == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate memory for audio recorder");
+        return NULL;
+    }
+
+    recorder->in_dev_handle = config->in_dev_handle;
+    recorder->sample_rate = config->sample_rate;
+    recorder->frame_duration_ms = config->frame_duration_ms;
+    /* 16 bit mono, not encoded */
+    recorder->frame_len = (size_t)config->sample_rate * config->frame_duration_ms / 1000 * 2;
+    recorder->frames = xQueueCreate(AUDIO_RECORDER_QUEUE_LEN, sizeof(audio_recorder_frame_t *));
+    if (recorder->frames == NULL) {
+        ESP_LOGE(TAG, "Failed to create the frame queue");
+        free(recorder);
+        return NULL;
+    }
+
+    ESP_LOGI(TAG, "Recording %u byte frames, %s is not encoded on the linux target", (unsigned)recorder->frame_len, config->format);
+    return (audio_recorder_handle_t)recorder;
+}
+
+esp_err_t audio_recorder_deinit(audio_recorder_handle_t handle)
+{
+    if (handle == NULL) {
+        ESP_LOGE(TAG, "Invalid recorder handle");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ESP_LOGI(TAG, "Deinitializing audio recorder");
+    audio_recorder_t *recorder = (audio_recorder_t *)handle;
+
+    recorder->running = false;
+    while (recorder->task_handle) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    audio_recorder_frame_t *frame = NULL;
+    while (xQueueReceive(recorder->frames, &frame, 0) == pdTRUE) {
+        free(frame);
+    }
+    vQueueDelete(recorder->frames);
+    free(recorder);
+
+    ESP_LOGI(TAG, "Audio recorder deinitialized");
+    return ESP_OK;
+}
+
+esp_err_t audio_recorder_start(audio_recorder_handle_t handle)
+{
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    audio_recorder_t *recorder = (audio_recorder_t *)handle;
+    if (recorder->task_handle) {
+        return ESP_OK;
+    }
+
+    recorder->running = true;
+    if (xTaskCreate(recorder_task, "audio_recorder", AUDIO_RECORDER_TASK_STACK_SIZE, recorder, 5, &recorder->task_handle) != pdPASS) {
+        recorder->running = false;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t audio_recorder_read(audio_recorder_handle_t handle, uint8_t *data, size_t len, size_t *read_len)
+{
+    if (handle == NULL || data == NULL || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    audio_recorder_t *recorder = (audio_recorder_t *)handle;
+    audio_recorder_frame_t *frame = NULL;
+
+    if (xQueueReceive(recorder->frames, &frame, portMAX_DELAY) != pdTRUE) {
+        *read_len = 0;
+        return ESP_FAIL;
+    }
+
+    size_t copy_len = (frame->len < len) ? frame->len : len;
+    memcpy(data, frame->data, copy_len);
+    *read_len = copy_len;
+    free(frame);
+
+    return ESP_OK;
+}
+
+esp_err_t audio_recorder_add_event_cb(audio_recorder_handle_t handle, audio_recorder_event_cb_t cb, void *user_data)
+{
+    if (!handle || !cb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    audio_recorder_t *recorder = (audio_recorder_t *)handle;
+
+    recorder->event_cb = cb;
+    recorder->cb_user_data = user_data;
+
+    return ESP_OK;
+}
+
+esp_err_t audio_recorder_stay_awake(audio_recorder_handle_t handle, bool awake)
+{
+    if (handle == NULL) {
+        ESP_LOGE(TAG, "Invalid recorder handle");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    /* Without a wake word, the recorder is awake whenever the device has samples */
+    ESP_LOGD(TAG, "Keep awake mode %s", awake ? "enabled" : "disabled");
+    return ESP_OK;
+}
+
+esp_err_t audio_recorder_trigger_sleep(audio_recorder_handle_t handle)
+{
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    audio_recorder_t *recorder = (audio_recorder_t *)handle;
+    recorder->sleep_requested = true;
+
+    ESP_LOGD(TAG, "Sleep triggered");
+    return ESP_OK;
+}
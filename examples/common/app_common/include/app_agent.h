@@ -32,6 +32,24 @@ esp_err_t app_agent_connect(void);
 
 esp_err_t app_agent_send_speech(uint8_t *audio_data, size_t audio_data_len);
 
+/**
+ * @brief Mark a stage of the current voice turn for latency tracking
+ *
+ * @param[in] stage Stage reached
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t app_agent_latency_mark(esp_agent_latency_stage_t stage);
+
+/**
+ * @brief Tell whether the user is speaking, from the voice activity detection
+ *
+ * A user transcript without a generation stage received while the user speaks is interim,
+ * so it does not run intents.
+ *
+ * @param[in] speaking true from the start of the speech to its end
+ */
+void app_agent_set_user_speaking(bool speaking);
+
 bool app_agent_is_active(void);
 
 app_agent_state_t app_agent_get_state(void);
@@ -53,6 +71,32 @@ void app_agent_default_event_handler(void *arg, esp_event_base_t event_base,
  */
 esp_err_t app_agent_register_tool(const char *name, esp_agent_tool_handler_t tool_handler, void *user_data);
 
+/**
+ * @brief Register a local tool with the agent, with options (e.g. result caching)
+ *
+ * @param[in] config Tool configuration
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t app_agent_register_tool_with_config(const esp_agent_tool_config_t *config);
+
+/**
+ * @brief Drop the cached results of a tool, when the state it reads changed
+ *
+ * @param[in] name Name of the tool, NULL for all tools
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t app_agent_invalidate_tool_cache(const char *name);
+
+/**
+ * @brief Run a registered local tool right away, on the device
+ *
+ * @param[in] name Name of the tool
+ * @param[in] params Array of tool parameters
+ * @param[in] num_params Number of tool parameters
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t app_agent_run_tool(const char *name, const esp_agent_tool_param_t params[], size_t num_params);
+
 /**
  * @brief Unregister a local tool from the agent
  *
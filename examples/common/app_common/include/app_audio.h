@@ -15,9 +15,25 @@ typedef enum {
     MICROPHONE_STATE_START,
     MICROPHONE_STATE_PAUSE,
     MICROPHONE_STATE_STOP,
+    MICROPHONE_STATE_BUFFER,        /* Capture into the connect buffer, sent once the microphone is started */
     MICROPHONE_STATE_MAX,
 } app_audio_microphone_state_t;
 
+/**
+ * @brief Statistics of the audio captured on wake while the agent connects
+ */
+typedef struct {
+    uint32_t utterances;                /* Wakes for which audio was buffered */
+    uint32_t lost_utterances;           /* Buffered utterances of which nothing was sent */
+    uint32_t buffered_frames;
+    uint32_t flushed_frames;
+    uint32_t dropped_full;              /* Frames dropped because the buffer was full */
+    uint32_t dropped_age;               /* Frames older than CONFIG_APP_AUDIO_CONNECT_BUFFER_MAX_AGE_MS */
+    uint32_t send_failures;             /* Buffered frames the agent did not take */
+    uint32_t last_wake_to_uplink_ms;    /* Time from wake to the first buffered frame sent */
+    uint32_t max_wake_to_uplink_ms;
+} app_audio_connect_buffer_stats_t;
+
 
 /**
  * @brief Initialize the audio pipeline
@@ -59,3 +75,11 @@ esp_err_t app_audio_play_media_async(const char *media_url, const uint8_t *data,
 esp_err_t app_audio_trigger_sleep(void);
 
 esp_err_t app_audio_set_awake(bool awake);
+
+/**
+ * @brief Get the statistics of the connect buffer
+ *
+ * @param[out] stats Statistics
+ * @return ESP_OK on success, otherwise an error code
+ */
+esp_err_t app_audio_get_connect_buffer_stats(app_audio_connect_buffer_stats_t *stats);
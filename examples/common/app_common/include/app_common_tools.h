@@ -24,3 +24,17 @@ esp_err_t app_common_tools_get_local_time_handler(esp_agent_handle_t handle, con
 esp_err_t app_common_tools_set_volume_handler(esp_agent_handle_t handle, const char *tool_name,
                                               esp_agent_tool_param_t params[], size_t num_params, void *user_data,
                                               char **result);
+
+/**
+ * @brief Register the common tools (reminder, local time, volume) with the agent, with their parameters
+ *
+ * @return ESP_OK on success, otherwise an error code
+ */
+esp_err_t app_common_tools_register(void);
+
+/**
+ * @brief Register the intents for the common tools (volume presets), run on the device
+ *
+ * @return ESP_OK on success, otherwise an error code
+ */
+esp_err_t app_common_tools_register_intents(void);
@@ -28,6 +28,7 @@ typedef enum {
     DEVICE_EVENT_REMINDER_COMPLETE,
     DEVICE_EVENT_SET_USER_TEXT,
     DEVICE_EVENT_SET_ASSISTANT_TEXT,
+    DEVICE_EVENT_CONNECT_TIMEOUT,
     DEVICE_EVENT_MAX,
 } app_device_event_t;
 
@@ -0,0 +1,47 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <esp_err.h>
+#include <esp_agent.h>
+
+/**
+ * @brief A simple command run on the device, without waiting for the server
+ */
+typedef struct {
+    const char *phrase;                         /* Command words, lower case, separated by single spaces */
+    const char *tool_name;                      /* Registered local tool to run */
+    const esp_agent_tool_param_t *params;       /* Tool parameters */
+    size_t num_params;
+} app_intent_t;
+
+/**
+ * @brief Register a table of intents
+ *
+ * The table is not copied and must stay valid. Up to 4 tables can be registered.
+ *
+ * @param intents Intent table
+ * @param num_intents Number of intents in the table
+ * @return ESP_OK on success, otherwise an error code
+ */
+esp_err_t app_intent_register(const app_intent_t *intents, size_t num_intents);
+
+/**
+ * @brief Run the intent matching a user transcript, if any
+ *
+ * Case and punctuation are ignored. The words of the phrase have to appear in the transcript,
+ * and its other words can only be fillers like "please" or "now", so that e.g. "don't mute" is
+ * left to the server. Call it with final transcripts only. The tool runs in a task of its own,
+ * and its result answers the request the server sends for the same command.
+ *
+ * @param text User transcript
+ * @return true if an intent was queued to run
+ */
+bool app_intent_handle_transcript(const char *text);
@@ -0,0 +1,83 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <esp_err.h>
+
+typedef enum {
+    APP_TRANSCRIPT_ENTRY_USER,
+    APP_TRANSCRIPT_ENTRY_ASSISTANT,
+    APP_TRANSCRIPT_ENTRY_TOOL_CALL,
+    APP_TRANSCRIPT_ENTRY_LATENCY,
+    APP_TRANSCRIPT_ENTRY_MAX,
+} app_transcript_entry_type_t;
+
+/**
+ * @brief Cost of the transcript on the event path and its flash usage
+ */
+typedef struct {
+    uint32_t entries;           /**< Entries in the transcript */
+    uint32_t size;              /**< Size of the transcript in RAM, and of each flash save */
+    uint32_t appends;
+    uint64_t append_total_us;
+    uint32_t append_max_us;
+    uint32_t saves;
+    uint32_t saves_skipped;     /**< Saves skipped by CONFIG_APP_TRANSCRIPT_NVS_MIN_INTERVAL_S */
+    uint64_t saved_bytes;
+    uint32_t save_max_us;
+} app_transcript_stats_t;
+
+/**
+ * @brief Initialize the transcript store
+ *
+ * Allocates the RAM ring, restores the transcript saved in NVS (if enabled)
+ * and registers the `transcript` console command.
+ *
+ * @return ESP_OK on success, otherwise an error code
+ */
+esp_err_t app_transcript_init(void);
+
+/**
+ * @brief Append an entry to the transcript
+ *
+ * The oldest entry is overwritten when the transcript is full. The text is formatted
+ * directly into the ring and truncated to CONFIG_APP_TRANSCRIPT_ENTRY_MAX_LEN.
+ *
+ * @param type Entry type
+ * @param fmt printf style format of the entry text
+ * @return ESP_OK on success, otherwise an error code
+ */
+esp_err_t app_transcript_append(app_transcript_entry_type_t type, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Save the transcript to NVS
+ *
+ * Does nothing if nothing changed since the last save or if flash spill is disabled.
+ * Unless forced, saves are rate limited by CONFIG_APP_TRANSCRIPT_NVS_MIN_INTERVAL_S.
+ *
+ * @param force Save even if the minimum interval has not elapsed
+ * @return ESP_OK on success or if nothing had to be saved, otherwise an error code
+ */
+esp_err_t app_transcript_save(bool force);
+
+/**
+ * @brief Print the transcript, oldest entry first
+ *
+ * @return ESP_OK on success, otherwise an error code
+ */
+esp_err_t app_transcript_dump(void);
+
+/**
+ * @brief Get the cost statistics of the transcript, as printed by `transcript stats`
+ *
+ * @param[out] stats Statistics
+ * @return ESP_OK on success, otherwise an error code
+ */
+esp_err_t app_transcript_get_stats(app_transcript_stats_t *stats);
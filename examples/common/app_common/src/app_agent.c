@@ -4,6 +4,11 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+
 #include <esp_log.h>
 #include <esp_check.h>
 
@@ -13,10 +18,13 @@
 #include <setup/rainmaker.h>
 #include <board_defs.h>
 #include <esp_console.h>
+#include <agent_console.h>
 
 #include "app_audio.h"
 #include "app_agent.h"
 #include "app_device.h"
+#include "app_transcript.h"
+#include "app_intent.h"
 
 static const char *TAG = "app_agent";
 
@@ -27,10 +35,32 @@ typedef struct {
     esp_event_handler_instance_t agent_event_handler;
     esp_event_handler_instance_t agent_setup_event_handler;
     app_agent_config_t config;
+    atomic_bool user_speaking;
 } app_agent_data_t;
 
 app_agent_data_t g_app_agent_data;
 
+static const char *g_transport_counter_names[ESP_AGENT_TRANSPORT_COUNTER_MAX] = {
+    [ESP_AGENT_TRANSPORT_COUNTER_TX_TEXT] = "tx_text",
+    [ESP_AGENT_TRANSPORT_COUNTER_TX_AUDIO] = "tx_audio",
+    [ESP_AGENT_TRANSPORT_COUNTER_TX_TOOL] = "tx_tool",
+    [ESP_AGENT_TRANSPORT_COUNTER_RX_TEXT] = "rx_text",
+    [ESP_AGENT_TRANSPORT_COUNTER_RX_AUDIO] = "rx_audio",
+    [ESP_AGENT_TRANSPORT_COUNTER_RX_TOOL] = "rx_tool",
+};
+
+static const char *g_transport_queue_names[ESP_AGENT_TRANSPORT_QUEUE_MAX] = {
+    [ESP_AGENT_TRANSPORT_QUEUE_SEND] = "send",
+    [ESP_AGENT_TRANSPORT_QUEUE_MESSAGE] = "message",
+};
+
+static const char *g_mem_buffer_names[ESP_AGENT_MEM_MAX] = {
+    [ESP_AGENT_MEM_TX_TEXT] = "tx_text",
+    [ESP_AGENT_MEM_TX_AUDIO] = "tx_audio",
+    [ESP_AGENT_MEM_RX_TEXT] = "rx_text",
+    [ESP_AGENT_MEM_RX_AUDIO] = "rx_audio",
+};
+
 static inline void app_agent_update_state(app_agent_state_t state)
 {
     g_app_agent_data.state = state;
@@ -62,10 +92,25 @@ void app_agent_default_event_handler(void *arg, esp_event_base_t event_base, int
             break;
         case ESP_AGENT_EVENT_DATA_TYPE_TEXT:
             {
-                if (data->text.generation_stage == ESP_AGENT_MESSAGE_GENERATION_STAGE_FINAL) {
+                bool user = data->text.role == ESP_AGENT_MESSAGE_ROLE_USER;
+
+                /* The final assistant text repeats what was shown already */
+                if (!user && data->text.generation_stage == ESP_AGENT_MESSAGE_GENERATION_STAGE_FINAL) {
                     break;
                 }
 
+                /* Speculative assistant text is superseded by the next update, so only the last one is kept */
+                if (data->text.text && data->text.generation_stage != ESP_AGENT_MESSAGE_GENERATION_STAGE_SPECULATIVE) {
+                    app_transcript_append(user ? APP_TRANSCRIPT_ENTRY_USER : APP_TRANSCRIPT_ENTRY_ASSISTANT, "%s", data->text.text);
+                }
+
+                /* Only the end of the utterance runs intents: a final transcript, or one without a stage once the user stopped speaking */
+                if (user && (data->text.generation_stage == ESP_AGENT_MESSAGE_GENERATION_STAGE_FINAL ||
+                             (data->text.generation_stage == ESP_AGENT_MESSAGE_GENERATION_STAGE_UNKNOWN &&
+                              !atomic_load(&g_app_agent_data.user_speaking)))) {
+                    app_intent_handle_transcript(data->text.text);
+                }
+
                 app_device_event_t event = DEVICE_EVENT_SET_USER_TEXT;
                 char *text = NULL;
                 if (data->text.text) {
@@ -102,6 +147,60 @@ void app_agent_default_event_handler(void *arg, esp_event_base_t event_base, int
             app_agent_update_state(APP_AGENT_STATE_STARTED);
             ESP_LOGI(TAG, "ESP Agent Started");
             break;
+        case ESP_AGENT_EVENT_LATENCY:
+            {
+                esp_agent_latency_percentiles_t total = {0};
+                esp_agent_latency_get_percentiles(g_app_agent_data.agent_handle, ESP_AGENT_LATENCY_STAGE_FIRST_CODEC_WRITE, &total);
+                ESP_LOGI(TAG, "Turn %lu latency (ms): vad_end=%ld uplink_last=%ld stream_end=%ld downlink_first=%ld decoded_first=%ld codec_first=%ld",
+                         (unsigned long)data->latency.turn,
+                         (long)data->latency.stage_ms[ESP_AGENT_LATENCY_STAGE_VAD_END],
+                         (long)data->latency.stage_ms[ESP_AGENT_LATENCY_STAGE_UPLINK_LAST_FRAME],
+                         (long)data->latency.stage_ms[ESP_AGENT_LATENCY_STAGE_AUDIO_STREAM_END],
+                         (long)data->latency.stage_ms[ESP_AGENT_LATENCY_STAGE_DOWNLINK_FIRST_FRAME],
+                         (long)data->latency.stage_ms[ESP_AGENT_LATENCY_STAGE_FIRST_DECODED_FRAME],
+                         (long)data->latency.stage_ms[ESP_AGENT_LATENCY_STAGE_FIRST_CODEC_WRITE]);
+                ESP_LOGI(TAG, "End-to-end latency over last %lu turns (ms): p50=%lu p90=%lu p99=%lu max=%lu",
+                         (unsigned long)total.samples, (unsigned long)total.p50_ms, (unsigned long)total.p90_ms,
+                         (unsigned long)total.p99_ms, (unsigned long)total.max_ms);
+                app_transcript_append(APP_TRANSCRIPT_ENTRY_LATENCY, "turn %lu: first audio after %ld ms",
+                                      (unsigned long)data->latency.turn,
+                                      (long)data->latency.stage_ms[ESP_AGENT_LATENCY_STAGE_FIRST_CODEC_WRITE]);
+            }
+            break;
+        case ESP_AGENT_EVENT_LINK_HEALTH:
+            if (data->link_health.dead) {
+                ESP_LOGW(TAG, "Agent link dead, no pong for %lu ms", (unsigned long)data->link_health.silent_ms);
+            } else if (data->link_health.rtt_ms < 0) {
+                ESP_LOGW(TAG, "Agent link: %lu pongs missed", (unsigned long)data->link_health.missed_pongs);
+            } else {
+                ESP_LOGD(TAG, "Agent link rtt: %ld ms", (long)data->link_health.rtt_ms);
+            }
+            break;
+        case ESP_AGENT_EVENT_IDLE:
+            ESP_LOGI(TAG, "Agent connection idle, closing it until the next wake up");
+            break;
+        case ESP_AGENT_EVENT_USAGE:
+            ESP_LOGI(TAG, "Turn %lu usage: %lu input tokens, %lu output tokens, server=%ld ms response=%ld ms network=%ld ms",
+                     (unsigned long)data->usage.turn, (unsigned long)data->usage.input_tokens,
+                     (unsigned long)data->usage.output_tokens, (long)data->usage.server_ms,
+                     (long)data->usage.response_ms, (long)data->usage.network_ms);
+            break;
+        case ESP_AGENT_EVENT_TOOL_INFO:
+            if (data->tool_info.result && data->tool_info.duration_ms >= 0) {
+                ESP_LOGI(TAG, "Server tool %s done in %ld ms", data->tool_info.name ? data->tool_info.name : "?",
+                         (long)data->tool_info.duration_ms);
+            } else if (data->tool_info.result) {
+                /* Neither a duration nor a matching call to time it from */
+                ESP_LOGI(TAG, "Server tool %s done", data->tool_info.name ? data->tool_info.name : "?");
+            } else {
+                ESP_LOGD(TAG, "Server tool %s called", data->tool_info.name ? data->tool_info.name : "?");
+            }
+            break;
+        case ESP_AGENT_EVENT_TOOL_CALL:
+            ESP_LOGD(TAG, "Tool call: %s", data->tool.name);
+            app_transcript_append(APP_TRANSCRIPT_ENTRY_TOOL_CALL, "%s (%s)", data->tool.name ? data->tool.name : "?",
+                                  data->tool.request_id ? data->tool.request_id : "on device");
+            break;
         default:
             break;
     }
@@ -115,6 +214,14 @@ esp_err_t app_agent_send_speech(uint8_t *audio_data, size_t audio_data_len)
     return esp_agent_send_speech(g_app_agent_data.agent_handle, audio_data, audio_data_len, pdMS_TO_TICKS(1000));
 }
 
+esp_err_t app_agent_latency_mark(esp_agent_latency_stage_t stage)
+{
+    if (!g_app_agent_data.agent_handle) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return esp_agent_latency_mark(g_app_agent_data.agent_handle, stage);
+}
+
 void app_agent_start_task(void *arg)
 {
     char *agent_id = agent_setup_get_agent_id();
@@ -194,6 +301,240 @@ esp_err_t app_agent_connect(void)
     return ret;
 }
 
+/* Prints the transport statistics as a single JSON line, so that it can be collected by a script */
+static esp_err_t app_agent_stats_handler(int argc, char **argv)
+{
+    if (argc > 2 || (argc == 2 && strcmp(argv[1], "reset") != 0)) {
+        ESP_LOGE(TAG, "Usage: agent-stats [reset]");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!g_app_agent_data.agent_handle) {
+        ESP_LOGE(TAG, "Agent handle not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (argc == 2) {
+        return esp_agent_reset_transport_stats(g_app_agent_data.agent_handle);
+    }
+
+    esp_agent_transport_stats_t stats = {0};
+    esp_agent_latency_percentiles_t turn = {0};
+    esp_agent_link_health_t link = {0};
+    esp_agent_connection_stats_t connection = {0};
+    esp_agent_event_stats_t events = {0};
+    esp_agent_resume_stats_t resume = {0};
+    esp_agent_usage_stats_t usage = {0};
+    esp_agent_tool_dedup_stats_t tool_dedup = {0};
+    esp_agent_tool_cache_stats_t tool_cache = {0};
+    esp_agent_tool_exec_stats_t tool_exec = {0};
+    esp_agent_mem_stats_t mem = {0};
+    ESP_RETURN_ON_ERROR(esp_agent_get_transport_stats(g_app_agent_data.agent_handle, &stats), TAG, "Failed to get transport stats");
+    ESP_RETURN_ON_ERROR(esp_agent_get_link_health(g_app_agent_data.agent_handle, &link), TAG, "Failed to get link health");
+    ESP_RETURN_ON_ERROR(esp_agent_get_connection_stats(g_app_agent_data.agent_handle, &connection), TAG, "Failed to get connection stats");
+    ESP_RETURN_ON_ERROR(esp_agent_get_event_stats(g_app_agent_data.agent_handle, &events), TAG, "Failed to get event stats");
+    ESP_RETURN_ON_ERROR(esp_agent_get_resume_stats(g_app_agent_data.agent_handle, &resume), TAG, "Failed to get resume stats");
+    ESP_RETURN_ON_ERROR(esp_agent_get_usage_stats(g_app_agent_data.agent_handle, &usage), TAG, "Failed to get usage stats");
+    ESP_RETURN_ON_ERROR(esp_agent_get_tool_dedup_stats(g_app_agent_data.agent_handle, &tool_dedup), TAG, "Failed to get tool dedup stats");
+    ESP_RETURN_ON_ERROR(esp_agent_get_tool_cache_stats(g_app_agent_data.agent_handle, &tool_cache), TAG, "Failed to get tool cache stats");
+    ESP_RETURN_ON_ERROR(esp_agent_get_tool_exec_stats(g_app_agent_data.agent_handle, &tool_exec), TAG, "Failed to get tool exec stats");
+    ESP_RETURN_ON_ERROR(esp_agent_get_mem_stats(g_app_agent_data.agent_handle, &mem), TAG, "Failed to get memory stats");
+    ESP_RETURN_ON_ERROR(esp_agent_latency_get_percentiles(g_app_agent_data.agent_handle, ESP_AGENT_LATENCY_STAGE_FIRST_CODEC_WRITE, &turn), TAG, "Failed to get latency percentiles");
+
+    uint64_t elapsed_ms = stats.elapsed_us > 0 ? stats.elapsed_us / 1000 : 0;
+
+    printf("{\"elapsed_ms\":%llu,\"messages\":{", elapsed_ms);
+    for (int i = 0; i < ESP_AGENT_TRANSPORT_COUNTER_MAX; i++) {
+        uint64_t per_sec = elapsed_ms ? (uint64_t)stats.messages[i] * 1000 / elapsed_ms : 0;
+        printf("%s\"%s\":{\"count\":%lu,\"bytes\":%llu,\"per_sec\":%llu}", i ? "," : "", g_transport_counter_names[i],
+               (unsigned long)stats.messages[i], stats.bytes[i], per_sec);
+    }
+    printf("},\"tx_dropped\":%lu,\"rx_dropped\":%lu,\"bytes_copied\":%llu,\"allocations\":%lu,\"queue_latency_us\":{",
+           (unsigned long)stats.tx_dropped, (unsigned long)stats.rx_dropped, stats.bytes_copied, (unsigned long)stats.allocations);
+    for (int i = 0; i < ESP_AGENT_TRANSPORT_QUEUE_MAX; i++) {
+        printf("%s\"%s\":{\"samples\":%lu,\"p50\":%lu,\"p99\":%lu,\"max\":%lu}", i ? "," : "", g_transport_queue_names[i],
+               (unsigned long)stats.queue_latency[i].samples, (unsigned long)stats.queue_latency[i].p50_us,
+               (unsigned long)stats.queue_latency[i].p99_us, (unsigned long)stats.queue_latency[i].max_us);
+    }
+    printf("},\"turn_latency_ms\":{\"samples\":%lu,\"p50\":%lu,\"p90\":%lu,\"p99\":%lu,\"max\":%lu}",
+           (unsigned long)turn.samples, (unsigned long)turn.p50_ms, (unsigned long)turn.p90_ms,
+           (unsigned long)turn.p99_ms, (unsigned long)turn.max_ms);
+    printf(",\"compression\":{\"memory\":%lu", (unsigned long)stats.compression_memory);
+    const esp_agent_compression_stats_t *compression[] = { &stats.tx_compression, &stats.rx_compression };
+    for (int i = 0; i < 2; i++) {
+        printf(",\"%s\":{\"count\":%lu,\"original\":%llu,\"compressed\":%llu,\"cpu_us\":%llu}", i ? "rx" : "tx",
+               (unsigned long)compression[i]->messages, compression[i]->original_bytes,
+               compression[i]->compressed_bytes, compression[i]->cpu_us);
+    }
+    printf("}");
+    printf(",\"audio_uplink\":{\"frames\":%lu,\"messages\":%lu,\"overhead_bytes\":%llu,\"window_ms\":%lu,\"added_latency_us\":{\"samples\":%lu,\"p50\":%lu,\"p99\":%lu,\"max\":%lu}}",
+           (unsigned long)stats.audio_uplink.frames, (unsigned long)stats.audio_uplink.messages,
+           stats.audio_uplink.overhead_bytes, (unsigned long)stats.audio_uplink.window_ms,
+           (unsigned long)stats.audio_uplink.added_latency.samples, (unsigned long)stats.audio_uplink.added_latency.p50_us,
+           (unsigned long)stats.audio_uplink.added_latency.p99_us, (unsigned long)stats.audio_uplink.added_latency.max_us);
+    printf(",\"send_path\":{\"fragmented\":%lu,\"fragments\":%lu,\"stalls\":%lu,\"stall_ms\":%llu,\"deadline_expired\":%lu,\"write_us\":{\"samples\":%lu,\"p50\":%lu,\"p99\":%lu,\"max\":%lu}}",
+           (unsigned long)stats.send_path.fragmented_messages, (unsigned long)stats.send_path.fragments,
+           (unsigned long)stats.send_path.stalls, stats.send_path.stall_ms, (unsigned long)stats.send_path.deadline_expired,
+           (unsigned long)stats.send_path.write_time.samples, (unsigned long)stats.send_path.write_time.p50_us,
+           (unsigned long)stats.send_path.write_time.p99_us, (unsigned long)stats.send_path.write_time.max_us);
+    printf(",\"connection\":{\"connects\":%lu,\"resumes\":%lu,\"idle_closes\":%lu,\"connected_ms\":%llu,\"uptime_ms\":%llu",
+           (unsigned long)connection.connects, (unsigned long)connection.resumes, (unsigned long)connection.idle_closes,
+           connection.connected_ms, connection.uptime_ms);
+    const esp_agent_latency_percentiles_t *connect_latency[] = { &connection.connect, &connection.resume };
+    for (int i = 0; i < 2; i++) {
+        printf(",\"%s_ms\":{\"samples\":%lu,\"p50\":%lu,\"p90\":%lu,\"max\":%lu}", i ? "resume" : "connect",
+               (unsigned long)connect_latency[i]->samples, (unsigned long)connect_latency[i]->p50_ms,
+               (unsigned long)connect_latency[i]->p90_ms, (unsigned long)connect_latency[i]->max_ms);
+    }
+    const esp_agent_queue_latency_t *call_latency[] = { &connection.start_call, &connection.stop_call };
+    for (int i = 0; i < 2; i++) {
+        printf(",\"%s_us\":{\"samples\":%lu,\"p50\":%lu,\"p99\":%lu,\"max\":%lu}", i ? "stop" : "start",
+               (unsigned long)call_latency[i]->samples, (unsigned long)call_latency[i]->p50_us,
+               (unsigned long)call_latency[i]->p99_us, (unsigned long)call_latency[i]->max_us);
+    }
+    printf(",\"stops\":%lu,\"heap\":{\"free_first\":%lu,\"free_last\":%lu,\"largest_last\":%lu,\"largest_min\":%lu}}",
+           (unsigned long)connection.stops, (unsigned long)connection.heap_free_first, (unsigned long)connection.heap_free_last,
+           (unsigned long)connection.heap_largest_block_last, (unsigned long)connection.heap_largest_block_min);
+    printf(",\"events\":{\"deferred\":%lu,\"replaced\":%lu,\"dropped\":%lu,\"cleared\":%lu,\"backlog\":%lu,\"max_backlog\":%lu",
+           (unsigned long)events.deferred, (unsigned long)events.replaced, (unsigned long)events.dropped,
+           (unsigned long)events.cleared, (unsigned long)events.backlog, (unsigned long)events.max_backlog);
+    static const char *const stream_names[ESP_AGENT_EVENT_STREAM_MAX] = {
+        [ESP_AGENT_EVENT_STREAM_THINKING] = "thinking",
+        [ESP_AGENT_EVENT_STREAM_SPECULATIVE] = "speculative",
+        [ESP_AGENT_EVENT_STREAM_USER_SPECULATIVE] = "user_speculative",
+    };
+    for (int i = 0; i < ESP_AGENT_EVENT_STREAM_MAX; i++) {
+        printf(",\"%s\":{\"received\":%lu,\"delivered\":%lu,\"discarded\":%lu}", stream_names[i],
+               (unsigned long)events.streams[i].received, (unsigned long)events.streams[i].delivered,
+               (unsigned long)events.streams[i].discarded);
+    }
+    printf("}");
+    printf(",\"resume\":{\"negotiated\":%s,\"tx_seq\":%lu,\"rx_seq\":%lu,\"unacked\":%lu,\"resumes\":%lu,\"replayed\":%lu,\"replayed_bytes\":%llu,\"duplicates\":%lu,\"gaps\":%lu,\"evicted\":%lu,\"recovery_ms\":{\"samples\":%lu,\"p50\":%lu,\"p90\":%lu,\"max\":%lu}}",
+           resume.negotiated ? "true" : "false", (unsigned long)resume.tx_seq, (unsigned long)resume.rx_seq,
+           (unsigned long)resume.unacked, (unsigned long)resume.resumes, (unsigned long)resume.replayed_messages,
+           resume.replayed_bytes, (unsigned long)resume.duplicates, (unsigned long)resume.gaps, (unsigned long)resume.evicted,
+           (unsigned long)resume.recovery.samples, (unsigned long)resume.recovery.p50_ms,
+           (unsigned long)resume.recovery.p90_ms, (unsigned long)resume.recovery.max_ms);
+    printf(",\"usage\":{\"turns\":%lu,\"input_tokens\":%llu,\"output_tokens\":%llu",
+           (unsigned long)usage.turns, usage.input_tokens, usage.output_tokens);
+    printf(",\"session\":{\"turns\":%lu,\"input_tokens\":%llu,\"output_tokens\":%llu}",
+           (unsigned long)usage.session_turns, usage.session_input_tokens, usage.session_output_tokens);
+    const esp_agent_latency_percentiles_t *usage_latency[] = { &usage.server, &usage.network };
+    for (int i = 0; i < 2; i++) {
+        printf(",\"%s_ms\":{\"samples\":%lu,\"p50\":%lu,\"p90\":%lu,\"max\":%lu}", i ? "network" : "server",
+               (unsigned long)usage_latency[i]->samples, (unsigned long)usage_latency[i]->p50_ms,
+               (unsigned long)usage_latency[i]->p90_ms, (unsigned long)usage_latency[i]->max_ms);
+    }
+    printf("}");
+    printf(",\"tool_dedup\":{\"requests\":%lu,\"duplicates\":%lu,\"in_flight\":%lu,\"evicted\":%lu,\"entries\":%lu,\"bytes\":%lu}",
+           (unsigned long)tool_dedup.requests, (unsigned long)tool_dedup.duplicates, (unsigned long)tool_dedup.in_flight_duplicates,
+           (unsigned long)tool_dedup.evicted, (unsigned long)tool_dedup.entries, (unsigned long)tool_dedup.bytes);
+    printf(",\"tool_cache\":{\"hits\":%lu,\"misses\":%lu,\"invalidated\":%lu,\"saved_ms\":%llu,\"entries\":%lu}",
+           (unsigned long)tool_cache.hits, (unsigned long)tool_cache.misses, (unsigned long)tool_cache.invalidated,
+           (unsigned long long)tool_cache.saved_ms, (unsigned long)tool_cache.entries);
+    printf(",\"tool_exec\":{\"running\":%lu,\"max_running\":%lu,\"slot_waits\":%lu,\"serialized_waits\":%lu,\"validated\":%lu,\"rejected\":%lu,\"validation_us\":%llu}",
+           (unsigned long)tool_exec.running, (unsigned long)tool_exec.max_running,
+           (unsigned long)tool_exec.slot_waits, (unsigned long)tool_exec.serialized_waits,
+           (unsigned long)tool_exec.validated, (unsigned long)tool_exec.rejected, (unsigned long long)tool_exec.validation_us);
+    printf(",\"memory\":{\"internal_free\":%lu,\"internal_min_free\":%lu,\"external_free\":%lu,\"queues_external\":%s",
+           (unsigned long)mem.internal_free, (unsigned long)mem.internal_min_free, (unsigned long)mem.external_free,
+           mem.queues_external ? "true" : "false");
+    for (int i = 0; i < ESP_AGENT_MEM_MAX; i++) {
+        const esp_agent_mem_buffer_stats_t *buffer = &mem.buffers[i];
+        printf(",\"%s\":{\"caps\":%lu,\"allocations\":%lu,\"internal_allocations\":%lu,\"fallbacks\":%lu,\"failures\":%lu,"
+               "\"bytes\":%llu,\"internal_bytes\":%llu,\"copies\":%lu,\"copy_bytes\":%llu,\"timed_copy_bytes\":%llu,\"copy_us\":%llu}",
+               g_mem_buffer_names[i], (unsigned long)buffer->caps, (unsigned long)buffer->allocations,
+               (unsigned long)buffer->internal_allocations, (unsigned long)buffer->fallbacks, (unsigned long)buffer->failures,
+               (unsigned long long)buffer->bytes, (unsigned long long)buffer->internal_bytes, (unsigned long)buffer->copies,
+               (unsigned long long)buffer->copy_bytes, (unsigned long long)buffer->timed_copy_bytes, (unsigned long long)buffer->copy_us);
+    }
+    printf("}");
+    app_audio_connect_buffer_stats_t connect_buffer = {0};
+    app_audio_get_connect_buffer_stats(&connect_buffer);
+    printf(",\"connect_buffer\":{\"utterances\":%lu,\"lost\":%lu,\"buffered\":%lu,\"flushed\":%lu,\"dropped_full\":%lu,\"dropped_age\":%lu,\"send_failures\":%lu,\"wake_to_uplink_ms\":{\"last\":%lu,\"max\":%lu}}",
+           (unsigned long)connect_buffer.utterances, (unsigned long)connect_buffer.lost_utterances,
+           (unsigned long)connect_buffer.buffered_frames, (unsigned long)connect_buffer.flushed_frames,
+           (unsigned long)connect_buffer.dropped_full, (unsigned long)connect_buffer.dropped_age,
+           (unsigned long)connect_buffer.send_failures,
+           (unsigned long)connect_buffer.last_wake_to_uplink_ms, (unsigned long)connect_buffer.max_wake_to_uplink_ms);
+    printf(",\"link\":{\"pings\":%lu,\"pongs\":%lu,\"missed\":%lu,\"dead\":%lu,\"rtt_ms\":{\"samples\":%lu,\"p50\":%lu,\"p90\":%lu,\"p99\":%lu,\"max\":%lu}}}\n",
+           (unsigned long)link.pings_sent, (unsigned long)link.pongs_received, (unsigned long)link.missed_pongs,
+           (unsigned long)link.dead_links, (unsigned long)link.rtt.samples, (unsigned long)link.rtt.p50_ms,
+           (unsigned long)link.rtt.p90_ms, (unsigned long)link.rtt.p99_ms, (unsigned long)link.rtt.max_ms);
+
+    return ESP_OK;
+}
+
+static int tool_stats_compare(const void *a, const void *b)
+{
+    uint32_t max_a = 0, max_b = 0;
+    for (int i = 0; i < ESP_AGENT_TOOL_TIMING_MAX; i++) {
+        max_a = MAX(max_a, ((const esp_agent_tool_stats_t *)a)->timing[i].max_ms);
+        max_b = MAX(max_b, ((const esp_agent_tool_stats_t *)b)->timing[i].max_ms);
+    }
+    return (max_a < max_b) - (max_a > max_b);
+}
+
+static esp_err_t app_tool_stats_handler(int argc, char **argv)
+{
+    if (!g_app_agent_data.agent_handle) {
+        ESP_LOGE(TAG, "Agent handle not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    size_t num_tools = 0;
+    esp_agent_tool_stats_t *tools = calloc(CONFIG_ESP_AGENT_TOOL_STATS_MAX, sizeof(esp_agent_tool_stats_t));
+    ESP_RETURN_ON_FALSE(tools, ESP_ERR_NO_MEM, TAG, "Failed to allocate tool stats");
+    esp_err_t err = esp_agent_get_tool_stats(g_app_agent_data.agent_handle, tools, CONFIG_ESP_AGENT_TOOL_STATS_MAX, &num_tools);
+    if (err != ESP_OK) {
+        free(tools);
+        return err;
+    }
+
+    /* Slowest first */
+    qsort(tools, num_tools, sizeof(esp_agent_tool_stats_t), tool_stats_compare);
+    printf("%-24s %6s %8s %8s %-6s histogram <10/50/100/250/500/1000/2500/more ms\n", "tool", "calls", "avg_ms", "max_ms", "source");
+    for (size_t i = 0; i < num_tools; i++) {
+        if (tools[i].stack_size) {
+            printf("%-24s stack %lu bytes, at least %lu left unused\n", tools[i].name,
+                   (unsigned long)tools[i].stack_size, (unsigned long)tools[i].stack_min_free);
+        }
+        for (int source = 0; source < ESP_AGENT_TOOL_TIMING_MAX; source++) {
+            const esp_agent_tool_timing_t *timing = &tools[i].timing[source];
+            if (timing->calls == 0) {
+                continue;
+            }
+            printf("%-24s %6lu %8lu %8lu %-6s", tools[i].name, (unsigned long)timing->calls,
+                   (unsigned long)(timing->total_ms / timing->calls), (unsigned long)timing->max_ms,
+                   source == ESP_AGENT_TOOL_TIMING_CLOUD ? "cloud" : "local");
+            for (int bucket = 0; bucket < ESP_AGENT_TOOL_HISTOGRAM_BUCKETS; bucket++) {
+                printf(" %lu", (unsigned long)timing->histogram[bucket]);
+            }
+            printf("\n");
+        }
+    }
+
+    free(tools);
+    return ESP_OK;
+}
+
+static esp_err_t register_agent_commands(void)
+{
+    esp_console_cmd_t cmd = {
+        .command = "agent-stats",
+        .help = "Print agent transport statistics as JSON, or reset them\nUsage: agent-stats [reset]",
+        .func = app_agent_stats_handler,
+    };
+    ESP_RETURN_ON_ERROR(agent_console_register_command(&cmd), TAG, "Failed to register agent-stats");
+
+    esp_console_cmd_t tool_stats_cmd = {
+        .command = "tool-stats",
+        .help = "Print the latency of server and local tools, slowest first, and the stack used by local tool tasks",
+        .func = app_tool_stats_handler,
+    };
+    return agent_console_register_command(&tool_stats_cmd);
+}
+
 esp_err_t app_agent_init(app_agent_config_t *config)
 {
     if (g_app_agent_data.initialized) {
@@ -238,6 +579,9 @@ esp_err_t app_agent_init(app_agent_config_t *config)
     esp_event_handler_t handler = config->event_handler;
     ESP_RETURN_ON_ERROR(esp_agent_register_event_handler(g_app_agent_data.agent_handle, ESP_EVENT_ANY_ID, handler, NULL, &g_app_agent_data.agent_event_handler), TAG, "Failed to register agent event handler");
 
+    ESP_RETURN_ON_ERROR(register_agent_commands(), TAG, "Failed to register agent commands");
+    ESP_RETURN_ON_ERROR(app_transcript_init(), TAG, "Failed to initialize transcript");
+
     g_app_agent_data.state = APP_AGENT_STATE_DISCONNECTED;
     g_app_agent_data.initialized = true;
     g_app_agent_data.config = *config;
@@ -262,6 +606,11 @@ esp_err_t app_agent_start(void)
     return ret;
 }
 
+void app_agent_set_user_speaking(bool speaking)
+{
+    atomic_store(&g_app_agent_data.user_speaking, speaking);
+}
+
 bool app_agent_is_active(void)
 {
     return (g_app_agent_data.state == APP_AGENT_STATE_STARTED);
@@ -285,6 +634,36 @@ esp_err_t app_agent_register_tool(const char *name, esp_agent_tool_handler_t too
     return err;
 }
 
+esp_err_t app_agent_register_tool_with_config(const esp_agent_tool_config_t *config)
+{
+    if (!g_app_agent_data.agent_handle) {
+        ESP_LOGE(TAG, "Agent handle not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t err = esp_agent_register_local_tool_with_config(g_app_agent_data.agent_handle, config);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to register local tool: %s", config ? config->name : "");
+    }
+    return err;
+}
+
+esp_err_t app_agent_invalidate_tool_cache(const char *name)
+{
+    if (!g_app_agent_data.agent_handle) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return esp_agent_invalidate_tool_cache(g_app_agent_data.agent_handle, name);
+}
+
+esp_err_t app_agent_run_tool(const char *name, const esp_agent_tool_param_t params[], size_t num_params)
+{
+    if (!g_app_agent_data.agent_handle) {
+        ESP_LOGE(TAG, "Agent handle not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+    return esp_agent_run_local_tool(g_app_agent_data.agent_handle, name, params, num_params);
+}
+
 esp_err_t app_agent_tool_unregister(const char *name)
 {
     if (!g_app_agent_data.agent_handle) {
@@ -4,9 +4,13 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <string.h>
+
 #include <esp_check.h>
 #include <esp_log.h>
 #include <driver/i2s_std.h>
+#include <esp_timer.h>
+#include <freertos/ringbuf.h>
 #include <nvs_flash.h>
 #include <agent_setup.h>
 #include <agent_console.h>
@@ -35,12 +39,29 @@ typedef struct {
     uint8_t volume;
 } app_audio_data_t;
 
+/* Audio captured on wake while the agent connects. Only accessed from the microphone task. */
+typedef struct {
+    RingbufHandle_t ring;
+    size_t frames;                      /* Including the oldest one */
+    struct connect_buffer_frame *oldest; /* Received from the ring to read its age, returned once dropped or sent */
+    size_t oldest_size;
+    int64_t wake_us;                    /* Capture start of the buffered utterance, 0 if none */
+    bool uplink_started;
+    app_audio_connect_buffer_stats_t stats;
+} app_audio_connect_buffer_t;
+
+/* Item stored in the ring, followed by the frame data */
+typedef struct connect_buffer_frame {
+    int64_t captured_us;
+} connect_buffer_frame_t;
+
 typedef struct {
     const char *dac;
     esp_codec_dev_vol_map_t vol_map[2];
 } dac_volume_curve_map;
 
 app_audio_data_t g_app_audio_data;
+static app_audio_connect_buffer_t g_connect_buffer;
 
 #define APP_AUDIO_NVS_NAMESPACE "app_audio"
 #define APP_AUDIO_NVS_KEY_VOLUME "volume"
@@ -153,13 +174,196 @@ static void audio_recorder_event_handler(audio_recorder_handle_t handle, audio_r
             app_device_event_enqueue(DEVICE_EVENT_WAKEUP);
             break;
         case AUDIO_RECORDER_EVENT_WAKEUP_END:
+            app_agent_set_user_speaking(false);
             app_device_event_enqueue(DEVICE_EVENT_SLEEP);
             break;
+        case AUDIO_RECORDER_EVENT_VAD_START:
+            app_agent_set_user_speaking(true);
+            break;
+        case AUDIO_RECORDER_EVENT_VAD_END:
+            app_agent_set_user_speaking(false);
+            app_agent_latency_mark(ESP_AGENT_LATENCY_STAGE_VAD_END);
+            break;
+        default:
+            break;
+    }
+}
+
+static void audio_playback_event_handler(audio_playback_handle_t handle, audio_playback_event_t event, void *user_data)
+{
+    switch (event) {
+        case AUDIO_PLAYBACK_EVENT_FRAME_DECODED:
+            app_agent_latency_mark(ESP_AGENT_LATENCY_STAGE_FIRST_DECODED_FRAME);
+            break;
+        case AUDIO_PLAYBACK_EVENT_CODEC_WRITE:
+            app_agent_latency_mark(ESP_AGENT_LATENCY_STAGE_FIRST_CODEC_WRITE);
+            break;
         default:
             break;
     }
 }
 
+#if CONFIG_APP_AUDIO_CONNECT_BUFFER
+static bool connect_buffer_pending(void)
+{
+    return g_connect_buffer.frames > 0;
+}
+
+/* The oldest frame, kept out of the ring until it is dropped or sent */
+static connect_buffer_frame_t *connect_buffer_oldest(size_t *size)
+{
+    if (g_connect_buffer.oldest == NULL && g_connect_buffer.frames > 0) {
+        g_connect_buffer.oldest = xRingbufferReceive(g_connect_buffer.ring, &g_connect_buffer.oldest_size, 0);
+        if (g_connect_buffer.oldest == NULL) {
+            g_connect_buffer.frames = 0;
+        }
+    }
+    *size = g_connect_buffer.oldest_size;
+    return g_connect_buffer.oldest;
+}
+
+static void connect_buffer_drop_oldest(void)
+{
+    size_t size = 0;
+    if (connect_buffer_oldest(&size)) {
+        vRingbufferReturnItem(g_connect_buffer.ring, g_connect_buffer.oldest);
+        g_connect_buffer.oldest = NULL;
+        g_connect_buffer.frames--;
+    }
+}
+
+static bool connect_buffer_expired(const connect_buffer_frame_t *frame, int64_t now)
+{
+    return now - frame->captured_us > CONFIG_APP_AUDIO_CONNECT_BUFFER_MAX_AGE_MS * 1000LL;
+}
+
+static void connect_buffer_push(const uint8_t *data, size_t len)
+{
+    if (g_connect_buffer.ring == NULL) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    if (g_connect_buffer.wake_us == 0) {
+        g_connect_buffer.wake_us = now;
+        g_connect_buffer.uplink_started = false;
+        g_connect_buffer.stats.utterances++;
+    }
+
+    /* Frames too old to be sent make room first */
+    size_t size = 0;
+    connect_buffer_frame_t *oldest;
+    while ((oldest = connect_buffer_oldest(&size)) != NULL && connect_buffer_expired(oldest, now)) {
+        connect_buffer_drop_oldest();
+        g_connect_buffer.stats.dropped_age++;
+    }
+
+    /* The oldest audio goes first if the connection takes longer than the buffer lasts */
+    void *item = NULL;
+    while (xRingbufferSendAcquire(g_connect_buffer.ring, &item, sizeof(connect_buffer_frame_t) + len, 0) != pdTRUE) {
+        if (g_connect_buffer.frames == 0) {
+            g_connect_buffer.stats.dropped_full++;
+            return;
+        }
+        connect_buffer_drop_oldest();
+        g_connect_buffer.stats.dropped_full++;
+    }
+
+    connect_buffer_frame_t *frame = (connect_buffer_frame_t *)item;
+    frame->captured_us = now;
+    memcpy(frame + 1, data, len);
+    xRingbufferSendComplete(g_connect_buffer.ring, item);
+    g_connect_buffer.frames++;
+    g_connect_buffer.stats.buffered_frames++;
+}
+
+/* Send up to max_frames buffered frames. The live frame is queued behind them, so the order is kept
+ * and the buffer drains at most max_frames times faster than real time.
+ */
+static esp_err_t connect_buffer_flush(int max_frames)
+{
+    esp_err_t err = ESP_OK;
+    int sent = 0;
+
+    while (sent < max_frames && g_connect_buffer.frames > 0) {
+        size_t size = 0;
+        connect_buffer_frame_t *frame = connect_buffer_oldest(&size);
+        if (frame == NULL) {
+            break;
+        }
+
+        int64_t now = esp_timer_get_time();
+        if (connect_buffer_expired(frame, now)) {
+            connect_buffer_drop_oldest();
+            g_connect_buffer.stats.dropped_age++;
+            continue;
+        }
+
+        err = app_agent_send_speech((uint8_t *)(frame + 1), size - sizeof(connect_buffer_frame_t));
+        connect_buffer_drop_oldest();
+        if (err != ESP_OK) {
+            g_connect_buffer.stats.send_failures++;
+            break;
+        }
+        sent++;
+        g_connect_buffer.stats.flushed_frames++;
+
+        if (!g_connect_buffer.uplink_started) {
+            g_connect_buffer.uplink_started = true;
+            uint32_t wake_to_uplink_ms = (uint32_t)((now - g_connect_buffer.wake_us) / 1000);
+            g_connect_buffer.stats.last_wake_to_uplink_ms = wake_to_uplink_ms;
+            if (wake_to_uplink_ms > g_connect_buffer.stats.max_wake_to_uplink_ms) {
+                g_connect_buffer.stats.max_wake_to_uplink_ms = wake_to_uplink_ms;
+            }
+            ESP_LOGI(TAG, "First buffered frame sent %lu ms after wake", (unsigned long)wake_to_uplink_ms);
+        }
+    }
+
+    if (g_connect_buffer.frames == 0) {
+        if (!g_connect_buffer.uplink_started) {
+            /* Everything aged out before the agent connected */
+            g_connect_buffer.stats.lost_utterances++;
+        }
+        g_connect_buffer.wake_us = 0;
+    }
+    return err;
+}
+
+/* The device went back to sleep, or gave up connecting, before the buffered audio was sent */
+static void connect_buffer_discard(void)
+{
+    if (g_connect_buffer.wake_us == 0) {
+        return;
+    }
+    while (g_connect_buffer.frames > 0) {
+        connect_buffer_drop_oldest();
+    }
+    if (!g_connect_buffer.uplink_started) {
+        g_connect_buffer.stats.lost_utterances++;
+    }
+    g_connect_buffer.wake_us = 0;
+    ESP_LOGW(TAG, "Discarded audio captured while connecting");
+}
+#else
+static bool connect_buffer_pending(void)
+{
+    return false;
+}
+
+static void connect_buffer_push(const uint8_t *data, size_t len)
+{
+}
+
+static esp_err_t connect_buffer_flush(int max_frames)
+{
+    return ESP_OK;
+}
+
+static void connect_buffer_discard(void)
+{
+}
+#endif /* CONFIG_APP_AUDIO_CONNECT_BUFFER */
+
 static void audio_microphone_task(void *arg)
 {
     uint8_t *audio_data = (uint8_t *) malloc(AUDIO_SEND_BUFFER_SIZE);
@@ -174,12 +378,21 @@ static void audio_microphone_task(void *arg)
         esp_err_t err = ESP_OK;
         switch (g_app_audio_data.microphone_state) {
             case MICROPHONE_STATE_START:
-                err = app_agent_send_speech(audio_data, audio_data_len);
+                if (connect_buffer_pending()) {
+                    connect_buffer_push(audio_data, audio_data_len);
+                    err = connect_buffer_flush(CONFIG_APP_AUDIO_CONNECT_BUFFER_FLUSH_FRAMES);
+                } else {
+                    err = app_agent_send_speech(audio_data, audio_data_len);
+                }
                 break;
             case MICROPHONE_STATE_PAUSE:
                 err = app_agent_send_speech(dummy_audio_data, OPUS_DUMMY_FRAME_DATA_SIZE);
                 break;
+            case MICROPHONE_STATE_BUFFER:
+                connect_buffer_push(audio_data, audio_data_len);
+                continue; // While loop
             case MICROPHONE_STATE_STOP:
+                connect_buffer_discard();
                 vTaskDelay(pdMS_TO_TICKS(10));
                 continue; // While loop
             default:
@@ -286,6 +499,8 @@ static esp_err_t audio_init_speaker()
         return ESP_FAIL;
     }
 
+    audio_playback_add_event_cb(g_app_audio_data.playback_handle, audio_playback_event_handler, NULL);
+
     return ESP_OK;
 }
 
@@ -340,6 +555,11 @@ esp_err_t app_audio_init(void)
     /* Register volume callbacks with RainMaker */
     ESP_RETURN_ON_ERROR(setup_rainmaker_register_volume_callbacks(app_audio_get_volume_cb, app_audio_set_volume_cb), TAG, "Failed to register volume callbacks");
 
+#if CONFIG_APP_AUDIO_CONNECT_BUFFER
+    g_connect_buffer.ring = xRingbufferCreate(CONFIG_APP_AUDIO_CONNECT_BUFFER_SIZE_KB * 1024, RINGBUF_TYPE_NOSPLIT);
+    ESP_RETURN_ON_FALSE(g_connect_buffer.ring, ESP_ERR_NO_MEM, TAG, "Failed to create connect buffer");
+#endif
+
     g_app_audio_data.event_group = xEventGroupCreate();
     g_app_audio_data.initialized = true;
 
@@ -404,6 +624,9 @@ esp_err_t app_audio_microphone_set_state(app_audio_microphone_state_t state)
         case MICROPHONE_STATE_PAUSE:
             ESP_LOGI(TAG, "Pausing microphone");
             break;
+        case MICROPHONE_STATE_BUFFER:
+            ESP_LOGI(TAG, "Buffering microphone until the agent connects");
+            break;
         case MICROPHONE_STATE_STOP:
             ESP_LOGI(TAG, "Stopping microphone");
             break;
@@ -461,3 +684,12 @@ esp_err_t app_audio_play_media_async(const char *media_url, const uint8_t *data,
 {
     return audio_playback_play_media_async(g_app_audio_data.playback_handle, media_url, data, data_len);
 }
+
+esp_err_t app_audio_get_connect_buffer_stats(app_audio_connect_buffer_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *stats = g_connect_buffer.stats;
+    return ESP_OK;
+}
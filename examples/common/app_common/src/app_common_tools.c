@@ -14,6 +14,8 @@
 #include "app_common_tools.h"
 #include "app_audio.h"
 #include "app_device.h"
+#include "app_intent.h"
+#include "app_agent.h"
 
 static const char *TAG = "app_common_tools";
 
@@ -157,3 +159,71 @@ esp_err_t app_common_tools_set_volume_handler(esp_agent_handle_t handle, const c
     }
     return err;
 }
+
+static const esp_agent_tool_param_t g_volume_mute_params[] = {
+    { .name = "volume", .type = ESP_AGENT_PARAM_TYPE_INT, .value.i = 0 },
+};
+
+static const esp_agent_tool_param_t g_volume_half_params[] = {
+    { .name = "volume", .type = ESP_AGENT_PARAM_TYPE_INT, .value.i = 50 },
+};
+
+static const esp_agent_tool_param_t g_volume_max_params[] = {
+    { .name = "volume", .type = ESP_AGENT_PARAM_TYPE_INT, .value.i = 100 },
+};
+
+static const app_intent_t g_common_intents[] = {
+    { "mute", TOOL_NAME_SET_VOLUME, g_volume_mute_params, 1 },
+    { "volume off", TOOL_NAME_SET_VOLUME, g_volume_mute_params, 1 },
+    { "half volume", TOOL_NAME_SET_VOLUME, g_volume_half_params, 1 },
+    { "full volume", TOOL_NAME_SET_VOLUME, g_volume_max_params, 1 },
+    { "maximum volume", TOOL_NAME_SET_VOLUME, g_volume_max_params, 1 },
+};
+
+/* As declared in agent_config.json */
+static const esp_agent_tool_param_schema_t g_set_reminder_schema[] = {
+    { .name = "task", .type = ESP_AGENT_PARAM_TYPE_STRING, .required = true },
+    { .name = "timeout", .type = ESP_AGENT_PARAM_TYPE_INT, .required = true },
+};
+
+/* The range is the one in the description of the volume in agent_config.json */
+static const esp_agent_tool_param_schema_t g_set_volume_schema[] = {
+    { .name = "volume", .type = ESP_AGENT_PARAM_TYPE_INT, .required = true, .has_range = true, .min = 0, .max = 100 },
+};
+
+esp_err_t app_common_tools_register(void)
+{
+    esp_agent_tool_config_t set_reminder_config = {
+        .name = TOOL_NAME_SET_REMINDER,
+        .handler = app_common_tools_set_reminder_handler,
+        .params = g_set_reminder_schema,
+        .num_params = sizeof(g_set_reminder_schema) / sizeof(g_set_reminder_schema[0]),
+    };
+    ESP_RETURN_ON_ERROR(app_agent_register_tool_with_config(&set_reminder_config), TAG, "Failed to register %s", TOOL_NAME_SET_REMINDER);
+
+    /* The time has a resolution of a second, so repeated requests within a second get the same answer.
+     * Reading it never blocks, so it does not need a task of its own.
+     */
+    esp_agent_tool_config_t get_local_time_config = {
+        .name = TOOL_NAME_GET_LOCAL_TIME,
+        .handler = app_common_tools_get_local_time_handler,
+        .cache_ttl_ms = 1000,
+        .exec_mode = ESP_AGENT_TOOL_EXEC_INLINE,
+    };
+    ESP_RETURN_ON_ERROR(app_agent_register_tool_with_config(&get_local_time_config), TAG, "Failed to register %s", TOOL_NAME_GET_LOCAL_TIME);
+
+    esp_agent_tool_config_t set_volume_config = {
+        .name = TOOL_NAME_SET_VOLUME,
+        .handler = app_common_tools_set_volume_handler,
+        .params = g_set_volume_schema,
+        .num_params = sizeof(g_set_volume_schema) / sizeof(g_set_volume_schema[0]),
+    };
+    ESP_RETURN_ON_ERROR(app_agent_register_tool_with_config(&set_volume_config), TAG, "Failed to register %s", TOOL_NAME_SET_VOLUME);
+
+    return app_common_tools_register_intents();
+}
+
+esp_err_t app_common_tools_register_intents(void)
+{
+    return app_intent_register(g_common_intents, sizeof(g_common_intents) / sizeof(g_common_intents[0]));
+}
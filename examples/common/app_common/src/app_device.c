@@ -13,6 +13,7 @@
 #include "app_device.h"
 #include "app_capacitive_touch.h"
 #include "app_touch_press.h"
+#include "app_transcript.h"
 #include "board_defs.h"
 #ifdef INDICATOR_DEVICE_NAME
 #include <dev_gpio_ctrl.h>
@@ -23,6 +24,13 @@ static const char *TAG = "app_device";
 #define REMINDER_DISPLAY_TIMEOUT_SECONDS 5
 #define AGENT_SLEEP_TIMEOUT_SECONDS 15
 
+/* A wake gives up if the agent has not started by then. Buffered audio is too old to send after this anyway. */
+#if CONFIG_APP_AUDIO_CONNECT_BUFFER
+#define AGENT_CONNECT_TIMEOUT_MS CONFIG_APP_AUDIO_CONNECT_BUFFER_MAX_AGE_MS
+#else
+#define AGENT_CONNECT_TIMEOUT_MS (AGENT_SLEEP_TIMEOUT_SECONDS * 1000)
+#endif
+
 typedef enum {
     DEVICE_STATE_IDLE,
     DEVICE_STATE_LISTENING,
@@ -34,6 +42,7 @@ typedef enum {
     DEVICE_ACTION_MICROPHONE_START,
     DEVICE_ACTION_MICROPHONE_PAUSE,
     DEVICE_ACTION_MICROPHONE_STOP,
+    DEVICE_ACTION_MICROPHONE_BUFFER,
     DEVICE_ACTION_SPEAKER_START,
     DEVICE_ACTION_SPEAKER_STOP,
     DEVICE_ACTION_SLEEP_TIMER_START,
@@ -54,7 +63,9 @@ typedef struct {
     bool init_done;
     bool wakeup;
     bool wakeup_start_pending;
+    bool wakeup_chime_played;
     esp_timer_handle_t sleep_timer;
+    esp_timer_handle_t connect_timer;
     bool reminder_active;
     esp_timer_handle_t reminder_complete_timer;
     bool system_initialized;
@@ -78,6 +89,11 @@ static void device_sleep_timer_callback(void *arg)
     app_audio_trigger_sleep();
 }
 
+static void connect_timer_callback(void *arg)
+{
+    app_device_event_enqueue(DEVICE_EVENT_CONNECT_TIMEOUT);
+}
+
 static void reminder_complete_timer_callback(void *arg)
 {
     app_device_event_enqueue(DEVICE_EVENT_REMINDER_COMPLETE);
@@ -159,6 +175,11 @@ static void device_perform_action(device_action_t action)
             device_update_led(false);
             break;
 
+        case DEVICE_ACTION_MICROPHONE_BUFFER:
+            app_audio_microphone_set_state(MICROPHONE_STATE_BUFFER);
+            device_update_led(true);
+            break;
+
         case DEVICE_ACTION_SPEAKER_START:
             app_audio_speaker_start();
             break;
@@ -232,15 +253,29 @@ void device_process_event(app_device_event_t event, void *data)
             }
 
             if (!app_agent_is_active()) {
+                if (g_device_data.wakeup_start_pending) {
+                    break;
+                }
                 g_device_data.wakeup_start_pending = true;
+#if CONFIG_APP_AUDIO_CONNECT_BUFFER
+                /* Chime now rather than once connected, when the buffered audio is already being sent */
+                app_audio_play_media_async("embed://audio/0_wakeup.mp3", wakeup_mp3_start, wakeup_mp3_end - wakeup_mp3_start);
+                g_device_data.wakeup_chime_played = true;
+                /* Start capturing right away, so that the user does not have to repeat themselves */
+                device_perform_action(DEVICE_ACTION_MICROPHONE_BUFFER);
+#endif
+                esp_timer_start_once(g_device_data.connect_timer, AGENT_CONNECT_TIMEOUT_MS * 1000ULL);
                 app_agent_connect();
                 break;
             }
 
             if (g_device_data.state == DEVICE_STATE_IDLE){
-                app_audio_play_media_async("embed://audio/0_wakeup.mp3", wakeup_mp3_start, wakeup_mp3_end - wakeup_mp3_start);
+                if (!g_device_data.wakeup_chime_played) {
+                    app_audio_play_media_async("embed://audio/0_wakeup.mp3", wakeup_mp3_start, wakeup_mp3_end - wakeup_mp3_start);
+                }
                 app_agent_speech_conversation_start();
             }
+            g_device_data.wakeup_chime_played = false;
 
             device_perform_action(DEVICE_ACTION_SPEAKER_STOP);
             device_perform_action(DEVICE_ACTION_MICROPHONE_START);
@@ -257,8 +292,14 @@ void device_process_event(app_device_event_t event, void *data)
             device_set_text(APP_DEVICE_TEXT_TYPE_SYSTEM, "Zzzz...");
             device_perform_action(DEVICE_ACTION_MICROPHONE_STOP);
             device_perform_action(DEVICE_ACTION_SLEEP_TIMER_STOP);
+            /* A wake still waiting for the agent is given up */
+            esp_timer_stop(g_device_data.connect_timer);
+            g_device_data.wakeup_start_pending = false;
+            g_device_data.wakeup_chime_played = false;
 
             app_agent_speech_conversation_end();
+            /* The conversation is idle, so this is a good time to write the transcript to flash */
+            app_transcript_save(false);
 
             device_notify_state_changed(APP_DEVICE_SYSTEM_STATE_SLEEP);
             g_device_data.state = DEVICE_STATE_IDLE;
@@ -286,11 +327,21 @@ void device_process_event(app_device_event_t event, void *data)
                 device_set_text(APP_DEVICE_TEXT_TYPE_SYSTEM, deivce_get_agent_state_text());
             }
             if (app_agent_get_state() == APP_AGENT_STATE_STARTED && g_device_data.wakeup_start_pending) {
+                esp_timer_stop(g_device_data.connect_timer);
                 app_device_event_enqueue(DEVICE_EVENT_WAKEUP);
                 g_device_data.wakeup_start_pending = false;
             }
             break;
 
+        case DEVICE_EVENT_CONNECT_TIMEOUT:
+            if (!g_device_data.wakeup_start_pending) {
+                break;
+            }
+            /* Going to sleep discards the buffered audio, which counts the utterance as lost */
+            ESP_LOGW(TAG, "Agent not started %d ms after wake", AGENT_CONNECT_TIMEOUT_MS);
+            app_device_event_enqueue(DEVICE_EVENT_SLEEP);
+            break;
+
         case DEVICE_EVENT_REMINDER:
             {
                 // Get reminder text from event data
@@ -407,6 +458,13 @@ esp_err_t app_device_init(app_device_config_t *config)
     };
     ESP_RETURN_ON_ERROR(esp_timer_create(&sleep_timer_args, &g_device_data.sleep_timer), TAG, "Failed to create device sleep timer");
 
+    esp_timer_create_args_t connect_timer_args = {
+        .callback = connect_timer_callback,
+        .arg = NULL,
+        .name = "device_connect_timer",
+    };
+    ESP_RETURN_ON_ERROR(esp_timer_create(&connect_timer_args, &g_device_data.connect_timer), TAG, "Failed to create device connect timer");
+
     // Initialize reminder complete timer
     esp_timer_create_args_t reminder_timer_args = {
         .callback = reminder_complete_timer_callback,
@@ -0,0 +1,229 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ctype.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "app_agent.h"
+#include "app_intent.h"
+
+static const char *TAG = "app_intent";
+
+#define APP_INTENT_MAX_TABLES 4
+#define APP_INTENT_MAX_PHRASE_LEN 64
+#define APP_INTENT_MAX_WORDS (APP_INTENT_MAX_PHRASE_LEN / 2)
+#define APP_INTENT_QUEUE_LEN 4
+
+/* Interim and final transcripts of the same utterance must not run the command twice */
+#define APP_INTENT_REPEAT_GUARD_US (2000 * 1000LL)
+
+typedef struct {
+    const app_intent_t *intents;
+    size_t num_intents;
+} app_intent_table_t;
+
+static app_intent_table_t g_intent_tables[APP_INTENT_MAX_TABLES];
+static size_t g_num_intent_tables;
+static const app_intent_t *g_last_intent;
+static int64_t g_last_intent_us;
+
+#if CONFIG_APP_INTENT_FAST_PATH
+static QueueHandle_t g_intent_queue;
+
+/* Words that may surround a command without changing it */
+static const char *g_filler_words[] = {
+    "please", "now", "ok", "okay", "hey", "thanks", "thank", "you",
+};
+
+/* Runs the tools, so that a slow one does not hold the agent event loop */
+static void app_intent_task(void *arg)
+{
+    const app_intent_t *intent;
+
+    while (true) {
+        if (xQueueReceive(g_intent_queue, &intent, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        int64_t start = esp_timer_get_time();
+        esp_err_t err = app_agent_run_tool(intent->tool_name, intent->params, intent->num_params);
+        ESP_LOGI(TAG, "\"%s\" ran %s on the device in %lld ms: %s", intent->phrase, intent->tool_name,
+                 (long long)((esp_timer_get_time() - start) / 1000), esp_err_to_name(err));
+    }
+}
+#endif
+
+esp_err_t app_intent_register(const app_intent_t *intents, size_t num_intents)
+{
+    if (intents == NULL || num_intents == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (g_num_intent_tables >= APP_INTENT_MAX_TABLES) {
+        ESP_LOGE(TAG, "Too many intent tables");
+        return ESP_ERR_NO_MEM;
+    }
+#if CONFIG_APP_INTENT_FAST_PATH
+    if (g_intent_queue == NULL) {
+        g_intent_queue = xQueueCreate(APP_INTENT_QUEUE_LEN, sizeof(const app_intent_t *));
+        if (g_intent_queue == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        if (xTaskCreate(app_intent_task, "app_intent_task", 4096, NULL, 5, NULL) != pdPASS) {
+            vQueueDelete(g_intent_queue);
+            g_intent_queue = NULL;
+            return ESP_ERR_NO_MEM;
+        }
+    }
+#endif
+    g_intent_tables[g_num_intent_tables].intents = intents;
+    g_intent_tables[g_num_intent_tables].num_intents = num_intents;
+    g_num_intent_tables++;
+    return ESP_OK;
+}
+
+/* Lower case, punctuation dropped and words separated by single spaces */
+static bool normalize(const char *text, char *out, size_t out_len)
+{
+    size_t len = 0;
+    bool space = false;
+
+    for (; *text; text++) {
+        unsigned char c = (unsigned char)*text;
+        if (isalnum(c)) {
+            if (space && len > 0) {
+                if (len + 1 >= out_len) {
+                    return false;
+                }
+                out[len++] = ' ';
+            }
+            if (len + 1 >= out_len) {
+                return false;
+            }
+            out[len++] = (char)tolower(c);
+            space = false;
+        } else if (isspace(c)) {
+            space = true;
+        }
+    }
+    out[len] = '\0';
+    return len > 0;
+}
+
+#if CONFIG_APP_INTENT_FAST_PATH
+static bool is_filler_word(const char *word)
+{
+    for (size_t i = 0; i < sizeof(g_filler_words) / sizeof(g_filler_words[0]); i++) {
+        if (strcmp(g_filler_words[i], word) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Splits a normalized text into its words, in place */
+static size_t split_words(char *text, const char *words[], size_t max_words)
+{
+    size_t num_words = 0;
+
+    while (*text && num_words < max_words) {
+        words[num_words++] = text;
+        char *space = strchr(text, ' ');
+        if (space == NULL) {
+            break;
+        }
+        *space = '\0';
+        text = space + 1;
+    }
+    return num_words;
+}
+
+/* Number of words of the phrase if they start at `start`, otherwise 0 */
+static size_t phrase_words_at(const char *words[], size_t num_words, size_t start, const char *phrase)
+{
+    size_t i = start;
+
+    while (*phrase) {
+        size_t len = strcspn(phrase, " ");
+        if (i >= num_words || strlen(words[i]) != len || strncmp(words[i], phrase, len) != 0) {
+            return 0;
+        }
+        i++;
+        phrase += len;
+        if (*phrase == ' ') {
+            phrase++;
+        }
+    }
+    return i - start;
+}
+
+/* The phrase must appear as whole words, and every other word of the transcript be a filler word */
+static bool phrase_matches(const char *words[], size_t num_words, const char *phrase)
+{
+    for (size_t start = 0; start < num_words; start++) {
+        size_t matched = phrase_words_at(words, num_words, start, phrase);
+        if (matched == 0) {
+            if (!is_filler_word(words[start])) {
+                return false;
+            }
+            continue;
+        }
+        for (size_t i = start + matched; i < num_words; i++) {
+            if (!is_filler_word(words[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+#endif
+
+bool app_intent_handle_transcript(const char *text)
+{
+#if CONFIG_APP_INTENT_FAST_PATH
+    char normalized[APP_INTENT_MAX_PHRASE_LEN];
+    const char *words[APP_INTENT_MAX_WORDS];
+    const app_intent_t *intent = NULL;
+
+    if (text == NULL || g_num_intent_tables == 0 || !normalize(text, normalized, sizeof(normalized))) {
+        return false;
+    }
+    size_t num_words = split_words(normalized, words, APP_INTENT_MAX_WORDS);
+
+    for (size_t i = 0; i < g_num_intent_tables && intent == NULL; i++) {
+        for (size_t j = 0; j < g_intent_tables[i].num_intents; j++) {
+            if (phrase_matches(words, num_words, g_intent_tables[i].intents[j].phrase)) {
+                intent = &g_intent_tables[i].intents[j];
+                break;
+            }
+        }
+    }
+    if (intent == NULL) {
+        return false;
+    }
+
+    int64_t now = esp_timer_get_time();
+    if (intent == g_last_intent && now - g_last_intent_us < APP_INTENT_REPEAT_GUARD_US) {
+        return true;
+    }
+    g_last_intent = intent;
+    g_last_intent_us = now;
+
+    if (xQueueSend(g_intent_queue, &intent, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Intent queue full, \"%s\" left to the server", intent->phrase);
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
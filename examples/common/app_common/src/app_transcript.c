@@ -0,0 +1,349 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include <esp_assert.h>
+#include <esp_check.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <nvs.h>
+
+#include <agent_console.h>
+
+#include "app_transcript.h"
+
+static const char *TAG = "app_transcript";
+
+#define APP_TRANSCRIPT_NVS_NAMESPACE "app_transcript"
+#define APP_TRANSCRIPT_NVS_KEY_RING "ring"
+
+/* Bump when the layout of app_transcript_ring_t changes, so that stale saves are ignored */
+#define APP_TRANSCRIPT_RING_VERSION 1
+
+typedef struct {
+    uint8_t type;
+    uint32_t seq;
+    int64_t uptime_ms;
+    char text[CONFIG_APP_TRANSCRIPT_ENTRY_MAX_LEN];
+} app_transcript_entry_t;
+
+/* This is saved to NVS as is */
+typedef struct {
+    uint32_t version;
+    uint32_t next_seq;
+    uint16_t head;              /* Index the next entry is written to */
+    uint16_t count;
+    app_transcript_entry_t entries[CONFIG_APP_TRANSCRIPT_NUM_ENTRIES];
+} app_transcript_ring_t;
+
+#if CONFIG_APP_TRANSCRIPT_NVS_SPILL
+/* The ring is saved as one blob, which has to fit in the nvs partition next to the other keys */
+#define APP_TRANSCRIPT_NVS_MAX_SIZE (8 * 1024)
+ESP_STATIC_ASSERT(sizeof(app_transcript_ring_t) <= APP_TRANSCRIPT_NVS_MAX_SIZE,
+                  "Transcript too large for NVS, reduce APP_TRANSCRIPT_NUM_ENTRIES or APP_TRANSCRIPT_ENTRY_MAX_LEN");
+#endif
+
+typedef struct {
+    bool initialized;
+    SemaphoreHandle_t lock;
+    app_transcript_ring_t *ring;
+    bool dirty;                 /* Changed since the last save */
+    int64_t last_save_us;
+#if CONFIG_APP_TRANSCRIPT_NVS_SPILL
+    SemaphoreHandle_t save_lock;        /* Serializes saves, which write to NVS without holding lock */
+    app_transcript_ring_t *snapshot;    /* Copy of the ring being saved */
+#endif
+
+    app_transcript_stats_t stats;
+} app_transcript_data_t;
+
+static app_transcript_data_t g_app_transcript_data;
+
+static const char *g_entry_type_names[APP_TRANSCRIPT_ENTRY_MAX] = {
+    [APP_TRANSCRIPT_ENTRY_USER] = "user",
+    [APP_TRANSCRIPT_ENTRY_ASSISTANT] = "assistant",
+    [APP_TRANSCRIPT_ENTRY_TOOL_CALL] = "tool",
+    [APP_TRANSCRIPT_ENTRY_LATENCY] = "latency",
+};
+
+esp_err_t app_transcript_append(app_transcript_entry_type_t type, const char *fmt, ...)
+{
+    if (!g_app_transcript_data.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (type >= APP_TRANSCRIPT_ENTRY_MAX || fmt == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t start = esp_timer_get_time();
+
+    xSemaphoreTake(g_app_transcript_data.lock, portMAX_DELAY);
+
+    app_transcript_ring_t *ring = g_app_transcript_data.ring;
+    app_transcript_entry_t *entry = &ring->entries[ring->head];
+    entry->type = type;
+    entry->seq = ring->next_seq++;
+    entry->uptime_ms = start / 1000;
+
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(entry->text, sizeof(entry->text), fmt, args);
+    va_end(args);
+
+    ring->head = (ring->head + 1) % CONFIG_APP_TRANSCRIPT_NUM_ENTRIES;
+    if (ring->count < CONFIG_APP_TRANSCRIPT_NUM_ENTRIES) {
+        ring->count++;
+    }
+    g_app_transcript_data.dirty = true;
+
+    uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start);
+    app_transcript_stats_t *stats = &g_app_transcript_data.stats;
+    stats->appends++;
+    stats->append_total_us += elapsed_us;
+    if (elapsed_us > stats->append_max_us) {
+        stats->append_max_us = elapsed_us;
+    }
+
+    xSemaphoreGive(g_app_transcript_data.lock);
+
+    return ESP_OK;
+}
+
+esp_err_t app_transcript_save(bool force)
+{
+#if CONFIG_APP_TRANSCRIPT_NVS_SPILL
+    if (!g_app_transcript_data.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_OK;
+    nvs_handle_t nvs_handle;
+    app_transcript_stats_t *stats = &g_app_transcript_data.stats;
+
+    xSemaphoreTake(g_app_transcript_data.save_lock, portMAX_DELAY);
+    xSemaphoreTake(g_app_transcript_data.lock, portMAX_DELAY);
+
+    int64_t now = esp_timer_get_time();
+    if (!g_app_transcript_data.dirty) {
+        xSemaphoreGive(g_app_transcript_data.lock);
+        goto end;
+    }
+
+    if (!force && g_app_transcript_data.last_save_us &&
+        now - g_app_transcript_data.last_save_us < CONFIG_APP_TRANSCRIPT_NVS_MIN_INTERVAL_S * 1000000LL) {
+        stats->saves_skipped++;
+        xSemaphoreGive(g_app_transcript_data.lock);
+        goto end;
+    }
+
+    /* Appends only wait for the copy, not for the flash write */
+    memcpy(g_app_transcript_data.snapshot, g_app_transcript_data.ring, sizeof(app_transcript_ring_t));
+    g_app_transcript_data.dirty = false;
+    xSemaphoreGive(g_app_transcript_data.lock);
+
+    ret = nvs_open(APP_TRANSCRIPT_NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(nvs_handle, APP_TRANSCRIPT_NVS_KEY_RING, g_app_transcript_data.snapshot, sizeof(app_transcript_ring_t));
+        if (ret == ESP_OK) {
+            ret = nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
+    }
+    uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - now);
+
+    xSemaphoreTake(g_app_transcript_data.lock, portMAX_DELAY);
+    if (ret == ESP_OK) {
+        g_app_transcript_data.last_save_us = now;
+        stats->saves++;
+        stats->saved_bytes += sizeof(app_transcript_ring_t);
+        if (elapsed_us > stats->save_max_us) {
+            stats->save_max_us = elapsed_us;
+        }
+    } else {
+        /* Saved with the next request */
+        g_app_transcript_data.dirty = true;
+    }
+    xSemaphoreGive(g_app_transcript_data.lock);
+    ESP_GOTO_ON_ERROR(ret, end, TAG, "Failed to save transcript");
+
+end:
+    xSemaphoreGive(g_app_transcript_data.save_lock);
+    return ret;
+#else
+    return ESP_OK;
+#endif
+}
+
+#if CONFIG_APP_TRANSCRIPT_NVS_SPILL
+static void transcript_restore(app_transcript_ring_t *ring)
+{
+    nvs_handle_t nvs_handle;
+    if (nvs_open(APP_TRANSCRIPT_NVS_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return;
+    }
+
+    size_t len = sizeof(app_transcript_ring_t);
+    esp_err_t err = nvs_get_blob(nvs_handle, APP_TRANSCRIPT_NVS_KEY_RING, ring, &len);
+    nvs_close(nvs_handle);
+
+    if (err != ESP_OK || len != sizeof(app_transcript_ring_t) || ring->version != APP_TRANSCRIPT_RING_VERSION ||
+        ring->head >= CONFIG_APP_TRANSCRIPT_NUM_ENTRIES || ring->count > CONFIG_APP_TRANSCRIPT_NUM_ENTRIES) {
+        /* Nothing saved, or saved with a different configuration */
+        memset(ring, 0, sizeof(app_transcript_ring_t));
+        ring->version = APP_TRANSCRIPT_RING_VERSION;
+        return;
+    }
+
+    ESP_LOGI(TAG, "Restored %d transcript entries", ring->count);
+}
+#endif
+
+esp_err_t app_transcript_dump(void)
+{
+    if (!g_app_transcript_data.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(g_app_transcript_data.lock, portMAX_DELAY);
+
+    app_transcript_ring_t *ring = g_app_transcript_data.ring;
+    size_t oldest = (ring->head + CONFIG_APP_TRANSCRIPT_NUM_ENTRIES - ring->count) % CONFIG_APP_TRANSCRIPT_NUM_ENTRIES;
+
+    for (size_t i = 0; i < ring->count; i++) {
+        const app_transcript_entry_t *entry = &ring->entries[(oldest + i) % CONFIG_APP_TRANSCRIPT_NUM_ENTRIES];
+        const char *type = entry->type < APP_TRANSCRIPT_ENTRY_MAX ? g_entry_type_names[entry->type] : "?";
+        printf("#%lu [%lld.%03lld] %s: %s\n", (unsigned long)entry->seq,
+               (long long)(entry->uptime_ms / 1000), (long long)(entry->uptime_ms % 1000), type, entry->text);
+    }
+
+    xSemaphoreGive(g_app_transcript_data.lock);
+    return ESP_OK;
+}
+
+esp_err_t app_transcript_get_stats(app_transcript_stats_t *stats)
+{
+    if (!g_app_transcript_data.initialized || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(g_app_transcript_data.lock, portMAX_DELAY);
+    *stats = g_app_transcript_data.stats;
+    stats->entries = g_app_transcript_data.ring->count;
+    stats->size = sizeof(app_transcript_ring_t);
+    xSemaphoreGive(g_app_transcript_data.lock);
+    return ESP_OK;
+}
+
+static void transcript_print_stats(void)
+{
+    app_transcript_stats_t stats;
+    if (app_transcript_get_stats(&stats) != ESP_OK) {
+        return;
+    }
+
+    printf("Entries: %lu/%d, %lu bytes\n", (unsigned long)stats.entries, CONFIG_APP_TRANSCRIPT_NUM_ENTRIES, (unsigned long)stats.size);
+    printf("Appends: %lu, avg %lu us, max %lu us\n", (unsigned long)stats.appends,
+           (unsigned long)(stats.appends ? stats.append_total_us / stats.appends : 0),
+           (unsigned long)stats.append_max_us);
+    printf("Flash saves: %lu (%llu bytes), skipped: %lu, max %lu us\n", (unsigned long)stats.saves,
+           (unsigned long long)stats.saved_bytes, (unsigned long)stats.saves_skipped,
+           (unsigned long)stats.save_max_us);
+}
+
+static esp_err_t transcript_cmd_handler(int argc, char **argv)
+{
+    if (argc == 1) {
+        return app_transcript_dump();
+    }
+
+    if (argc == 2 && strcmp(argv[1], "stats") == 0) {
+        transcript_print_stats();
+        return ESP_OK;
+    }
+
+    if (argc == 2 && strcmp(argv[1], "save") == 0) {
+        return app_transcript_save(true);
+    }
+
+    if (argc == 2 && strcmp(argv[1], "clear") == 0) {
+        xSemaphoreTake(g_app_transcript_data.lock, portMAX_DELAY);
+        g_app_transcript_data.ring->head = 0;
+        g_app_transcript_data.ring->count = 0;
+        g_app_transcript_data.dirty = true;
+        xSemaphoreGive(g_app_transcript_data.lock);
+        return ESP_OK;
+    }
+
+    ESP_LOGE(TAG, "Usage: transcript [stats|save|clear]");
+    return ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t app_transcript_init(void)
+{
+    if (g_app_transcript_data.initialized) {
+        return ESP_OK;
+    }
+
+    g_app_transcript_data.ring = calloc(1, sizeof(app_transcript_ring_t));
+    if (g_app_transcript_data.ring == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate transcript");
+        return ESP_ERR_NO_MEM;
+    }
+    g_app_transcript_data.ring->version = APP_TRANSCRIPT_RING_VERSION;
+
+#if CONFIG_APP_TRANSCRIPT_NVS_SPILL
+    transcript_restore(g_app_transcript_data.ring);
+#endif
+
+    g_app_transcript_data.lock = xSemaphoreCreateMutex();
+#if CONFIG_APP_TRANSCRIPT_NVS_SPILL
+    g_app_transcript_data.save_lock = xSemaphoreCreateMutex();
+    g_app_transcript_data.snapshot = malloc(sizeof(app_transcript_ring_t));
+    if (g_app_transcript_data.save_lock == NULL || g_app_transcript_data.snapshot == NULL) {
+        goto err;
+    }
+#endif
+    if (g_app_transcript_data.lock == NULL) {
+        goto err;
+    }
+
+    esp_console_cmd_t cmd = {
+        .command = "transcript",
+        .help = "Dump the recent conversation transcript, its cost statistics, save it to flash or clear it\n"
+                "Usage: transcript [stats|save|clear]",
+        .func = transcript_cmd_handler,
+    };
+    ESP_RETURN_ON_ERROR(agent_console_register_command(&cmd), TAG, "Failed to register transcript command");
+
+    g_app_transcript_data.initialized = true;
+    return ESP_OK;
+
+err:
+    ESP_LOGE(TAG, "Failed to create the transcript locks");
+#if CONFIG_APP_TRANSCRIPT_NVS_SPILL
+    if (g_app_transcript_data.save_lock) {
+        vSemaphoreDelete(g_app_transcript_data.save_lock);
+        g_app_transcript_data.save_lock = NULL;
+    }
+    free(g_app_transcript_data.snapshot);
+    g_app_transcript_data.snapshot = NULL;
+#endif
+    if (g_app_transcript_data.lock) {
+        vSemaphoreDelete(g_app_transcript_data.lock);
+        g_app_transcript_data.lock = NULL;
+    }
+    free(g_app_transcript_data.ring);
+    g_app_transcript_data.ring = NULL;
+    return ESP_ERR_NO_MEM;
+}
@@ -112,17 +112,42 @@ static esp_err_t app_tools_set_emotion_handler(esp_agent_handle_t handle, const
     return err;
 }
 
+/* As declared in agent_config.json, except command_args which not all commands need */
+static const esp_agent_tool_param_schema_t g_control_device_schema[] = {
+    { .name = "node_id", .type = ESP_AGENT_PARAM_TYPE_STRING, .required = true },
+    { .name = "cluster_id", .type = ESP_AGENT_PARAM_TYPE_INT, .required = true },
+    { .name = "command_id", .type = ESP_AGENT_PARAM_TYPE_INT, .required = true },
+    { .name = "command_args", .type = ESP_AGENT_PARAM_TYPE_STRING },
+};
+
+static const esp_agent_tool_param_schema_t g_set_emotion_schema[] = {
+    { .name = "emotion_name", .type = ESP_AGENT_PARAM_TYPE_STRING, .required = true },
+};
+
 esp_err_t app_tools_register(void)
 {
     /* Register common tools */
-    app_agent_register_tool(TOOL_NAME_SET_REMINDER, app_common_tools_set_reminder_handler, NULL);
-    app_agent_register_tool(TOOL_NAME_GET_LOCAL_TIME, app_common_tools_get_local_time_handler, NULL);
-    app_agent_register_tool(TOOL_NAME_SET_VOLUME, app_common_tools_set_volume_handler, NULL);
+    app_common_tools_register();
 
     /* Register Matter controller specific tools */
+    /* Not cached: the device states also change outside the agent, from other controllers and switches */
     app_agent_register_tool("get_device_list", app_tools_get_device_list_handler, NULL);
-    app_agent_register_tool("control_device", app_tools_control_device_handler, NULL);
-    app_agent_register_tool("set_emotion", app_tools_set_emotion_handler, NULL);
+    /* Commands to the devices are sent one at a time, in the order requested */
+    esp_agent_tool_config_t control_device_config = {
+        .name = "control_device",
+        .handler = app_tools_control_device_handler,
+        .non_reentrant = true,
+        .params = g_control_device_schema,
+        .num_params = sizeof(g_control_device_schema) / sizeof(g_control_device_schema[0]),
+    };
+    app_agent_register_tool_with_config(&control_device_config);
+    esp_agent_tool_config_t set_emotion_config = {
+        .name = "set_emotion",
+        .handler = app_tools_set_emotion_handler,
+        .params = g_set_emotion_schema,
+        .num_params = sizeof(g_set_emotion_schema) / sizeof(g_set_emotion_schema[0]),
+    };
+    app_agent_register_tool_with_config(&set_emotion_config);
 
     return ESP_OK;
 }
@@ -50,15 +50,23 @@ static esp_err_t app_tools_set_emotion_handler(esp_agent_handle_t handle, const
     return err;
 }
 
+static const esp_agent_tool_param_schema_t g_set_emotion_schema[] = {
+    { .name = "emotion_name", .type = ESP_AGENT_PARAM_TYPE_STRING, .required = true },
+};
+
 esp_err_t app_tools_register(void)
 {
     /* Register common tools */
-    app_agent_register_tool(TOOL_NAME_SET_REMINDER, app_common_tools_set_reminder_handler, NULL);
-    app_agent_register_tool(TOOL_NAME_GET_LOCAL_TIME, app_common_tools_get_local_time_handler, NULL);
-    app_agent_register_tool(TOOL_NAME_SET_VOLUME, app_common_tools_set_volume_handler, NULL);
+    app_common_tools_register();
 
     /* Register voice_chat specific tools */
-    app_agent_register_tool("set_emotion", app_tools_set_emotion_handler, NULL);
+    esp_agent_tool_config_t set_emotion_config = {
+        .name = "set_emotion",
+        .handler = app_tools_set_emotion_handler,
+        .params = g_set_emotion_schema,
+        .num_params = sizeof(g_set_emotion_schema) / sizeof(g_set_emotion_schema[0]),
+    };
+    app_agent_register_tool_with_config(&set_emotion_config);
 
     return ESP_OK;
 }
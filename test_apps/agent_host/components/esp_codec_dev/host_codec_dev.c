@@ -0,0 +1,187 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <host_codec_dev.h>
+
+static const char *TAG = "host_codec_dev";
+
+typedef struct {
+    char *path;
+    bool input;
+    bool realtime;
+    FILE *file;
+    bool eof;
+    uint32_t bytes_per_ms;
+    int64_t next_us;            /* When the samples handed over so far are done playing or recording */
+    size_t bytes;
+} host_codec_dev_t;
+
+esp_codec_dev_handle_t host_codec_dev_new(const host_codec_dev_config_t *config)
+{
+    if (config == NULL || config->path == NULL) {
+        return NULL;
+    }
+
+    host_codec_dev_t *dev = calloc(1, sizeof(host_codec_dev_t));
+    if (dev == NULL) {
+        return NULL;
+    }
+    dev->path = strdup(config->path);
+    if (dev->path == NULL) {
+        free(dev);
+        return NULL;
+    }
+    dev->input = config->input;
+    dev->realtime = config->realtime;
+    return (esp_codec_dev_handle_t)dev;
+}
+
+int esp_codec_dev_open(esp_codec_dev_handle_t codec, esp_codec_dev_sample_info_t *fs)
+{
+    host_codec_dev_t *dev = (host_codec_dev_t *)codec;
+    if (dev == NULL || fs == NULL || fs->sample_rate == 0) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    if (dev->file) {
+        return ESP_CODEC_DEV_WRONG_STATE;
+    }
+
+    dev->file = fopen(dev->path, dev->input ? "rb" : "ab");
+    if (dev->file == NULL) {
+        ESP_LOGE(TAG, "Failed to open %s", dev->path);
+        return ESP_CODEC_DEV_NOT_FOUND;
+    }
+    uint32_t bytes_per_sample = (fs->bits_per_sample ? fs->bits_per_sample : 16) / 8 * (fs->channel ? fs->channel : 1);
+    dev->bytes_per_ms = fs->sample_rate * bytes_per_sample / 1000;
+    dev->next_us = esp_timer_get_time();
+    dev->eof = false;
+    ESP_LOGI(TAG, "%s %s at %lu Hz", dev->input ? "Microphone reading" : "Speaker writing", dev->path, (unsigned long)fs->sample_rate);
+    return ESP_CODEC_DEV_OK;
+}
+
+/* Waits until the previous samples are done, and accounts for these */
+static void codec_pace(host_codec_dev_t *dev, int len)
+{
+    if (!dev->realtime || dev->bytes_per_ms == 0) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    if (dev->next_us < now) {
+        dev->next_us = now;
+    }
+    dev->next_us += (int64_t)len * 1000 / dev->bytes_per_ms;
+    int64_t wait_us = dev->next_us - now;
+    if (wait_us >= 1000) {
+        vTaskDelay(pdMS_TO_TICKS(wait_us / 1000) ? pdMS_TO_TICKS(wait_us / 1000) : 1);
+    }
+}
+
+int esp_codec_dev_read(esp_codec_dev_handle_t codec, void *data, int len)
+{
+    host_codec_dev_t *dev = (host_codec_dev_t *)codec;
+    if (dev == NULL || data == NULL || len <= 0 || !dev->input) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    if (dev->file == NULL) {
+        return ESP_CODEC_DEV_WRONG_STATE;
+    }
+
+    size_t read_len = fread(data, 1, len, dev->file);
+    if (read_len < (size_t)len) {
+        dev->eof = true;
+        if (read_len == 0) {
+            return ESP_CODEC_DEV_READ_FAIL;
+        }
+        /* The last partial frame is completed with silence */
+        memset((uint8_t *)data + read_len, 0, len - read_len);
+    }
+    dev->bytes += read_len;
+    codec_pace(dev, len);
+    return ESP_CODEC_DEV_OK;
+}
+
+int esp_codec_dev_write(esp_codec_dev_handle_t codec, void *data, int len)
+{
+    host_codec_dev_t *dev = (host_codec_dev_t *)codec;
+    if (dev == NULL || data == NULL || len <= 0 || dev->input) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    if (dev->file == NULL) {
+        return ESP_CODEC_DEV_WRONG_STATE;
+    }
+
+    if (fwrite(data, 1, len, dev->file) != (size_t)len) {
+        return ESP_CODEC_DEV_WRITE_FAIL;
+    }
+    dev->bytes += len;
+    codec_pace(dev, len);
+    return ESP_CODEC_DEV_OK;
+}
+
+int esp_codec_dev_set_out_vol(esp_codec_dev_handle_t codec, int volume)
+{
+    return codec ? ESP_CODEC_DEV_OK : ESP_CODEC_DEV_INVALID_ARG;
+}
+
+int esp_codec_dev_set_in_gain(esp_codec_dev_handle_t codec, float db_value)
+{
+    return codec ? ESP_CODEC_DEV_OK : ESP_CODEC_DEV_INVALID_ARG;
+}
+
+int esp_codec_dev_close(esp_codec_dev_handle_t codec)
+{
+    host_codec_dev_t *dev = (host_codec_dev_t *)codec;
+    if (dev == NULL) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    if (dev->file) {
+        fclose(dev->file);
+        dev->file = NULL;
+    }
+    return ESP_CODEC_DEV_OK;
+}
+
+void esp_codec_dev_delete(esp_codec_dev_handle_t codec)
+{
+    host_codec_dev_t *dev = (host_codec_dev_t *)codec;
+    if (dev == NULL) {
+        return;
+    }
+    esp_codec_dev_close(codec);
+    free(dev->path);
+    free(dev);
+}
+
+bool host_codec_dev_eof(esp_codec_dev_handle_t codec)
+{
+    host_codec_dev_t *dev = (host_codec_dev_t *)codec;
+    return dev && dev->eof;
+}
+
+void host_codec_dev_rewind(esp_codec_dev_handle_t codec)
+{
+    host_codec_dev_t *dev = (host_codec_dev_t *)codec;
+    if (dev && dev->file) {
+        rewind(dev->file);
+        dev->eof = false;
+    }
+}
+
+size_t host_codec_dev_bytes(esp_codec_dev_handle_t codec)
+{
+    host_codec_dev_t *dev = (host_codec_dev_t *)codec;
+    return dev ? dev->bytes : 0;
+}
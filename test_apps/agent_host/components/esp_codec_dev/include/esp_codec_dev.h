@@ -0,0 +1,56 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Subset of the espressif/esp_codec_dev API used by the audio component, for the linux target.
+ * The devices are files, created with host_codec_dev_new().
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_CODEC_DEV_OK            (0)
+#define ESP_CODEC_DEV_DRV_ERR       (-1)
+#define ESP_CODEC_DEV_INVALID_ARG   (-2)
+#define ESP_CODEC_DEV_NOT_SUPPORT   (-3)
+#define ESP_CODEC_DEV_NOT_FOUND     (-4)
+#define ESP_CODEC_DEV_WRONG_STATE   (-5)
+#define ESP_CODEC_DEV_WRITE_FAIL    (-6)
+#define ESP_CODEC_DEV_READ_FAIL     (-7)
+
+typedef void *esp_codec_dev_handle_t;
+
+typedef struct {
+    uint8_t bits_per_sample;
+    uint8_t channel;
+    uint16_t channel_mask;
+    uint32_t sample_rate;
+    int mclk_multiple;
+} esp_codec_dev_sample_info_t;
+
+int esp_codec_dev_open(esp_codec_dev_handle_t codec, esp_codec_dev_sample_info_t *fs);
+
+int esp_codec_dev_read(esp_codec_dev_handle_t codec, void *data, int len);
+
+int esp_codec_dev_write(esp_codec_dev_handle_t codec, void *data, int len);
+
+int esp_codec_dev_set_out_vol(esp_codec_dev_handle_t codec, int volume);
+
+int esp_codec_dev_set_in_gain(esp_codec_dev_handle_t codec, float db_value);
+
+int esp_codec_dev_close(esp_codec_dev_handle_t codec);
+
+void esp_codec_dev_delete(esp_codec_dev_handle_t codec);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,66 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <esp_codec_dev.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief File backed codec device.
+ *
+ * A microphone reads raw PCM from the file, a speaker appends the samples written to it.
+ * Reads and writes take as long as the samples last at the rate given to esp_codec_dev_open(),
+ * unless `realtime` is false.
+ */
+typedef struct {
+    const char *path;
+    bool input;                 /**< Microphone if true, speaker otherwise */
+    bool realtime;              /**< Pace reads and writes as the hardware would */
+} host_codec_dev_config_t;
+
+/**
+ * @brief Creates a file backed codec device.
+ *
+ * @param[in] config Device configuration, the path is copied
+ * @return Codec handle, NULL on failure
+ */
+esp_codec_dev_handle_t host_codec_dev_new(const host_codec_dev_config_t *config);
+
+/**
+ * @brief Checks if a microphone has read its whole file.
+ *
+ * Reads at the end of the file return ESP_CODEC_DEV_READ_FAIL, until host_codec_dev_rewind().
+ *
+ * @param[in] codec Codec handle
+ * @return true at the end of the file
+ */
+bool host_codec_dev_eof(esp_codec_dev_handle_t codec);
+
+/**
+ * @brief Reads a microphone file again from the start.
+ *
+ * @param[in] codec Codec handle
+ */
+void host_codec_dev_rewind(esp_codec_dev_handle_t codec);
+
+/**
+ * @brief Bytes written to a speaker, or read from a microphone, since it was created.
+ *
+ * @param[in] codec Codec handle
+ * @return Byte count
+ */
+size_t host_codec_dev_bytes(esp_codec_dev_handle_t codec);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,140 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/event_groups.h>
+
+#include <esp_err.h>
+#include <esp_event.h>
+#include <cJSON.h>
+
+#include <esp_agent.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A test case, run by name from the HOST_TEST environment variable.
+ *
+ * @param[in] args Arguments of the scenario (HOST_TEST_ARGS), an empty object if none
+ * @param[out] metrics Measurements reported with the result, checked against the thresholds of the scenario
+ * @return ESP_OK if the test passed
+ */
+typedef esp_err_t (*host_test_fn_t)(const cJSON *args, cJSON *metrics);
+
+typedef struct {
+    const char *name;
+    host_test_fn_t fn;
+} host_test_case_t;
+
+/**
+ * @brief Called from the agent event loop for every event, before the counters are updated.
+ */
+typedef void (*host_test_event_cb_t)(void *arg, esp_agent_event_t event, esp_agent_message_data_t *data);
+
+/**
+ * @brief An agent connected to the mock server, with the events it received.
+ */
+typedef struct {
+    esp_agent_handle_t handle;
+    SemaphoreHandle_t lock;
+    EventGroupHandle_t changed;
+    esp_event_handler_instance_t handler;
+    uint32_t counts[ESP_AGENT_EVENT_DATA_TYPE_MAX];
+    int64_t first_us[ESP_AGENT_EVENT_DATA_TYPE_MAX];
+    int64_t last_us[ESP_AGENT_EVENT_DATA_TYPE_MAX];
+    uint64_t speech_bytes;
+    char last_text[128];
+    host_test_event_cb_t cb;
+    void *cb_arg;
+} host_test_agent_t;
+
+/**
+ * @brief Creates an agent for the mock server.
+ *
+ * @param[out] agent Agent to initialize
+ * @param[in] agent_id Agent ID, which selects the script of the mock server
+ * @param[in] type Conversation type, speech uses 16 kHz PCM in 20 ms frames both ways
+ * @return ESP_OK on success
+ */
+esp_err_t host_test_agent_init(host_test_agent_t *agent, const char *agent_id, esp_agent_conversation_type_t type);
+
+/**
+ * @brief Deinitializes the agent.
+ */
+void host_test_agent_deinit(host_test_agent_t *agent);
+
+/**
+ * @brief Starts the agent and waits for the handshake ack.
+ *
+ * @param[in] agent Agent
+ * @param[in] timeout_ms Time to wait for ESP_AGENT_EVENT_START
+ * @return ESP_OK once started, ESP_ERR_TIMEOUT otherwise
+ */
+esp_err_t host_test_agent_start(host_test_agent_t *agent, uint32_t timeout_ms);
+
+/**
+ * @brief Waits until an event was received `count` times in total.
+ *
+ * @return true if it was, false on timeout
+ */
+bool host_test_agent_wait(host_test_agent_t *agent, esp_agent_event_t event, uint32_t count, uint32_t timeout_ms);
+
+/**
+ * @brief Number of times an event was received.
+ */
+uint32_t host_test_agent_count(host_test_agent_t *agent, esp_agent_event_t event);
+
+/**
+ * @brief Integer argument of the scenario, `def` if it is not set.
+ */
+int host_test_arg_int(const cJSON *args, const char *name, int def);
+
+/**
+ * @brief String argument of the scenario, `def` if it is not set.
+ */
+const char *host_test_arg_str(const cJSON *args, const char *name, const char *def);
+
+/**
+ * @brief Adds latency percentiles (ms) to a JSON object.
+ */
+void host_test_add_percentiles(cJSON *obj, const char *name, const esp_agent_latency_percentiles_t *percentiles);
+
+/**
+ * @brief Adds queue latency percentiles (us) to a JSON object.
+ */
+void host_test_add_queue_latency(cJSON *obj, const char *name, const esp_agent_queue_latency_t *latency);
+
+/**
+ * @brief Adds the transport statistics of an agent to a JSON object, under "transport".
+ */
+void host_test_add_transport_stats(cJSON *metrics, esp_agent_handle_t handle);
+
+/**
+ * @brief Adds the per-stage latency percentiles of an agent to a JSON object, under "latency".
+ */
+void host_test_add_latency(cJSON *metrics, esp_agent_handle_t handle);
+
+/**
+ * @brief Writes `duration_ms` of a 16 bit mono 440 Hz tone to a new temporary file.
+ *
+ * @param[out] path Path of the file, at least 32 bytes
+ * @param[in] sample_rate Sample rate in Hz
+ * @param[in] duration_ms Duration of the tone
+ * @return ESP_OK on success
+ */
+esp_err_t host_test_tone_file(char *path, uint32_t sample_rate, uint32_t duration_ms);
+
+#ifdef __cplusplus
+}
+#endif
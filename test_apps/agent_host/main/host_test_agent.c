@@ -0,0 +1,244 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "host_test.h"
+
+static const char *TAG = "host_test";
+
+#define HOST_TEST_EVENT_BIT BIT0
+
+static const char *g_stage_names[ESP_AGENT_LATENCY_STAGE_MAX] = {
+    [ESP_AGENT_LATENCY_STAGE_VAD_END] = "vad_end",
+    [ESP_AGENT_LATENCY_STAGE_UPLINK_LAST_FRAME] = "uplink_last_frame",
+    [ESP_AGENT_LATENCY_STAGE_AUDIO_STREAM_END] = "audio_stream_end",
+    [ESP_AGENT_LATENCY_STAGE_DOWNLINK_FIRST_FRAME] = "downlink_first_frame",
+    [ESP_AGENT_LATENCY_STAGE_FIRST_DECODED_FRAME] = "first_decoded_frame",
+    [ESP_AGENT_LATENCY_STAGE_FIRST_CODEC_WRITE] = "first_codec_write",
+};
+
+static const char *g_counter_names[ESP_AGENT_TRANSPORT_COUNTER_MAX] = {
+    [ESP_AGENT_TRANSPORT_COUNTER_TX_TEXT] = "tx_text",
+    [ESP_AGENT_TRANSPORT_COUNTER_TX_AUDIO] = "tx_audio",
+    [ESP_AGENT_TRANSPORT_COUNTER_TX_TOOL] = "tx_tool",
+    [ESP_AGENT_TRANSPORT_COUNTER_RX_TEXT] = "rx_text",
+    [ESP_AGENT_TRANSPORT_COUNTER_RX_AUDIO] = "rx_audio",
+    [ESP_AGENT_TRANSPORT_COUNTER_RX_TOOL] = "rx_tool",
+};
+
+static esp_agent_audio_config_t g_audio_config = {
+    .format = ESP_AGENT_CONVERSATION_AUDIO_FORMAT_PCM,
+    .sample_rate = 16000,
+    .frame_duration = 20,
+};
+
+static void host_test_event_handler(void *arg, esp_event_base_t base, int32_t event_id, void *event_data)
+{
+    host_test_agent_t *agent = (host_test_agent_t *)arg;
+    esp_agent_message_data_t *data = (esp_agent_message_data_t *)event_data;
+
+    if (event_id < 0 || event_id >= ESP_AGENT_EVENT_DATA_TYPE_MAX) {
+        return;
+    }
+    if (agent->cb) {
+        agent->cb(agent->cb_arg, (esp_agent_event_t)event_id, data);
+    }
+
+    int64_t now = esp_timer_get_time();
+    xSemaphoreTake(agent->lock, portMAX_DELAY);
+    if (agent->counts[event_id]++ == 0) {
+        agent->first_us[event_id] = now;
+    }
+    agent->last_us[event_id] = now;
+    if (event_id == ESP_AGENT_EVENT_DATA_TYPE_SPEECH && data) {
+        agent->speech_bytes += data->speech.len;
+    } else if (event_id == ESP_AGENT_EVENT_DATA_TYPE_TEXT && data && data->text.text) {
+        snprintf(agent->last_text, sizeof(agent->last_text), "%s", data->text.text);
+    }
+    xSemaphoreGive(agent->lock);
+    xEventGroupSetBits(agent->changed, HOST_TEST_EVENT_BIT);
+}
+
+esp_err_t host_test_agent_init(host_test_agent_t *agent, const char *agent_id, esp_agent_conversation_type_t type)
+{
+    ESP_RETURN_ON_FALSE(agent && agent_id, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    host_test_event_cb_t cb = agent->cb;
+    void *cb_arg = agent->cb_arg;
+    memset(agent, 0, sizeof(host_test_agent_t));
+    agent->cb = cb;
+    agent->cb_arg = cb_arg;
+
+    agent->lock = xSemaphoreCreateMutex();
+    agent->changed = xEventGroupCreate();
+    ESP_RETURN_ON_FALSE(agent->lock && agent->changed, ESP_ERR_NO_MEM, TAG, "Failed to create the event sync");
+
+    esp_agent_config_t config = {
+        .agent_id = agent_id,
+        .refresh_token = "host-test-refresh-token",
+        .conversation_type = type,
+        .upload_audio_config = &g_audio_config,
+        .download_audio_config = &g_audio_config,
+        .name = agent_id,
+    };
+    agent->handle = esp_agent_init(&config);
+    ESP_RETURN_ON_FALSE(agent->handle, ESP_FAIL, TAG, "Failed to initialize the agent");
+
+    return esp_agent_register_event_handler(agent->handle, (esp_agent_event_t)ESP_EVENT_ANY_ID, host_test_event_handler, agent, &agent->handler);
+}
+
+void host_test_agent_deinit(host_test_agent_t *agent)
+{
+    if (agent->handle) {
+        esp_agent_stop(agent->handle);
+        esp_agent_unregister_event_handler(agent->handle, &agent->handler, (esp_agent_event_t)ESP_EVENT_ANY_ID);
+        esp_agent_deinit(agent->handle);
+        agent->handle = NULL;
+    }
+    if (agent->lock) {
+        vSemaphoreDelete(agent->lock);
+        agent->lock = NULL;
+    }
+    if (agent->changed) {
+        vEventGroupDelete(agent->changed);
+        agent->changed = NULL;
+    }
+}
+
+esp_err_t host_test_agent_start(host_test_agent_t *agent, uint32_t timeout_ms)
+{
+    uint32_t started = host_test_agent_count(agent, ESP_AGENT_EVENT_START);
+    ESP_RETURN_ON_ERROR(esp_agent_start(agent->handle, NULL), TAG, "Failed to start the agent");
+    if (!host_test_agent_wait(agent, ESP_AGENT_EVENT_START, started + 1, timeout_ms)) {
+        ESP_LOGE(TAG, "No handshake ack within %lu ms", (unsigned long)timeout_ms);
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+uint32_t host_test_agent_count(host_test_agent_t *agent, esp_agent_event_t event)
+{
+    xSemaphoreTake(agent->lock, portMAX_DELAY);
+    uint32_t count = agent->counts[event];
+    xSemaphoreGive(agent->lock);
+    return count;
+}
+
+bool host_test_agent_wait(host_test_agent_t *agent, esp_agent_event_t event, uint32_t count, uint32_t timeout_ms)
+{
+    int64_t deadline_us = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+
+    while (host_test_agent_count(agent, event) < count) {
+        int64_t remaining_us = deadline_us - esp_timer_get_time();
+        if (remaining_us <= 0) {
+            return false;
+        }
+        xEventGroupWaitBits(agent->changed, HOST_TEST_EVENT_BIT, pdTRUE, pdFALSE, pdMS_TO_TICKS(remaining_us / 1000) + 1);
+    }
+    return true;
+}
+
+int host_test_arg_int(const cJSON *args, const char *name, int def)
+{
+    cJSON *arg = cJSON_GetObjectItemCaseSensitive(args, name);
+    return cJSON_IsNumber(arg) ? arg->valueint : def;
+}
+
+const char *host_test_arg_str(const cJSON *args, const char *name, const char *def)
+{
+    const char *arg = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(args, name));
+    return arg ? arg : def;
+}
+
+void host_test_add_percentiles(cJSON *obj, const char *name, const esp_agent_latency_percentiles_t *percentiles)
+{
+    cJSON *json = cJSON_AddObjectToObject(obj, name);
+    cJSON_AddNumberToObject(json, "samples", percentiles->samples);
+    cJSON_AddNumberToObject(json, "p50_ms", percentiles->p50_ms);
+    cJSON_AddNumberToObject(json, "p90_ms", percentiles->p90_ms);
+    cJSON_AddNumberToObject(json, "p99_ms", percentiles->p99_ms);
+    cJSON_AddNumberToObject(json, "max_ms", percentiles->max_ms);
+}
+
+void host_test_add_queue_latency(cJSON *obj, const char *name, const esp_agent_queue_latency_t *latency)
+{
+    cJSON *json = cJSON_AddObjectToObject(obj, name);
+    cJSON_AddNumberToObject(json, "samples", latency->samples);
+    cJSON_AddNumberToObject(json, "p50_us", latency->p50_us);
+    cJSON_AddNumberToObject(json, "p99_us", latency->p99_us);
+    cJSON_AddNumberToObject(json, "max_us", latency->max_us);
+}
+
+void host_test_add_transport_stats(cJSON *metrics, esp_agent_handle_t handle)
+{
+    esp_agent_transport_stats_t stats;
+    if (esp_agent_get_transport_stats(handle, &stats) != ESP_OK) {
+        return;
+    }
+
+    cJSON *transport = cJSON_AddObjectToObject(metrics, "transport");
+    double elapsed_s = stats.elapsed_us > 0 ? stats.elapsed_us / 1e6 : 1;
+    cJSON_AddNumberToObject(transport, "elapsed_ms", stats.elapsed_us / 1000);
+    uint32_t messages = 0;
+    for (int i = 0; i < ESP_AGENT_TRANSPORT_COUNTER_MAX; i++) {
+        cJSON *counter = cJSON_AddObjectToObject(transport, g_counter_names[i]);
+        cJSON_AddNumberToObject(counter, "messages", stats.messages[i]);
+        cJSON_AddNumberToObject(counter, "bytes", stats.bytes[i]);
+        cJSON_AddNumberToObject(counter, "messages_per_s", stats.messages[i] / elapsed_s);
+        cJSON_AddNumberToObject(counter, "bytes_per_s", stats.bytes[i] / elapsed_s);
+        if (i != ESP_AGENT_TRANSPORT_COUNTER_TX_TOOL && i != ESP_AGENT_TRANSPORT_COUNTER_RX_TOOL) {
+            messages += stats.messages[i];
+        }
+    }
+    cJSON_AddNumberToObject(transport, "tx_dropped", stats.tx_dropped);
+    cJSON_AddNumberToObject(transport, "rx_dropped", stats.rx_dropped);
+    cJSON_AddNumberToObject(transport, "bytes_copied", stats.bytes_copied);
+    cJSON_AddNumberToObject(transport, "allocations", stats.allocations);
+    cJSON_AddNumberToObject(transport, "bytes_copied_per_message", messages ? (double)stats.bytes_copied / messages : 0);
+    cJSON_AddNumberToObject(transport, "allocations_per_message", messages ? (double)stats.allocations / messages : 0);
+    host_test_add_queue_latency(transport, "send_queue", &stats.queue_latency[ESP_AGENT_TRANSPORT_QUEUE_SEND]);
+    host_test_add_queue_latency(transport, "message_queue", &stats.queue_latency[ESP_AGENT_TRANSPORT_QUEUE_MESSAGE]);
+}
+
+void host_test_add_latency(cJSON *metrics, esp_agent_handle_t handle)
+{
+    cJSON *latency = cJSON_AddObjectToObject(metrics, "latency");
+    for (int i = 0; i < ESP_AGENT_LATENCY_STAGE_MAX; i++) {
+        esp_agent_latency_percentiles_t percentiles;
+        if (esp_agent_latency_get_percentiles(handle, (esp_agent_latency_stage_t)i, &percentiles) == ESP_OK) {
+            host_test_add_percentiles(latency, g_stage_names[i], &percentiles);
+        }
+    }
+}
+
+esp_err_t host_test_tone_file(char *path, uint32_t sample_rate, uint32_t duration_ms)
+{
+    snprintf(path, 32, "/tmp/host_test_XXXXXX");
+    int fd = mkstemp(path);
+    ESP_RETURN_ON_FALSE(fd >= 0, ESP_FAIL, TAG, "Failed to create a temporary file");
+
+    FILE *file = fdopen(fd, "wb");
+    if (file == NULL) {
+        close(fd);
+        return ESP_FAIL;
+    }
+    uint32_t samples = sample_rate * duration_ms / 1000;
+    for (uint32_t i = 0; i < samples; i++) {
+        int16_t sample = (int16_t)(8000 * sin(2 * M_PI * 440 * i / sample_rate));
+        fwrite(&sample, sizeof(sample), 1, file);
+    }
+    fclose(file);
+    return ESP_OK;
+}
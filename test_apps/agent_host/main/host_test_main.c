@@ -0,0 +1,131 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_event.h>
+
+#include "host_test.h"
+
+static const char *TAG = "host_test_main";
+
+esp_err_t host_test_conversation(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_task_stats(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_throughput(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_multi_agent(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_keepalive(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_compression(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_idle(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_event_saturation(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_resume(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_stop_purge(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_throttle(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_transcript(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_usage(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_tool_stats(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_chatty(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_tool_dedup(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_tool_cache(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_tool_exec(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_tool_parallel(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_tool_validation(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_session_cycle(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_mem(const cJSON *args, cJSON *metrics);
+esp_err_t host_test_local_run(const cJSON *args, cJSON *metrics);
+
+static const host_test_case_t g_test_cases[] = {
+    {.name = "conversation", .fn = host_test_conversation},
+    {.name = "task_stats", .fn = host_test_task_stats},
+    {.name = "throughput", .fn = host_test_throughput},
+    {.name = "transcript", .fn = host_test_transcript},
+    {.name = "multi_agent", .fn = host_test_multi_agent},
+    {.name = "keepalive", .fn = host_test_keepalive},
+    {.name = "compression", .fn = host_test_compression},
+    {.name = "idle", .fn = host_test_idle},
+    {.name = "event_saturation", .fn = host_test_event_saturation},
+    {.name = "resume", .fn = host_test_resume},
+    {.name = "stop_purge", .fn = host_test_stop_purge},
+    {.name = "throttle", .fn = host_test_throttle},
+    {.name = "usage", .fn = host_test_usage},
+    {.name = "tool_stats", .fn = host_test_tool_stats},
+    {.name = "chatty", .fn = host_test_chatty},
+    {.name = "tool_dedup", .fn = host_test_tool_dedup},
+    {.name = "tool_cache", .fn = host_test_tool_cache},
+    {.name = "tool_exec", .fn = host_test_tool_exec},
+    {.name = "tool_parallel", .fn = host_test_tool_parallel},
+    {.name = "tool_validation", .fn = host_test_tool_validation},
+    {.name = "session_cycle", .fn = host_test_session_cycle},
+    {.name = "mem", .fn = host_test_mem},
+    {.name = "local_run", .fn = host_test_local_run},
+};
+
+static const host_test_case_t *host_test_find(const char *name)
+{
+    for (size_t i = 0; i < sizeof(g_test_cases) / sizeof(g_test_cases[0]); i++) {
+        if (strcmp(g_test_cases[i].name, name) == 0) {
+            return &g_test_cases[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * The test to run and its arguments are taken from the environment, set by run_host_tests.py:
+ * HOST_TEST is the name of the test case, HOST_TEST_ARGS a JSON object.
+ * The result is printed on one line, prefixed with HOST_TEST_RESULT, and is the exit status too.
+ */
+void app_main(void)
+{
+    const char *name = getenv("HOST_TEST");
+    if (name == NULL) {
+        printf("Set HOST_TEST to one of:");
+        for (size_t i = 0; i < sizeof(g_test_cases) / sizeof(g_test_cases[0]); i++) {
+            printf(" %s", g_test_cases[i].name);
+        }
+        printf("\n");
+        exit(2);
+    }
+
+    const host_test_case_t *test_case = host_test_find(name);
+    if (test_case == NULL) {
+        ESP_LOGE(TAG, "Unknown test: %s", name);
+        exit(2);
+    }
+
+    const char *args_str = getenv("HOST_TEST_ARGS");
+    cJSON *args = args_str ? cJSON_Parse(args_str) : cJSON_CreateObject();
+    if (args == NULL) {
+        ESP_LOGE(TAG, "Invalid HOST_TEST_ARGS: %s", args_str);
+        exit(2);
+    }
+
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
+
+    cJSON *result = cJSON_CreateObject();
+    cJSON_AddStringToObject(result, "test", name);
+    cJSON *metrics = cJSON_AddObjectToObject(result, "metrics");
+
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t err = test_case->fn(args, metrics);
+    cJSON_AddNumberToObject(result, "duration_ms", (esp_timer_get_time() - start_us) / 1000);
+    cJSON_AddBoolToObject(result, "passed", err == ESP_OK);
+    if (err != ESP_OK) {
+        cJSON_AddStringToObject(result, "error", esp_err_to_name(err));
+    }
+
+    char *result_str = cJSON_PrintUnformatted(result);
+    printf("HOST_TEST_RESULT %s\n", result_str ? result_str : "{}");
+    fflush(stdout);
+
+    free(result_str);
+    cJSON_Delete(result);
+    cJSON_Delete(args);
+    exit(err == ESP_OK ? 0 : 1);
+}
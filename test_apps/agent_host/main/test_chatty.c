@@ -0,0 +1,114 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Chatty session (scenarios/chatty.json): on every turn the mock server sends a burst of
+ * interim user transcripts, the final user text, a burst of speculative assistant text and the
+ * final assistant text. The updates of both roles must be rate limited to
+ * CONFIG_ESP_AGENT_EVENT_STREAM_WINDOW_MS, and an update still held when the final text of its
+ * role arrives must be discarded: once a final text was delivered, the next update of its role
+ * must be the first one of the next turn.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <sdkconfig.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_chatty";
+
+typedef struct {
+    uint32_t updates;
+    uint32_t finals;
+    uint32_t stale;                 /* Updates delivered after the final text of their turn */
+    bool after_final;
+} chatty_role_t;
+
+typedef struct {
+    chatty_role_t user;
+    chatty_role_t assistant;
+} chatty_state_t;
+
+static host_test_agent_t g_agent;
+static chatty_state_t g_state;
+
+/* Runs in the agent event loop */
+static void chatty_event_cb(void *arg, esp_agent_event_t event, esp_agent_message_data_t *data)
+{
+    chatty_state_t *state = (chatty_state_t *)arg;
+    unsigned index;
+
+    if (event != ESP_AGENT_EVENT_DATA_TYPE_TEXT || data == NULL || data->text.text == NULL) {
+        return;
+    }
+    chatty_role_t *role = data->text.role == ESP_AGENT_MESSAGE_ROLE_USER ? &state->user : &state->assistant;
+    if (data->text.generation_stage == ESP_AGENT_MESSAGE_GENERATION_STAGE_FINAL) {
+        role->finals++;
+        role->after_final = true;
+        return;
+    }
+
+    role->updates++;
+    /* The server pauses longer than a window between turns, so the first update of a turn is never held */
+    if (role->after_final && (sscanf(data->text.text, "%*c%u", &index) != 1 || index != 0)) {
+        role->stale++;
+    }
+    role->after_final = false;
+}
+
+static void add_role(cJSON *metrics, const char *name, const chatty_role_t *role, const esp_agent_event_stream_stats_t *stream)
+{
+    cJSON *json = cJSON_AddObjectToObject(metrics, name);
+    cJSON_AddNumberToObject(json, "updates", role->updates);
+    cJSON_AddNumberToObject(json, "finals", role->finals);
+    cJSON_AddNumberToObject(json, "stale", role->stale);
+    cJSON_AddNumberToObject(json, "received", stream->received);
+    cJSON_AddNumberToObject(json, "delivered", stream->delivered);
+    cJSON_AddNumberToObject(json, "discarded", stream->discarded);
+}
+
+esp_err_t host_test_chatty(const cJSON *args, cJSON *metrics)
+{
+    int turns = host_test_arg_int(args, "turns", 5);
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 10000);
+
+    esp_err_t ret = ESP_OK;
+    esp_agent_event_stats_t stats;
+
+    memset(&g_agent, 0, sizeof(g_agent));
+    memset(&g_state, 0, sizeof(g_state));
+    g_agent.cb = chatty_event_cb;
+    g_agent.cb_arg = &g_state;
+
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&g_agent, "host-test", ESP_AGENT_CONVERSATION_TEXT), end, TAG, "Failed to create the agent");
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&g_agent, 5000), end, TAG, "Failed to start the agent");
+
+    /* The last final text of the session closes the last turn */
+    bool done = false;
+    for (int waited = 0; !done && waited < timeout_ms; waited += 10) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+        done = g_state.assistant.finals >= (uint32_t)turns;
+    }
+    /* A stale update would be released at the end of its window */
+    vTaskDelay(pdMS_TO_TICKS(2 * CONFIG_ESP_AGENT_EVENT_STREAM_WINDOW_MS));
+
+    ESP_GOTO_ON_ERROR(esp_agent_get_event_stats(g_agent.handle, &stats), end, TAG, "Failed to get the event stats");
+    add_role(metrics, "user", &g_state.user, &stats.streams[ESP_AGENT_EVENT_STREAM_USER_SPECULATIVE]);
+    add_role(metrics, "assistant", &g_state.assistant, &stats.streams[ESP_AGENT_EVENT_STREAM_SPECULATIVE]);
+    cJSON_AddNumberToObject(metrics, "window_ms", CONFIG_ESP_AGENT_EVENT_STREAM_WINDOW_MS);
+    ESP_GOTO_ON_FALSE(done, ESP_ERR_TIMEOUT, end, TAG, "%lu of %d turns completed", (unsigned long)g_state.assistant.finals, turns);
+
+end:
+    host_test_agent_deinit(&g_agent);
+    return ret;
+}
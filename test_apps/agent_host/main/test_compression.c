@@ -0,0 +1,92 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Received compressed messages (scenarios/compression.json): the mock server sends
+ * compressed tool requests, then a message compressed twice, which must be dropped, then
+ * a plain message, which must still be processed.
+ *
+ * Reports the received tool messages with their size on the wire next to the decompressed
+ * size, so that the transport statistics can be checked to count the wire bytes.
+ */
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_compression";
+
+#define COMPRESSION_TOOL_NAME "echo"
+
+static atomic_uint g_tool_calls;
+
+static esp_err_t echo_handler(esp_agent_handle_t handle, const char *tool_name, esp_agent_tool_param_t params[],
+                              size_t num_params, void *user_data, char **result)
+{
+    atomic_fetch_add(&g_tool_calls, 1);
+    *result = strdup("ok");
+    return *result ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t host_test_compression(const cJSON *args, cJSON *metrics)
+{
+    int tool_count = host_test_arg_int(args, "tool_count", 10);
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 10000);
+
+    esp_err_t ret = ESP_OK;
+    static host_test_agent_t agent;
+    esp_agent_transport_stats_t stats;
+
+    atomic_store(&g_tool_calls, 0);
+    memset(&agent, 0, sizeof(agent));
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&agent, "host-test", ESP_AGENT_CONVERSATION_TEXT), end, TAG, "Failed to create the agent");
+    esp_agent_tool_config_t tool_config = {
+        .name = COMPRESSION_TOOL_NAME,
+        .handler = echo_handler,
+        .exec_mode = ESP_AGENT_TOOL_EXEC_INLINE,
+    };
+    ESP_GOTO_ON_ERROR(esp_agent_register_local_tool_with_config(agent.handle, &tool_config), end, TAG, "Failed to register the tool");
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&agent, 5000), end, TAG, "Failed to start the agent");
+
+    /* The plain message comes after the nested one, so the nested one was handled by then */
+    bool received = host_test_agent_wait(&agent, ESP_AGENT_EVENT_DATA_TYPE_TEXT, 1, timeout_ms);
+    /* Let a wrongly accepted nested message show up as a second text */
+    vTaskDelay(pdMS_TO_TICKS(200));
+
+    xSemaphoreTake(agent.lock, portMAX_DELAY);
+    uint32_t texts = agent.counts[ESP_AGENT_EVENT_DATA_TYPE_TEXT];
+    bool last_is_plain = strcmp(agent.last_text, "plain") == 0;
+    xSemaphoreGive(agent.lock);
+
+    cJSON_AddNumberToObject(metrics, "tool_calls", atomic_load(&g_tool_calls));
+    cJSON_AddNumberToObject(metrics, "texts", texts);
+    cJSON_AddBoolToObject(metrics, "last_is_plain", last_is_plain);
+    ESP_GOTO_ON_ERROR(esp_agent_get_transport_stats(agent.handle, &stats), end, TAG, "Failed to get the transport stats");
+    uint32_t rx_tool = stats.messages[ESP_AGENT_TRANSPORT_COUNTER_RX_TOOL];
+    cJSON_AddNumberToObject(metrics, "rx_tool_messages", rx_tool);
+    cJSON_AddNumberToObject(metrics, "rx_tool_bytes_per_message", rx_tool ? (double)stats.bytes[ESP_AGENT_TRANSPORT_COUNTER_RX_TOOL] / rx_tool : 0);
+    cJSON_AddNumberToObject(metrics, "rx_decompressed", stats.rx_compression.messages);
+    cJSON_AddNumberToObject(metrics, "rx_original_bytes_per_message",
+                            stats.rx_compression.messages ? (double)stats.rx_compression.original_bytes / stats.rx_compression.messages : 0);
+    host_test_add_transport_stats(metrics, agent.handle);
+
+    ESP_GOTO_ON_FALSE(received, ESP_ERR_TIMEOUT, end, TAG, "The plain message was not received");
+    ESP_GOTO_ON_FALSE(texts == 1 && last_is_plain, ESP_FAIL, end, TAG, "The nested compressed message was processed");
+    ESP_GOTO_ON_FALSE(atomic_load(&g_tool_calls) == (unsigned)tool_count, ESP_FAIL, end, TAG, "%u of %d tool calls",
+                      atomic_load(&g_tool_calls), tool_count);
+
+end:
+    host_test_agent_deinit(&agent);
+    return ret;
+}
@@ -0,0 +1,266 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Scripted voice conversation through the audio component, with file backed codecs.
+ *
+ * Every turn replays the microphone file as one utterance. The mock server answers each
+ * audio_stream_end with a transcript and downlink audio (scenarios/conversation.json),
+ * which is written to the speaker file. Reports the per-stage latency and the throughput.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <audio_recorder.h>
+#include <audio_playback.h>
+#include <host_codec_dev.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_conversation";
+
+#define CONVERSATION_SAMPLE_RATE 16000
+#define CONVERSATION_FRAME_MS 20
+#define CONVERSATION_FRAME_LEN (CONVERSATION_SAMPLE_RATE * CONVERSATION_FRAME_MS / 1000 * 2)
+#define CONVERSATION_MAX_TURNS 32
+
+#define WAKEUP_BIT BIT0
+#define VAD_END_BIT BIT1
+
+typedef struct {
+    host_test_agent_t agent;
+    audio_recorder_handle_t recorder;
+    audio_playback_handle_t playback;
+    EventGroupHandle_t bits;
+    volatile bool in_turn;
+    volatile bool running;
+    TaskHandle_t uplink_task;
+    uint32_t uplink_frames;
+    uint32_t uplink_failures;
+    uint32_t playback_failures;
+    /* Per-turn breakdown from ESP_AGENT_EVENT_LATENCY */
+    int32_t stage_ms[CONVERSATION_MAX_TURNS][ESP_AGENT_LATENCY_STAGE_MAX];
+    uint32_t breakdowns;
+} conversation_t;
+
+static void recorder_event_cb(audio_recorder_handle_t handle, audio_recorder_event_t event, void *user_data)
+{
+    conversation_t *conversation = (conversation_t *)user_data;
+
+    if (event == AUDIO_RECORDER_EVENT_WAKEUP_START) {
+        xEventGroupSetBits(conversation->bits, WAKEUP_BIT);
+    } else if (event == AUDIO_RECORDER_EVENT_VAD_END) {
+        esp_agent_latency_mark(conversation->agent.handle, ESP_AGENT_LATENCY_STAGE_VAD_END);
+        xEventGroupSetBits(conversation->bits, VAD_END_BIT);
+    }
+}
+
+static void playback_event_cb(audio_playback_handle_t handle, audio_playback_event_t event, void *user_data)
+{
+    conversation_t *conversation = (conversation_t *)user_data;
+
+    esp_agent_latency_mark(conversation->agent.handle, event == AUDIO_PLAYBACK_EVENT_FRAME_DECODED ?
+                           ESP_AGENT_LATENCY_STAGE_FIRST_DECODED_FRAME : ESP_AGENT_LATENCY_STAGE_FIRST_CODEC_WRITE);
+}
+
+static void agent_event_cb(void *arg, esp_agent_event_t event, esp_agent_message_data_t *data)
+{
+    conversation_t *conversation = (conversation_t *)arg;
+
+    if (event == ESP_AGENT_EVENT_DATA_TYPE_SPEECH) {
+        if (audio_playback_write(conversation->playback, data->speech.data, data->speech.len) != ESP_OK) {
+            conversation->playback_failures++;
+        }
+    } else if (event == ESP_AGENT_EVENT_LATENCY && conversation->breakdowns < CONVERSATION_MAX_TURNS) {
+        memcpy(conversation->stage_ms[conversation->breakdowns++], data->latency.stage_ms, sizeof(data->latency.stage_ms));
+    }
+}
+
+/* Breakdown of every turn, and the number of turns that reached all stages */
+static void add_breakdowns(cJSON *metrics, conversation_t *conversation)
+{
+    cJSON *turns = cJSON_AddArrayToObject(metrics, "turn_latency_ms");
+    uint32_t complete = 0;
+
+    for (uint32_t turn = 0; turn < conversation->breakdowns; turn++) {
+        cJSON *stages = cJSON_CreateIntArray((const int *)conversation->stage_ms[turn], ESP_AGENT_LATENCY_STAGE_MAX);
+        cJSON_AddItemToArray(turns, stages);
+        bool reached = true;
+        for (int i = 0; i < ESP_AGENT_LATENCY_STAGE_MAX; i++) {
+            reached &= conversation->stage_ms[turn][i] >= 0;
+        }
+        complete += reached;
+    }
+    cJSON_AddNumberToObject(metrics, "complete_turns", complete);
+}
+
+static void uplink_task(void *arg)
+{
+    conversation_t *conversation = (conversation_t *)arg;
+    uint8_t frame[CONVERSATION_FRAME_LEN];
+
+    while (conversation->running) {
+        size_t len = 0;
+        if (audio_recorder_read(conversation->recorder, frame, sizeof(frame), &len) != ESP_OK || len == 0) {
+            continue;
+        }
+        if (!conversation->in_turn) {
+            continue;
+        }
+        if (esp_agent_send_speech(conversation->agent.handle, frame, len, pdMS_TO_TICKS(1000)) == ESP_OK) {
+            conversation->uplink_frames++;
+        } else {
+            conversation->uplink_failures++;
+        }
+    }
+    conversation->uplink_task = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t host_test_conversation(const cJSON *args, cJSON *metrics)
+{
+    int turns = host_test_arg_int(args, "turns", 3);
+    ESP_RETURN_ON_FALSE(turns > 0 && turns <= CONVERSATION_MAX_TURNS, ESP_ERR_INVALID_ARG, TAG, "turns must be 1 to %d", CONVERSATION_MAX_TURNS);
+    int utterance_ms = host_test_arg_int(args, "utterance_ms", 1000);
+    int reply_timeout_ms = host_test_arg_int(args, "reply_timeout_ms", 10000);
+    bool realtime = host_test_arg_int(args, "realtime", 1);
+
+    esp_err_t ret = ESP_OK;
+    static conversation_t conversation;
+    char mic_path[32];
+    char speaker_path[32] = "";
+    esp_codec_dev_handle_t mic = NULL;
+    esp_codec_dev_handle_t speaker = NULL;
+    int completed = 0;
+
+    memset(&conversation, 0, sizeof(conversation));
+    conversation.bits = xEventGroupCreate();
+    ESP_RETURN_ON_FALSE(conversation.bits, ESP_ERR_NO_MEM, TAG, "Failed to create the event group");
+
+    ESP_GOTO_ON_ERROR(host_test_tone_file(mic_path, CONVERSATION_SAMPLE_RATE, utterance_ms), end, TAG, "Failed to create the microphone file");
+    snprintf(speaker_path, sizeof(speaker_path), "%s.out", mic_path);
+
+    esp_codec_dev_sample_info_t fs = {
+        .bits_per_sample = 16,
+        .channel = 1,
+        .sample_rate = CONVERSATION_SAMPLE_RATE,
+    };
+    host_codec_dev_config_t mic_config = {.path = mic_path, .input = true, .realtime = realtime};
+    host_codec_dev_config_t speaker_config = {.path = speaker_path, .input = false, .realtime = realtime};
+    mic = host_codec_dev_new(&mic_config);
+    speaker = host_codec_dev_new(&speaker_config);
+    ESP_GOTO_ON_FALSE(mic && speaker, ESP_ERR_NO_MEM, end, TAG, "Failed to create the codec devices");
+    ESP_GOTO_ON_FALSE(esp_codec_dev_open(mic, &fs) == 0, ESP_FAIL, end, TAG, "Failed to open the microphone");
+    ESP_GOTO_ON_FALSE(esp_codec_dev_open(speaker, &fs) == 0, ESP_FAIL, end, TAG, "Failed to open the speaker");
+
+    audio_recorder_config_t recorder_config = {
+        .format = "pcm",
+        .in_dev_handle = mic,
+        .sample_rate = CONVERSATION_SAMPLE_RATE,
+        .frame_duration_ms = CONVERSATION_FRAME_MS,
+    };
+    conversation.recorder = audio_recorder_init(&recorder_config);
+    audio_playback_config_t playback_config = {
+        .audio_in_info = {.frame_duration_ms = CONVERSATION_FRAME_MS, .sample_rate = CONVERSATION_SAMPLE_RATE},
+        .out_codec_info = fs,
+        .out_dev_handle = speaker,
+    };
+    conversation.playback = audio_playback_init(&playback_config);
+    ESP_GOTO_ON_FALSE(conversation.recorder && conversation.playback, ESP_FAIL, end, TAG, "Failed to initialize the audio");
+    audio_recorder_add_event_cb(conversation.recorder, recorder_event_cb, &conversation);
+    audio_playback_add_event_cb(conversation.playback, playback_event_cb, &conversation);
+
+    conversation.agent.cb = agent_event_cb;
+    conversation.agent.cb_arg = &conversation;
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&conversation.agent, "host-test", ESP_AGENT_CONVERSATION_SPEECH), end, TAG, "Failed to create the agent");
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&conversation.agent, 5000), end, TAG, "Failed to start the agent");
+    esp_agent_reset_transport_stats(conversation.agent.handle);
+
+    ESP_GOTO_ON_ERROR(audio_playback_start(conversation.playback), end, TAG, "Failed to start the playback");
+    conversation.running = true;
+    ESP_GOTO_ON_FALSE(xTaskCreate(uplink_task, "uplink", 4096, &conversation, 5, &conversation.uplink_task) == pdPASS,
+                      ESP_ERR_NO_MEM, end, TAG, "Failed to create the uplink task");
+    ESP_GOTO_ON_ERROR(audio_recorder_start(conversation.recorder), end, TAG, "Failed to start the recorder");
+
+    int64_t start_us = esp_timer_get_time();
+    for (int turn = 1; turn <= turns; turn++) {
+        xEventGroupClearBits(conversation.bits, WAKEUP_BIT | VAD_END_BIT);
+        if (turn > 1) {
+            host_codec_dev_rewind(mic);
+        }
+        EventBits_t bits = xEventGroupWaitBits(conversation.bits, WAKEUP_BIT, pdTRUE, pdFALSE, pdMS_TO_TICKS(2000));
+        ESP_GOTO_ON_FALSE(bits & WAKEUP_BIT, ESP_ERR_TIMEOUT, end, TAG, "No utterance in turn %d", turn);
+
+        ESP_GOTO_ON_ERROR(esp_agent_speech_conversation_start(conversation.agent.handle), end, TAG, "Failed to start the turn");
+        conversation.in_turn = true;
+
+        bits = xEventGroupWaitBits(conversation.bits, VAD_END_BIT, pdTRUE, pdFALSE, pdMS_TO_TICKS(utterance_ms + 2000));
+        ESP_GOTO_ON_FALSE(bits & VAD_END_BIT, ESP_ERR_TIMEOUT, end, TAG, "Utterance of turn %d did not end", turn);
+        /* The last frames are still on their way from the recorder */
+        vTaskDelay(pdMS_TO_TICKS(2 * CONVERSATION_FRAME_MS));
+        conversation.in_turn = false;
+        ESP_GOTO_ON_ERROR(esp_agent_speech_conversation_end(conversation.agent.handle), end, TAG, "Failed to end the turn");
+
+        ESP_GOTO_ON_FALSE(host_test_agent_wait(&conversation.agent, ESP_AGENT_EVENT_SPEECH_END, turn, reply_timeout_ms),
+                          ESP_ERR_TIMEOUT, end, TAG, "No reply in turn %d", turn);
+        size_t remaining = 0;
+        do {
+            vTaskDelay(pdMS_TO_TICKS(CONVERSATION_FRAME_MS));
+            audio_playback_remaining_bytes(conversation.playback, &remaining);
+        } while (remaining);
+        completed++;
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    /* The breakdown is posted with the first codec write of the turn, it may still be in the event loop */
+    host_test_agent_wait(&conversation.agent, ESP_AGENT_EVENT_LATENCY, completed, 1000);
+
+    cJSON_AddNumberToObject(metrics, "turns", completed);
+    cJSON_AddNumberToObject(metrics, "elapsed_ms", elapsed_us / 1000);
+    cJSON_AddNumberToObject(metrics, "uplink_frames", conversation.uplink_frames);
+    cJSON_AddNumberToObject(metrics, "uplink_failures", conversation.uplink_failures);
+    cJSON_AddNumberToObject(metrics, "downlink_bytes", conversation.agent.speech_bytes);
+    cJSON_AddNumberToObject(metrics, "speaker_bytes", host_codec_dev_bytes(speaker));
+    cJSON_AddNumberToObject(metrics, "playback_failures", conversation.playback_failures);
+    cJSON_AddNumberToObject(metrics, "transcripts", host_test_agent_count(&conversation.agent, ESP_AGENT_EVENT_DATA_TYPE_TEXT));
+    add_breakdowns(metrics, &conversation);
+    host_test_add_latency(metrics, conversation.agent.handle);
+    host_test_add_transport_stats(metrics, conversation.agent.handle);
+
+end:
+    conversation.running = false;
+    if (conversation.recorder) {
+        /* Unblocks the uplink task, which may wait for a frame */
+        host_codec_dev_rewind(mic);
+        while (conversation.uplink_task) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+    }
+    host_test_agent_deinit(&conversation.agent);
+    if (conversation.recorder) {
+        audio_recorder_deinit(conversation.recorder);
+    }
+    if (conversation.playback) {
+        audio_playback_deinit(conversation.playback);
+    }
+    if (mic) {
+        esp_codec_dev_delete(mic);
+        remove(mic_path);
+    }
+    if (speaker) {
+        esp_codec_dev_delete(speaker);
+        remove(speaker_path);
+    }
+    vEventGroupDelete(conversation.bits);
+    return ret;
+}
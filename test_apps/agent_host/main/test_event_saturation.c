@@ -0,0 +1,141 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Saturated event loop (scenarios/event_saturation.json): the application blocks the agent
+ * event loop on a "block" text, while the mock server keeps sending text.
+ *
+ * First the loop is released: every text must be delivered in order from the backlog, and a
+ * latency event completed meanwhile must be kept rather than dropped. Then the loop is blocked
+ * again and the agent stopped: the text still deferred must be cleared, and the disconnect
+ * still delivered.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <sdkconfig.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_event_saturation";
+
+typedef struct {
+    volatile bool blocked;
+    volatile bool release;
+    uint32_t texts;
+    uint32_t out_of_order;
+} saturation_state_t;
+
+static host_test_agent_t g_agent;
+static saturation_state_t g_state;
+
+/* Runs in the agent event loop */
+static void saturation_event_cb(void *arg, esp_agent_event_t event, esp_agent_message_data_t *data)
+{
+    saturation_state_t *state = (saturation_state_t *)arg;
+    unsigned index;
+
+    if (event != ESP_AGENT_EVENT_DATA_TYPE_TEXT || data == NULL || data->text.text == NULL) {
+        return;
+    }
+
+    if (strncmp(data->text.text, "block", 5) == 0) {
+        state->release = false;
+        state->blocked = true;
+        while (!state->release) {
+            vTaskDelay(pdMS_TO_TICKS(5));
+        }
+        state->blocked = false;
+        state->texts = 0;
+    } else if (sscanf(data->text.text, "t%u", &index) == 1) {
+        if (index != state->texts) {
+            state->out_of_order++;
+        }
+        state->texts++;
+    }
+}
+
+static bool wait_blocked(int timeout_ms)
+{
+    for (int waited = 0; !g_state.blocked && waited < timeout_ms; waited += 10) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return g_state.blocked;
+}
+
+static void add_event_stats(cJSON *metrics, const char *name)
+{
+    esp_agent_event_stats_t stats;
+    if (esp_agent_get_event_stats(g_agent.handle, &stats) != ESP_OK) {
+        return;
+    }
+    cJSON *json = cJSON_AddObjectToObject(metrics, name);
+    cJSON_AddNumberToObject(json, "deferred", stats.deferred);
+    cJSON_AddNumberToObject(json, "replaced", stats.replaced);
+    cJSON_AddNumberToObject(json, "dropped", stats.dropped);
+    cJSON_AddNumberToObject(json, "cleared", stats.cleared);
+    cJSON_AddNumberToObject(json, "max_backlog", stats.max_backlog);
+}
+
+esp_err_t host_test_event_saturation(const cJSON *args, cJSON *metrics)
+{
+    int count = host_test_arg_int(args, "count", 30);
+    int block_ms = host_test_arg_int(args, "block_ms", 300);
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 5000);
+
+    esp_err_t ret = ESP_OK;
+
+    memset(&g_agent, 0, sizeof(g_agent));
+    memset(&g_state, 0, sizeof(g_state));
+    g_agent.cb = saturation_event_cb;
+    g_agent.cb_arg = &g_state;
+
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&g_agent, "host-test", ESP_AGENT_CONVERSATION_TEXT), end, TAG, "Failed to create the agent");
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&g_agent, 5000), end, TAG, "Failed to start the agent");
+
+    /* The texts pile up behind the blocked handler, and a turn completes meanwhile */
+    ESP_GOTO_ON_FALSE(wait_blocked(timeout_ms), ESP_ERR_TIMEOUT, end, TAG, "The event loop was not blocked");
+    vTaskDelay(pdMS_TO_TICKS(block_ms));
+    esp_agent_latency_mark(g_agent.handle, ESP_AGENT_LATENCY_STAGE_VAD_END);
+    esp_agent_latency_mark(g_agent.handle, ESP_AGENT_LATENCY_STAGE_DOWNLINK_FIRST_FRAME);
+    esp_agent_latency_mark(g_agent.handle, ESP_AGENT_LATENCY_STAGE_FIRST_CODEC_WRITE);
+    g_state.release = true;
+
+    bool delivered = host_test_agent_wait(&g_agent, ESP_AGENT_EVENT_DATA_TYPE_TEXT, 1 + count, timeout_ms);
+    bool latency = host_test_agent_wait(&g_agent, ESP_AGENT_EVENT_LATENCY, 1, timeout_ms);
+    cJSON_AddNumberToObject(metrics, "texts", g_state.texts);
+    cJSON_AddNumberToObject(metrics, "out_of_order", g_state.out_of_order);
+    cJSON_AddNumberToObject(metrics, "latency_events", host_test_agent_count(&g_agent, ESP_AGENT_EVENT_LATENCY));
+    add_event_stats(metrics, "saturated");
+    ESP_GOTO_ON_FALSE(delivered, ESP_ERR_TIMEOUT, end, TAG, "%lu of %d texts delivered", (unsigned long)g_state.texts, count);
+    ESP_GOTO_ON_FALSE(latency, ESP_ERR_TIMEOUT, end, TAG, "The latency event was lost");
+
+    /* Blocked again, then stopped: what is still deferred belongs to a stopped conversation */
+    ESP_GOTO_ON_ERROR(esp_agent_send_text(g_agent.handle, "next", pdMS_TO_TICKS(1000)), end, TAG, "Failed to send");
+    ESP_GOTO_ON_FALSE(wait_blocked(timeout_ms), ESP_ERR_TIMEOUT, end, TAG, "The event loop was not blocked again");
+    vTaskDelay(pdMS_TO_TICKS(block_ms));
+    ESP_GOTO_ON_ERROR(esp_agent_stop(g_agent.handle), end, TAG, "Failed to stop");
+    g_state.release = true;
+
+    bool disconnected = host_test_agent_wait(&g_agent, ESP_AGENT_EVENT_DISCONNECTED, 1, timeout_ms);
+    /* Only what the event loop queue held at the stop may still show up, not the backlog */
+    vTaskDelay(pdMS_TO_TICKS(200));
+    cJSON_AddNumberToObject(metrics, "texts_after_stop", g_state.texts);
+    cJSON_AddBoolToObject(metrics, "disconnected", disconnected);
+    add_event_stats(metrics, "stopped");
+    ESP_GOTO_ON_FALSE(disconnected, ESP_ERR_TIMEOUT, end, TAG, "The disconnect was not delivered");
+
+end:
+    g_state.release = true;
+    host_test_agent_deinit(&g_agent);
+    return ret;
+}
@@ -0,0 +1,117 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Idle connection close (scenarios/idle.json): the device exchanges a message every
+ * `interval_ms` for longer than CONFIG_ESP_AGENT_IDLE_TIMEOUT_S, which must not close the
+ * connection, then goes quiet. The agent must post the idle event, close the connection from
+ * its message task and start again on the next esp_agent_start().
+ *
+ * Reports the time from the last message to the idle event, and from the idle event to the
+ * disconnect. Both are events, so a close blocking the event loop shows up in the second.
+ */
+
+#include <string.h>
+
+#include <sdkconfig.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_idle";
+
+typedef struct {
+    int64_t idle_us;
+    int64_t disconnected_us;
+} idle_events_t;
+
+static host_test_agent_t g_agent;
+static idle_events_t g_events;
+
+/* Runs in the agent event loop */
+static void idle_event_cb(void *arg, esp_agent_event_t event, esp_agent_message_data_t *data)
+{
+    idle_events_t *events = (idle_events_t *)arg;
+    int64_t now = esp_timer_get_time();
+
+    if (event == ESP_AGENT_EVENT_IDLE && events->idle_us == 0) {
+        events->idle_us = now;
+    } else if (event == ESP_AGENT_EVENT_DISCONNECTED && events->idle_us && events->disconnected_us == 0) {
+        events->disconnected_us = now;
+    }
+}
+
+static esp_err_t round_trip(int timeout_ms)
+{
+    uint32_t replies = host_test_agent_count(&g_agent, ESP_AGENT_EVENT_DATA_TYPE_TEXT);
+    ESP_RETURN_ON_ERROR(esp_agent_send_text(g_agent.handle, "ping", pdMS_TO_TICKS(1000)), TAG, "Failed to send");
+    ESP_RETURN_ON_FALSE(host_test_agent_wait(&g_agent, ESP_AGENT_EVENT_DATA_TYPE_TEXT, replies + 1, timeout_ms),
+                        ESP_ERR_TIMEOUT, TAG, "No reply");
+    return ESP_OK;
+}
+
+esp_err_t host_test_idle(const cJSON *args, cJSON *metrics)
+{
+    int interval_ms = host_test_arg_int(args, "interval_ms", 1000);
+    int active_ms = host_test_arg_int(args, "active_ms", 2 * CONFIG_ESP_AGENT_IDLE_TIMEOUT_S * 1000);
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 5000);
+    ESP_RETURN_ON_FALSE(CONFIG_ESP_AGENT_IDLE_TIMEOUT_S > 0, ESP_ERR_NOT_SUPPORTED, TAG, "CONFIG_ESP_AGENT_IDLE_TIMEOUT_S is 0");
+    ESP_RETURN_ON_FALSE(interval_ms > 0 && interval_ms < CONFIG_ESP_AGENT_IDLE_TIMEOUT_S * 1000, ESP_ERR_INVALID_ARG, TAG, "Invalid interval_ms");
+
+    esp_err_t ret = ESP_OK;
+    esp_agent_connection_stats_t stats;
+    int round_trips = 0;
+
+    memset(&g_agent, 0, sizeof(g_agent));
+    memset(&g_events, 0, sizeof(g_events));
+    g_agent.cb = idle_event_cb;
+    g_agent.cb_arg = &g_events;
+
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&g_agent, "host-test", ESP_AGENT_CONVERSATION_TEXT), end, TAG, "Failed to create the agent");
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&g_agent, 5000), end, TAG, "Failed to start the agent");
+
+    /* Messages more often than the timeout keep the connection up */
+    int64_t active_until_us = esp_timer_get_time() + (int64_t)active_ms * 1000;
+    int64_t last_activity_us = 0;
+    while (esp_timer_get_time() < active_until_us) {
+        ESP_GOTO_ON_ERROR(round_trip(timeout_ms), end, TAG, "Round trip %d failed", round_trips);
+        last_activity_us = esp_timer_get_time();
+        round_trips++;
+        vTaskDelay(pdMS_TO_TICKS(interval_ms));
+    }
+    cJSON_AddNumberToObject(metrics, "active_round_trips", round_trips);
+    cJSON_AddNumberToObject(metrics, "idle_while_active", host_test_agent_count(&g_agent, ESP_AGENT_EVENT_IDLE));
+
+    /* Quiet: closed after the timeout, checked every quarter of it */
+    bool closed = host_test_agent_wait(&g_agent, ESP_AGENT_EVENT_DISCONNECTED, 1, CONFIG_ESP_AGENT_IDLE_TIMEOUT_S * 2000 + timeout_ms);
+    cJSON_AddNumberToObject(metrics, "idle_after_ms",
+                            g_events.idle_us && last_activity_us ? (g_events.idle_us - last_activity_us) / 1000 : -1);
+    cJSON_AddNumberToObject(metrics, "idle_to_disconnected_ms",
+                            g_events.disconnected_us ? (g_events.disconnected_us - g_events.idle_us) / 1000 : -1);
+    ESP_GOTO_ON_FALSE(closed && g_events.idle_us, ESP_ERR_TIMEOUT, end, TAG, "Not closed when idle");
+
+    /* Stopped already, so this must not stop it twice */
+    ESP_GOTO_ON_ERROR(esp_agent_stop(g_agent.handle), end, TAG, "Failed to stop the idle agent");
+
+    /* The next start connects again */
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&g_agent, 5000), end, TAG, "Failed to start again");
+    ESP_GOTO_ON_ERROR(round_trip(timeout_ms), end, TAG, "Round trip after the idle close failed");
+
+end:
+    if (g_agent.handle && esp_agent_get_connection_stats(g_agent.handle, &stats) == ESP_OK) {
+        cJSON_AddNumberToObject(metrics, "connects", stats.connects);
+        cJSON_AddNumberToObject(metrics, "idle_closes", stats.idle_closes);
+        cJSON_AddNumberToObject(metrics, "stops", stats.stops);
+        cJSON_AddNumberToObject(metrics, "stop_call_max_us", stats.stop_call.max_us);
+    }
+    host_test_agent_deinit(&g_agent);
+    return ret;
+}
@@ -0,0 +1,154 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Dead link detection (scenarios/keepalive.json): the device streams audio in bursts, so
+ * that pings are queued behind audio frames, until the mock server goes silent on the first
+ * connection. The keep-alive must declare the link dead, tear it down and connect again,
+ * while the event loop keeps delivering events.
+ *
+ * Reports the round trip of the pings under load, and the time from the dead link event to
+ * the disconnect and to the next start. Both are events, so a teardown blocking the event
+ * loop shows up in them.
+ */
+
+#include <string.h>
+
+#include <sdkconfig.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_keepalive";
+
+#define KEEPALIVE_FRAME_SIZE 640     /* 20 ms of 16 kHz PCM */
+
+typedef struct {
+    int64_t dead_us;
+    int64_t disconnected_us;
+    int64_t restarted_us;
+    uint32_t silent_ms;
+    uint32_t starts;
+} keepalive_events_t;
+
+typedef struct {
+    esp_agent_handle_t handle;
+    int burst;
+    volatile bool stop;
+    volatile bool done;
+    uint32_t frames;
+} keepalive_streamer_t;
+
+static host_test_agent_t g_agent;
+static keepalive_events_t g_events;
+static keepalive_streamer_t g_streamer;
+
+/* Runs in the agent event loop */
+static void keepalive_event_cb(void *arg, esp_agent_event_t event, esp_agent_message_data_t *data)
+{
+    keepalive_events_t *events = (keepalive_events_t *)arg;
+    int64_t now = esp_timer_get_time();
+
+    switch (event) {
+        case ESP_AGENT_EVENT_LINK_HEALTH:
+            if (data && data->link_health.dead && events->dead_us == 0) {
+                events->dead_us = now;
+                events->silent_ms = data->link_health.silent_ms;
+            }
+            break;
+        case ESP_AGENT_EVENT_DISCONNECTED:
+            if (events->dead_us && events->disconnected_us == 0) {
+                events->disconnected_us = now;
+            }
+            break;
+        case ESP_AGENT_EVENT_START:
+            if (++events->starts == 2) {
+                events->restarted_us = now;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/* Queues bursts of frames, so that the send queue is never empty when a ping is due */
+static void streamer_task(void *arg)
+{
+    keepalive_streamer_t *streamer = (keepalive_streamer_t *)arg;
+    uint8_t frame[KEEPALIVE_FRAME_SIZE] = {0};
+
+    while (!streamer->stop) {
+        for (int i = 0; i < streamer->burst && !streamer->stop; i++) {
+            if (esp_agent_send_speech(streamer->handle, frame, sizeof(frame), 0) == ESP_OK) {
+                streamer->frames++;
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(20 * streamer->burst));
+    }
+    streamer->done = true;
+    vTaskDelete(NULL);
+}
+
+esp_err_t host_test_keepalive(const cJSON *args, cJSON *metrics)
+{
+    int burst = host_test_arg_int(args, "burst", 25);
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 30000);
+    ESP_RETURN_ON_FALSE(burst > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid burst");
+
+    esp_err_t ret = ESP_OK;
+    esp_agent_link_health_t health;
+
+    memset(&g_agent, 0, sizeof(g_agent));
+    memset(&g_events, 0, sizeof(g_events));
+    g_agent.cb = keepalive_event_cb;
+    g_agent.cb_arg = &g_events;
+
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&g_agent, "host-test", ESP_AGENT_CONVERSATION_SPEECH), end, TAG, "Failed to create the agent");
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&g_agent, 5000), end, TAG, "Failed to start the agent");
+    ESP_GOTO_ON_ERROR(esp_agent_speech_conversation_start(g_agent.handle), end, TAG, "Failed to start the conversation");
+
+    g_streamer = (keepalive_streamer_t) {
+        .handle = g_agent.handle,
+        .burst = burst,
+    };
+    ESP_GOTO_ON_FALSE(xTaskCreate(streamer_task, "streamer", 4096, &g_streamer, 5, NULL) == pdPASS, ESP_ERR_NO_MEM, end, TAG,
+                      "Failed to create the streamer task");
+
+    /* The server goes silent on the first connection and answers on the next one */
+    bool restarted = host_test_agent_wait(&g_agent, ESP_AGENT_EVENT_START, 2, timeout_ms);
+    g_streamer.stop = true;
+    while (!g_streamer.done) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    esp_agent_get_link_health(g_agent.handle, &health);
+    cJSON_AddNumberToObject(metrics, "uplink_frames", g_streamer.frames);
+    cJSON_AddNumberToObject(metrics, "pings_sent", health.pings_sent);
+    cJSON_AddNumberToObject(metrics, "pongs_received", health.pongs_received);
+    cJSON_AddNumberToObject(metrics, "missed_pongs", health.missed_pongs);
+    cJSON_AddNumberToObject(metrics, "dead_links", health.dead_links);
+    host_test_add_percentiles(metrics, "rtt", &health.rtt);
+    cJSON_AddNumberToObject(metrics, "dead_silent_ms", g_events.silent_ms);
+    cJSON_AddNumberToObject(metrics, "dead_to_disconnected_ms",
+                            g_events.disconnected_us ? (g_events.disconnected_us - g_events.dead_us) / 1000 : -1);
+    cJSON_AddNumberToObject(metrics, "dead_to_restarted_ms",
+                            g_events.restarted_us ? (g_events.restarted_us - g_events.dead_us) / 1000 : -1);
+    cJSON_AddNumberToObject(metrics, "starts", g_events.starts);
+    host_test_add_transport_stats(metrics, g_agent.handle);
+
+    ESP_GOTO_ON_FALSE(g_events.dead_us, ESP_ERR_TIMEOUT, end, TAG, "The dead link was not detected");
+    ESP_GOTO_ON_FALSE(restarted, ESP_ERR_TIMEOUT, end, TAG, "Not started again after the dead link");
+
+end:
+    g_streamer.stop = true;
+    host_test_agent_deinit(&g_agent);
+    return ret;
+}
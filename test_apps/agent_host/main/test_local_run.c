@@ -0,0 +1,85 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Local runs answering the server (scenarios/local_run.json): the application runs a slow tool
+ * on the device twice. The mock server requests the same call while the first run is still in
+ * progress, and after the second one returned. Both requests must be answered with the result
+ * of the local run, without running the tool again.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_local_run";
+
+typedef struct {
+    esp_agent_handle_t handle;
+    int work_ms;
+    volatile uint32_t calls;
+} local_run_state_t;
+
+static local_run_state_t g_state;
+
+/* Tells the server that it runs, so that its request arrives meanwhile */
+static esp_err_t set_level_tool(esp_agent_handle_t handle, const char *tool_name, esp_agent_tool_param_t params[], size_t num_params,
+                                void *user_data, char **result)
+{
+    local_run_state_t *state = (local_run_state_t *)user_data;
+    char text[32];
+
+    state->calls++;
+    snprintf(text, sizeof(text), "running %d", num_params == 1 ? params[0].value.i : -1);
+    esp_agent_send_text(handle, text, pdMS_TO_TICKS(1000));
+    vTaskDelay(pdMS_TO_TICKS(state->work_ms));
+    *result = strdup("level set");
+    return ESP_OK;
+}
+
+esp_err_t host_test_local_run(const cJSON *args, cJSON *metrics)
+{
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 10000);
+
+    esp_err_t ret = ESP_OK;
+    static host_test_agent_t agent;
+    const esp_agent_tool_config_t config = {.name = "set_level", .handler = set_level_tool, .user_data = &g_state};
+    const int levels[] = {30, 60};
+
+    memset(&agent, 0, sizeof(agent));
+    memset(&g_state, 0, sizeof(g_state));
+    g_state.work_ms = host_test_arg_int(args, "work_ms", 1000);
+
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&agent, "host-test", ESP_AGENT_CONVERSATION_TEXT), end, TAG, "Failed to create the agent");
+    ESP_GOTO_ON_ERROR(esp_agent_register_local_tool_with_config(agent.handle, &config), end, TAG, "Failed to register the tool");
+    g_state.handle = agent.handle;
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&agent, 5000), end, TAG, "Failed to start the agent");
+
+    for (size_t i = 0; i < sizeof(levels) / sizeof(levels[0]); i++) {
+        const esp_agent_tool_param_t params[] = {
+            {.name = "level", .type = ESP_AGENT_PARAM_TYPE_INT, .value.i = levels[i]},
+        };
+        ESP_GOTO_ON_ERROR(esp_agent_run_local_tool(agent.handle, "set_level", params, 1), end, TAG, "Local run %d failed", (int)i);
+        ESP_GOTO_ON_ERROR(esp_agent_send_text(agent.handle, "ran", pdMS_TO_TICKS(1000)), end, TAG, "Failed to send");
+    }
+
+    /* The server ends the script with a text, once it received the responses */
+    bool done = host_test_agent_wait(&agent, ESP_AGENT_EVENT_DATA_TYPE_TEXT, 1, timeout_ms);
+    cJSON_AddNumberToObject(metrics, "calls", g_state.calls);
+    ESP_GOTO_ON_FALSE(done, ESP_ERR_TIMEOUT, end, TAG, "The server did not get the tool responses");
+
+end:
+    host_test_agent_deinit(&agent);
+    return ret;
+}
@@ -0,0 +1,94 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Transport buffer accounting (scenarios/mem.json): the device sends texts and audio frames,
+ * and the mock server answers with as many texts and audio frames. Every copy into a transport
+ * buffer must be counted against its buffer, and only one copy in several must be timed.
+ *
+ * The host has a single heap, so the placement options have no effect here: every buffer
+ * reports the default heap, and no allocation falls back or fails.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_mem";
+
+#define MEM_FRAME_SIZE 640     /* 20 ms of 16 kHz PCM */
+
+static const char *g_buffer_names[ESP_AGENT_MEM_MAX] = {
+    [ESP_AGENT_MEM_TX_TEXT] = "tx_text",
+    [ESP_AGENT_MEM_TX_AUDIO] = "tx_audio",
+    [ESP_AGENT_MEM_RX_TEXT] = "rx_text",
+    [ESP_AGENT_MEM_RX_AUDIO] = "rx_audio",
+};
+
+static void add_mem_stats(cJSON *metrics, const esp_agent_mem_stats_t *stats)
+{
+    cJSON_AddBoolToObject(metrics, "queues_external", stats->queues_external);
+    for (int i = 0; i < ESP_AGENT_MEM_MAX; i++) {
+        const esp_agent_mem_buffer_stats_t *buffer = &stats->buffers[i];
+        cJSON *json = cJSON_AddObjectToObject(metrics, g_buffer_names[i]);
+        cJSON_AddNumberToObject(json, "caps", buffer->caps);
+        cJSON_AddNumberToObject(json, "allocations", buffer->allocations);
+        cJSON_AddNumberToObject(json, "fallbacks", buffer->fallbacks);
+        cJSON_AddNumberToObject(json, "failures", buffer->failures);
+        cJSON_AddNumberToObject(json, "copies", buffer->copies);
+        cJSON_AddNumberToObject(json, "copy_bytes", buffer->copy_bytes);
+        cJSON_AddNumberToObject(json, "timed_copy_bytes", buffer->timed_copy_bytes);
+        cJSON_AddNumberToObject(json, "copy_us", buffer->copy_us);
+        cJSON_AddNumberToObject(json, "timed_ratio", buffer->copy_bytes ? (double)buffer->timed_copy_bytes / buffer->copy_bytes : 0);
+    }
+}
+
+esp_err_t host_test_mem(const cJSON *args, cJSON *metrics)
+{
+    int frames = host_test_arg_int(args, "frames", 160);
+    int texts = host_test_arg_int(args, "texts", 20);
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 10000);
+
+    esp_err_t ret = ESP_OK;
+    static host_test_agent_t agent;
+    esp_agent_mem_stats_t stats;
+    uint8_t frame[MEM_FRAME_SIZE] = {0};
+    char text[32];
+
+    memset(&agent, 0, sizeof(agent));
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&agent, "host-test", ESP_AGENT_CONVERSATION_SPEECH), end, TAG, "Failed to create the agent");
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&agent, 5000), end, TAG, "Failed to start the agent");
+    ESP_GOTO_ON_ERROR(esp_agent_speech_conversation_start(agent.handle), end, TAG, "Failed to start the conversation");
+
+    for (int i = 0; i < texts; i++) {
+        snprintf(text, sizeof(text), "text %d", i);
+        ESP_GOTO_ON_ERROR(esp_agent_send_text(agent.handle, text, pdMS_TO_TICKS(1000)), end, TAG, "Failed to send text %d", i);
+    }
+    for (int i = 0; i < frames; i++) {
+        ESP_GOTO_ON_ERROR(esp_agent_send_speech(agent.handle, frame, sizeof(frame), pdMS_TO_TICKS(1000)), end, TAG, "Failed to send frame %d", i);
+    }
+    ESP_GOTO_ON_ERROR(esp_agent_speech_conversation_end(agent.handle), end, TAG, "Failed to end the conversation");
+
+    /* The server ends with one more text, after its audio frames */
+    bool received = host_test_agent_wait(&agent, ESP_AGENT_EVENT_DATA_TYPE_TEXT, texts + 1, timeout_ms) &&
+                    host_test_agent_wait(&agent, ESP_AGENT_EVENT_DATA_TYPE_SPEECH, frames, timeout_ms);
+    ESP_GOTO_ON_ERROR(esp_agent_get_mem_stats(agent.handle, &stats), end, TAG, "Failed to get the memory stats");
+    cJSON_AddNumberToObject(metrics, "rx_texts", host_test_agent_count(&agent, ESP_AGENT_EVENT_DATA_TYPE_TEXT));
+    cJSON_AddNumberToObject(metrics, "rx_frames", host_test_agent_count(&agent, ESP_AGENT_EVENT_DATA_TYPE_SPEECH));
+    add_mem_stats(metrics, &stats);
+    ESP_GOTO_ON_FALSE(received, ESP_ERR_TIMEOUT, end, TAG, "The server answers were not received");
+
+end:
+    host_test_agent_deinit(&agent);
+    return ret;
+}
@@ -0,0 +1,176 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Two agents on one device (scenarios/multi_agent.json): a text agent ("fast") answering
+ * every message, and a speech agent ("assistant") streaming audio both ways. The mock
+ * server runs a separate script for each agent ID.
+ *
+ * Reports the heap used by each agent, the round trip of the text agent alone and while
+ * the speech agent streams, and the events each agent received, which must only be its own.
+ */
+
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sdkconfig.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_multi_agent";
+
+#define MULTI_AGENT_MAX_ROUND_TRIPS 256
+#define MULTI_AGENT_FRAME_SIZE      640     /* 20 ms of 16 kHz PCM */
+
+typedef struct {
+    esp_agent_handle_t handle;
+    volatile bool stop;
+    volatile bool done;
+    uint32_t frames;
+    uint32_t failures;
+} multi_agent_streamer_t;
+
+static host_test_agent_t g_fast;
+static host_test_agent_t g_assistant;
+static multi_agent_streamer_t g_streamer;
+static uint32_t g_round_trip_us[MULTI_AGENT_MAX_ROUND_TRIPS];
+
+/* Heap in use, glibc counts every allocation of the process */
+static size_t heap_used(void)
+{
+    return mallinfo2().uordblks;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void streamer_task(void *arg)
+{
+    multi_agent_streamer_t *streamer = (multi_agent_streamer_t *)arg;
+    uint8_t frame[MULTI_AGENT_FRAME_SIZE] = {0};
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (!streamer->stop) {
+        if (esp_agent_send_speech(streamer->handle, frame, sizeof(frame), pdMS_TO_TICKS(100)) == ESP_OK) {
+            streamer->frames++;
+        } else {
+            streamer->failures++;
+        }
+        xTaskDelayUntil(&last_wake, pdMS_TO_TICKS(20));
+    }
+    streamer->done = true;
+    vTaskDelete(NULL);
+}
+
+/* Sends `count` messages one after the other and adds the time to the reply of each to `name` */
+static esp_err_t round_trips(int count, int timeout_ms, cJSON *metrics, const char *name)
+{
+    int done = 0;
+
+    for (int i = 0; i < count; i++) {
+        uint32_t replies = host_test_agent_count(&g_fast, ESP_AGENT_EVENT_DATA_TYPE_TEXT);
+        int64_t start_us = esp_timer_get_time();
+        if (esp_agent_send_text(g_fast.handle, "ping", pdMS_TO_TICKS(1000)) != ESP_OK ||
+                !host_test_agent_wait(&g_fast, ESP_AGENT_EVENT_DATA_TYPE_TEXT, replies + 1, timeout_ms)) {
+            break;
+        }
+        g_round_trip_us[done++] = (uint32_t)(esp_timer_get_time() - start_us);
+    }
+
+    cJSON *json = cJSON_AddObjectToObject(metrics, name);
+    cJSON_AddNumberToObject(json, "samples", done);
+    if (done) {
+        qsort(g_round_trip_us, done, sizeof(uint32_t), compare_u32);
+        cJSON_AddNumberToObject(json, "p50_us", g_round_trip_us[done / 2]);
+        cJSON_AddNumberToObject(json, "p90_us", g_round_trip_us[done * 9 / 10]);
+        cJSON_AddNumberToObject(json, "max_us", g_round_trip_us[done - 1]);
+    }
+    ESP_RETURN_ON_FALSE(done == count, ESP_ERR_TIMEOUT, TAG, "%s: %d of %d round trips", name, done, count);
+    return ESP_OK;
+}
+
+static void add_agent_events(cJSON *metrics, const char *name, host_test_agent_t *agent)
+{
+    cJSON *json = cJSON_AddObjectToObject(metrics, name);
+    cJSON_AddNumberToObject(json, "text", host_test_agent_count(agent, ESP_AGENT_EVENT_DATA_TYPE_TEXT));
+    cJSON_AddNumberToObject(json, "speech", host_test_agent_count(agent, ESP_AGENT_EVENT_DATA_TYPE_SPEECH));
+    cJSON_AddNumberToObject(json, "speech_bytes", agent->speech_bytes);
+    host_test_add_transport_stats(json, agent->handle);
+}
+
+esp_err_t host_test_multi_agent(const cJSON *args, cJSON *metrics)
+{
+    int count = host_test_arg_int(args, "round_trips", 50);
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 5000);
+    ESP_RETURN_ON_FALSE(count > 0 && count <= MULTI_AGENT_MAX_ROUND_TRIPS, ESP_ERR_INVALID_ARG, TAG, "Invalid round_trips");
+
+    esp_err_t ret = ESP_OK;
+    memset(&g_fast, 0, sizeof(g_fast));
+    memset(&g_assistant, 0, sizeof(g_assistant));
+
+    size_t used = heap_used();
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&g_fast, "fast", ESP_AGENT_CONVERSATION_TEXT), end, TAG, "Failed to create the text agent");
+    cJSON_AddNumberToObject(metrics, "fast_heap_bytes", (double)heap_used() - used);
+    used = heap_used();
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&g_assistant, "assistant", ESP_AGENT_CONVERSATION_SPEECH), end, TAG, "Failed to create the speech agent");
+    cJSON_AddNumberToObject(metrics, "assistant_heap_bytes", (double)heap_used() - used);
+
+    /* The text agent alone */
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&g_fast, 5000), end, TAG, "Failed to start the text agent");
+    ESP_GOTO_ON_ERROR(round_trips(count, timeout_ms, metrics, "alone"), end, TAG, "Round trips alone failed");
+
+    /* The text agent while the speech agent streams both ways */
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&g_assistant, 5000), end, TAG, "Failed to start the speech agent");
+    ESP_GOTO_ON_ERROR(esp_agent_speech_conversation_start(g_assistant.handle), end, TAG, "Failed to start the conversation");
+    g_streamer = (multi_agent_streamer_t) {
+        .handle = g_assistant.handle,
+    };
+    ESP_GOTO_ON_FALSE(xTaskCreate(streamer_task, "streamer", 4096, &g_streamer, 5, NULL) == pdPASS, ESP_ERR_NO_MEM, end, TAG,
+                      "Failed to create the streamer task");
+    /* Wait for the downlink, so that the round trips overlap it */
+    host_test_agent_wait(&g_assistant, ESP_AGENT_EVENT_DATA_TYPE_SPEECH, 1, timeout_ms);
+    ret = round_trips(count, timeout_ms, metrics, "with_speech");
+    g_streamer.stop = true;
+    while (!g_streamer.done) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    esp_agent_speech_conversation_end(g_assistant.handle);
+    ESP_GOTO_ON_ERROR(ret, end, TAG, "Round trips with speech failed");
+
+    cJSON *alone = cJSON_GetObjectItem(metrics, "alone");
+    cJSON *with_speech = cJSON_GetObjectItem(metrics, "with_speech");
+    double alone_p50 = cJSON_GetNumberValue(cJSON_GetObjectItem(alone, "p50_us"));
+    cJSON_AddNumberToObject(metrics, "round_trip_p50_ratio",
+                            alone_p50 > 0 ? cJSON_GetNumberValue(cJSON_GetObjectItem(with_speech, "p50_us")) / alone_p50 : 0);
+
+end:
+    cJSON_AddNumberToObject(metrics, "uplink_frames", g_streamer.frames);
+    cJSON_AddNumberToObject(metrics, "uplink_failures", g_streamer.failures);
+    if (g_fast.handle) {
+        add_agent_events(metrics, "fast", &g_fast);
+    }
+    if (g_assistant.handle) {
+        add_agent_events(metrics, "assistant", &g_assistant);
+    }
+
+    /* Whatever one agent left behind shows up as leaked by the deinit */
+    used = heap_used();
+    host_test_agent_deinit(&g_assistant);
+    host_test_agent_deinit(&g_fast);
+    cJSON_AddNumberToObject(metrics, "heap_freed_bytes", (double)used - heap_used());
+    return ret;
+}
@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Message sequencing (scenarios/resume.json): the mock server delays the handshake ack, and
+ * the device sends text as soon as it is connected. That text must be held until the ack and
+ * sent sequenced, not without a sequence number. The server then sends messages whose sequence
+ * number or ack is negative, fractional or out of range, which must be processed as unsequenced
+ * and leave the sequence state alone, then a valid one, which must not be taken for a duplicate.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_resume";
+
+static void add_resume_stats(cJSON *metrics, const char *name, const esp_agent_resume_stats_t *stats)
+{
+    cJSON *json = cJSON_AddObjectToObject(metrics, name);
+    cJSON_AddBoolToObject(json, "negotiated", stats->negotiated);
+    cJSON_AddNumberToObject(json, "tx_seq", stats->tx_seq);
+    cJSON_AddNumberToObject(json, "rx_seq", stats->rx_seq);
+    cJSON_AddNumberToObject(json, "unacked", stats->unacked);
+    cJSON_AddNumberToObject(json, "duplicates", stats->duplicates);
+    cJSON_AddNumberToObject(json, "gaps", stats->gaps);
+}
+
+esp_err_t host_test_resume(const cJSON *args, cJSON *metrics)
+{
+    int count = host_test_arg_int(args, "count", 6);
+    int invalid = host_test_arg_int(args, "invalid", 3);
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 5000);
+
+    esp_err_t ret = ESP_OK;
+    static host_test_agent_t agent;
+    esp_agent_resume_stats_t stats;
+    char text[32];
+
+    memset(&agent, 0, sizeof(agent));
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&agent, "host-test", ESP_AGENT_CONVERSATION_TEXT), end, TAG, "Failed to create the agent");
+    ESP_GOTO_ON_ERROR(esp_agent_start(agent.handle, NULL), end, TAG, "Failed to start the agent");
+
+    /* Connected, the handshake ack is still on its way */
+    ESP_GOTO_ON_FALSE(host_test_agent_wait(&agent, ESP_AGENT_EVENT_CONNECTED, 1, timeout_ms), ESP_ERR_TIMEOUT, end, TAG, "Not connected");
+    for (int i = 0; i < count; i++) {
+        snprintf(text, sizeof(text), "early %d", i);
+        ESP_GOTO_ON_ERROR(esp_agent_send_text(agent.handle, text, pdMS_TO_TICKS(1000)), end, TAG, "Failed to send %d", i);
+    }
+    cJSON_AddBoolToObject(metrics, "sent_before_ack", host_test_agent_count(&agent, ESP_AGENT_EVENT_START) == 0);
+    ESP_GOTO_ON_FALSE(host_test_agent_wait(&agent, ESP_AGENT_EVENT_START, 1, timeout_ms), ESP_ERR_TIMEOUT, end, TAG, "No handshake ack");
+
+    /* The server pauses after the invalid messages, so the state seen here is theirs */
+    bool received = host_test_agent_wait(&agent, ESP_AGENT_EVENT_DATA_TYPE_TEXT, invalid, timeout_ms);
+    esp_agent_get_resume_stats(agent.handle, &stats);
+    add_resume_stats(metrics, "after_invalid", &stats);
+    ESP_GOTO_ON_FALSE(received, ESP_ERR_TIMEOUT, end, TAG, "The messages with invalid sequence numbers were not processed");
+
+    received = host_test_agent_wait(&agent, ESP_AGENT_EVENT_DATA_TYPE_TEXT, invalid + 1, timeout_ms);
+    esp_agent_get_resume_stats(agent.handle, &stats);
+    add_resume_stats(metrics, "after_valid", &stats);
+    ESP_GOTO_ON_FALSE(received, ESP_ERR_TIMEOUT, end, TAG, "The valid message was not processed");
+
+end:
+    host_test_agent_deinit(&agent);
+    return ret;
+}
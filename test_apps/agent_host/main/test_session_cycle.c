@@ -0,0 +1,83 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Session cycles (scenarios/session_cycle.json): the agent is started, exchanges a text with
+ * the mock server and is stopped `cycles` times. The tasks, queues and websocket client are
+ * created once by esp_agent_init, so a cycle must neither create tasks nor leak memory, and
+ * its time must stay flat from the first cycle to the last.
+ *
+ * Reports the time of a whole cycle and of esp_agent_start and esp_agent_stop, the heap lost
+ * between the first and the last stop, and the tasks left over.
+ */
+
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_session_cycle";
+
+esp_err_t host_test_session_cycle(const cJSON *args, cJSON *metrics)
+{
+    int cycles = host_test_arg_int(args, "cycles", 1000);
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 5000);
+
+    esp_err_t ret = ESP_OK;
+    static host_test_agent_t agent;
+    esp_agent_connection_stats_t stats;
+    int cycle = 0;
+    int64_t cycle_max_us = 0;
+    int64_t first_cycles_us = 0;
+    int64_t last_cycles_us = 0;
+    int window = cycles >= 20 ? 10 : 1;
+
+    memset(&agent, 0, sizeof(agent));
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&agent, "host-test", ESP_AGENT_CONVERSATION_TEXT), end, TAG, "Failed to create the agent");
+    UBaseType_t tasks = uxTaskGetNumberOfTasks();
+
+    int64_t start_us = esp_timer_get_time();
+    for (cycle = 0; cycle < cycles; cycle++) {
+        int64_t cycle_start_us = esp_timer_get_time();
+        ESP_GOTO_ON_ERROR(host_test_agent_start(&agent, timeout_ms), end, TAG, "Failed to start, cycle %d", cycle);
+        ESP_GOTO_ON_ERROR(esp_agent_send_text(agent.handle, "ping", pdMS_TO_TICKS(timeout_ms)), end, TAG, "Failed to send, cycle %d", cycle);
+        ESP_GOTO_ON_FALSE(host_test_agent_wait(&agent, ESP_AGENT_EVENT_DATA_TYPE_TEXT, cycle + 1, timeout_ms), ESP_ERR_TIMEOUT, end, TAG,
+                          "No answer, cycle %d", cycle);
+        ESP_GOTO_ON_ERROR(esp_agent_stop(agent.handle), end, TAG, "Failed to stop, cycle %d", cycle);
+
+        int64_t cycle_us = esp_timer_get_time() - cycle_start_us;
+        cycle_max_us = cycle_us > cycle_max_us ? cycle_us : cycle_max_us;
+        if (cycle < window) {
+            first_cycles_us += cycle_us;
+        }
+        if (cycle >= cycles - window) {
+            last_cycles_us += cycle_us;
+        }
+    }
+    cJSON_AddNumberToObject(metrics, "total_ms", (esp_timer_get_time() - start_us) / 1000);
+    cJSON_AddNumberToObject(metrics, "cycle_first_avg_ms", (double)first_cycles_us / window / 1000);
+    cJSON_AddNumberToObject(metrics, "cycle_last_avg_ms", (double)last_cycles_us / window / 1000);
+    cJSON_AddNumberToObject(metrics, "cycle_max_ms", cycle_max_us / 1000);
+    cJSON_AddNumberToObject(metrics, "tasks_added", (double)uxTaskGetNumberOfTasks() - tasks);
+
+end:
+    cJSON_AddNumberToObject(metrics, "cycles", cycle);
+    if (agent.handle && esp_agent_get_connection_stats(agent.handle, &stats) == ESP_OK) {
+        cJSON_AddNumberToObject(metrics, "stops", stats.stops);
+        host_test_add_queue_latency(metrics, "start_call", &stats.start_call);
+        host_test_add_queue_latency(metrics, "stop_call", &stats.stop_call);
+        /* The first stop is the baseline: what the first session allocated for good is not a leak */
+        cJSON_AddNumberToObject(metrics, "heap_lost_bytes", (double)stats.heap_free_first - stats.heap_free_last);
+    }
+    host_test_agent_deinit(&agent);
+    return ret;
+}
@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Stop with a full send queue (scenarios/stop_purge.json): the mock server reads slowly, so
+ * that audio frames pile up in the send queue and are aggregated, and the agent is stopped
+ * and started again `cycles` times while a task keeps queueing frames. The queue is emptied
+ * on every stop while the send task is taking frames from it for the next message.
+ *
+ * Reports the longest stop, and the frames queued, sent (aggregated in fewer messages) and
+ * dropped with the queue.
+ */
+
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_stop_purge";
+
+#define STOP_PURGE_FRAME_SIZE 640     /* 20 ms of 16 kHz PCM */
+
+typedef struct {
+    esp_agent_handle_t handle;
+    volatile bool stop;
+    volatile bool done;
+    uint32_t queued;
+} stop_purge_streamer_t;
+
+static stop_purge_streamer_t g_streamer;
+
+/* Queues frames faster than the server reads them, whether the agent is started or not */
+static void streamer_task(void *arg)
+{
+    stop_purge_streamer_t *streamer = (stop_purge_streamer_t *)arg;
+    uint8_t frame[STOP_PURGE_FRAME_SIZE] = {0};
+
+    while (!streamer->stop) {
+        if (esp_agent_send_speech(streamer->handle, frame, sizeof(frame), 0) == ESP_OK) {
+            streamer->queued++;
+        }
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    streamer->done = true;
+    vTaskDelete(NULL);
+}
+
+esp_err_t host_test_stop_purge(const cJSON *args, cJSON *metrics)
+{
+    int cycles = host_test_arg_int(args, "cycles", 10);
+    int stream_ms = host_test_arg_int(args, "stream_ms", 500);
+
+    esp_err_t ret = ESP_OK;
+    static host_test_agent_t agent;
+    esp_agent_connection_stats_t connection;
+    esp_agent_transport_stats_t transport;
+    int cycle = 0;
+    bool streaming = false;
+
+    memset(&agent, 0, sizeof(agent));
+    memset(&g_streamer, 0, sizeof(g_streamer));
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&agent, "host-test", ESP_AGENT_CONVERSATION_SPEECH), end, TAG, "Failed to create the agent");
+
+    g_streamer.handle = agent.handle;
+    ESP_GOTO_ON_FALSE(xTaskCreate(streamer_task, "streamer", 4096, &g_streamer, 5, NULL) == pdPASS, ESP_ERR_NO_MEM, end, TAG,
+                      "Failed to create the streamer task");
+    streaming = true;
+
+    for (cycle = 0; cycle < cycles; cycle++) {
+        ESP_GOTO_ON_ERROR(host_test_agent_start(&agent, 5000), end, TAG, "Failed to start, cycle %d", cycle);
+        ESP_GOTO_ON_ERROR(esp_agent_speech_conversation_start(agent.handle), end, TAG, "Failed to start the conversation");
+        vTaskDelay(pdMS_TO_TICKS(stream_ms));
+        ESP_GOTO_ON_ERROR(esp_agent_stop(agent.handle), end, TAG, "Failed to stop, cycle %d", cycle);
+    }
+
+end:
+    g_streamer.stop = true;
+    while (streaming && !g_streamer.done) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    cJSON_AddNumberToObject(metrics, "cycles", cycle);
+    cJSON_AddNumberToObject(metrics, "frames_queued", g_streamer.queued);
+    if (agent.handle && esp_agent_get_connection_stats(agent.handle, &connection) == ESP_OK) {
+        cJSON_AddNumberToObject(metrics, "stops", connection.stops);
+        cJSON_AddNumberToObject(metrics, "stop_call_max_ms", connection.stop_call.max_us / 1000);
+    }
+    if (agent.handle && esp_agent_get_transport_stats(agent.handle, &transport) == ESP_OK) {
+        cJSON_AddNumberToObject(metrics, "frames_sent", transport.audio_uplink.frames);
+        cJSON_AddNumberToObject(metrics, "aggregated", transport.audio_uplink.frames - transport.audio_uplink.messages);
+        cJSON_AddNumberToObject(metrics, "tx_dropped", transport.tx_dropped);
+    }
+    host_test_agent_deinit(&agent);
+    return ret;
+}
@@ -0,0 +1,155 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * The task-stats table of agent_console, from synthetic snapshots: CPU share and order,
+ * tasks missing from the start snapshot, run time counter wrap-around, several cores,
+ * core affinity and truncation to the output buffer.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <esp_log.h>
+
+#include <agent_console_task_stats.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_task_stats";
+
+#define TASK_A ((TaskHandle_t)0x1000)
+#define TASK_B ((TaskHandle_t)0x2000)
+#define TASK_C ((TaskHandle_t)0x3000)
+
+static int g_checks;
+static int g_failures;
+
+static void check(bool ok, const char *what, const char *output)
+{
+    g_checks++;
+    if (!ok) {
+        g_failures++;
+        ESP_LOGE(TAG, "%s, got:\n%s", what, output);
+    }
+}
+
+/* The row of a task, NULL if it is not in the table */
+static const char *find_row(const char *output, const char *name)
+{
+    char prefix[24];
+    snprintf(prefix, sizeof(prefix), "\n%-16s ", name);
+    const char *row = strstr(output, prefix);
+    return row ? row + 1 : NULL;
+}
+
+static bool row_has(const char *output, const char *name, const char *cpu, const char *core)
+{
+    const char *row = find_row(output, name);
+    if (row == NULL) {
+        return false;
+    }
+    char expected[64];
+    snprintf(expected, sizeof(expected), "%-16.16s %6s", name, cpu);
+    if (strncmp(row, expected, strlen(expected)) != 0) {
+        return false;
+    }
+    const char *end = strchr(row, '\n');
+    snprintf(expected, sizeof(expected), " %5s ", core);
+    const char *found = strstr(row, expected);
+    return found && found < end;
+}
+
+static void set_entry(task_stats_entry_t *entry, TaskHandle_t handle, const char *name, uint32_t run_time, BaseType_t core_id)
+{
+    memset(entry, 0, sizeof(task_stats_entry_t));
+    entry->handle = handle;
+    snprintf(entry->name, sizeof(entry->name), "%s", name);
+    entry->run_time = run_time;
+    entry->stack_hwm = 1024;
+    entry->priority = 5;
+    entry->core_id = core_id;
+}
+
+static void test_cpu_share(void)
+{
+    char output[512];
+    task_stats_entry_t start_entries[2];
+    task_stats_entry_t end_entries[3];
+    task_stats_snapshot_t start = {.entries = start_entries, .count = 2, .capacity = 2, .total_run_time = 1000000};
+    task_stats_snapshot_t end = {.entries = end_entries, .count = 3, .capacity = 3, .total_run_time = 2000000};
+
+    set_entry(&start_entries[0], TASK_A, "low", 100000, 0);
+    set_entry(&start_entries[1], TASK_B, "high", 200000, 1);
+    set_entry(&end_entries[0], TASK_A, "low", 350000, 0);
+    set_entry(&end_entries[1], TASK_B, "high", 700000, 1);
+    set_entry(&end_entries[2], TASK_C, "new", 5000, tskNO_AFFINITY);
+
+    task_stats_format(&start, &end, 1, output, sizeof(output));
+    check(row_has(output, "high", "50.0", "any"), "Core 1 of a single core system is reported as any", output);
+    check(row_has(output, "low", "25.0", "0"), "CPU share of a task", output);
+    check(row_has(output, "new", "-", "any"), "A task missing from the start snapshot has no CPU share", output);
+    check(find_row(output, "high") < find_row(output, "low") && find_row(output, "low") < find_row(output, "new"),
+          "Tasks are sorted by CPU share", output);
+    check(strstr(output, "Window: 1000 ms, 3 tasks\n") != NULL, "Window and number of tasks", output);
+
+    task_stats_format(&start, &end, 2, output, sizeof(output));
+    check(row_has(output, "high", "25.0", "1") && row_has(output, "low", "12.5", "0"),
+          "The CPU share is spread over the cores", output);
+
+    task_stats_format(NULL, &end, 1, output, sizeof(output));
+    check(row_has(output, "high", "-", "any") && strstr(output, "Window: 0 ms") != NULL,
+          "No CPU share without a start snapshot", output);
+}
+
+static void test_wrap_around(void)
+{
+    char output[256];
+    task_stats_entry_t start_entry;
+    task_stats_entry_t end_entry;
+    task_stats_snapshot_t start = {.entries = &start_entry, .count = 1, .capacity = 1, .total_run_time = UINT32_MAX - 99999};
+    task_stats_snapshot_t end = {.entries = &end_entry, .count = 1, .capacity = 1, .total_run_time = 100000};
+
+    /* 200 ms window across the wrap of the total, 100 ms across the wrap of the task */
+    set_entry(&start_entry, TASK_A, "wrap", UINT32_MAX - 49999, 0);
+    set_entry(&end_entry, TASK_A, "wrap", 50000, 0);
+
+    task_stats_format(&start, &end, 1, output, sizeof(output));
+    check(row_has(output, "wrap", "50.0", "0"), "CPU share across the counter wrap-around", output);
+    check(strstr(output, "Window: 200 ms") != NULL, "Window across the counter wrap-around", output);
+}
+
+static void test_truncation(void)
+{
+    char output[40];
+    task_stats_entry_t entries[4];
+    task_stats_snapshot_t end = {.entries = entries, .count = 4, .capacity = 4, .total_run_time = 1000};
+
+    for (int i = 0; i < 4; i++) {
+        set_entry(&entries[i], (TaskHandle_t)(uintptr_t)(0x1000 * (i + 1)), "task", 0, 0);
+    }
+    memset(output, 'x', sizeof(output));
+
+    size_t len = task_stats_format(NULL, &end, 1, output, sizeof(output));
+    check(len == sizeof(output) - 1 && output[len] == '\0', "Output is truncated to the buffer", output);
+
+    check(task_stats_format(NULL, &end, 1, output, 0) == 0, "Empty buffer", "");
+    check(task_stats_format(NULL, NULL, 1, output, sizeof(output)) == 0, "No end snapshot", "");
+}
+
+esp_err_t host_test_task_stats(const cJSON *args, cJSON *metrics)
+{
+    g_checks = 0;
+    g_failures = 0;
+
+    test_cpu_share();
+    test_wrap_around();
+    test_truncation();
+
+    cJSON_AddNumberToObject(metrics, "checks", g_checks);
+    cJSON_AddNumberToObject(metrics, "failures", g_failures);
+    return g_failures ? ESP_FAIL : ESP_OK;
+}
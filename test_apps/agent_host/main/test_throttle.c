@@ -0,0 +1,86 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Write deadline (scenarios/throttle.json): the mock server reads slowly, and the device
+ * queues large text messages, sent in fragments, which take longer in total than
+ * CONFIG_ESP_AGENT_WRITE_DEADLINE_MS. As every fragment makes progress, no write may expire.
+ * The server then stops reading: the first write without progress must expire within the
+ * deadline and drop the connection, rather than every queued message waiting a deadline of
+ * its own.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <sdkconfig.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_throttle";
+
+static int queue_messages(esp_agent_handle_t handle, const char *text, int count, TickType_t timeout)
+{
+    int queued = 0;
+    for (int i = 0; i < count; i++) {
+        if (esp_agent_send_text(handle, text, timeout) == ESP_OK) {
+            queued++;
+        }
+    }
+    return queued;
+}
+
+esp_err_t host_test_throttle(const cJSON *args, cJSON *metrics)
+{
+    int size = host_test_arg_int(args, "size", 6000);
+    int count = host_test_arg_int(args, "count", 6);
+    int stall_count = host_test_arg_int(args, "stall_count", 30);
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 60000);
+    ESP_RETURN_ON_FALSE(size > CONFIG_ESP_AGENT_SEND_FRAGMENT_SIZE, ESP_ERR_INVALID_ARG, TAG, "Messages of %d bytes are not fragmented", size);
+
+    esp_err_t ret = ESP_OK;
+    static host_test_agent_t agent;
+    esp_agent_transport_stats_t stats;
+    char *text = malloc(size + 1);
+    ESP_RETURN_ON_FALSE(text, ESP_ERR_NO_MEM, TAG, "No memory");
+    memset(text, 'x', size);
+    text[size] = '\0';
+
+    memset(&agent, 0, sizeof(agent));
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&agent, "host-test", ESP_AGENT_CONVERSATION_TEXT), end, TAG, "Failed to create the agent");
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&agent, 5000), end, TAG, "Failed to start the agent");
+
+    /* Slow, but every fragment goes through: the server answers once it read them all */
+    int64_t start_us = esp_timer_get_time();
+    cJSON_AddNumberToObject(metrics, "slow_queued", queue_messages(agent.handle, text, count, portMAX_DELAY));
+    bool read = host_test_agent_wait(&agent, ESP_AGENT_EVENT_DATA_TYPE_TEXT, 1, timeout_ms);
+    esp_agent_get_transport_stats(agent.handle, &stats);
+    cJSON_AddNumberToObject(metrics, "slow_ms", (esp_timer_get_time() - start_us) / 1000);
+    cJSON_AddNumberToObject(metrics, "slow_stalls", stats.send_path.stalls);
+    cJSON_AddNumberToObject(metrics, "slow_deadline_expired", stats.send_path.deadline_expired);
+    ESP_GOTO_ON_FALSE(read, ESP_ERR_TIMEOUT, end, TAG, "The slow messages were not read");
+
+    /* The server no longer reads: one deadline, not one per queued message */
+    start_us = esp_timer_get_time();
+    cJSON_AddNumberToObject(metrics, "stalled_queued", queue_messages(agent.handle, text, stall_count, 0));
+    bool dropped = host_test_agent_wait(&agent, ESP_AGENT_EVENT_DISCONNECTED, 1, timeout_ms);
+    esp_agent_get_transport_stats(agent.handle, &stats);
+    cJSON_AddNumberToObject(metrics, "stalled_to_disconnected_ms", dropped ? (esp_timer_get_time() - start_us) / 1000 : -1);
+    cJSON_AddNumberToObject(metrics, "deadline_expired", stats.send_path.deadline_expired);
+    cJSON_AddNumberToObject(metrics, "deadline_ms", CONFIG_ESP_AGENT_WRITE_DEADLINE_MS);
+    ESP_GOTO_ON_FALSE(dropped, ESP_ERR_TIMEOUT, end, TAG, "The stalled connection was not dropped");
+
+end:
+    host_test_agent_deinit(&agent);
+    free(text);
+    return ret;
+}
@@ -0,0 +1,139 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Transport throughput: the device sends `count` messages of `size` bytes (text or audio,
+ * by conversation type) every `interval_ms`, then the mock server sends `rx_count`
+ * messages and `tool_count` tool requests for the bench_echo tool (scenarios/throughput_*.json).
+ *
+ * Reports the send and receive rates next to the transport statistics of the agent, which
+ * include the bytes copied and heap allocations per message and the queue latencies.
+ * The fragment size of the uplink is CONFIG_ESP_AGENT_SEND_FRAGMENT_SIZE of the build.
+ */
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sdkconfig.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_throughput";
+
+#define BENCH_TOOL_NAME "bench_echo"
+
+static atomic_uint g_tool_calls;
+
+static esp_err_t bench_echo_handler(esp_agent_handle_t handle, const char *tool_name, esp_agent_tool_param_t params[],
+                                    size_t num_params, void *user_data, char **result)
+{
+    atomic_fetch_add(&g_tool_calls, 1);
+    *result = strdup("ok");
+    return *result ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+static uint32_t tx_tool_messages(esp_agent_handle_t handle)
+{
+    esp_agent_transport_stats_t stats;
+    if (esp_agent_get_transport_stats(handle, &stats) != ESP_OK) {
+        return 0;
+    }
+    return stats.messages[ESP_AGENT_TRANSPORT_COUNTER_TX_TOOL];
+}
+
+esp_err_t host_test_throughput(const cJSON *args, cJSON *metrics)
+{
+    bool speech = strcmp(host_test_arg_str(args, "type", "text"), "speech") == 0;
+    int count = host_test_arg_int(args, "count", 200);
+    int size = host_test_arg_int(args, "size", 256);
+    int interval_ms = host_test_arg_int(args, "interval_ms", 0);
+    int rx_count = host_test_arg_int(args, "rx_count", 200);
+    int tool_count = host_test_arg_int(args, "tool_count", 0);
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 20000);
+    ESP_RETURN_ON_FALSE(count >= 0 && size > 0 && rx_count >= 0 && tool_count >= 0, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    esp_err_t ret = ESP_OK;
+    static host_test_agent_t agent;
+    esp_agent_event_t rx_event = speech ? ESP_AGENT_EVENT_DATA_TYPE_SPEECH : ESP_AGENT_EVENT_DATA_TYPE_TEXT;
+    uint32_t tx_failures = 0;
+
+    /* Text is sent as a string, audio as raw frames */
+    char *payload = malloc(size + 1);
+    ESP_RETURN_ON_FALSE(payload, ESP_ERR_NO_MEM, TAG, "Failed to allocate the payload");
+    memset(payload, 'a', size);
+    payload[size] = '\0';
+
+    atomic_store(&g_tool_calls, 0);
+    memset(&agent, 0, sizeof(agent));
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&agent, "host-test", speech ? ESP_AGENT_CONVERSATION_SPEECH : ESP_AGENT_CONVERSATION_TEXT),
+                      end, TAG, "Failed to create the agent");
+    esp_agent_tool_config_t tool_config = {
+        .name = BENCH_TOOL_NAME,
+        .handler = bench_echo_handler,
+        .exec_mode = ESP_AGENT_TOOL_EXEC_INLINE,
+    };
+    ESP_GOTO_ON_ERROR(esp_agent_register_local_tool_with_config(agent.handle, &tool_config), end, TAG, "Failed to register the tool");
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&agent, 5000), end, TAG, "Failed to start the agent");
+    esp_agent_reset_transport_stats(agent.handle);
+
+    if (speech) {
+        ESP_GOTO_ON_ERROR(esp_agent_speech_conversation_start(agent.handle), end, TAG, "Failed to start the conversation");
+    }
+
+    int64_t tx_start_us = esp_timer_get_time();
+    for (int i = 0; i < count; i++) {
+        esp_err_t err = speech ? esp_agent_send_speech(agent.handle, (const uint8_t *)payload, size, pdMS_TO_TICKS(1000)) :
+                        esp_agent_send_text(agent.handle, payload, pdMS_TO_TICKS(1000));
+        if (err != ESP_OK) {
+            tx_failures++;
+        }
+        if (interval_ms) {
+            vTaskDelay(pdMS_TO_TICKS(interval_ms));
+        }
+    }
+    int64_t tx_us = esp_timer_get_time() - tx_start_us;
+    if (speech) {
+        /* Tells the server that the uplink is complete */
+        esp_agent_speech_conversation_end(agent.handle);
+    }
+
+    bool received = host_test_agent_wait(&agent, rx_event, rx_count, timeout_ms);
+    int64_t deadline_us = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+    while (tx_tool_messages(agent.handle) < (uint32_t)tool_count && esp_timer_get_time() < deadline_us) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    xSemaphoreTake(agent.lock, portMAX_DELAY);
+    uint32_t rx_messages = agent.counts[rx_event];
+    int64_t rx_us = agent.last_us[rx_event] - agent.first_us[rx_event];
+    xSemaphoreGive(agent.lock);
+
+    cJSON_AddStringToObject(metrics, "type", speech ? "speech" : "text");
+    cJSON_AddNumberToObject(metrics, "size", size);
+    cJSON_AddNumberToObject(metrics, "fragment_size", CONFIG_ESP_AGENT_SEND_FRAGMENT_SIZE);
+    cJSON_AddNumberToObject(metrics, "tx_messages", count - tx_failures);
+    cJSON_AddNumberToObject(metrics, "tx_failures", tx_failures);
+    cJSON_AddNumberToObject(metrics, "tx_messages_per_s", tx_us > 0 ? (count - tx_failures) * 1e6 / tx_us : 0);
+    cJSON_AddNumberToObject(metrics, "rx_messages", rx_messages);
+    cJSON_AddNumberToObject(metrics, "rx_messages_per_s", rx_us > 0 && rx_messages > 1 ? (rx_messages - 1) * 1e6 / rx_us : 0);
+    cJSON_AddNumberToObject(metrics, "tool_calls", atomic_load(&g_tool_calls));
+    cJSON_AddNumberToObject(metrics, "tool_responses", tx_tool_messages(agent.handle));
+    host_test_add_transport_stats(metrics, agent.handle);
+
+    ESP_GOTO_ON_FALSE(received, ESP_ERR_TIMEOUT, end, TAG, "Received %lu of %d messages", (unsigned long)rx_messages, rx_count);
+
+end:
+    host_test_agent_deinit(&agent);
+    free(payload);
+    return ret;
+}
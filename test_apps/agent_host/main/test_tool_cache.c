@@ -0,0 +1,80 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Tool result cache (scenarios/tool_cache.json): the mock server requests a read-only tool,
+ * one request at a time. A request with the parameters of an earlier call is answered from
+ * the cache; other parameters run the tool. The call with id 3 invalidates the cache while it
+ * runs, as a change of the state the tool reads would: its own result must not be cached,
+ * since it may be stale already, and the results cached before are dropped.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_tool_cache";
+
+#define TOOL_CACHE_INVALIDATING_ID 3
+
+static volatile uint32_t g_calls;
+
+static esp_err_t sensor_tool(esp_agent_handle_t handle, const char *tool_name, esp_agent_tool_param_t params[], size_t num_params,
+                             void *user_data, char **result)
+{
+    int id = num_params == 1 && params[0].type == ESP_AGENT_PARAM_TYPE_INT ? params[0].value.i : -1;
+    char reading[32];
+
+    g_calls++;
+    if (id == TOOL_CACHE_INVALIDATING_ID) {
+        esp_agent_invalidate_tool_cache(handle, tool_name);
+    }
+    snprintf(reading, sizeof(reading), "sensor %d: %lu", id, (unsigned long)g_calls);
+    *result = strdup(reading);
+    return *result ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t host_test_tool_cache(const cJSON *args, cJSON *metrics)
+{
+    int ttl_ms = host_test_arg_int(args, "ttl_ms", 10000);
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 5000);
+
+    esp_err_t ret = ESP_OK;
+    static host_test_agent_t agent;
+    esp_agent_tool_cache_stats_t stats;
+    esp_agent_tool_config_t config = {
+        .name = "sensor",
+        .handler = sensor_tool,
+        .cache_ttl_ms = ttl_ms,
+    };
+
+    g_calls = 0;
+    memset(&agent, 0, sizeof(agent));
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&agent, "host-test", ESP_AGENT_CONVERSATION_TEXT), end, TAG, "Failed to create the agent");
+    ESP_GOTO_ON_ERROR(esp_agent_register_local_tool_with_config(agent.handle, &config), end, TAG, "Failed to register the tool");
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&agent, 5000), end, TAG, "Failed to start the agent");
+
+    /* The server ends the script with a text, once it received the responses */
+    bool done = host_test_agent_wait(&agent, ESP_AGENT_EVENT_DATA_TYPE_TEXT, 1, timeout_ms);
+    esp_agent_get_tool_cache_stats(agent.handle, &stats);
+    cJSON_AddNumberToObject(metrics, "calls", g_calls);
+    cJSON_AddNumberToObject(metrics, "hits", stats.hits);
+    cJSON_AddNumberToObject(metrics, "misses", stats.misses);
+    cJSON_AddNumberToObject(metrics, "invalidated", stats.invalidated);
+    cJSON_AddNumberToObject(metrics, "entries", stats.entries);
+    ESP_GOTO_ON_FALSE(done, ESP_ERR_TIMEOUT, end, TAG, "The server did not get the tool responses");
+
+end:
+    host_test_agent_deinit(&agent);
+    return ret;
+}
@@ -0,0 +1,68 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Duplicate tool requests (scenarios/tool_dedup.json): the mock server sends a tool request
+ * twice in a row, while the tool is still running, then again once it answered, then a request
+ * with a new ID. The tool must run once per request ID: the duplicate while it runs is ignored,
+ * the one after it answered gets the same response again.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_tool_dedup";
+
+static volatile uint32_t g_calls;
+static int g_tool_ms;
+
+static esp_err_t slow_tool(esp_agent_handle_t handle, const char *tool_name, esp_agent_tool_param_t params[], size_t num_params,
+                           void *user_data, char **result)
+{
+    g_calls++;
+    vTaskDelay(pdMS_TO_TICKS(g_tool_ms));
+    *result = strdup("done");
+    return ESP_OK;
+}
+
+esp_err_t host_test_tool_dedup(const cJSON *args, cJSON *metrics)
+{
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 5000);
+    g_tool_ms = host_test_arg_int(args, "tool_ms", 300);
+
+    esp_err_t ret = ESP_OK;
+    static host_test_agent_t agent;
+    esp_agent_tool_dedup_stats_t stats;
+
+    g_calls = 0;
+    memset(&agent, 0, sizeof(agent));
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&agent, "host-test", ESP_AGENT_CONVERSATION_TEXT), end, TAG, "Failed to create the agent");
+    ESP_GOTO_ON_ERROR(esp_agent_register_local_tool(agent.handle, "slow", slow_tool, NULL), end, TAG, "Failed to register the tool");
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&agent, 5000), end, TAG, "Failed to start the agent");
+
+    /* The server ends the script with a text, once it received the responses */
+    bool done = host_test_agent_wait(&agent, ESP_AGENT_EVENT_DATA_TYPE_TEXT, 1, timeout_ms);
+    esp_agent_get_tool_dedup_stats(agent.handle, &stats);
+    cJSON_AddNumberToObject(metrics, "calls", g_calls);
+    cJSON_AddNumberToObject(metrics, "tool_call_events", host_test_agent_count(&agent, ESP_AGENT_EVENT_TOOL_CALL));
+    cJSON_AddNumberToObject(metrics, "requests", stats.requests);
+    cJSON_AddNumberToObject(metrics, "duplicates", stats.duplicates);
+    cJSON_AddNumberToObject(metrics, "in_flight_duplicates", stats.in_flight_duplicates);
+    cJSON_AddNumberToObject(metrics, "entries", stats.entries);
+    ESP_GOTO_ON_FALSE(done, ESP_ERR_TIMEOUT, end, TAG, "The server did not get the tool responses");
+
+end:
+    host_test_agent_deinit(&agent);
+    return ret;
+}
@@ -0,0 +1,125 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Tool execution modes (scenarios/tool_exec.json): the mock server requests an inline tool,
+ * then sends a text right away, and requests a tool with its own stack and priority. The
+ * inline tool must run in the message task, before the next message is processed; the other
+ * one in a task of its own, created with the stack and priority it declared.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_tool_exec";
+
+#define TOOL_EXEC_STACK_SIZE 6144
+#define TOOL_EXEC_PRIORITY   3
+
+typedef struct {
+    char inline_task[configMAX_TASK_NAME_LEN];
+    TaskHandle_t inline_handle;
+    TaskHandle_t task_handle;
+    UBaseType_t task_priority;
+    volatile uint32_t inline_calls;
+    volatile uint32_t task_calls;
+    bool inline_before_text;        /* The inline tool had run when the text sent after it was delivered */
+} tool_exec_state_t;
+
+static host_test_agent_t g_agent;
+static tool_exec_state_t g_state;
+
+static esp_err_t inline_tool(esp_agent_handle_t handle, const char *tool_name, esp_agent_tool_param_t params[], size_t num_params,
+                             void *user_data, char **result)
+{
+    tool_exec_state_t *state = (tool_exec_state_t *)user_data;
+    snprintf(state->inline_task, sizeof(state->inline_task), "%s", pcTaskGetName(NULL));
+    state->inline_handle = xTaskGetCurrentTaskHandle();
+    state->inline_calls++;
+    *result = strdup("inline");
+    return ESP_OK;
+}
+
+static esp_err_t task_tool(esp_agent_handle_t handle, const char *tool_name, esp_agent_tool_param_t params[], size_t num_params,
+                           void *user_data, char **result)
+{
+    tool_exec_state_t *state = (tool_exec_state_t *)user_data;
+    state->task_handle = xTaskGetCurrentTaskHandle();
+    state->task_priority = uxTaskPriorityGet(NULL);
+    state->task_calls++;
+    *result = strdup("task");
+    return ESP_OK;
+}
+
+/* Runs in the agent event loop */
+static void tool_exec_event_cb(void *arg, esp_agent_event_t event, esp_agent_message_data_t *data)
+{
+    tool_exec_state_t *state = (tool_exec_state_t *)arg;
+
+    if (event == ESP_AGENT_EVENT_DATA_TYPE_TEXT && data && data->text.text && strcmp(data->text.text, "after inline") == 0) {
+        state->inline_before_text = state->inline_calls > 0;
+    }
+}
+
+esp_err_t host_test_tool_exec(const cJSON *args, cJSON *metrics)
+{
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 5000);
+
+    esp_err_t ret = ESP_OK;
+    static esp_agent_tool_stats_t tools[CONFIG_ESP_AGENT_TOOL_STATS_MAX];
+    size_t num_tools = 0;
+    const esp_agent_tool_config_t configs[] = {
+        {.name = "inline_tool", .handler = inline_tool, .user_data = &g_state, .exec_mode = ESP_AGENT_TOOL_EXEC_INLINE},
+        {
+            .name = "task_tool", .handler = task_tool, .user_data = &g_state,
+            .stack_size = TOOL_EXEC_STACK_SIZE, .priority = TOOL_EXEC_PRIORITY,
+        },
+    };
+
+    memset(&g_agent, 0, sizeof(g_agent));
+    memset(&g_state, 0, sizeof(g_state));
+    g_agent.cb = tool_exec_event_cb;
+    g_agent.cb_arg = &g_state;
+
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&g_agent, "host-test", ESP_AGENT_CONVERSATION_TEXT), end, TAG, "Failed to create the agent");
+    for (size_t i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) {
+        ESP_GOTO_ON_ERROR(esp_agent_register_local_tool_with_config(g_agent.handle, &configs[i]), end, TAG, "Failed to register %s",
+                          configs[i].name);
+    }
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&g_agent, 5000), end, TAG, "Failed to start the agent");
+
+    /* The server ends the script with a second text, once it received the responses */
+    bool done = host_test_agent_wait(&g_agent, ESP_AGENT_EVENT_DATA_TYPE_TEXT, 2, timeout_ms);
+    cJSON_AddNumberToObject(metrics, "inline_calls", g_state.inline_calls);
+    cJSON_AddStringToObject(metrics, "inline_task", g_state.inline_task);
+    cJSON_AddBoolToObject(metrics, "inline_before_text", g_state.inline_before_text);
+    cJSON_AddNumberToObject(metrics, "task_calls", g_state.task_calls);
+    cJSON_AddBoolToObject(metrics, "task_own_task", g_state.task_handle && g_state.task_handle != g_state.inline_handle);
+    cJSON_AddNumberToObject(metrics, "task_priority", g_state.task_priority);
+    ESP_GOTO_ON_FALSE(done, ESP_ERR_TIMEOUT, end, TAG, "The server did not get the tool responses");
+
+    ESP_GOTO_ON_ERROR(esp_agent_get_tool_stats(g_agent.handle, tools, CONFIG_ESP_AGENT_TOOL_STATS_MAX, &num_tools), end, TAG,
+                      "Failed to get the tool stats");
+    for (size_t i = 0; i < num_tools; i++) {
+        cJSON *json = cJSON_AddObjectToObject(metrics, tools[i].name);
+        cJSON_AddNumberToObject(json, "stack_size", tools[i].stack_size);
+        cJSON_AddNumberToObject(json, "stack_min_free", tools[i].stack_min_free);
+        cJSON_AddNumberToObject(json, "calls", tools[i].timing[ESP_AGENT_TOOL_TIMING_LOCAL].calls);
+    }
+
+end:
+    host_test_agent_deinit(&g_agent);
+    return ret;
+}
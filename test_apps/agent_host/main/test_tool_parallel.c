@@ -0,0 +1,152 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Parallel tool calls (scenarios/tool_parallel.json): the mock server requests a slow tool
+ * more times than CONFIG_ESP_AGENT_TOOL_MAX_CONCURRENT allows at once, interleaved with calls
+ * to a non-reentrant tool, which the application also runs on the device meanwhile.
+ *
+ * The calls beyond the limit must wait without a task of their own, and start in the order
+ * they arrived as slots free up. The non-reentrant tool must never run twice at once, whether
+ * called by the server or by the application.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <sdkconfig.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_tool_parallel";
+
+typedef struct {
+    portMUX_TYPE lock;
+    int work_ms;
+    uint32_t work_calls;
+    int last_started;               /* Index of the last call to the work tool started */
+    uint32_t out_of_order;
+    uint32_t serial_calls;
+    uint32_t serial_active;
+    uint32_t serial_max_active;
+    UBaseType_t tasks_max;          /* Tasks in the system while a tool runs */
+} tool_parallel_state_t;
+
+static tool_parallel_state_t g_state;
+
+static void count_tasks(tool_parallel_state_t *state)
+{
+    UBaseType_t tasks = uxTaskGetNumberOfTasks();
+    portENTER_CRITICAL(&state->lock);
+    if (tasks > state->tasks_max) {
+        state->tasks_max = tasks;
+    }
+    portEXIT_CRITICAL(&state->lock);
+}
+
+static esp_err_t work_tool(esp_agent_handle_t handle, const char *tool_name, esp_agent_tool_param_t params[], size_t num_params,
+                           void *user_data, char **result)
+{
+    tool_parallel_state_t *state = (tool_parallel_state_t *)user_data;
+    int index = num_params == 1 && params[0].type == ESP_AGENT_PARAM_TYPE_INT ? params[0].value.i : -1;
+
+    portENTER_CRITICAL(&state->lock);
+    state->work_calls++;
+    if (index < state->last_started) {
+        state->out_of_order++;
+    }
+    state->last_started = index;
+    portEXIT_CRITICAL(&state->lock);
+
+    count_tasks(state);
+    vTaskDelay(pdMS_TO_TICKS(state->work_ms));
+    *result = strdup("worked");
+    return ESP_OK;
+}
+
+static esp_err_t serial_tool(esp_agent_handle_t handle, const char *tool_name, esp_agent_tool_param_t params[], size_t num_params,
+                             void *user_data, char **result)
+{
+    tool_parallel_state_t *state = (tool_parallel_state_t *)user_data;
+
+    portENTER_CRITICAL(&state->lock);
+    state->serial_calls++;
+    if (++state->serial_active > state->serial_max_active) {
+        state->serial_max_active = state->serial_active;
+    }
+    portEXIT_CRITICAL(&state->lock);
+
+    count_tasks(state);
+    vTaskDelay(pdMS_TO_TICKS(state->work_ms / 2));
+
+    portENTER_CRITICAL(&state->lock);
+    state->serial_active--;
+    portEXIT_CRITICAL(&state->lock);
+
+    *result = strdup("serialized");
+    return ESP_OK;
+}
+
+esp_err_t host_test_tool_parallel(const cJSON *args, cJSON *metrics)
+{
+    int local_runs = host_test_arg_int(args, "local_runs", 2);
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 10000);
+
+    esp_err_t ret = ESP_OK;
+    static host_test_agent_t agent;
+    esp_agent_tool_exec_stats_t stats;
+    const esp_agent_tool_config_t configs[] = {
+        {.name = "work", .handler = work_tool, .user_data = &g_state},
+        {.name = "serial", .handler = serial_tool, .user_data = &g_state, .non_reentrant = true},
+    };
+    /* Other parameters than the server requests, so that these runs do not answer them */
+    const esp_agent_tool_param_t local_params[] = {
+        {.name = "source", .type = ESP_AGENT_PARAM_TYPE_STRING, .value.s = "device"},
+    };
+
+    memset(&agent, 0, sizeof(agent));
+    memset(&g_state, 0, sizeof(g_state));
+    portMUX_INITIALIZE(&g_state.lock);
+    g_state.work_ms = host_test_arg_int(args, "work_ms", 300);
+    g_state.last_started = -1;
+
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&agent, "host-test", ESP_AGENT_CONVERSATION_TEXT), end, TAG, "Failed to create the agent");
+    for (size_t i = 0; i < sizeof(configs) / sizeof(configs[0]); i++) {
+        ESP_GOTO_ON_ERROR(esp_agent_register_local_tool_with_config(agent.handle, &configs[i]), end, TAG, "Failed to register %s",
+                          configs[i].name);
+    }
+    UBaseType_t tasks_idle = uxTaskGetNumberOfTasks();
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&agent, 5000), end, TAG, "Failed to start the agent");
+
+    /* While the server requests are running */
+    for (int i = 0; i < local_runs; i++) {
+        esp_agent_run_local_tool(agent.handle, "serial", local_params, 1);
+    }
+
+    /* The server ends the script with a text, once it received the responses */
+    bool done = host_test_agent_wait(&agent, ESP_AGENT_EVENT_DATA_TYPE_TEXT, 1, timeout_ms);
+    esp_agent_get_tool_exec_stats(agent.handle, &stats);
+    cJSON_AddNumberToObject(metrics, "work_calls", g_state.work_calls);
+    cJSON_AddNumberToObject(metrics, "out_of_order", g_state.out_of_order);
+    cJSON_AddNumberToObject(metrics, "serial_calls", g_state.serial_calls);
+    cJSON_AddNumberToObject(metrics, "serial_max_active", g_state.serial_max_active);
+    /* The idle count was taken before the agent connected, so this includes the websocket task */
+    cJSON_AddNumberToObject(metrics, "extra_tasks_max", g_state.tasks_max > tasks_idle ? g_state.tasks_max - tasks_idle : 0);
+    cJSON_AddNumberToObject(metrics, "max_running", stats.max_running);
+    cJSON_AddNumberToObject(metrics, "slot_waits", stats.slot_waits);
+    cJSON_AddNumberToObject(metrics, "serialized_waits", stats.serialized_waits);
+    cJSON_AddNumberToObject(metrics, "max_concurrent", CONFIG_ESP_AGENT_TOOL_MAX_CONCURRENT);
+    ESP_GOTO_ON_FALSE(done, ESP_ERR_TIMEOUT, end, TAG, "The server did not get the tool responses");
+
+end:
+    host_test_agent_deinit(&agent);
+    return ret;
+}
@@ -0,0 +1,92 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Server tool latency (scenarios/tool_stats.json): the mock server sends tool_call_info and
+ * tool_result_info messages timed in each of the ways accepted: by server timestamps, by the
+ * arrival of the two messages (with the content as a JSON string), and by a duration. A result
+ * without a call or a duration has no duration, and is not recorded. Two names longer than
+ * the stored names, which only differ past the truncation, are recorded as one tool.
+ */
+
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_tool_stats";
+
+typedef struct {
+    uint32_t results;
+    uint32_t unknown_duration;
+} tool_stats_state_t;
+
+static host_test_agent_t g_agent;
+static tool_stats_state_t g_state;
+
+/* Runs in the agent event loop */
+static void tool_stats_event_cb(void *arg, esp_agent_event_t event, esp_agent_message_data_t *data)
+{
+    tool_stats_state_t *state = (tool_stats_state_t *)arg;
+
+    if (event != ESP_AGENT_EVENT_TOOL_INFO || data == NULL || !data->tool_info.result) {
+        return;
+    }
+    state->results++;
+    if (data->tool_info.duration_ms < 0) {
+        state->unknown_duration++;
+    }
+}
+
+static void add_tool(cJSON *tools, const esp_agent_tool_stats_t *tool, const char *name)
+{
+    const esp_agent_tool_timing_t *timing = &tool->timing[ESP_AGENT_TOOL_TIMING_CLOUD];
+    cJSON *json = cJSON_AddObjectToObject(tools, name);
+    cJSON_AddNumberToObject(json, "calls", timing->calls);
+    cJSON_AddNumberToObject(json, "max_ms", timing->max_ms);
+}
+
+esp_err_t host_test_tool_stats(const cJSON *args, cJSON *metrics)
+{
+    int infos = host_test_arg_int(args, "infos", 8);
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 5000);
+
+    esp_err_t ret = ESP_OK;
+    static esp_agent_tool_stats_t tools[CONFIG_ESP_AGENT_TOOL_STATS_MAX];
+    size_t num_tools = 0;
+
+    memset(&g_agent, 0, sizeof(g_agent));
+    memset(&g_state, 0, sizeof(g_state));
+    g_agent.cb = tool_stats_event_cb;
+    g_agent.cb_arg = &g_state;
+
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&g_agent, "host-test", ESP_AGENT_CONVERSATION_TEXT), end, TAG, "Failed to create the agent");
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&g_agent, 5000), end, TAG, "Failed to start the agent");
+
+    bool received = host_test_agent_wait(&g_agent, ESP_AGENT_EVENT_TOOL_INFO, infos, timeout_ms);
+    cJSON_AddNumberToObject(metrics, "results", g_state.results);
+    cJSON_AddNumberToObject(metrics, "unknown_duration", g_state.unknown_duration);
+    ESP_GOTO_ON_FALSE(received, ESP_ERR_TIMEOUT, end, TAG, "%lu of %d tool infos received",
+                      (unsigned long)host_test_agent_count(&g_agent, ESP_AGENT_EVENT_TOOL_INFO), infos);
+
+    ESP_GOTO_ON_ERROR(esp_agent_get_tool_stats(g_agent.handle, tools, CONFIG_ESP_AGENT_TOOL_STATS_MAX, &num_tools), end, TAG,
+                      "Failed to get the tool stats");
+    cJSON_AddNumberToObject(metrics, "tools", num_tools);
+    cJSON *json = cJSON_AddObjectToObject(metrics, "tool");
+    for (size_t i = 0; i < num_tools; i++) {
+        /* The truncated name is reported under a name of its own */
+        bool truncated = strlen(tools[i].name) == ESP_AGENT_TOOL_STATS_NAME_LEN - 1;
+        add_tool(json, &tools[i], truncated ? "truncated" : tools[i].name);
+    }
+
+end:
+    host_test_agent_deinit(&g_agent);
+    return ret;
+}
@@ -0,0 +1,89 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Tool parameter validation (scenarios/tool_validation.json): the mock server requests a tool
+ * declaring a required number within [0, 100] and an optional string of 1 to 8 characters,
+ * with valid parameters, a missing one, one of the wrong type, and values and lengths out of
+ * range. Every request is answered, but only the valid ones may reach the tool; the others
+ * are rejected with an error before the tool runs.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_tool_validation";
+
+typedef struct {
+    volatile uint32_t calls;
+    int min_level;
+    int max_level;
+} tool_validation_state_t;
+
+static host_test_agent_t g_agent;
+static tool_validation_state_t g_state;
+
+static const esp_agent_tool_param_schema_t g_set_level_schema[] = {
+    { .name = "level", .type = ESP_AGENT_PARAM_TYPE_INT, .required = true, .has_range = true, .min = 0, .max = 100 },
+    { .name = "label", .type = ESP_AGENT_PARAM_TYPE_STRING, .has_range = true, .min = 1, .max = 8 },
+};
+
+static esp_err_t set_level_tool(esp_agent_handle_t handle, const char *tool_name, esp_agent_tool_param_t params[], size_t num_params,
+                                void *user_data, char **result)
+{
+    tool_validation_state_t *state = (tool_validation_state_t *)user_data;
+    for (size_t i = 0; i < num_params; i++) {
+        if (strcmp(params[i].name, "level") == 0) {
+            state->min_level = state->calls == 0 || params[i].value.i < state->min_level ? params[i].value.i : state->min_level;
+            state->max_level = state->calls == 0 || params[i].value.i > state->max_level ? params[i].value.i : state->max_level;
+        }
+    }
+    state->calls++;
+    *result = strdup("ok");
+    return ESP_OK;
+}
+
+esp_err_t host_test_tool_validation(const cJSON *args, cJSON *metrics)
+{
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 5000);
+
+    esp_err_t ret = ESP_OK;
+    esp_agent_tool_exec_stats_t stats;
+    const esp_agent_tool_config_t config = {
+        .name = "set_level",
+        .handler = set_level_tool,
+        .user_data = &g_state,
+        .params = g_set_level_schema,
+        .num_params = sizeof(g_set_level_schema) / sizeof(g_set_level_schema[0]),
+    };
+
+    memset(&g_agent, 0, sizeof(g_agent));
+    memset(&g_state, 0, sizeof(g_state));
+
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&g_agent, "host-test", ESP_AGENT_CONVERSATION_TEXT), end, TAG, "Failed to create the agent");
+    ESP_GOTO_ON_ERROR(esp_agent_register_local_tool_with_config(g_agent.handle, &config), end, TAG, "Failed to register the tool");
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&g_agent, 5000), end, TAG, "Failed to start the agent");
+
+    /* The server sends a text once it received a response to every request */
+    bool done = host_test_agent_wait(&g_agent, ESP_AGENT_EVENT_DATA_TYPE_TEXT, 1, timeout_ms);
+    ESP_GOTO_ON_ERROR(esp_agent_get_tool_exec_stats(g_agent.handle, &stats), end, TAG, "Failed to get the tool execution stats");
+    cJSON_AddNumberToObject(metrics, "validated", stats.validated);
+    cJSON_AddNumberToObject(metrics, "rejected", stats.rejected);
+    cJSON_AddNumberToObject(metrics, "validation_us", stats.validation_us);
+    cJSON_AddNumberToObject(metrics, "calls", g_state.calls);
+    cJSON_AddNumberToObject(metrics, "min_level", g_state.min_level);
+    cJSON_AddNumberToObject(metrics, "max_level", g_state.max_level);
+    ESP_GOTO_ON_FALSE(done, ESP_ERR_TIMEOUT, end, TAG, "The server did not get the tool responses");
+
+end:
+    host_test_agent_deinit(&g_agent);
+    return ret;
+}
@@ -0,0 +1,130 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Cost of the transcript store of app_common: time per append, alone and while the
+ * transcript is saved to NVS from another task, time and size of a save, and the rate
+ * limit of the flash writes.
+ */
+
+#include <string.h>
+
+#include <sdkconfig.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_console.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <nvs.h>
+#include <nvs_flash.h>
+
+#include <agent_console.h>
+#include <app_transcript.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_transcript";
+
+typedef struct {
+    int saves;
+    int failures;
+    volatile bool done;
+} transcript_saver_t;
+
+static void saver_task(void *arg)
+{
+    transcript_saver_t *saver = (transcript_saver_t *)arg;
+
+    for (int i = 0; i < saver->saves; i++) {
+        if (app_transcript_save(true) != ESP_OK) {
+            saver->failures++;
+        }
+        vTaskDelay(1);
+    }
+    saver->done = true;
+    vTaskDelete(NULL);
+}
+
+esp_err_t host_test_transcript(const cJSON *args, cJSON *metrics)
+{
+    int entries = host_test_arg_int(args, "entries", 1000);
+    int saves = host_test_arg_int(args, "saves", 20);
+
+    app_transcript_stats_t stats;
+    esp_err_t ret = ESP_OK;
+    int cmd_ret = 0;
+
+    ESP_RETURN_ON_ERROR(nvs_flash_erase(), TAG, "Failed to erase NVS");
+    ESP_RETURN_ON_ERROR(nvs_flash_init(), TAG, "Failed to initialize NVS");
+    ESP_RETURN_ON_ERROR(agent_console_init(), TAG, "Failed to initialize the console");
+    ESP_RETURN_ON_ERROR(app_transcript_init(), TAG, "Failed to initialize the transcript");
+
+    /* Event path alone */
+    for (int i = 0; i < entries; i++) {
+        ESP_RETURN_ON_ERROR(app_transcript_append(i % 2 ? APP_TRANSCRIPT_ENTRY_ASSISTANT : APP_TRANSCRIPT_ENTRY_USER,
+                                                  "entry %d: the quick brown fox jumps over the lazy dog", i),
+                            TAG, "Failed to append");
+    }
+    ESP_RETURN_ON_ERROR(app_transcript_get_stats(&stats), TAG, "Failed to get the stats");
+    cJSON_AddNumberToObject(metrics, "entries", stats.entries);
+    cJSON_AddNumberToObject(metrics, "size", stats.size);
+    cJSON_AddNumberToObject(metrics, "append_avg_us", stats.appends ? (double)stats.append_total_us / stats.appends : 0);
+    cJSON_AddNumberToObject(metrics, "append_max_us", stats.append_max_us);
+
+    /* Event path while saving: appends must not wait for the flash write */
+    static transcript_saver_t saver;
+    saver = (transcript_saver_t) {
+        .saves = saves,
+    };
+    uint32_t appends_during_saves = 0;
+    int64_t append_max_during_saves_us = 0;
+    ESP_RETURN_ON_FALSE(xTaskCreate(saver_task, "saver", 4096, &saver, 5, NULL) == pdPASS, ESP_ERR_NO_MEM, TAG, "Failed to create the saver task");
+    while (!saver.done) {
+        int64_t start_us = esp_timer_get_time();
+        app_transcript_append(APP_TRANSCRIPT_ENTRY_TOOL_CALL, "tool %lu", (unsigned long)appends_during_saves);
+        int64_t elapsed_us = esp_timer_get_time() - start_us;
+        if (elapsed_us > append_max_during_saves_us) {
+            append_max_during_saves_us = elapsed_us;
+        }
+        appends_during_saves++;
+        if (appends_during_saves % 16 == 0) {
+            vTaskDelay(1);
+        }
+    }
+    ESP_RETURN_ON_ERROR(app_transcript_get_stats(&stats), TAG, "Failed to get the stats");
+    cJSON_AddNumberToObject(metrics, "appends_during_saves", appends_during_saves);
+    cJSON_AddNumberToObject(metrics, "append_max_during_saves_us", append_max_during_saves_us);
+    cJSON_AddNumberToObject(metrics, "saves", stats.saves);
+    cJSON_AddNumberToObject(metrics, "save_failures", saver.failures);
+    cJSON_AddNumberToObject(metrics, "save_max_us", stats.save_max_us);
+    cJSON_AddNumberToObject(metrics, "saved_bytes", stats.saved_bytes);
+
+    /* Flash write rate: a save within the minimum interval is skipped */
+    uint32_t skipped = stats.saves_skipped;
+    app_transcript_append(APP_TRANSCRIPT_ENTRY_USER, "after the saves");
+    ESP_RETURN_ON_ERROR(app_transcript_save(false), TAG, "Failed to request a save");
+    ESP_RETURN_ON_ERROR(app_transcript_get_stats(&stats), TAG, "Failed to get the stats");
+    cJSON_AddNumberToObject(metrics, "saves_skipped", stats.saves_skipped - skipped);
+    cJSON_AddNumberToObject(metrics, "max_flash_bytes_per_hour",
+                            CONFIG_APP_TRANSCRIPT_NVS_MIN_INTERVAL_S ? (double)stats.size * 3600 / CONFIG_APP_TRANSCRIPT_NVS_MIN_INTERVAL_S : -1);
+
+    /* The save is one blob of the size of the transcript */
+    nvs_handle_t nvs_handle;
+    size_t saved_len = 0;
+    ESP_RETURN_ON_ERROR(nvs_open("app_transcript", NVS_READONLY, &nvs_handle), TAG, "Nothing saved");
+    ret = nvs_get_blob(nvs_handle, "ring", NULL, &saved_len);
+    nvs_close(nvs_handle);
+    ESP_RETURN_ON_ERROR(ret, TAG, "Nothing saved");
+    cJSON_AddNumberToObject(metrics, "saved_len", saved_len);
+    ESP_RETURN_ON_FALSE(saved_len == stats.size, ESP_FAIL, TAG, "Saved %u bytes, the transcript has %lu", (unsigned)saved_len, (unsigned long)stats.size);
+
+    ESP_RETURN_ON_ERROR(esp_console_run("transcript stats", &cmd_ret), TAG, "Failed to run the transcript command");
+    ESP_RETURN_ON_FALSE(cmd_ret == ESP_OK, ESP_FAIL, TAG, "transcript stats failed: %d", cmd_ret);
+
+    return ESP_OK;
+}
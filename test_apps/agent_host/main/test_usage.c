@@ -0,0 +1,87 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Usage reports (scenarios/usage.json): on every turn the mock server replies with an audio
+ * frame, then sends two usage reports, the first with the server time of the first reply and
+ * the second with a longer one (the end of the reply). The server time must be sampled once
+ * per turn, from the first report, and the tokens of both summed. The agent is then stopped and
+ * started again for one more turn: the session counters must only count that turn.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_check.h>
+#include <esp_log.h>
+
+#include "host_test.h"
+
+static const char *TAG = "test_usage";
+
+static esp_err_t usage_turn(host_test_agent_t *agent, int turn, int reports, int timeout_ms)
+{
+    char text[32];
+    uint32_t usage = host_test_agent_count(agent, ESP_AGENT_EVENT_USAGE);
+
+    esp_agent_latency_mark(agent->handle, ESP_AGENT_LATENCY_STAGE_VAD_END);
+    esp_agent_latency_mark(agent->handle, ESP_AGENT_LATENCY_STAGE_AUDIO_STREAM_END);
+    snprintf(text, sizeof(text), "turn %d", turn);
+    ESP_RETURN_ON_ERROR(esp_agent_send_text(agent->handle, text, pdMS_TO_TICKS(1000)), TAG, "Failed to send turn %d", turn);
+    ESP_RETURN_ON_FALSE(host_test_agent_wait(agent, ESP_AGENT_EVENT_USAGE, usage + reports, timeout_ms), ESP_ERR_TIMEOUT, TAG,
+                        "No usage for turn %d", turn);
+    return ESP_OK;
+}
+
+static void add_usage_stats(cJSON *metrics, const char *name, esp_agent_handle_t handle)
+{
+    esp_agent_usage_stats_t stats;
+    if (esp_agent_get_usage_stats(handle, &stats) != ESP_OK) {
+        return;
+    }
+    cJSON *json = cJSON_AddObjectToObject(metrics, name);
+    cJSON_AddNumberToObject(json, "turns", stats.turns);
+    cJSON_AddNumberToObject(json, "input_tokens", stats.input_tokens);
+    cJSON_AddNumberToObject(json, "output_tokens", stats.output_tokens);
+    cJSON_AddNumberToObject(json, "session_turns", stats.session_turns);
+    cJSON_AddNumberToObject(json, "session_input_tokens", stats.session_input_tokens);
+    cJSON_AddNumberToObject(json, "session_output_tokens", stats.session_output_tokens);
+    cJSON_AddNumberToObject(json, "server_samples", stats.server.samples);
+    cJSON_AddNumberToObject(json, "server_max_ms", stats.server.max_ms);
+    cJSON_AddNumberToObject(json, "network_samples", stats.network.samples);
+}
+
+esp_err_t host_test_usage(const cJSON *args, cJSON *metrics)
+{
+    int turns = host_test_arg_int(args, "turns", 3);
+    int reports = host_test_arg_int(args, "reports", 2);
+    int timeout_ms = host_test_arg_int(args, "timeout_ms", 5000);
+
+    esp_err_t ret = ESP_OK;
+    static host_test_agent_t agent;
+
+    memset(&agent, 0, sizeof(agent));
+    ESP_GOTO_ON_ERROR(host_test_agent_init(&agent, "host-test", ESP_AGENT_CONVERSATION_TEXT), end, TAG, "Failed to create the agent");
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&agent, 5000), end, TAG, "Failed to start the agent");
+
+    for (int i = 0; i < turns; i++) {
+        ESP_GOTO_ON_ERROR(usage_turn(&agent, i, reports, timeout_ms), end, TAG, "Turn %d failed", i);
+    }
+    add_usage_stats(metrics, "first", agent.handle);
+
+    /* A new session: the totals go on, the session counters start again */
+    ESP_GOTO_ON_ERROR(esp_agent_stop(agent.handle), end, TAG, "Failed to stop");
+    ESP_GOTO_ON_ERROR(host_test_agent_start(&agent, 5000), end, TAG, "Failed to start again");
+    ESP_GOTO_ON_ERROR(usage_turn(&agent, turns, reports, timeout_ms), end, TAG, "Turn of the second session failed");
+    add_usage_stats(metrics, "second", agent.handle);
+
+end:
+    host_test_agent_deinit(&agent);
+    return ret;
+}
@@ -0,0 +1,632 @@
+# SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Local mock of the ESP Private Agents API, for the host tests of the agent component.
+
+Implements the token endpoint and the conversation websocket, and replays a scripted
+message sequence on every connection. Only the Python standard library is used, so that
+it runs wherever ESP-IDF does.
+
+The scenario format is described in ../README.md.
+"""
+
+import argparse
+import base64
+import copy
+import hashlib
+import json
+import os
+import queue
+import re
+import signal
+import socket
+import struct
+import sys
+import threading
+import time
+import uuid
+import zlib
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import parse_qs, urlparse
+
+WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+OPCODE_CONTINUATION = 0x0
+OPCODE_TEXT = 0x1
+OPCODE_BINARY = 0x2
+OPCODE_CLOSE = 0x8
+OPCODE_PING = 0x9
+OPCODE_PONG = 0xA
+
+COMPRESSION_ALGORITHM = "deflate-raw"
+AGGREGATION_FRAMING = "u16be-length-prefixed"
+
+# Messages counted as a received binary message by the "wait" step
+BINARY = "binary"
+
+
+class Stats:
+    """Counters of everything the server saw, written as JSON on exit."""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.data = {
+            "tokens": 0,
+            "connections": 0,
+            "handshakes": 0,
+            "resumes_accepted": 0,
+            "messages": {},
+            "rx_text_bytes": 0,
+            "rx_wire_text_bytes": 0,
+            "rx_binary_messages": 0,
+            "rx_binary_bytes": 0,
+            "rx_audio_frames": 0,
+            "rx_fragments": 0,
+            "tx_text_messages": 0,
+            "tx_text_bytes": 0,
+            "tx_binary_messages": 0,
+            "tx_binary_bytes": 0,
+            "rx_compressed": 0,
+            "rx_compressed_wire_bytes": 0,
+            "rx_compressed_original_bytes": 0,
+            "pings": 0,
+            "pongs": 0,
+            "rx_seq_duplicates": 0,
+            "rx_seq_gaps": 0,
+            "rx_unsequenced": 0,
+            "tx_replayed": 0,
+            "script_errors": [],
+            "per_agent": {},
+        }
+
+    def add(self, key, value=1, agent=None):
+        with self.lock:
+            self.data[key] = self.data.get(key, 0) + value
+            if agent is not None:
+                per_agent = self.data["per_agent"].setdefault(agent, {})
+                per_agent[key] = per_agent.get(key, 0) + value
+
+    def count_message(self, msg_type, agent):
+        with self.lock:
+            self.data["messages"][msg_type] = self.data["messages"].get(msg_type, 0) + 1
+            per_agent = self.data["per_agent"].setdefault(agent, {})
+            messages = per_agent.setdefault("messages", {})
+            messages[msg_type] = messages.get(msg_type, 0) + 1
+
+    def error(self, text):
+        with self.lock:
+            self.data["script_errors"].append(text)
+        print(f"mock_agent_server: {text}", file=sys.stderr)
+
+    def dump(self, path):
+        with self.lock:
+            text = json.dumps(self.data, indent=2, sort_keys=True)
+        if path:
+            with open(path + ".tmp", "w") as f:
+                f.write(text)
+            os.replace(path + ".tmp", path)
+
+
+class Conversation:
+    """Server side of the message sequencing, kept across connections for the resume."""
+
+    def __init__(self, conversation_id):
+        self.id = conversation_id
+        self.lock = threading.Lock()
+        self.next_seq = 1
+        self.last_rx_seq = 0
+        self.unacked = []   # (seq, text) sent but not acknowledged by the device
+
+
+class Connection:
+    def __init__(self, server, handler, agent_id, index):
+        self.server = server
+        self.stats = server.stats
+        self.sock = handler.connection
+        self.rfile = handler.rfile
+        self.agent_id = agent_id
+        self.index = index
+        self.config = server.connection_config(agent_id, index)
+        self.received = queue.Queue()
+        self.send_lock = threading.Lock()
+        self.closed = threading.Event()
+        self.silent = threading.Event()
+        self.throttle_bps = self.config.get("throttle_bps", 0)
+        self.compression = False
+        self.compression_window_bits = 15
+        self.aggregation = False
+        self.conversation = None
+        self.sequencing = False
+        self.unacked_rx = 0
+
+    # Framing
+
+    def _read_exact(self, n):
+        data = b""
+        while len(data) < n:
+            chunk_len = n - len(data)
+            if self.throttle_bps:
+                chunk_len = min(chunk_len, max(1, self.throttle_bps // 50))
+            chunk = self.rfile.read1(chunk_len) if hasattr(self.rfile, "read1") else self.rfile.read(chunk_len)
+            if not chunk:
+                raise ConnectionError("connection closed")
+            data += chunk
+            if self.throttle_bps:
+                time.sleep(len(chunk) / self.throttle_bps)
+        return data
+
+    def _read_frame(self):
+        b0, b1 = self._read_exact(2)
+        fin = bool(b0 & 0x80)
+        opcode = b0 & 0x0F
+        masked = bool(b1 & 0x80)
+        length = b1 & 0x7F
+        if length == 126:
+            length = struct.unpack(">H", self._read_exact(2))[0]
+        elif length == 127:
+            length = struct.unpack(">Q", self._read_exact(8))[0]
+        mask = self._read_exact(4) if masked else None
+        payload = self._read_exact(length) if length else b""
+        if mask:
+            payload = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+        return fin, opcode, payload
+
+    def send_frame(self, opcode, payload):
+        header = bytes([0x80 | opcode])
+        length = len(payload)
+        if length < 126:
+            header += bytes([length])
+        elif length < 65536:
+            header += bytes([126]) + struct.pack(">H", length)
+        else:
+            header += bytes([127]) + struct.pack(">Q", length)
+        with self.send_lock:
+            if self.closed.is_set():
+                return False
+            try:
+                self.sock.sendall(header + payload)
+            except OSError:
+                self.closed.set()
+                return False
+        return True
+
+    # Receive side, in its own thread so that pings are answered while the script waits
+
+    def reader(self):
+        message = b""
+        message_opcode = None
+        fragments = 0
+        try:
+            while not self.closed.is_set():
+                fin, opcode, payload = self._read_frame()
+                if opcode == OPCODE_PING:
+                    self.stats.add("pings", agent=self.agent_id)
+                    if not self.silent.is_set():
+                        self.send_frame(OPCODE_PONG, payload)
+                        self.stats.add("pongs", agent=self.agent_id)
+                    continue
+                if opcode == OPCODE_PONG:
+                    continue
+                if opcode == OPCODE_CLOSE:
+                    self.send_frame(OPCODE_CLOSE, payload[:2])
+                    break
+                if opcode != OPCODE_CONTINUATION:
+                    message = b""
+                    message_opcode = opcode
+                    fragments = 0
+                message += payload
+                fragments += 1
+                if not fin:
+                    continue
+                if fragments > 1:
+                    self.stats.add("rx_fragments", fragments, agent=self.agent_id)
+                if message_opcode == OPCODE_TEXT:
+                    self.on_text(message.decode("utf-8", errors="replace"), len(message))
+                elif message_opcode == OPCODE_BINARY:
+                    self.on_binary(message)
+                message = b""
+        except (ConnectionError, OSError, ValueError):
+            pass
+        finally:
+            self.closed.set()
+            self.received.put(None)
+
+    def on_text(self, text, wire_len, inner=False):
+        try:
+            msg = json.loads(text)
+        except ValueError:
+            self.stats.error(f"invalid JSON from the device: {text[:80]}")
+            return
+        msg_type = msg.get("type", "?")
+        if not inner:
+            self.stats.add("rx_wire_text_bytes", wire_len, agent=self.agent_id)
+        if msg_type == "compressed":
+            original = self.inflate(msg)
+            if original is not None:
+                self.stats.add("rx_compressed", agent=self.agent_id)
+                self.stats.add("rx_compressed_wire_bytes", wire_len, agent=self.agent_id)
+                self.stats.add("rx_compressed_original_bytes", len(original), agent=self.agent_id)
+                self.on_text(original.decode("utf-8", errors="replace"), wire_len, inner=True)
+            return
+        self.stats.add("rx_text_bytes", len(text), agent=self.agent_id)
+        self.stats.count_message(msg_type, self.agent_id)
+        if msg_type == "handshake":
+            self.on_handshake(msg)
+        elif self.sequencing:
+            self.on_sequenced(msg)
+        self.received.put((msg_type, msg, time.monotonic()))
+
+    def on_binary(self, data):
+        self.stats.add("rx_binary_messages", agent=self.agent_id)
+        self.stats.add("rx_binary_bytes", len(data), agent=self.agent_id)
+        frames = 1
+        if self.aggregation:
+            frames = 0
+            offset = 0
+            while offset + 2 <= len(data):
+                (frame_len,) = struct.unpack(">H", data[offset:offset + 2])
+                offset += 2 + frame_len
+                frames += 1
+            if offset != len(data):
+                self.stats.error(f"malformed aggregated audio message of {len(data)} bytes")
+        self.stats.add("rx_audio_frames", frames, agent=self.agent_id)
+        self.received.put((BINARY, {"len": len(data), "frames": frames}, time.monotonic()))
+
+    def inflate(self, msg):
+        try:
+            deflated = base64.b64decode(msg.get("content", ""))
+            original = zlib.decompress(deflated, -15)
+        except (ValueError, zlib.error) as e:
+            self.stats.error(f"invalid compressed message: {e}")
+            return None
+        length = msg.get("metadata", {}).get("length")
+        if length != len(original):
+            self.stats.error(f"compressed message length {length} does not match {len(original)}")
+        return original
+
+    # Handshake and negotiation
+
+    def on_handshake(self, msg):
+        content = msg.get("content", {})
+        ack = {"conversationId": content.get("conversationId") or str(uuid.uuid4())}
+        offered = content.get("compression")
+        if self.config.get("compression") and isinstance(offered, dict) and offered.get("algorithm") == COMPRESSION_ALGORITHM:
+            ack["compression"] = {"algorithm": COMPRESSION_ALGORITHM}
+            self.compression = True
+            # The device inflates with the window it offered, a back-reference beyond it cannot be resolved
+            self.compression_window_bits = offered.get("windowBits", 15)
+        offered = content.get("audioConfiguration", {}).get("input", {}).get("aggregation")
+        if self.config.get("aggregation") and isinstance(offered, dict) and offered.get("framing") == AGGREGATION_FRAMING:
+            ack["audioAggregation"] = {"framing": AGGREGATION_FRAMING}
+            self.aggregation = True
+
+        replay = []
+        offered = content.get("resume")
+        if self.config.get("resume") and isinstance(offered, dict):
+            conversation = self.server.conversations.get(ack["conversationId"])
+            accepted = conversation is not None
+            if not accepted:
+                conversation = Conversation(ack["conversationId"])
+                self.server.conversations[conversation.id] = conversation
+            with conversation.lock:
+                device_last_rx = int(offered.get("lastReceivedSeq", 0))
+                conversation.unacked = [(s, t) for s, t in conversation.unacked if s > device_last_rx]
+                replay = list(conversation.unacked) if accepted else []
+                if not accepted:
+                    conversation.unacked = []
+                    conversation.next_seq = 1
+                    conversation.last_rx_seq = 0
+                ack["resume"] = {"accepted": accepted, "lastReceivedSeq": conversation.last_rx_seq}
+            if accepted:
+                self.stats.add("resumes_accepted", agent=self.agent_id)
+            self.conversation = conversation
+            self.sequencing = True
+
+        ack.update(self.config.get("handshake_ack", {}))
+        delay_ms = self.config.get("handshake_delay_ms", 0)
+        if delay_ms:
+            time.sleep(delay_ms / 1000)
+        self.stats.add("handshakes", agent=self.agent_id)
+        self.send_json({"type": "handshake_ack", "content": ack}, sequence=False, compress=False)
+        for seq, text in replay:
+            self.stats.add("tx_replayed", agent=self.agent_id)
+            self.send_text(text)
+
+    def on_sequenced(self, msg):
+        conversation = self.conversation
+        send_ack = 0
+        with conversation.lock:
+            if isinstance(msg.get("ack"), int):
+                conversation.unacked = [(s, t) for s, t in conversation.unacked if s > msg["ack"]]
+            seq = msg.get("seq")
+            if isinstance(seq, int):
+                if seq <= conversation.last_rx_seq:
+                    self.stats.add("rx_seq_duplicates", agent=self.agent_id)
+                else:
+                    if seq > conversation.last_rx_seq + 1:
+                        self.stats.add("rx_seq_gaps", seq - conversation.last_rx_seq - 1, agent=self.agent_id)
+                    conversation.last_rx_seq = seq
+                    self.unacked_rx += 1
+                    if self.unacked_rx >= self.config.get("ack_every", 4):
+                        self.unacked_rx = 0
+                        send_ack = conversation.last_rx_seq
+            elif msg.get("type") != "ack":
+                # Sent once sequencing was negotiated, but without a sequence number
+                self.stats.add("rx_unsequenced", agent=self.agent_id)
+        if send_ack:
+            self.send_json({"type": "ack", "ack": send_ack}, sequence=False)
+
+    # Send side
+
+    def send_text(self, text):
+        data = text.encode("utf-8")
+        if self.send_frame(OPCODE_TEXT, data):
+            self.stats.add("tx_text_messages", agent=self.agent_id)
+            self.stats.add("tx_text_bytes", len(data), agent=self.agent_id)
+
+    def send_json(self, msg, sequence=True, compress=None):
+        msg = copy.deepcopy(msg)
+        conversation = self.conversation if self.sequencing and sequence else None
+        if conversation:
+            with conversation.lock:
+                msg["seq"] = conversation.next_seq
+                msg["ack"] = conversation.last_rx_seq
+                conversation.next_seq += 1
+        text = json.dumps(msg, separators=(",", ":"))
+        threshold = self.config.get("compression_threshold", 0)
+        if compress is None:
+            compress = bool(threshold) and len(text) >= threshold
+        # A number compresses the compressed message again, which a device must reject
+        for _ in range(int(compress) if self.compression else 0):
+            deflater = zlib.compressobj(zlib.Z_DEFAULT_COMPRESSION, zlib.DEFLATED, -self.compression_window_bits)
+            deflated = deflater.compress(text.encode("utf-8")) + deflater.flush()
+            text = json.dumps({
+                "type": "compressed",
+                "content_type": COMPRESSION_ALGORITHM,
+                "content": base64.b64encode(deflated).decode("ascii"),
+                "metadata": {"length": len(text.encode("utf-8"))},
+            }, separators=(",", ":"))
+        if conversation:
+            with conversation.lock:
+                conversation.unacked.append((msg["seq"], text))
+        self.send_text(text)
+
+    def send_audio(self, frames, size, interval_ms):
+        payload = bytes((i * 7) & 0xFF for i in range(size))
+        next_at = time.monotonic()
+        for _ in range(frames):
+            if self.closed.is_set() or self.silent.is_set():
+                return
+            if self.send_frame(OPCODE_BINARY, payload):
+                self.stats.add("tx_binary_messages", agent=self.agent_id)
+                self.stats.add("tx_binary_bytes", size, agent=self.agent_id)
+            if interval_ms:
+                next_at += interval_ms / 1000
+                time.sleep(max(0, next_at - time.monotonic()))
+
+    # Script
+
+    def wait(self, msg_type, count, timeout_ms, step_index):
+        deadline = time.monotonic() + timeout_ms / 1000
+        seen = 0
+        while seen < count:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                self.stats.error(f"{self.agent_id}#{self.index} step {step_index}: timed out waiting for {count} {msg_type}, got {seen}")
+                return False
+            try:
+                item = self.received.get(timeout=remaining)
+            except queue.Empty:
+                continue
+            if item is None:
+                return False
+            if item[0] == msg_type or msg_type == "any":
+                seen += 1
+                self.last_received = item[1]
+        return True
+
+    def run_steps(self, steps, variables):
+        for i, step in enumerate(steps):
+            if self.closed.is_set():
+                return False
+            if "repeat" not in step:
+                # The steps of a repeat are substituted on every iteration, with their own ${i}
+                step = substitute(step, variables)
+            if "wait" in step:
+                if not self.wait(step["wait"], step.get("count", 1), step.get("timeout_ms", 30000), i):
+                    return False
+            elif "send" in step:
+                self.send_json(step["send"], compress=step.get("compress"))
+            elif "send_raw" in step:
+                self.send_text(step["send_raw"])
+            elif "send_audio" in step:
+                audio = step["send_audio"]
+                self.send_audio(audio.get("frames", 1), audio.get("size", 80), audio.get("interval_ms", 0))
+            elif "sleep_ms" in step:
+                time.sleep(step["sleep_ms"] / 1000)
+            elif "repeat" in step:
+                for n in range(step["repeat"]):
+                    if not self.run_steps(step["steps"], dict(variables, i=n)):
+                        return False
+            elif "throttle_bps" in step:
+                self.throttle_bps = step["throttle_bps"]
+            elif "silence" in step:
+                # Stop answering pings and sending, without closing: the link looks dead to the device
+                self.silent.set()
+                self.closed.wait(step.get("timeout_ms", 60000) / 1000)
+                return False
+            elif "close" in step:
+                self.close(abort=step["close"] == "abort")
+                return False
+            else:
+                self.stats.error(f"unknown step {step}")
+        return True
+
+    def close(self, abort):
+        with self.send_lock:
+            if self.closed.is_set():
+                return
+            try:
+                if abort:
+                    # RST instead of FIN, as a lost connection
+                    self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_LINGER, struct.pack("ii", 1, 0))
+                else:
+                    self.sock.sendall(bytes([0x80 | OPCODE_CLOSE, 2]) + struct.pack(">H", 1000))
+                self.sock.shutdown(socket.SHUT_RDWR)
+            except OSError:
+                pass
+            self.closed.set()
+
+    def run(self):
+        self.stats.add("connections", agent=self.agent_id)
+        if self.throttle_bps:
+            self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4096)
+        reader = threading.Thread(target=self.reader, daemon=True)
+        reader.start()
+        # The script starts once the handshake is acknowledged
+        if self.wait("handshake", 1, 10000, -1):
+            finished = self.run_steps(self.config.get("script", []), {"conn": self.index, "i": 0})
+            if finished and not self.config.get("close_after_script", False):
+                self.closed.wait()
+            elif finished:
+                self.close(abort=False)
+        reader.join(timeout=5)
+
+
+PAD_PATTERN = re.compile(r"\$\{pad:(\d+)\}")
+
+
+def substitute(value, variables):
+    """Replaces ${conn} and ${i} in the strings of a step, and ${pad:N} with N characters."""
+    if isinstance(value, str):
+        for name, v in variables.items():
+            value = value.replace("${" + name + "}", str(v))
+        return PAD_PATTERN.sub(lambda m: "x" * int(m.group(1)), value)
+    if isinstance(value, list):
+        return [substitute(v, variables) for v in value]
+    if isinstance(value, dict):
+        return {k: substitute(v, variables) for k, v in value.items()}
+    return value
+
+
+class MockAgentServer(ThreadingHTTPServer):
+    daemon_threads = True
+    allow_reuse_address = True
+
+    def __init__(self, address, scenario, stats):
+        super().__init__(address, Handler)
+        self.scenario = scenario
+        self.stats = stats
+        self.conversations = {}
+        self.connection_counts = {}
+        self.lock = threading.Lock()
+
+    def agent_config(self, agent_id):
+        server = self.scenario.get("server", {})
+        agents = server.get("agents", {})
+        return dict(server, **agents.get(agent_id, {}))
+
+    def connection_config(self, agent_id, index):
+        config = self.agent_config(agent_id)
+        connections = config.get("connections")
+        if connections:
+            config = dict(config, **connections[min(index, len(connections) - 1)])
+        return config
+
+    def next_connection(self, agent_id):
+        with self.lock:
+            index = self.connection_counts.get(agent_id, 0)
+            self.connection_counts[agent_id] = index + 1
+            return index
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def log_message(self, fmt, *args):
+        if self.server.scenario.get("verbose"):
+            super().log_message(fmt, *args)
+
+    def do_POST(self):
+        length = int(self.headers.get("Content-Length", 0))
+        body = self.rfile.read(length) if length else b""
+        if urlparse(self.path).path != "/user/auth/tokens":
+            self.send_error(404)
+            return
+        try:
+            refresh_token = json.loads(body).get("refresh_token")
+        except ValueError:
+            refresh_token = None
+        if not refresh_token:
+            self.send_error(400)
+            return
+        delay_ms = self.server.scenario.get("server", {}).get("token_delay_ms", 0)
+        if delay_ms:
+            time.sleep(delay_ms / 1000)
+        self.server.stats.add("tokens")
+        reply = json.dumps({"access_token": "host-test-" + uuid.uuid4().hex}).encode()
+        self.send_response(200)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(reply)))
+        self.end_headers()
+        self.wfile.write(reply)
+
+    def do_GET(self):
+        url = urlparse(self.path)
+        parts = url.path.strip("/").split("/")
+        if len(parts) != 4 or parts[:2] != ["user", "agents"] or parts[3] != "ws":
+            self.send_error(404)
+            return
+        if not parse_qs(url.query).get("token") or self.headers.get("Upgrade", "").lower() != "websocket":
+            self.send_error(400)
+            return
+        agent_id = parts[2]
+        index = self.server.next_connection(agent_id)
+        config = self.server.connection_config(agent_id, index)
+        if config.get("reject"):
+            self.send_error(config["reject"])
+            return
+        delay_ms = config.get("connect_delay_ms", 0)
+        if delay_ms:
+            time.sleep(delay_ms / 1000)
+
+        accept = base64.b64encode(hashlib.sha1((self.headers["Sec-WebSocket-Key"] + WS_GUID).encode()).digest()).decode()
+        self.send_response(101)
+        self.send_header("Upgrade", "websocket")
+        self.send_header("Connection", "Upgrade")
+        self.send_header("Sec-WebSocket-Accept", accept)
+        self.end_headers()
+        self.wfile.flush()
+
+        Connection(self.server, self, agent_id, index).run()
+        self.close_connection = True
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", type=int, default=8765)
+    parser.add_argument("--scenario", required=True, help="Scenario JSON file")
+    parser.add_argument("--report", help="Where to write the server statistics (JSON)")
+    args = parser.parse_args()
+
+    with open(args.scenario) as f:
+        scenario = json.load(f)
+
+    stats = Stats()
+    server = MockAgentServer(("127.0.0.1", args.port), scenario, stats)
+
+    def stop(signum, frame):
+        threading.Thread(target=server.shutdown, daemon=True).start()
+
+    signal.signal(signal.SIGTERM, stop)
+    signal.signal(signal.SIGINT, stop)
+    print(f"mock_agent_server: listening on 127.0.0.1:{args.port}", flush=True)
+    try:
+        server.serve_forever(poll_interval=0.1)
+    finally:
+        stats.dump(args.report)
+
+
+if __name__ == "__main__":
+    main()
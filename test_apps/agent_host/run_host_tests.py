@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Runs the host test scenarios of the agent component.
+
+For every scenarios/*.json: starts the mock agent server with the scenario, runs the
+linux build of this app with the test case of the scenario, and checks the metrics the
+device reported and the statistics the server collected against the thresholds.
+
+    ./run_host_tests.py --build
+    ./run_host_tests.py --filter resume --report report.json
+
+The scenario format is described in README.md.
+"""
+
+import argparse
+import glob
+import json
+import os
+import signal
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = os.path.dirname(os.path.abspath(__file__))
+MOCK_SERVER = os.path.join(ROOT, "mock_server", "mock_agent_server.py")
+DEFAULT_ELF = os.path.join(ROOT, "build", "agent_host.elf")
+PORT = 8765
+RESULT_PREFIX = "HOST_TEST_RESULT "
+
+
+def build():
+    subprocess.run(["idf.py", "--preview", "set-target", "linux"], cwd=ROOT, check=True)
+    subprocess.run(["idf.py", "build"], cwd=ROOT, check=True)
+
+
+def wait_for_port(port, timeout_s):
+    deadline = time.monotonic() + timeout_s
+    while time.monotonic() < deadline:
+        try:
+            with socket.create_connection(("localhost", port), timeout=0.2):
+                return True
+        except OSError:
+            time.sleep(0.05)
+    return False
+
+
+def lookup(data, path):
+    """Value at a dotted path, e.g. device.latency.first_codec_write.p90_ms."""
+    value = data
+    for key in path.split("."):
+        if isinstance(value, dict) and key in value:
+            value = value[key]
+        elif isinstance(value, list) and key.isdigit() and int(key) < len(value):
+            value = value[int(key)]
+        else:
+            return None
+    return value
+
+
+def check_thresholds(thresholds, data):
+    failures = []
+    for path, limits in thresholds.items():
+        value = lookup(data, path)
+        if value is None:
+            failures.append(f"{path}: not reported")
+            continue
+        if "eq" in limits and value != limits["eq"]:
+            failures.append(f"{path} = {value}, expected {limits['eq']}")
+        if "min" in limits and value < limits["min"]:
+            failures.append(f"{path} = {value}, expected >= {limits['min']}")
+        if "max" in limits and value > limits["max"]:
+            failures.append(f"{path} = {value}, expected <= {limits['max']}")
+    return failures
+
+
+def run_scenario(path, elf, verbose):
+    with open(path) as f:
+        scenario = json.load(f)
+    name = os.path.splitext(os.path.basename(path))[0]
+    timeout_s = scenario.get("timeout_s", 60)
+    result = {"scenario": name, "test": scenario["test"], "passed": False, "failures": []}
+
+    with tempfile.TemporaryDirectory() as tmp:
+        scenario_path = os.path.join(tmp, "scenario.json")
+        report_path = os.path.join(tmp, "server.json")
+        with open(scenario_path, "w") as f:
+            json.dump(scenario, f)
+
+        server = subprocess.Popen([sys.executable, MOCK_SERVER, "--port", str(PORT),
+                                   "--scenario", scenario_path, "--report", report_path])
+        try:
+            if not wait_for_port(PORT, 5):
+                result["failures"].append("mock server did not start")
+                return result
+
+            env = dict(os.environ, HOST_TEST=scenario["test"], HOST_TEST_ARGS=json.dumps(scenario.get("args", {})))
+            try:
+                device = subprocess.run([elf], env=env, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                        timeout=timeout_s, text=True, errors="replace")
+                output = device.stdout
+            except subprocess.TimeoutExpired as e:
+                output = e.stdout.decode(errors="replace") if isinstance(e.stdout, bytes) else (e.stdout or "")
+                result["failures"].append(f"timed out after {timeout_s} s")
+        finally:
+            server.send_signal(signal.SIGTERM)
+            try:
+                server.wait(timeout=10)
+            except subprocess.TimeoutExpired:
+                server.kill()
+
+        if verbose:
+            print(output)
+        device_result = None
+        for line in output.splitlines():
+            if line.startswith(RESULT_PREFIX):
+                device_result = json.loads(line[len(RESULT_PREFIX):])
+        server_report = {}
+        if os.path.exists(report_path):
+            with open(report_path) as f:
+                server_report = json.load(f)
+
+    if device_result is None:
+        result["failures"].append("no result from the device")
+        result["output"] = output.splitlines()[-40:]
+        return result
+
+    result["duration_ms"] = device_result.get("duration_ms")
+    result["device"] = device_result.get("metrics", {})
+    result["server"] = server_report
+    if not device_result.get("passed"):
+        result["failures"].append(f"device: {device_result.get('error', 'failed')}")
+        if not verbose:
+            result["output"] = output.splitlines()[-40:]
+    result["failures"] += check_thresholds(scenario.get("thresholds", {}),
+                                           {"device": result["device"], "server": server_report})
+    result["passed"] = not result["failures"]
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--build", action="store_true", help="build the app for the linux target first")
+    parser.add_argument("--elf", default=DEFAULT_ELF, help="app to run (default: %(default)s)")
+    parser.add_argument("--filter", default="", help="only run the scenarios whose name contains this")
+    parser.add_argument("--report", help="write the results of all scenarios to this JSON file")
+    parser.add_argument("--verbose", action="store_true", help="print the output of the app")
+    args = parser.parse_args()
+
+    if args.build:
+        build()
+    if not os.path.exists(args.elf):
+        sys.exit(f"{args.elf} not found, run with --build")
+
+    results = []
+    for path in sorted(glob.glob(os.path.join(ROOT, "scenarios", "*.json"))):
+        if args.filter not in os.path.basename(path):
+            continue
+        result = run_scenario(path, args.elf, args.verbose)
+        results.append(result)
+        status = "PASS" if result["passed"] else "FAIL"
+        print(f"{status} {result['scenario']} ({result.get('duration_ms', '-')} ms)")
+        for failure in result["failures"]:
+            print(f"    {failure}")
+        for line in result.get("output", []):
+            print(f"    | {line}")
+
+    passed = sum(1 for r in results if r["passed"])
+    print(f"{passed}/{len(results)} scenarios passed")
+    if args.report:
+        with open(args.report, "w") as f:
+            json.dump(results, f, indent=2)
+    sys.exit(0 if results and passed == len(results) else 1)
+
+
+if __name__ == "__main__":
+    main()